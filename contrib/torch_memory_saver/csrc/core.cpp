@@ -1,5 +1,144 @@
 #include "core.h"
 #include "utils.h"
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+
+HostBackupPool::HostBackupPool() {
+  const char *limit = std::getenv("TMS_HOST_BACKUP_POOL_LIMIT_BYTES");
+  limit_bytes_ = limit != nullptr ? std::strtoull(limit, nullptr, 10)
+                                  : std::numeric_limits<size_t>::max();
+}
+
+void *HostBackupPool::acquire(size_t size) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // reuse a free block unless it would waste more than half of itself
+    auto it = free_blocks_.lower_bound(size);
+    if (it != free_blocks_.end() && it->first / 2 <= size) {
+      void *ptr = it->second;
+      pooled_bytes_ -= it->first;
+      free_blocks_.erase(it);
+      return ptr;
+    }
+  }
+  void *ptr = nullptr;
+  aclError ret = aclrtMallocHost(&ptr, size);
+  SIMPLE_CHECK(ret == ACL_SUCCESS && ptr != nullptr, "aclrtMallocHost failed");
+  const std::lock_guard<std::mutex> lock(mutex_);
+  capacity_.emplace(ptr, size);
+  return ptr;
+}
+
+void HostBackupPool::release(void *ptr) {
+  if (nullptr == ptr) {
+    return;
+  }
+  const std::lock_guard<std::mutex> lock(mutex_);
+  SIMPLE_CHECK(capacity_.count(ptr),
+               "Trying to release a host buffer not allocated here");
+  const size_t size = capacity_[ptr];
+  if (size <= limit_bytes_ - pooled_bytes_) {
+    free_blocks_.emplace(size, ptr);
+    pooled_bytes_ += size;
+    return;
+  }
+  capacity_.erase(ptr);
+  aclError ret = aclrtFreeHost(ptr);
+  SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtFreeHost failed");
+}
+
+void HostBackupPool::set_limit(size_t limit_bytes) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  limit_bytes_ = limit_bytes;
+  trim_locked();
+}
+
+size_t HostBackupPool::pooled_bytes() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return pooled_bytes_;
+}
+
+void HostBackupPool::trim_locked() {
+  // give back the largest buffers first, they free the most memory per call
+  while (pooled_bytes_ > limit_bytes_) {
+    auto it = std::prev(free_blocks_.end());
+    aclError ret = aclrtFreeHost(it->second);
+    SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtFreeHost failed");
+    capacity_.erase(it->second);
+    pooled_bytes_ -= it->first;
+    free_blocks_.erase(it);
+  }
+}
+
+PhysicalHandlePool::PhysicalHandlePool() {
+  const char *limit = std::getenv("TMS_PHYSICAL_POOL_LIMIT_BYTES");
+  limit_bytes_ = limit != nullptr ? std::strtoull(limit, nullptr, 10) : 0;
+}
+
+aclrtDrvMemHandle PhysicalHandlePool::acquire(int device, size_t size) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buckets_.find({device, size});
+    if (it != buckets_.end() && !it->second.empty()) {
+      aclrtDrvMemHandle handle = it->second.back().handle;
+      it->second.pop_back();
+      pooled_bytes_ -= size;
+      return handle;
+    }
+  }
+  aclrtDrvMemHandle handle;
+  CANNUtils::cann_mem_create(&handle, size, device);
+  return handle;
+}
+
+void PhysicalHandlePool::release(int device, size_t size,
+                                 aclrtDrvMemHandle handle,
+                                 const std::string &tag) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (pooled_bytes_ + size <= limit_bytes_) {
+      buckets_[{device, size}].push_back(Entry{handle, tag});
+      pooled_bytes_ += size;
+      return;
+    }
+  }
+  int ret = aclrtFreePhysical(handle);
+  SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtFreePhysical failed");
+}
+
+void PhysicalHandlePool::set_limit(size_t limit_bytes) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  limit_bytes_ = limit_bytes;
+  trim_locked();
+}
+
+size_t PhysicalHandlePool::pooled_bytes(const std::string &tag) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  size_t bytes = 0;
+  for (const auto &bucket : buckets_) {
+    for (const Entry &entry : bucket.second) {
+      if (tag.empty() || entry.tag == tag) {
+        bytes += bucket.first.second;
+      }
+    }
+  }
+  return bytes;
+}
+
+void PhysicalHandlePool::trim_locked() {
+  // give back the largest handles first, they free the most memory per call
+  for (auto it = buckets_.rbegin();
+       it != buckets_.rend() && pooled_bytes_ > limit_bytes_; ++it) {
+    std::vector<Entry> &entries = it->second;
+    while (!entries.empty() && pooled_bytes_ > limit_bytes_) {
+      int ret = aclrtFreePhysical(entries.back().handle);
+      SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtFreePhysical failed");
+      entries.pop_back();
+      pooled_bytes_ -= it->first.second;
+    }
+  }
+}
 
 TorchMemorySaver::TorchMemorySaver() {}
 
@@ -11,8 +150,7 @@ TorchMemorySaver &TorchMemorySaver::instance() {
 aclError TorchMemorySaver::malloc(void **ptr, int device, size_t size,
                                   const std::string &tag,
                                   const bool enable_cpu_backup) {
-  aclrtDrvMemHandle allocHandle;
-  CANNUtils::cann_mem_create(&allocHandle, size, device);
+  aclrtDrvMemHandle allocHandle = physical_handle_pool_.acquire(device, size);
   int ret = aclrtReserveMemAddress(ptr, size, 0, nullptr, 0);
   SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtReserveMemAddress failed");
   ret = aclrtMapMem(*ptr, size, 0, allocHandle, 0);
@@ -20,8 +158,9 @@ aclError TorchMemorySaver::malloc(void **ptr, int device, size_t size,
   {
     const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
     allocation_metadata_.emplace(
-        *ptr, AllocationMetadata{size, device, allocHandle, tag,
-                                 enable_cpu_backup, nullptr});
+        *ptr,
+        AllocationMetadata{size, device, allocHandle, tag, enable_cpu_backup,
+                           nullptr, AllocationState::ACTIVE});
   }
 #ifdef TMS_DEBUG_LOG
   std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.cuda_malloc "
@@ -34,15 +173,26 @@ aclError TorchMemorySaver::malloc(void **ptr, int device, size_t size,
 aclError TorchMemorySaver::free(void *ptr) {
   AllocationMetadata metadata;
   {
-    const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
+    std::unique_lock<std::mutex> lock(allocator_metadata_mutex_);
     SIMPLE_CHECK(allocation_metadata_.count(ptr),
                  "Trying to free a pointer not allocated here");
+    // a concurrent pause/resume owns the region until it publishes the result
+    transition_done_.wait(lock, [&]() {
+      return allocation_metadata_.at(ptr).state !=
+             AllocationState::TRANSITIONING;
+    });
     metadata = allocation_metadata_[ptr];
     allocation_metadata_.erase(ptr);
   }
-  int ret = aclrtUnmapMem(ptr);
-  ret = aclrtFreePhysical(metadata.allocHandle);
+  int ret;
+  // a paused region has no physical memory behind its address
+  if (metadata.state == AllocationState::ACTIVE) {
+    ret = aclrtUnmapMem(ptr);
+    physical_handle_pool_.release(metadata.device, metadata.size,
+                                  metadata.allocHandle, metadata.tag);
+  }
   ret = aclrtReleaseMemAddress(ptr);
+  host_backup_pool_.release(metadata.cpu_backup);
 #ifdef TMS_DEBUG_LOG
   std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.cuda_free "
             << " ptr=" << ptr << " metadata.size=" << metadata.size
@@ -52,78 +202,215 @@ aclError TorchMemorySaver::free(void *ptr) {
   return ACL_SUCCESS;
 }
 
-void TorchMemorySaver::pause(const std::string &tag) {
+std::vector<TorchMemorySaver::Region>
+TorchMemorySaver::begin_transition(const std::string &tag,
+                                   AllocationState from) {
+  std::vector<Region> regions;
   const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
   for (auto it = allocation_metadata_.begin(); it != allocation_metadata_.end();
        ++it) {
-    void *ptr = it->first;
     AllocationMetadata &metadata = it->second;
-    if (!tag.empty() && metadata.tag != tag) {
+    if ((!tag.empty() && metadata.tag != tag) || metadata.state != from) {
       continue;
     }
+    metadata.state = AllocationState::TRANSITIONING;
+    regions.push_back(Region{it->first, metadata});
+  }
+  return regions;
+}
 
-    if (metadata.enable_cpu_backup) {
-      if (nullptr == metadata.cpu_backup) {
-        aclrtMallocHost(&metadata.cpu_backup, metadata.size);
-      }
-      SIMPLE_CHECK(metadata.cpu_backup != nullptr,
-                   "cpu_backup should not be nullptr");
-      aclrtMemcpy(metadata.cpu_backup, metadata.size, ptr, metadata.size,
-                  ACL_MEMCPY_DEVICE_TO_HOST);
+void TorchMemorySaver::end_transition(const std::vector<Region> &regions,
+                                      AllocationState to) {
+  {
+    const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
+    for (const Region &region : regions) {
+      AllocationMetadata &metadata = allocation_metadata_.at(region.ptr);
+      metadata.allocHandle = region.metadata.allocHandle;
+      metadata.cpu_backup = region.metadata.cpu_backup;
+      metadata.state = to;
     }
+  }
+  transition_done_.notify_all();
+}
 
-    int ret = aclrtUnmapMem(ptr);
-    ret = aclrtFreePhysical(metadata.allocHandle);
+const std::vector<aclrtStream> &TorchMemorySaver::copy_streams(int device) {
+  std::vector<aclrtStream> &streams = copy_streams_[device];
+  while (streams.size() < NUM_COPY_STREAMS) {
+    aclrtStream stream;
+    aclError ret = aclrtCreateStream(&stream);
+    SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtCreateStream failed");
+    streams.push_back(stream);
+  }
+  return streams;
+}
 
-#ifdef TMS_DEBUG_LOG
-    std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.pause"
-              << " ptr=" << ptr << " metadata.size=" << metadata.size
-              << " metadata.allocHandle=" << metadata.allocHandle
-              << " tag=" << metadata.tag << " filter_tag=" << tag
-              << " metadata.enable_cpu_backup=" << metadata.enable_cpu_backup
-              << std::endl;
+void TorchMemorySaver::copy_regions(const std::vector<Region> &regions,
+                                    bool to_host) {
+  std::map<int, std::vector<const Region *>> device_regions;
+  for (const Region &region : regions) {
+    if (region.metadata.enable_cpu_backup) {
+      SIMPLE_CHECK(region.metadata.cpu_backup != nullptr,
+                   "cpu_backup should not be nullptr");
+      device_regions[region.metadata.device].push_back(&region);
+    }
+  }
+  if (device_regions.empty()) {
+    return;
+  }
 
-#endif
+  const int caller_device = CANNUtils::cann_ctx_get_device();
+  const aclrtMemcpyKind kind =
+      to_host ? ACL_MEMCPY_DEVICE_TO_HOST : ACL_MEMCPY_HOST_TO_DEVICE;
+  // issue the chunks of every device first, then wait, so that devices and
+  // streams overlap with each other
+  for (const auto &entry : device_regions) {
+    aclError ret = aclrtSetDevice(entry.first);
+    SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSetDevice failed");
+    if (to_host) {
+      // kernels on other streams may still be writing the regions
+      ret = aclrtSynchronizeDevice();
+      SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSynchronizeDevice failed");
+    }
+    const std::vector<aclrtStream> &streams = copy_streams(entry.first);
+    size_t chunk_id = 0;
+    for (const Region *region : entry.second) {
+      auto *device_ptr = static_cast<char *>(region->ptr);
+      auto *host_ptr = static_cast<char *>(region->metadata.cpu_backup);
+      for (size_t offset = 0; offset < region->metadata.size;
+           offset += COPY_CHUNK_SIZE) {
+        const size_t bytes =
+            std::min(COPY_CHUNK_SIZE, region->metadata.size - offset);
+        aclrtStream stream = streams[chunk_id++ % streams.size()];
+        if (to_host) {
+          ret = aclrtMemcpyAsync(host_ptr + offset, bytes, device_ptr + offset,
+                                 bytes, kind, stream);
+        } else {
+          ret = aclrtMemcpyAsync(device_ptr + offset, bytes, host_ptr + offset,
+                                 bytes, kind, stream);
+        }
+        SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtMemcpyAsync failed");
+      }
+    }
   }
+  for (const auto &entry : device_regions) {
+    aclError ret = aclrtSetDevice(entry.first);
+    SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSetDevice failed");
+    for (aclrtStream stream : copy_streams(entry.first)) {
+      ret = aclrtSynchronizeStream(stream);
+      SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSynchronizeStream failed");
+    }
+  }
+  aclError ret = aclrtSetDevice(caller_device);
+  SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSetDevice failed");
 }
 
-void TorchMemorySaver::resume(const std::string &tag) {
-  const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
-
-  for (auto it = allocation_metadata_.begin(); it != allocation_metadata_.end();
-       ++it) {
-    void *ptr = it->first;
-    AllocationMetadata &metadata = it->second;
+void TorchMemorySaver::pause(const std::string &tag) {
+  const std::lock_guard<std::mutex> transition_lock(transition_mutex_);
+  // the metadata lock is only held while picking and publishing regions,
+  // allocations outside of them are not blocked by the copies below
+  std::vector<Region> regions =
+      begin_transition(tag, AllocationState::ACTIVE);
 
-    if (!tag.empty() && metadata.tag != tag) {
-      continue;
+  for (Region &region : regions) {
+    AllocationMetadata &metadata = region.metadata;
+    if (metadata.enable_cpu_backup && nullptr == metadata.cpu_backup) {
+      metadata.cpu_backup = host_backup_pool_.acquire(metadata.size);
     }
+  }
+  copy_regions(regions, /*to_host=*/true);
 
-    aclrtDrvMemHandle newAllocHandle;
-    CANNUtils::cann_mem_create(&newAllocHandle, metadata.size, metadata.device);
+  CANNUtils::parallel_for(
+      regions.size(),
+      [&](size_t i) { return regions[i].metadata.device; },
+      [&](size_t i) {
+        void *ptr = regions[i].ptr;
+        const AllocationMetadata &metadata = regions[i].metadata;
+        int ret = aclrtUnmapMem(ptr);
+        SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtUnmapMem failed");
+        physical_handle_pool_.release(metadata.device, metadata.size,
+                                      metadata.allocHandle, metadata.tag);
 
-    aclrtMapMem(ptr, metadata.size, 0, newAllocHandle, 0);
+#ifdef TMS_DEBUG_LOG
+        std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.pause"
+                  << " ptr=" << ptr << " metadata.size=" << metadata.size
+                  << " metadata.allocHandle=" << metadata.allocHandle
+                  << " tag=" << metadata.tag << " filter_tag=" << tag
+                  << " metadata.enable_cpu_backup="
+                  << metadata.enable_cpu_backup << std::endl;
+#endif
+      });
 
-    if (metadata.enable_cpu_backup) {
-      SIMPLE_CHECK(metadata.cpu_backup != nullptr,
-                   "cpu_backup should not be nullptr");
-      // TODO may use cudaMemcpyAsync if needed
-      aclrtMemcpy(ptr, metadata.size, metadata.cpu_backup, metadata.size,
-                  ACL_MEMCPY_HOST_TO_DEVICE);
-      // maybe we can free host memory if needed (currently keep it there to
-      // reduce re-alloc time)
-    }
+  end_transition(regions, AllocationState::PAUSED);
+}
+
+void TorchMemorySaver::resume(const std::string &tag) {
+  const std::lock_guard<std::mutex> transition_lock(transition_mutex_);
+  std::vector<Region> regions =
+      begin_transition(tag, AllocationState::PAUSED);
+
+  CANNUtils::parallel_for(
+      regions.size(),
+      [&](size_t i) { return regions[i].metadata.device; },
+      [&](size_t i) {
+        void *ptr = regions[i].ptr;
+        AllocationMetadata &metadata = regions[i].metadata;
+        aclrtDrvMemHandle newAllocHandle =
+            physical_handle_pool_.acquire(metadata.device, metadata.size);
+        int ret = aclrtMapMem(ptr, metadata.size, 0, newAllocHandle, 0);
+        SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtMapMem failed");
 
 #ifdef TMS_DEBUG_LOG
-    std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.resume"
-              << " ptr=" << ptr << " metadata.size=" << metadata.size
-              << " (old)metadata.allocHandle=" << metadata.allocHandle
-              << " (new)newAllocHandle=" << newAllocHandle
-              << " tag=" << metadata.tag << " filter_tag=" << tag
-              << " metadata.enable_cpu_backup=" << metadata.enable_cpu_backup
-              << std::endl;
+        std::cout << "[torch_memory_saver.cpp] TorchMemorySaver.resume"
+                  << " ptr=" << ptr << " metadata.size=" << metadata.size
+                  << " (old)metadata.allocHandle=" << metadata.allocHandle
+                  << " (new)newAllocHandle=" << newAllocHandle
+                  << " tag=" << metadata.tag << " filter_tag=" << tag
+                  << " metadata.enable_cpu_backup="
+                  << metadata.enable_cpu_backup << std::endl;
 #endif
 
-    metadata.allocHandle = newAllocHandle;
+        metadata.allocHandle = newAllocHandle;
+      });
+
+  copy_regions(regions, /*to_host=*/false);
+  // the copies are done, the host backups go back to the pool and the next
+  // pause reuses them unless the pool limit trims them first
+  for (Region &region : regions) {
+    host_backup_pool_.release(region.metadata.cpu_backup);
+    region.metadata.cpu_backup = nullptr;
+  }
+
+  end_transition(regions, AllocationState::ACTIVE);
+}
+
+void TorchMemorySaver::set_physical_pool_limit(size_t limit_bytes) {
+  physical_handle_pool_.set_limit(limit_bytes);
+}
+
+void TorchMemorySaver::set_host_backup_pool_limit(size_t limit_bytes) {
+  host_backup_pool_.set_limit(limit_bytes);
+}
+
+void TorchMemorySaver::get_stats(const std::string &tag, size_t *mapped_bytes,
+                                 size_t *paused_bytes, size_t *pooled_bytes,
+                                 size_t *host_pooled_bytes) {
+  *mapped_bytes = 0;
+  *paused_bytes = 0;
+  {
+    const std::lock_guard<std::mutex> lock(allocator_metadata_mutex_);
+    for (const auto &entry : allocation_metadata_) {
+      const AllocationMetadata &metadata = entry.second;
+      if (!tag.empty() && metadata.tag != tag) {
+        continue;
+      }
+      // a region in transition still holds its physical memory or is about to
+      if (metadata.state == AllocationState::PAUSED) {
+        *paused_bytes += metadata.size;
+      } else {
+        *mapped_bytes += metadata.size;
+      }
+    }
   }
+  *pooled_bytes = physical_handle_pool_.pooled_bytes(tag);
+  *host_pooled_bytes = host_backup_pool_.pooled_bytes();
 }
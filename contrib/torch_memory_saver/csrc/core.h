@@ -1,10 +1,25 @@
 #pragma once
 #include "utils.h"
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <stdio.h>
 #include <string>
 #include <sys/types.h>
 #include <unordered_map>
+#include <vector>
+
+// Size of one async backup copy, chunks are spread round-robin over the copy
+// streams of a device so several of them are in flight at once
+static constexpr size_t COPY_CHUNK_SIZE = 64UL * 1024 * 1024;
+static constexpr size_t NUM_COPY_STREAMS = 4;
+
+enum class AllocationState {
+  ACTIVE,
+  PAUSED,
+  // pause/resume is moving this region with the metadata lock released
+  TRANSITIONING,
+};
 
 struct AllocationMetadata {
   size_t size;
@@ -13,6 +28,58 @@ struct AllocationMetadata {
   std::string tag;
   bool enable_cpu_backup;
   void *cpu_backup;
+  AllocationState state;
+};
+
+// Pinned host buffers kept across pause/resume cycles and between
+// allocations, so that a backup does not pay aclrtMallocHost every time. Idle
+// buffers are capped at limit bytes, the rest go back with aclrtFreeHost; the
+// limit defaults to TMS_HOST_BACKUP_POOL_LIMIT_BYTES, unbounded when unset.
+class HostBackupPool {
+public:
+  HostBackupPool();
+
+  void *acquire(size_t size);
+  void release(void *ptr);
+  void set_limit(size_t limit_bytes);
+  size_t pooled_bytes();
+
+private:
+  void trim_locked();
+
+  std::mutex mutex_;
+  size_t limit_bytes_;
+  size_t pooled_bytes_ = 0;
+  std::unordered_map<void *, size_t> capacity_;
+  std::multimap<size_t, void *> free_blocks_;
+};
+
+// Physical memory handles kept for reuse instead of going back to the driver
+// on pause/free, bucketed by (device, size). Pooled memory is still owned by
+// this process, so the pool never holds more than limit bytes; the limit
+// defaults to TMS_PHYSICAL_POOL_LIMIT_BYTES, 0 (disabled) when unset.
+class PhysicalHandlePool {
+public:
+  PhysicalHandlePool();
+
+  aclrtDrvMemHandle acquire(int device, size_t size);
+  void release(int device, size_t size, aclrtDrvMemHandle handle,
+               const std::string &tag);
+  void set_limit(size_t limit_bytes);
+  // bytes pooled by regions of tag, all tags if tag is empty
+  size_t pooled_bytes(const std::string &tag);
+
+private:
+  struct Entry {
+    aclrtDrvMemHandle handle;
+    std::string tag;
+  };
+  void trim_locked();
+
+  std::mutex mutex_;
+  size_t limit_bytes_;
+  size_t pooled_bytes_ = 0;
+  std::map<std::pair<int, size_t>, std::vector<Entry>> buckets_;
 };
 
 class TorchMemorySaver {
@@ -26,12 +93,40 @@ public:
   void pause(const std::string &tag);
   void resume(const std::string &tag);
 
+  void set_physical_pool_limit(size_t limit_bytes);
+  void set_host_backup_pool_limit(size_t limit_bytes);
+  // bytes of regions of tag that are mapped, paused and pooled, all tags if
+  // tag is empty; idle pinned host backups are not tagged and always counted
+  void get_stats(const std::string &tag, size_t *mapped_bytes,
+                 size_t *paused_bytes, size_t *pooled_bytes,
+                 size_t *host_pooled_bytes);
+
 private:
+  struct Region {
+    void *ptr;
+    AllocationMetadata metadata;
+  };
+
   TorchMemorySaver();
   ~TorchMemorySaver() = default;
   TorchMemorySaver(const TorchMemorySaver &) = delete;
   TorchMemorySaver &operator=(const TorchMemorySaver &) = delete;
 
+  std::vector<Region> begin_transition(const std::string &tag,
+                                       AllocationState from);
+  void end_transition(const std::vector<Region> &regions,
+                      AllocationState to);
+  void copy_regions(const std::vector<Region> &regions, bool to_host);
+  const std::vector<aclrtStream> &copy_streams(int device);
+
   std::mutex allocator_metadata_mutex_;
   std::unordered_map<void *, AllocationMetadata> allocation_metadata_;
+  // signalled by end_transition, a free of a region in transition waits on it
+  std::condition_variable transition_done_;
+
+  // serializes pause/resume, and guards copy_streams_
+  std::mutex transition_mutex_;
+  std::unordered_map<int, std::vector<aclrtStream>> copy_streams_;
+  HostBackupPool host_backup_pool_;
+  PhysicalHandlePool physical_handle_pool_;
 };
@@ -97,4 +97,19 @@ void tms_resume(const char *tag) {
   std::string tag_str = (tag != nullptr) ? std::string(tag) : "";
   TorchMemorySaver::instance().resume(tag_str);
 }
+
+void tms_set_physical_pool_limit(size_t limit_bytes) {
+  TorchMemorySaver::instance().set_physical_pool_limit(limit_bytes);
+}
+
+void tms_set_host_backup_pool_limit(size_t limit_bytes) {
+  TorchMemorySaver::instance().set_host_backup_pool_limit(limit_bytes);
+}
+
+void tms_get_stats(const char *tag, size_t *mapped_bytes, size_t *paused_bytes,
+                   size_t *pooled_bytes, size_t *host_pooled_bytes) {
+  std::string tag_str = (tag != nullptr) ? std::string(tag) : "";
+  TorchMemorySaver::instance().get_stats(tag_str, mapped_bytes, paused_bytes,
+                                         pooled_bytes, host_pooled_bytes);
+}
 }
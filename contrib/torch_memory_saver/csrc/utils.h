@@ -1,6 +1,10 @@
 #pragma once
 #include <acl/acl.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 // #define TMS_DEBUG_LOG
 
@@ -46,4 +50,44 @@ static int cann_ctx_get_device() {
 
 static int cann_device_get(int device_ordinal) { return device_ordinal; }
 
+// Upper bound of threads mapping/unmapping physical memory in parallel
+static constexpr size_t MAX_MAP_THREADS = 8;
+
+// Runs fn(i) for i in [0, n) on up to MAX_MAP_THREADS worker threads. Every
+// worker binds itself to the device returned by device_of(i) before calling
+// fn(i) and restores its previous device when done, the device of the calling
+// thread is left untouched.
+template <typename DeviceOf, typename Fn>
+static void parallel_for(size_t n, DeviceOf device_of, Fn fn) {
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    // a fresh thread has no device yet, there is nothing to restore then
+    int previous_device = -1;
+    if (aclrtGetDevice(&previous_device) != ACL_SUCCESS) {
+      previous_device = -1;
+    }
+    int current_device = previous_device;
+    for (size_t i = next++; i < n; i = next++) {
+      const int device = device_of(i);
+      if (device != current_device) {
+        aclError ret = aclrtSetDevice(device);
+        SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSetDevice failed");
+        current_device = device;
+      }
+      fn(i);
+    }
+    if (previous_device >= 0 && current_device != previous_device) {
+      aclError ret = aclrtSetDevice(previous_device);
+      SIMPLE_CHECK(ret == ACL_SUCCESS, "aclrtSetDevice failed");
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < std::min(n, MAX_MAP_THREADS); ++t) {
+    threads.emplace_back(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
 } // namespace CANNUtils
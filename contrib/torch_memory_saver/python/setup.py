@@ -75,6 +75,8 @@ setup(
                 *extra_macros,
             ],
             extra_compile_args=extra_compile_args,
+            # pause/resume map and unmap physical memory on worker threads
+            extra_link_args=["-pthread"],
             py_limited_api=True,
         )
         for name, extra_macros in [
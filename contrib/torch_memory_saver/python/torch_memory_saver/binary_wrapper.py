@@ -30,3 +30,12 @@ def _setup_function_signatures(cdll):
     cdll.tms_set_enable_cpu_backup.argtypes = [ctypes.c_bool]
     cdll.tms_pause.argtypes = [ctypes.c_char_p]
     cdll.tms_resume.argtypes = [ctypes.c_char_p]
+    cdll.tms_set_physical_pool_limit.argtypes = [ctypes.c_size_t]
+    cdll.tms_set_host_backup_pool_limit.argtypes = [ctypes.c_size_t]
+    cdll.tms_get_stats.argtypes = [
+        ctypes.c_char_p,
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.POINTER(ctypes.c_size_t),
+        ctypes.POINTER(ctypes.c_size_t),
+    ]
@@ -2,7 +2,7 @@ import ctypes
 import logging
 import os
 from contextlib import contextmanager
-from typing import Optional
+from typing import Dict, Optional
 
 import torch
 
@@ -61,6 +61,22 @@ class TorchMemorySaver:
         """Resume memory for specific tag or all memory if tag is None"""
         self._impl.resume(tag=tag)
 
+    def set_physical_pool_limit(self, limit_bytes: int):
+        """Keep up to limit_bytes of released physical memory for reuse, 0 disables pooling"""
+        self._ensure_initialized()
+        self._impl.set_physical_pool_limit(limit_bytes)
+
+    def set_host_backup_pool_limit(self, limit_bytes: int):
+        """Keep up to limit_bytes of idle pinned host backups for reuse, 0 frees them all"""
+        self._ensure_initialized()
+        self._impl.set_host_backup_pool_limit(limit_bytes)
+
+    def get_stats(self, tag: Optional[str] = None) -> Dict[str, int]:
+        """Bytes mapped, paused and pooled for specific tag or all tags if tag is None,
+        and bytes of idle pinned host backups"""
+        self._ensure_initialized()
+        return self._impl.get_stats(tag=tag)
+
     # for compatibility
     @property
     def enabled(self):
@@ -154,6 +170,29 @@ class _TorchMemorySaverImpl:
         tag_bytes = tag.encode("utf-8") if tag else None
         self._binary_wrapper.cdll.tms_resume(tag_bytes)
 
+    def set_physical_pool_limit(self, limit_bytes: int):
+        self._binary_wrapper.cdll.tms_set_physical_pool_limit(limit_bytes)
+
+    def set_host_backup_pool_limit(self, limit_bytes: int):
+        self._binary_wrapper.cdll.tms_set_host_backup_pool_limit(limit_bytes)
+
+    def get_stats(self, tag: Optional[str]) -> Dict[str, int]:
+        tag_bytes = tag.encode("utf-8") if tag else None
+        mapped, paused, pooled, host_pooled = (ctypes.c_size_t() for _ in range(4))
+        self._binary_wrapper.cdll.tms_get_stats(
+            tag_bytes,
+            ctypes.byref(mapped),
+            ctypes.byref(paused),
+            ctypes.byref(pooled),
+            ctypes.byref(host_pooled),
+        )
+        return dict(
+            mapped_bytes=mapped.value,
+            paused_bytes=paused.value,
+            pooled_bytes=pooled.value,
+            host_pooled_bytes=host_pooled.value,
+        )
+
 
 def _sanity_checks():
     if "expandable_segments:True" in os.environ.get("PYTORCH_CUDA_ALLOC_CONF", ""):
@@ -21,6 +21,12 @@ def run(hook_mode: str):
             (20_000_000,), 20, dtype=torch.uint8, device="npu"
         )
 
+    print("Allocate tensor_multi_chunk")
+    with torch_memory_saver.region(enable_cpu_backup=True):
+        # spans several copy chunks, the tail is not chunk-aligned
+        tensor_multi_chunk = torch.arange(50_000_003, dtype=torch.int32, device="npu")
+    expect_multi_chunk = tensor_multi_chunk.cpu()
+
     print(f"{tensor_with_backup[:3]=} {tensor_without_backup[:3]=}")
     assert tensor_with_backup[:3].tolist() == [10, 10, 10]
     assert tensor_without_backup[:3].tolist() == [20, 20, 20]
@@ -35,6 +41,25 @@ def run(hook_mode: str):
     print(f"{tensor_with_backup[:3]=} {tensor_without_backup[:3]=}")
     assert tensor_with_backup[:3].tolist() == [10, 10, 10]
     assert tensor_without_backup[:3].tolist() != [20, 20, 20]
+    assert torch.equal(tensor_multi_chunk.cpu(), expect_multi_chunk)
+
+    # resume parks the host backups in the pool, a second cycle reuses them
+    host_pooled_bytes = torch_memory_saver.get_stats()["host_pooled_bytes"]
+    assert host_pooled_bytes >= 20_000_000 + tensor_multi_chunk.nbytes
+    torch_memory_saver.pause()
+    assert torch_memory_saver.get_stats()["host_pooled_bytes"] == 0
+    torch_memory_saver.resume()
+    assert torch.equal(tensor_multi_chunk.cpu(), expect_multi_chunk)
+    assert torch_memory_saver.get_stats()["host_pooled_bytes"] == host_pooled_bytes
+
+    # a zero limit frees the idle backups, later cycles allocate and free their own
+    torch_memory_saver.set_host_backup_pool_limit(0)
+    assert torch_memory_saver.get_stats()["host_pooled_bytes"] == 0
+    torch_memory_saver.pause()
+    torch_memory_saver.resume()
+    assert tensor_with_backup[:3].tolist() == [10, 10, 10]
+    assert torch.equal(tensor_multi_chunk.cpu(), expect_multi_chunk)
+    assert torch_memory_saver.get_stats()["host_pooled_bytes"] == 0
 
 
 if __name__ == "__main__":
@@ -0,0 +1,59 @@
+import logging
+import sys
+
+import torch
+from torch_memory_saver import torch_memory_saver
+
+
+def run(hook_mode: str):
+    torch_memory_saver.hook_mode = hook_mode
+    logging.basicConfig(level=logging.DEBUG, stream=sys.stdout)
+    size = 200 * 1024 * 1024
+
+    with torch_memory_saver.region(tag="pooled"):
+        pooled_tensor = torch.full((size,), 1, dtype=torch.uint8, device="npu")
+    with torch_memory_saver.region(tag="other"):
+        other_tensor = torch.full((size,), 2, dtype=torch.uint8, device="npu")
+    torch.npu.synchronize()
+
+    stats = torch_memory_saver.get_stats("pooled")
+    print(f"Before pause {stats=}")
+    assert stats["mapped_bytes"] >= size
+    assert stats["paused_bytes"] == 0
+    assert stats["pooled_bytes"] == 0
+
+    # without a limit, pause gives the memory back to the driver
+    torch_memory_saver.pause("pooled")
+    stats = torch_memory_saver.get_stats("pooled")
+    print(f"After pause without pool {stats=}")
+    assert stats["mapped_bytes"] == 0
+    assert stats["paused_bytes"] >= size
+    assert stats["pooled_bytes"] == 0
+    torch_memory_saver.resume("pooled")
+
+    torch_memory_saver.set_physical_pool_limit(4 * size)
+    for _ in range(3):
+        torch_memory_saver.pause("pooled")
+        stats = torch_memory_saver.get_stats("pooled")
+        print(f"After pause with pool {stats=}")
+        assert stats["pooled_bytes"] == stats["paused_bytes"]
+        torch_memory_saver.resume("pooled")
+        stats = torch_memory_saver.get_stats("pooled")
+        assert stats["pooled_bytes"] == 0
+
+    # the other tag is untouched by pause/resume of "pooled"
+    assert torch_memory_saver.get_stats("other")["paused_bytes"] == 0
+    assert other_tensor[:3].tolist() == [2, 2, 2]
+
+    # lowering the limit gives pooled memory back
+    torch_memory_saver.pause("pooled")
+    torch_memory_saver.set_physical_pool_limit(0)
+    assert torch_memory_saver.get_stats()["pooled_bytes"] == 0
+    torch_memory_saver.resume("pooled")
+
+    pooled_tensor.fill_(3)
+    assert pooled_tensor[:3].tolist() == [3, 3, 3]
+
+
+if __name__ == "__main__":
+    run(hook_mode=sys.argv[1])
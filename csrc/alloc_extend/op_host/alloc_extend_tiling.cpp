@@ -9,32 +9,33 @@
 // limitations under the License.
 #include "defines.h"
 #include "alloc_extend_tiling.h"
-#include "tiling/platform/platform_ascendc.h"
 #include "aclrtlaunch_alloc_extend.h"
 #include "torch_helper.h"
+#include "platform_info.h"
+#include "tiling_cache.h"
 
 namespace sglang {
 namespace npu_kernel {
-constexpr uint32_t PADDING_BYTE = 32U;
 
 at::Tensor get_tiling(int32_t &block_dim, int32_t &workspace_size, const int64_t &page_size, int32_t &batch_size,
                       int64_t &total_extend_tokens)
 {
-    auto ascendc_platform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    int32_t max_aiv_core = static_cast<int32_t>(ascendc_platform->GetCoreNumAiv());
-    block_dim = std::min(max_aiv_core, batch_size);
-    workspace_size = static_cast<int32_t>(ascendc_platform->GetLibApiWorkSpaceSize());
+    const auto &platform_info = PlatformInfoRegistry::Get();
+    workspace_size = static_cast<int32_t>(platform_info.libApiWorkspaceSize);
 
-    int32_t tiling_size = (sizeof(AllocExtendTilingData) + PADDING_BYTE - 1) / PADDING_BYTE * PADDING_BYTE;
-    auto tiling_buffer = at::empty({tiling_size}, at::TensorOptions().dtype(at::kByte).device(at::kCPU));
-
-    AllocExtendTilingData *tiling_data = reinterpret_cast<AllocExtendTilingData *>(tiling_buffer.data_ptr());
-    tiling_data->batch_size = batch_size;
-    tiling_data->page_size = static_cast<int32_t>(page_size);
-    tiling_data->used_core_num = block_dim;
-    tiling_data->total_extend_tokens = total_extend_tokens;
-
-    auto tiling_tensor = TorchNpuHelper::CopyTensorHostToDevice(tiling_buffer);
+    at::Tensor tiling_tensor;
+    auto key = TilingKey("alloc_extend").Add(page_size).Add(batch_size).Add(total_extend_tokens);
+    auto tiling_data = TilingCache::Instance().GetOrCreate<AllocExtendTilingData>(
+        key,
+        [&](AllocExtendTilingData &tiling) {
+            int32_t max_aiv_core = static_cast<int32_t>(platform_info.coreNumAiv);
+            tiling.batch_size = batch_size;
+            tiling.page_size = static_cast<int32_t>(page_size);
+            tiling.used_core_num = std::min(max_aiv_core, batch_size);
+            tiling.total_extend_tokens = total_extend_tokens;
+        },
+        tiling_tensor);
+    block_dim = tiling_data.used_core_num;
     return tiling_tensor;
 }
 
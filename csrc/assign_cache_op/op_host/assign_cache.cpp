@@ -1,10 +1,10 @@
 #include <iostream>
 #include "acl/acl.h"
 #include "kernel_tiling/kernel_tiling.h"
-#include "tiling/platform/platform_ascendc.h"
 #include "tiling_data.h"
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 #include "aclrtlaunch_assign_cache_op.h"
 
 namespace sglang {
@@ -43,10 +43,9 @@ HOST_API bool assign_cache_op(at::Tensor &dstTensor, const at::Tensor &srcTensor
     OP_CHECK(dstShape[0] == dstStartShape[0] && dstShape[0] == dstEndShape[0],
              "batch size is not same between srcTensor and dstTensor", return false);
 
-    auto ascendcPlatform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    uint32_t blockDim = static_cast<uint32_t>(ascendcPlatform->GetCoreNumAiv());
-    uint64_t ubSize;
-    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
+    const auto &platformInfo = PlatformInfoRegistry::Get();
+    uint32_t blockDim = platformInfo.coreNumAiv;
+    uint64_t ubSize = platformInfo.ubSize;
     uint32_t eleBytes = GetElementByteSize(dstTensor);
     uint32_t syncWorkspaceSize = blockDim * 32 + blockDim * 32 + 32;
     struct CustomAssignTilingData tilingData = {.batchSize = static_cast<uint32_t>(dstShape[0]),
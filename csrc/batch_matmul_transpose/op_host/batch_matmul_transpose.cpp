@@ -6,6 +6,7 @@
 #include "tiling/tiling_data.h"
 #include "defines.h"
 #include "torch_helper.h"
+#include "tiling_cache.h"
 #include "common_tiling.h"
 #include "aclrtlaunch_batch_matmul_transpose.h"
 
@@ -28,9 +29,6 @@ std::unordered_map<c10::ScalarType, TensorDType> atType2tensorDType = {
     {at::ScalarType::BFloat16, TensorDType::TENSOR_DTYPE_BF16},
     {at::ScalarType::Half, TensorDType::TENSOR_DTYPE_FLOAT16}};
 
-// batch size -> memory index
-constexpr uint32_t MAX_CAPTURE_NUM = 1024;
-
 template <typename MapType>
 inline int GetModeVal(const MapType &mode_map, c10::optional<c10::string_view> mode_opt, c10::string_view default_mode,
                       const char *mode_name)
@@ -82,39 +80,42 @@ HOST_API void batch_matmul_transpose(const at::Tensor &tensor_a, const at::Tenso
                        .m = static_cast<uint32_t>(tensorAShape[0]),
                        .k = static_cast<uint32_t>(tensorAShape[2]),
                        .n = n};
-    PpMatmulTilingData matmulTilingData = {
-        .opShape = opShape,
-    };
-    auto dType = atType2tensorDType[aType];
-    MatMulInfo mmInfo = {.batchSize = opShape.batchSize,
-                         .m = opShape.m,
-                         .k = opShape.k,
-                         .n = opShape.n,
-                         .dtypeA = dType,
-                         .dtypeB = dType,
-                         .dtypeC = dType,
-                         .formatB = formatMode,
-                         .mmType = MatMul::MatMulType::MATMUL_EIN_SUM,
-                         .inDtype = dTypeMap[aType],
-                         .outDtype = dTypeMap[cType],
-                         .quantMode = quantMode};
-    GetPpMatmulTiling(mmInfo, hwInfo, block_dim, matmulTilingData);
-    host_utils::PpMatmulTilingCheck(matmulTilingData);
+    TORCH_CHECK(opShape.m > 0, "m must be positive, got ", opShape.m);
 
     // tiling
-    int32_t batchIdx = opShape.m - 1;
-    uint32_t tilingSize = sizeof(PpMatmulTilingData);
-    static auto global_tiling_data = at::empty(
-        {tilingSize * MAX_CAPTURE_NUM}, at::TensorOptions().dtype(at::kByte).device(tensor_a.options().device()));
-    if (batchIdx >= 0 && batchIdx < MAX_CAPTURE_NUM) {
-        aclrtMemcpy(global_tiling_data.data_ptr<uint8_t>() + (tilingSize * batchIdx), tilingSize, &matmulTilingData,
-                    tilingSize, ACL_MEMCPY_HOST_TO_DEVICE);
-    } else {
-        // Handle the case where batchIdx is out of range
-        TORCH_CHECK(false, "batchIdx is out of range: ", batchIdx);
-    }
-    at::Tensor tiling_tensor =
-        at::from_blob(global_tiling_data.data_ptr<uint8_t>() + (tilingSize * batchIdx), tilingSize, at::kByte);
+    at::Tensor tiling_tensor;
+    auto key = TilingKey("batch_matmul_transpose")
+                   .Add(aType)
+                   .Add(static_cast<int64_t>(formatMode))
+                   .Add(static_cast<int64_t>(quantMode))
+                   .Add(opShape.batchSize)
+                   .Add(opShape.m)
+                   .Add(opShape.k)
+                   .Add(opShape.n);
+    auto matmulTilingData = TilingCache::Instance().GetOrCreate<PpMatmulTilingData>(
+        key,
+        [&](PpMatmulTilingData &tilingData) {
+            tilingData.opShape = opShape;
+            auto dType = atType2tensorDType[aType];
+            MatMulInfo mmInfo = {.batchSize = opShape.batchSize,
+                                 .m = opShape.m,
+                                 .k = opShape.k,
+                                 .n = opShape.n,
+                                 .dtypeA = dType,
+                                 .dtypeB = dType,
+                                 .dtypeC = dType,
+                                 .formatB = formatMode,
+                                 .mmType = MatMul::MatMulType::MATMUL_EIN_SUM,
+                                 .inDtype = dTypeMap[aType],
+                                 .outDtype = dTypeMap[cType],
+                                 .quantMode = quantMode};
+            // the block dim is also kept in tilingData.blockDim, which is what hits read back
+            uint32_t tilingBlockDim = 0;
+            GetPpMatmulTiling(mmInfo, hwInfo, tilingBlockDim, tilingData);
+            host_utils::PpMatmulTilingCheck(tilingData);
+        },
+        tiling_tensor);
+    block_dim = matmulTilingData.blockDim;
 
     EXEC_KERNEL_CMD(batch_matmul_transpose, block_dim, tensor_a, tensor_b, tensor_c, tiling_tensor);
 }
@@ -31,7 +31,7 @@ bool IsI8Bf16Kernel(const MatMulInfo &mmInfo)
 
 HardwareInfo::HardwareInfo()
 {
-    auto &platform = PlatformInfo::Instance();
+    const auto platform = PlatformInfo::Current();
     coreNum = platform.coreNumAic;
     l2Size = platform.l2Size;
     l1Size = platform.l1Size;
@@ -61,7 +61,8 @@ void PpMatmulTilingData::SetBaseOp(uint32_t coreNum, uint32_t mBase, uint32_t nB
     if (mLoop == 1 && mmInfo.transB && coreLoop % coreNum < coreNum / CONST_4 * CONST_3) {
         mBase = RoundUp<uint32_t>(opShape.m, CONST_16);
         opShape.m0 = mBase;
-        uint32_t maxN0 = PlatformInfo::Instance().l0cSize / (mBase * sizeof(float));
+        const uint64_t l0cSize = PlatformInfo::Current().l0cSize;
+        uint32_t maxN0 = l0cSize / (mBase * sizeof(float));
         if (mmInfo.isInt8 || mmInfo.mmType == MmType::MATMUL_WITH_BIAS) {
             maxN0 = maxN0 < CONST_256 ? maxN0 : CONST_256;
         }
@@ -69,7 +70,7 @@ void PpMatmulTilingData::SetBaseOp(uint32_t coreNum, uint32_t mBase, uint32_t nB
         uint32_t y = CeilDiv(x, maxN0);
         nBase = RoundUp<uint32_t>(CeilDiv(x, y), CONST_16);
         uint32_t rqdL0CSize = mBase * nBase * sizeof(float);
-        if (rqdL0CSize < PlatformInfo::Instance().l0cSize &&
+        if (rqdL0CSize < l0cSize &&
             (mBase + nBase) * CONST_256 * sizeof(uint16_t) < L1AB_PINGPONG_BUFFER_LEN) {
             opShape.n0 = nBase;
             nLoop = CeilDiv(opShape.n, opShape.n0);
@@ -9,21 +9,39 @@
 // limitations under the License.
 #include "defines.h"
 #include "build_tree_tiling.h"
-#include "tiling/platform/platform_ascendc.h"
 #include "aclrtlaunch_build_tree_efficient.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 namespace sglang {
 namespace npu_kernel {
 constexpr uint32_t PADDING_BYTE = 32U;
+constexpr int64_t BITS_PER_BYTE = 8;
+constexpr int64_t BITS_PER_WORD = 32;
+
+// QLEN_ONLY_BITPACKING packs one row of draft_token_num bits per draft token into a uint8/uint16/uint32 element,
+// or into ceil(draft_token_num / 32) uint32 words once the tree is wider than 32 tokens.
+static int64_t get_mask_row_bytes(int64_t draft_token_num, int64_t tree_mask_mode)
+{
+    if (tree_mask_mode != QLEN_ONLY_BITPACKING) {
+        return draft_token_num;
+    }
+    if (draft_token_num <= BITS_PER_BYTE) {
+        return 1;
+    }
+    if (draft_token_num <= 2 * BITS_PER_BYTE) {
+        return 2;
+    }
+    return (draft_token_num + BITS_PER_WORD - 1) / BITS_PER_WORD * (BITS_PER_WORD / BITS_PER_BYTE);
+}
 
 at::Tensor get_tiling(int32_t &block_dim, int32_t &workspace_size, int32_t batch_size, int32_t mask_size, int64_t topk,
                       int64_t depth, int64_t draft_token_num, int64_t tree_mask_mode)
 {
-    auto ascendc_platform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    int32_t max_aiv_core = static_cast<int32_t>(ascendc_platform->GetCoreNumAiv());
+    const auto &platform_info = PlatformInfoRegistry::Get();
+    int32_t max_aiv_core = static_cast<int32_t>(platform_info.coreNumAiv);
     block_dim = std::min(max_aiv_core, batch_size);
-    workspace_size = static_cast<int32_t>(ascendc_platform->GetLibApiWorkSpaceSize());
+    workspace_size = static_cast<int32_t>(platform_info.libApiWorkspaceSize);
 
     // align to 32 bytes
     int32_t tiling_size = (sizeof(BuildTreeTilingData) + PADDING_BYTE - 1) / PADDING_BYTE * PADDING_BYTE;
@@ -36,6 +54,7 @@ at::Tensor get_tiling(int32_t &block_dim, int32_t &workspace_size, int32_t batch
     tiling_data->depth = depth;
     tiling_data->draft_token_num = draft_token_num;
     tiling_data->tree_mask_mode = tree_mask_mode;
+    tiling_data->mask_row_bytes = static_cast<int32_t>(get_mask_row_bytes(draft_token_num, tree_mask_mode));
 
     auto num_big_core = batch_size % block_dim;
     tiling_data->big_core_num = num_big_core == 0 ? block_dim : num_big_core;
@@ -52,22 +71,33 @@ HOST_API void build_tree_efficient(const at::Tensor &parent_list, const at::Tens
                                    const at::Tensor &retrive_next_token, const at::Tensor &retrive_next_sibling,
                                    int64_t topk, int64_t depth, int64_t draft_token_num, int64_t tree_mask_mode)
 {
-    if (QLEN_ONLY_BITPACKING == tree_mask_mode) {
-        throw std::runtime_error("Not implemented");
+    if (tree_mask_mode != FULL_MASK && tree_mask_mode != QLEN_ONLY && tree_mask_mode != QLEN_ONLY_BITPACKING) {
+        throw std::invalid_argument("Invalid tree_mask_mode: " + std::to_string(tree_mask_mode));
     }
+    bool is_bitpacking = tree_mask_mode == QLEN_ONLY_BITPACKING;
+    bool is_mask_dtype_valid = is_bitpacking ? (!tree_mask.is_floating_point() && tree_mask.scalar_type() != at::kBool)
+                                             : tree_mask.options().dtype() == at::kBool;
 
     if (parent_list.options().dtype() != at::kLong || selected_index.options().dtype() != at::kLong ||
-        verified_seq_len.options().dtype() != at::kLong || tree_mask.options().dtype() != at::kBool ||
+        verified_seq_len.options().dtype() != at::kLong || !is_mask_dtype_valid ||
         positions.options().dtype() != at::kLong || retrive_index.options().dtype() != at::kLong ||
         retrive_next_token.options().dtype() != at::kLong || retrive_next_sibling.options().dtype() != at::kLong) {
         throw std::invalid_argument(
             "Invalid input datetype. "
-            "Support combo: int64, int64, int64, bool, int64, int64, int64, int64");
+            "Support combo: int64, int64, int64, bool (integer when bit-packed), int64, int64, int64, int64");
     }
     int32_t block_dim;
     int32_t workspace_size;
     int32_t batch_size = parent_list.sizes()[0];
     int32_t mask_size = tree_mask.size(0);
+    if (is_bitpacking) {
+        int64_t packed_bytes = batch_size * draft_token_num * get_mask_row_bytes(draft_token_num, tree_mask_mode);
+        if (tree_mask.nbytes() < static_cast<size_t>(packed_bytes)) {
+            throw std::invalid_argument("Bit-packed tree_mask needs at least " + std::to_string(packed_bytes) +
+                                        " bytes, got " + std::to_string(tree_mask.nbytes()));
+        }
+        mask_size = static_cast<int32_t>(packed_bytes);
+    }
 
     at::Tensor tiling_tensor =
         get_tiling(block_dim, workspace_size, batch_size, mask_size, topk, depth, draft_token_num, tree_mask_mode);
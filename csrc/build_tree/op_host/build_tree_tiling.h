@@ -25,6 +25,7 @@ struct BuildTreeTilingData {
 
     int32_t batch_size;
     int32_t mask_size;
+    int32_t mask_row_bytes;  // bytes written per draft token row of tree_mask
 
     int32_t big_core_num;
     int32_t big_core_tile_num;
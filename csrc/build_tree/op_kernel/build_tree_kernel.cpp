@@ -15,6 +15,8 @@
 /* tensor num for each queue */
 constexpr int32_t BUFFER_NUM = 1;
 constexpr int64_t ALIGN_32B = 32;
+constexpr uint32_t BITS_PER_BYTE_SHIFT = 3;
+constexpr uint32_t BIT_IN_BYTE_MASK = 7;
 
 class KernalBuildTree
 {
@@ -38,7 +40,8 @@ public:
         this->tree_mask_mode = tiling->tree_mask_mode;
 
         this->batch_size = tiling->batch_size;
-        this->mask_size = static_cast<uint16_t>(tiling->mask_size);
+        this->mask_size = tiling->mask_size;
+        this->mask_row_bytes = tiling->mask_row_bytes;
 
         this->bs_offset = AscendC::GetBlockIdx() * tiling->big_core_tile_num;
         if (AscendC::GetBlockIdx() < tiling->big_core_num) {
@@ -51,7 +54,8 @@ public:
 
         // global addr
         this->verified_seq_len_gm.SetGlobalBuffer((__gm__ int64_t *)verified_seq_len, this->batch_size);
-        this->tree_mask_gm.SetGlobalBuffer((__gm__ bool *)tree_mask, this->mask_size);
+        // bool and bit-packed masks are both written byte by byte
+        this->tree_mask_gm.SetGlobalBuffer((__gm__ uint8_t *)tree_mask, this->mask_size);
 
         // tiling offset addr
         auto stride_dim1 = this->topk * (this->depth - 1) + 1;
@@ -73,7 +77,7 @@ public:
         this->retrive_next_sibling_gm.SetGlobalBuffer((__gm__ int64_t *)retrive_next_sibling + offset, buffer_size);
 
         // init buffer
-        auto buf_len = (this->draft_token_num * sizeof(bool) + ALIGN_32B - 1) / ALIGN_32B * ALIGN_32B;
+        auto buf_len = (this->mask_row_bytes * sizeof(uint8_t) + ALIGN_32B - 1) / ALIGN_32B * ALIGN_32B;
         this->pipe.InitBuffer(this->mask_queue, BUFFER_NUM, buf_len);
 
         buf_len = (this->draft_token_num * sizeof(int64_t) + ALIGN_32B - 1) / ALIGN_32B * ALIGN_32B;
@@ -129,16 +133,19 @@ private:
         if (tree_mask_mode == sglang::npu_kernel::TreeMaskMode::FULL_MASK) {
             // [seq_lens_sum * num_verify_tokens + num_verify_tokens * num_verify_tokens * bs, ]
             token_tree_idx = seq_tree_idx + (seq_len + draft_token_num) * tid + seq_len;
-        } else {
+        } else if (tree_mask_mode == sglang::npu_kernel::TreeMaskMode::QLEN_ONLY) {
             // [num_verify_tokens * bs * num_verify_tokens, ]
-            token_tree_idx = draft_token_num * draft_token_num * bs + draft_token_num * bs;
+            token_tree_idx = draft_token_num * draft_token_num * bs + draft_token_num * tid;
+        } else {
+            // [num_verify_tokens * bs, mask_row_bytes], bit j of row tid is byte j / 8, bit j % 8
+            token_tree_idx = (draft_token_num * bs + tid) * mask_row_bytes;
         }
 
-        AscendC::LocalTensor<bool> tree_mask_ub = mask_queue.AllocTensor<bool>();
-        tree_mask_ub.SetValue(0, true);
-        for (int i = 1; i < draft_token_num; i++) {
-            tree_mask_ub.SetValue(i, false);
+        AscendC::LocalTensor<uint8_t> tree_mask_ub = mask_queue.AllocTensor<uint8_t>();
+        for (int i = 0; i < mask_row_bytes; i++) {
+            tree_mask_ub.SetValue(i, 0);
         }
+        SetMask(tree_mask_ub, 0);
 
         int64_t position = 0;
         if (tid == 0) {
@@ -177,7 +184,7 @@ private:
             int64_t cur_position = tid - 1;
             while (true) {
                 position += 1;
-                tree_mask_ub.SetValue(1 + cur_position, true);
+                SetMask(tree_mask_ub, 1 + cur_position);
                 int64_t parent_tb_idx = selected_index_gm.GetValue(bid * (draft_token_num - 1) + cur_position) / topk;
                 if (parent_tb_idx == 0) {
                     break;
@@ -194,12 +201,24 @@ private:
         }
 
         this->mask_queue.EnQue(tree_mask_ub);
-        AscendC::LocalTensor<bool> mask_ub = mask_queue.DeQue<bool>();
-        AscendC::DataCopyExtParams copy_params{1, static_cast<uint32_t>(this->draft_token_num * sizeof(bool)), 0, 0, 0};
-        AscendC::DataCopyPad<bool>(this->tree_mask_gm[token_tree_idx], mask_ub, copy_params);
+        AscendC::LocalTensor<uint8_t> mask_ub = mask_queue.DeQue<uint8_t>();
+        AscendC::DataCopyExtParams copy_params{1, static_cast<uint32_t>(this->mask_row_bytes * sizeof(uint8_t)), 0, 0,
+                                               0};
+        AscendC::DataCopyPad<uint8_t>(this->tree_mask_gm[token_tree_idx], mask_ub, copy_params);
         mask_queue.FreeTensor(mask_ub);
     }
 
+    __aicore__ inline void SetMask(AscendC::LocalTensor<uint8_t> &tree_mask_ub, int64_t idx)
+    {
+        if (tree_mask_mode != sglang::npu_kernel::TreeMaskMode::QLEN_ONLY_BITPACKING) {
+            tree_mask_ub.SetValue(idx, 1);
+            return;
+        }
+        uint32_t byte_idx = static_cast<uint32_t>(idx) >> BITS_PER_BYTE_SHIFT;
+        uint8_t bits = tree_mask_ub.GetValue(byte_idx) | (1U << (static_cast<uint32_t>(idx) & BIT_IN_BYTE_MASK));
+        tree_mask_ub.SetValue(byte_idx, bits);
+    }
+
     __aicore__ inline void CopyOut(int32_t bid)
     {
         int offset = bid * this->draft_token_num;
@@ -236,7 +255,7 @@ private:
     AscendC::GlobalTensor<int64_t> parent_list_gm;
     AscendC::GlobalTensor<int64_t> selected_index_gm;
     AscendC::GlobalTensor<int64_t> verified_seq_len_gm;
-    AscendC::GlobalTensor<bool> tree_mask_gm;
+    AscendC::GlobalTensor<uint8_t> tree_mask_gm;
     AscendC::GlobalTensor<int64_t> positions_gm;
     AscendC::GlobalTensor<int64_t> retrive_index_gm;
     AscendC::GlobalTensor<int64_t> retrive_next_token_gm;
@@ -248,7 +267,8 @@ private:
     int64_t tree_mask_mode;
 
     int32_t batch_size;
-    uint16_t mask_size;
+    int32_t mask_size;
+    int32_t mask_row_bytes;
     int32_t bs_per_core;
 
     uint32_t bs_offset = 0;
@@ -12,63 +12,79 @@
 #include "defines.h"
 #include "common.h"
 #include "torch_helper.h"
-#include "tiling/platform/platform_ascendc.h"
+#include "tiling_cache.h"
+#include "platform_info.h"
 #include "tiling/cache_loc_assign.h"
 #include "aclrtlaunch_cache_loc_assign.h"
 
 namespace sglang {
 namespace npu_kernel {
 
-at::Tensor getTiling(const at::Tensor &reqPoolIndices, uint64_t rowSize, uint64_t poolSize, uint32_t &blockDim,
-                     bool isUpddate)
+static void BuildCacheLocTiling(AssignCacheTillingData &tillingData, at::ScalarType reqIdxType, int64_t batchSize,
+                                uint64_t rowSize, uint64_t poolSize, bool isUpddate)
 {
-    auto batchSize = reqPoolIndices.sizes()[0];
-    auto ascendcPlatform = platform_ascendc::PlatformAscendCManager::GetInstance();
+    const auto &platformInfo = PlatformInfoRegistry::Get();
+    uint32_t blockDim;
     if (isUpddate) {
         blockDim = 1;  // todo: support mulitcore calculate for update
     } else {
-        blockDim = ascendcPlatform->GetCoreNumAiv();
+        blockDim = platformInfo.coreNumAiv;
     }
 
-    auto tilingBuffer =
-        at::empty({sizeof(AssignCacheTillingData)}, at::TensorOptions().dtype(at::kByte).device(at::kCPU));
-    AssignCacheTillingData *tillingData = reinterpret_cast<AssignCacheTillingData *>(tilingBuffer.data_ptr());
-    tillingData->vcoreNum = blockDim;
-    tillingData->poolSize = poolSize;
-    tillingData->batchSize = batchSize;
-    tillingData->rowNumNoTail = batchSize / (tillingData->vcoreNum);
-    tillingData->tailNum = batchSize % (tillingData->vcoreNum);
-    tillingData->rowSize = rowSize;
-
-    if (reqPoolIndices.options().dtype() == at::kInt) {
-        tillingData->key = 1;
-        tillingData->reqInxBufferCount = host_utils::alinInt32Count(batchSize);
-        tillingData->reqInxBufferSize = tillingData->reqInxBufferCount * sizeof(int32_t);
-    } else if (reqPoolIndices.options().dtype() == at::kLong) {
-        tillingData->key = 2;
-        tillingData->reqInxBufferCount = host_utils::alinInt64Count(batchSize);
-        tillingData->reqInxBufferSize = tillingData->reqInxBufferCount * sizeof(int64_t);
+    tillingData.vcoreNum = blockDim;
+    tillingData.poolSize = poolSize;
+    tillingData.batchSize = batchSize;
+    tillingData.rowNumNoTail = batchSize / (tillingData.vcoreNum);
+    tillingData.tailNum = batchSize % (tillingData.vcoreNum);
+    tillingData.rowSize = rowSize;
+
+    if (reqIdxType == at::kInt) {
+        tillingData.key = 1;
+        tillingData.reqInxBufferCount = host_utils::alinInt32Count(batchSize);
+        tillingData.reqInxBufferSize = tillingData.reqInxBufferCount * sizeof(int32_t);
+    } else if (reqIdxType == at::kLong) {
+        tillingData.key = 2;
+        tillingData.reqInxBufferCount = host_utils::alinInt64Count(batchSize);
+        tillingData.reqInxBufferSize = tillingData.reqInxBufferCount * sizeof(int64_t);
     }
 
-    tillingData->tokenCountAlignInt32 = host_utils::alinInt32Count(MAX_STEP);
-    tillingData->tokenColAlignInt32 = tillingData->tokenCountAlignInt32 * sizeof(int32_t);
+    tillingData.tokenCountAlignInt32 = host_utils::alinInt32Count(MAX_STEP);
+    tillingData.tokenColAlignInt32 = tillingData.tokenCountAlignInt32 * sizeof(int32_t);
 
-    tillingData->offsetCountAlignInt64 = host_utils::alinInt64Count(batchSize);
-    tillingData->offsetColAlignInt64 = tillingData->offsetCountAlignInt64 * sizeof(int64_t);
+    tillingData.offsetCountAlignInt64 = host_utils::alinInt64Count(batchSize);
+    tillingData.offsetColAlignInt64 = tillingData.offsetCountAlignInt64 * sizeof(int64_t);
 
-    tillingData->cacheLocSize = batchSize * MAX_STEP;
-    tillingData->cacheLocCountAlignInt32 = host_utils::alinInt32Count(tillingData->cacheLocSize);
-    tillingData->cacheLocAlignInt32 = tillingData->cacheLocCountAlignInt32 * sizeof(int32_t);
+    tillingData.cacheLocSize = batchSize * MAX_STEP;
+    tillingData.cacheLocCountAlignInt32 = host_utils::alinInt32Count(tillingData.cacheLocSize);
+    tillingData.cacheLocAlignInt32 = tillingData.cacheLocCountAlignInt32 * sizeof(int32_t);
 
-    uint64_t ubSize;
-    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
-    uint64_t ubBufferSizeToUse = tillingData->tokenColAlignInt32 + 3 * tillingData->offsetColAlignInt64 +
-                                 3 * batchSize * sizeof(int32_t) + tillingData->cacheLocAlignInt32;
+    uint64_t ubSize = platformInfo.ubSize;
+    uint64_t ubBufferSizeToUse = tillingData.tokenColAlignInt32 + 3 * tillingData.offsetColAlignInt64 +
+                                 3 * batchSize * sizeof(int32_t) + tillingData.cacheLocAlignInt32;
     if (ubBufferSizeToUse > ubSize) {
         throw std::invalid_argument("Batch size is too large, buffer is not enough to do calculate");
     }
+}
 
-    auto tilingTensor = TorchNpuHelper::CopyTensorHostToDevice(tilingBuffer);
+at::Tensor getTiling(const at::Tensor &reqPoolIndices, uint64_t rowSize, uint64_t poolSize, uint32_t &blockDim,
+                     bool isUpddate)
+{
+    auto batchSize = reqPoolIndices.sizes()[0];
+    auto reqIdxType = reqPoolIndices.scalar_type();
+    at::Tensor tilingTensor;
+    auto key = TilingKey("cache_loc_assign")
+                   .Add(reqIdxType)
+                   .Add(batchSize)
+                   .Add(static_cast<int64_t>(rowSize))
+                   .Add(static_cast<int64_t>(poolSize))
+                   .Add(isUpddate);
+    auto tillingData = TilingCache::Instance().GetOrCreate<AssignCacheTillingData>(
+        key,
+        [&](AssignCacheTillingData &tilling) {
+            BuildCacheLocTiling(tilling, reqIdxType, batchSize, rowSize, poolSize, isUpddate);
+        },
+        tilingTensor);
+    blockDim = static_cast<uint32_t>(tillingData.vcoreNum);
     return tilingTensor;
 }
 
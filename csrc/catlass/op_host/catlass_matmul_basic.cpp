@@ -10,8 +10,8 @@
 #include <map>
 
 #include "defines.h"
-#include "tiling/platform/platform_ascendc.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 #include "catlass_matmul_tiling.h"
 #include "aclrtlaunch_catlass_matmul_basic.h"
 
@@ -42,8 +42,7 @@ inline int GetModeVal(const MapType &mode_map, c10::optional<c10::string_view> m
 at::Tensor get_tiling(int32_t &m, int32_t &n, int32_t k, int64_t weight_format_mode, int64_t data_format_mode,
                       uint32_t &blockDim)
 {
-    auto ascendc_platform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    blockDim = static_cast<uint32_t>(ascendc_platform->GetCoreNumAiv());
+    blockDim = static_cast<uint32_t>(PlatformInfoRegistry::Get().coreNumAiv);
 
     // align to 32 bytes
     int32_t tiling_size = (sizeof(KernelCatlassMatmulTilingData) + PADDING_BYTE - 1) / PADDING_BYTE * PADDING_BYTE;
@@ -14,10 +14,10 @@
 #include <functional>
 #include "acl/acl.h"
 #include "kernel_tiling/kernel_tiling.h"
-#include "tiling/platform/platform_ascendc.h"
 #include "tiling/causal_conv1d_update_tiling.h"
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 #include "common_tiling.h"
 #include "common.h"
 #include "stub/aclrtlaunch_causal_conv1d_update_bfloat16_t.h"
@@ -113,13 +113,13 @@ HOST_API at::Tensor causal_conv1d_update_impl(const at::Tensor &x, const at::Ten
     // Create output tensor
     at::Tensor y = at::empty_like(x);
 
-    auto ascendc_platform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    int32_t max_aiv_core = static_cast<int32_t>(ascendc_platform->GetCoreNumAiv());
+    const auto &platform_info = PlatformInfoRegistry::Get(x.get_device());
+    int32_t max_aiv_core = static_cast<int32_t>(platform_info.coreNumAiv);
     int32_t block_dim = std::min(max_aiv_core, static_cast<int32_t>(batch));
     if (block_dim == 0) {
         block_dim = 1;
     }
-    int32_t workspace_size = static_cast<int32_t>(ascendc_platform->GetLibApiWorkSpaceSize());
+    int32_t workspace_size = static_cast<int32_t>(platform_info.libApiWorkspaceSize);
 
     // 1. Prepare Tiling Data Struct
     CausalConv1dUpdateTilingData tiling_data;
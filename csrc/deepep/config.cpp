@@ -1,9 +1,129 @@
+#include <algorithm>
+#include "aclnn/opdev/platform.h"
 #include "config.hpp"
 
 namespace deep_ep {
-size_t get_low_latency_rdma_size_hint(int num_max_dispatch_tokens_per_rank, int hidden, int num_ranks, int num_experts)
+namespace {
+constexpr int64_t MB_SIZE = 1024 * 1024;
+constexpr int DEFAULT_HCCL_BUFFSIZE_MB = 200;
+constexpr int64_t WIN_ADDR_ALIGN = 512;  // every token slot of the window starts on 512B
+constexpr int64_t UB_ALIGN = 32;
+constexpr int64_t MAX_OUT_DTYPE_SIZE = 2;  // the window always holds 16-bit tokens, quantized ones are never larger
+constexpr int64_t DOUBLE_DATA_BUFFER = 2;
+constexpr int64_t FLOAT_BYTES = 4;                     // scales, and the uint32 routing words of layered tokens
+constexpr int64_t TRIPLE_BYTES = 3 * sizeof(int32_t);  // (rank, token, topk) the dispatch appends to a token
+constexpr int64_t SCALE_EXPAND_IDX_BUFFER = 44;        // normal dispatch: 32B scale + triple
+constexpr int64_t A2_LL_STATE_BYTES = 2 * MB_SIZE;     // ops2 low-latency status area
+constexpr int64_t A2_LAYERED_TOKEN_INFO_NUM = 4;       // expert, weight, scale and flag of a layered token
+constexpr int64_t A2_LAYERED_K_ALIGN = 8;              // layered kernels pad top-k to one 32B block of uint32
+constexpr int64_t A2_LAYERED_IPC_OFFSET = 4 * MB_SIZE;
+constexpr int64_t A2_LAYERED_RDMA_BYTES = 800 * MB_SIZE;
+constexpr int64_t A3_NORMAL_RESERVED_BYTES = (4 + 102) * MB_SIZE;  // ops/op_host/tiling_args.h
+constexpr int64_t A2_NORMAL_RESERVED_BYTES = (8 + 404) * MB_SIZE;  // ops2/op_host/tiling_args.h
+constexpr int64_t A2_NORMAL_STATE_BYTES = 4 * 2 * MB_SIZE;
+constexpr int DEFAULT_PER_ROUND_TOKENS = 8192;
+constexpr int QUANT_BLOCK_SIZE = 128;
+
+int64_t align_up(int64_t value, int64_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+WindowLayout current_window_layout()
+{
+    return op::GetCurrentPlatformInfo().GetSocVersion() == op::SocVersion::ASCEND910B ? WindowLayout::A2_FULLMESH
+                                                                                       : WindowLayout::A3;
+}
+}  // namespace
+
+size_t Config::get_nvl_buffer_size_hint(size_t hidden_bytes, int num_ranks, int num_topk) const
+{
+    // A normal dispatch reserves `min(per_round_tokens, max_bs)` tokens per rank, the worst case is a full round
+    int64_t round = get_value_from_env("DEEPEP_NORMAL_LONG_SEQ_ROUND", 1);
+    int64_t per_round_tokens = get_value_from_env("DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS", DEFAULT_PER_ROUND_TOKENS);
+    auto hidden = static_cast<int64_t>((hidden_bytes + MAX_OUT_DTYPE_SIZE - 1) / MAX_OUT_DTYPE_SIZE);
+    auto layout = current_window_layout();
+    return static_cast<size_t>(
+        std::max(get_normal_dispatch_window_bytes(per_round_tokens, hidden, num_topk, round, layout),
+                 get_normal_combine_window_bytes(per_round_tokens, hidden, num_topk, round > 1, layout)));
+}
+
+size_t Config::get_rdma_buffer_size_hint(int64_t hidden_bytes, int num_ranks, int num_experts) const
+{
+    int64_t num_local_experts = std::max(num_experts / std::max(num_ranks, 1), 1);
+    auto hidden = (hidden_bytes + MAX_OUT_DTYPE_SIZE - 1) / MAX_OUT_DTYPE_SIZE;
+    return static_cast<size_t>(
+        get_internode_dispatch_window_bytes(MAX_BATCH_SIZE, hidden, num_ranks, num_local_experts));
+}
+
+int64_t get_hccl_window_bytes()
+{
+    // Same lookup as `Mc2TilingUtils::GetMaxWindowSize` of the operators
+    const char *name = std::getenv("DEEPEP_HCCL_BUFFSIZE") == nullptr ? "HCCL_BUFFSIZE" : "DEEPEP_HCCL_BUFFSIZE";
+    return static_cast<int64_t>(get_value_from_env(name, DEFAULT_HCCL_BUFFSIZE_MB)) * MB_SIZE;
+}
+
+int64_t get_low_latency_window_bytes(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden, int64_t num_ranks,
+                                     int64_t num_experts, int64_t num_local_experts, int64_t num_topk,
+                                     int64_t num_scales, WindowLayout layout)
+{
+    int64_t bs = num_max_dispatch_tokens_per_rank;
+    if (layout == WindowLayout::A2_LAYERED) {
+        // Every token carries its top-k routing next to the data, on top of the fixed RDMA and IPC areas
+        int64_t token_bytes = hidden * MAX_OUT_DTYPE_SIZE +
+                              A2_LAYERED_TOKEN_INFO_NUM * align_up(num_topk, A2_LAYERED_K_ALIGN) * FLOAT_BYTES;
+        return num_experts * bs * token_bytes + A2_LAYERED_IPC_OFFSET + A2_LAYERED_RDMA_BYTES;
+    }
+    if (layout == WindowLayout::A2_FULLMESH) {
+        int64_t bytes = bs * num_ranks * std::min(num_local_experts, num_topk) * hidden * MAX_OUT_DTYPE_SIZE;
+        return (bytes + A2_LL_STATE_BYTES) * DOUBLE_DATA_BUFFER;
+    }
+    // A3: every local expert may receive `bs` tokens from every rank, and every token gets one combine slot per expert
+    // it was sent to. `num_topk` has to include the shared experts.
+    int64_t token_len = align_up(hidden * MAX_OUT_DTYPE_SIZE, UB_ALIGN) +
+                        align_up(std::max<int64_t>(num_scales, 1) * FLOAT_BYTES, UB_ALIGN) + TRIPLE_BYTES;
+    int64_t dispatch_bytes = bs * align_up(token_len, WIN_ADDR_ALIGN) * num_ranks * num_local_experts;
+    int64_t combine_bytes = bs * align_up(hidden * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN) * num_topk;
+    return (dispatch_bytes + combine_bytes) * DOUBLE_DATA_BUFFER;
+}
+
+int64_t get_normal_dispatch_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_topk, int64_t round,
+                                         WindowLayout layout)
+{
+    int64_t dispatch_token = align_up(align_up(hidden * MAX_OUT_DTYPE_SIZE, UB_ALIGN) + SCALE_EXPAND_IDX_BUFFER,
+                                      WIN_ADDR_ALIGN);
+    // With more than one round the combine half is double buffered
+    int64_t combine_token = align_up(hidden * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN) * (round > 1 ? 2 : 1);
+    int64_t data_bytes = max_bs * num_topk * (dispatch_token + combine_token);
+    if (layout == WindowLayout::A3) {
+        return (data_bytes + A3_NORMAL_RESERVED_BYTES) * DOUBLE_DATA_BUFFER;
+    }
+    return (data_bytes + A2_NORMAL_RESERVED_BYTES) * DOUBLE_DATA_BUFFER + A2_NORMAL_STATE_BYTES;
+}
+
+int64_t get_normal_combine_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_topk, bool multi_round,
+                                        WindowLayout layout)
+{
+    int64_t combine_token = align_up(hidden * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN) * (multi_round ? 2 : 1);
+    int64_t reserved = layout == WindowLayout::A3 ? A3_NORMAL_RESERVED_BYTES : A2_NORMAL_RESERVED_BYTES;
+    return (max_bs * num_topk * combine_token + reserved) * DOUBLE_DATA_BUFFER;
+}
+
+int64_t get_internode_dispatch_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_ranks,
+                                            int64_t num_local_experts)
+{
+    return num_ranks * max_bs * hidden * MAX_OUT_DTYPE_SIZE * DOUBLE_DATA_BUFFER * num_local_experts;
+}
+
+size_t get_low_latency_rdma_size_hint(int num_max_dispatch_tokens_per_rank, int hidden, int num_ranks, int num_experts,
+                                      int num_topk)
 {
-    return num_max_dispatch_tokens_per_rank;
+    // Worst case over the quantization modes: per-128-channel scales take the largest scale slot of a token
+    auto layout = current_window_layout();
+    int64_t num_local_experts = std::max(num_experts / std::max(num_ranks, 1), 1);
+    return static_cast<size_t>(get_low_latency_window_bytes(num_max_dispatch_tokens_per_rank, hidden, num_ranks,
+                                                            num_experts, num_local_experts, num_topk,
+                                                            std::max(hidden / QUANT_BLOCK_SIZE, 1), layout));
 }
 
 int get_value_from_env(const std::string &name, int defaultValue)
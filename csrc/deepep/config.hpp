@@ -3,10 +3,20 @@
 #include <pybind11/pytypes.h>
 #include <cstdlib>
 #include <cctype>
+#include <cstdint>
 #include <string>
 
 namespace deep_ep {
 
+// Largest top-k the dispatch/combine operators accept, used when a size hint is asked without one
+constexpr int NUM_MAX_TOPK = 16;
+// Tokens per rank the A2 internode dispatch reserves its window and notify buffers for
+constexpr int MAX_BATCH_SIZE = 4096;
+
+// How the operators carve up the HCCL window: A3, A2 full mesh, or A2 layered (HCCL_INTRA_PCIE_ENABLE=1 and
+// HCCL_INTRA_ROCE_ENABLE=0)
+enum class WindowLayout { A3, A2_FULLMESH, A2_LAYERED };
+
 struct Config {
     int num_sms;
     int num_max_nvl_chunked_send_tokens;
@@ -23,18 +33,28 @@ struct Config {
           num_max_rdma_chunked_recv_tokens(num_max_rdma_chunked_recv_tokens)
     {}
 
-    size_t get_nvl_buffer_size_hint(size_t hidden_bytes, int num_ranks) const
-    {
-        return hidden_bytes;
-    }
+    // HCCL window bytes a normal-mode intranode dispatch + combine needs, with the round settings of the environment
+    size_t get_nvl_buffer_size_hint(size_t hidden_bytes, int num_ranks, int num_topk = NUM_MAX_TOPK) const;
 
-    size_t get_rdma_buffer_size_hint(int64_t hidden_bytes, int num_ranks) const
-    {
-        return hidden_bytes;
-    }
+    // HCCL window bytes the A2 internode dispatch needs, `num_experts` defaults to one expert per rank
+    size_t get_rdma_buffer_size_hint(int64_t hidden_bytes, int num_ranks, int num_experts = 0) const;
 };
 
-size_t get_low_latency_rdma_size_hint(int num_max_dispatch_tokens_per_rank, int hidden, int num_ranks, int num_experts);
+// Window bytes of one operator family, mirroring the `CheckWinSize` checks of the ops/ (A3) and ops2/ (A2) tilings.
+// Buffer runs them before launching, so a window that is too small fails on the host instead of inside the kernel.
+int64_t get_hccl_window_bytes();
+int64_t get_low_latency_window_bytes(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden, int64_t num_ranks,
+                                     int64_t num_experts, int64_t num_local_experts, int64_t num_topk,
+                                     int64_t num_scales, WindowLayout layout);
+int64_t get_normal_dispatch_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_topk, int64_t round,
+                                         WindowLayout layout);
+int64_t get_normal_combine_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_topk, bool multi_round,
+                                        WindowLayout layout);
+int64_t get_internode_dispatch_window_bytes(int64_t max_bs, int64_t hidden, int64_t num_ranks,
+                                            int64_t num_local_experts);
+
+size_t get_low_latency_rdma_size_hint(int num_max_dispatch_tokens_per_rank, int hidden, int num_ranks, int num_experts,
+                                      int num_topk = NUM_MAX_TOPK);
 
 int get_value_from_env(const std::string &name, int defaultValue);
 }  // namespace deep_ep
@@ -6,14 +6,19 @@
 #include "exception.hpp"
 #include "deep_ep.hpp"
 #include "pytorch_npu_helper.hpp"
+#include "torch_npu/csrc/core/npu/NPUGuard.h"
 
 namespace deep_ep {
 constexpr int PADDING_SIZE = 1;
 constexpr size_t HCOMM_NAME_LEN = 128;
 constexpr uint32_t NO_SCALES = 0;
 constexpr uint32_t DYNAMIC_SCALES = 2;
+constexpr uint32_t PER_BLOCK_SCALES = 3;
+constexpr uint32_t PER_BLOCK_POW2_SCALES = 4;
+constexpr int SCALE_BLOCK_SIZE = 128;
+constexpr int UE8M0_PER_INT32 = 4;
+constexpr int FP32_MANTISSA_BITS = 23;
 constexpr int LOCAL_RANK_SIZE = 8;
-constexpr int MAX_BATCH_SIZE = 4096;
 constexpr int EXPERT_DATA_SIZE = 1 + MAX_BATCH_SIZE;  // 4097
 constexpr int A3_MAX_HCCS_PEERS = 384;
 constexpr int A2_MAX_HCCS_PEERS = 8;
@@ -29,7 +34,8 @@ Buffer::Buffer(int64_t rank, int64_t num_ranks, int64_t num_nvl_bytes, int64_t n
       num_nvl_bytes(num_nvl_bytes),
       num_rdma_bytes(num_rdma_bytes),
       low_latency_mode(low_latency_mode),
-      moe_all_to_all_group_name(moe_all_to_all_group_name)
+      moe_all_to_all_group_name(moe_all_to_all_group_name),
+      comm_stream(c10_npu::getNPUStreamFromPool(true))
 {
     rdma_rank = rank;
     EP_HOST_ASSERT(0 <= rank and rank < num_ranks);
@@ -71,6 +77,12 @@ Buffer::Buffer(int64_t rank, int64_t num_ranks, int64_t num_nvl_bytes, int64_t n
         round = static_cast<int>(r);
         per_round_tokens = static_cast<int>(t);
     }
+    this->normal_rounds_from_env = roundSet;
+    this->normal_total_tokens = static_cast<int64_t>(round) * per_round_tokens;
+    // Upper bound of the batch size of every rank, used by the sync-free dispatch instead of the notified max bs.
+    // All ranks must agree on it, so it is configured through the environment like the round settings above.
+    this->sync_free_max_bs = get_value_from_env("DEEPEP_NORMAL_SYNC_FREE_MAX_BS", round * per_round_tokens);
+    EP_HOST_ASSERT(sync_free_max_bs > 0 and sync_free_max_bs <= round * per_round_tokens);
 
     soc_version = op::GetCurrentPlatformInfo().GetSocVersion();
     num_rdma_ranks = 1;
@@ -92,6 +104,61 @@ bool Buffer::is_available() const
     return available;
 }
 
+c10_npu::NPUStream Buffer::wait_on_comm_stream(const std::optional<EventHandle> &previous_event, bool async,
+                                              bool allocate_on_comm_stream)
+{
+    // Communication kernels and their tensors always live on `comm_stream`, `allocate_on_comm_stream` only keeps the
+    // DeepEP contract that the caller synchronizes through events in this mode.
+    if (allocate_on_comm_stream) {
+        EP_HOST_ASSERT(previous_event.has_value() and async);
+    }
+
+    auto compute_stream = c10_npu::getCurrentNPUStream();
+    if (previous_event.has_value()) {
+        stream_wait(comm_stream, previous_event.value());
+    } else {
+        stream_wait(comm_stream, compute_stream);
+    }
+    return compute_stream;
+}
+
+std::optional<EventHandle> Buffer::release_to_compute_stream(const c10_npu::NPUStream &compute_stream, bool async,
+                                                             const std::vector<std::optional<at::Tensor>> &inputs,
+                                                             const std::vector<std::optional<at::Tensor>> &outputs)
+{
+    // Outputs are allocated on `comm_stream` but consumed on the compute stream
+    for (auto &t : outputs) {
+        if (t.has_value() and t->defined()) {
+            t->record_stream(compute_stream.unwrap());
+        }
+    }
+
+    if (not async) {
+        stream_wait(compute_stream, comm_stream);
+        return std::nullopt;
+    }
+
+    // The compute stream may release the inputs before the communication kernels are done with them
+    for (auto &t : inputs) {
+        if (t.has_value() and t->defined()) {
+            t->record_stream(comm_stream.unwrap());
+        }
+    }
+    return EventHandle(comm_stream);
+}
+
+// The low-latency kernels cannot be split into a send and a receive half, so the hook defers the receive at stream
+// level: the compute stream only waits for the communication stream once the hook is called.
+static std::function<void()> make_recv_hook(std::optional<EventHandle> &event, bool return_recv_hook)
+{
+    if (not return_recv_hook) {
+        return [] {};
+    }
+    auto recv_event = event.value();
+    event = std::nullopt;
+    return [recv_event]() { recv_event.current_stream_wait(); };
+}
+
 std::tuple<torch::Tensor, std::optional<torch::Tensor>, torch::Tensor, torch::Tensor, std::optional<EventHandle>>
 Buffer::get_dispatch_layout(const torch::Tensor &topk_idx, int num_experts, std::optional<EventHandle> &previous_event,
                             bool async, bool allocate_on_comm_stream)
@@ -107,6 +174,10 @@ Buffer::get_dispatch_layout(const torch::Tensor &topk_idx, int num_experts, std:
     auto server_num = num_ranks / local_ranksize;
     auto device = topk_idx.device();
 
+    auto compute_stream = wait_on_comm_stream(previous_event, async, allocate_on_comm_stream);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    auto physical_topk_idx = to_physical_expert_ids(topk_idx, num_experts, true);
+
     auto num_tokens_per_expert = at::zeros({round, num_experts}, at::dtype(at::kInt).device(device));
     auto num_tokens_per_rank = at::zeros({num_ranks}, at::dtype(at::kInt).device(device));
     auto is_token_in_rank = at::zeros({num_tokens, num_ranks}, at::dtype(at::kInt).device(device));
@@ -132,20 +203,54 @@ Buffer::get_dispatch_layout(const torch::Tensor &topk_idx, int num_experts, std:
        size:[numExpert, MAX_BS]
     */
     auto send_token_idx_small = at::zeros({num_tokens, num_topk}, at::dtype(at::kInt).device(device));
-    auto notify_send_data = at::zeros({notify_send_data_size}, at::dtype(at::kInt).device(device));
     int32_t rank_id = static_cast<int>(rank);
-    EXEC_NPU_CMD(aclnnDispatchLayout, topk_idx, num_tokens, num_ranks, num_experts, num_topk, local_ranksize,
-                 per_round_tokens, rank_id, num_tokens_per_rank, num_tokens_per_expert, is_token_in_rank,
-                 notify_send_data, send_token_idx_small);
+    at::Tensor notify_send_data;
+    const int internode_rounds = get_internode_rounds();
+    if (soc_version == op::SocVersion::ASCEND910B and num_rdma_ranks > 1) {
+        const int round_tokens = internode_rounds == 1 ? num_tokens : per_round_tokens;
+        EP_HOST_ASSERT_S(round_tokens <= MAX_BATCH_SIZE, "A2 internode layout holds at most ", MAX_BATCH_SIZE,
+                         " tokens per rank in a round, but got ", round_tokens,
+                         ", set DEEPEP_NORMAL_LONG_SEQ_ROUND to split the batch");
+    }
+    if (internode_rounds == 1) {
+        notify_send_data = at::zeros({notify_send_data_size}, at::dtype(at::kInt).device(device));
+        EXEC_NPU_CMD(aclnnDispatchLayout, physical_topk_idx, num_tokens, num_ranks, num_experts, num_topk,
+                     local_ranksize, per_round_tokens, rank_id, num_tokens_per_rank, num_tokens_per_expert,
+                     is_token_in_rank, notify_send_data, send_token_idx_small);
+    } else {
+        // The A2 layout kernel covers a single round, so every round gets its own row of notify send data. Rounds
+        // past the end of this rank's tokens keep their zeroed row, the notify of that round still runs on all ranks.
+        notify_send_data = at::zeros({internode_rounds, notify_send_data_size}, at::dtype(at::kInt).device(device));
+        auto round_tokens_per_rank = at::empty({num_ranks}, at::dtype(at::kInt).device(device));
+        for (int r = 0; r < internode_rounds; ++r) {
+            const int begin = std::min(r * per_round_tokens, num_tokens);
+            const int end = std::min(begin + per_round_tokens, num_tokens);
+            if (begin == end) {
+                break;
+            }
+            const int round_num_tokens = end - begin;
+            auto round_topk_idx = physical_topk_idx.slice(0, begin, end);
+            auto round_tokens_per_expert = num_tokens_per_expert[r];
+            auto round_is_token_in_rank = is_token_in_rank.slice(0, begin, end);
+            auto round_send_data = notify_send_data[r];
+            auto round_send_token_idx = send_token_idx_small.slice(0, begin, end);
+            round_tokens_per_rank.zero_();
+            EXEC_NPU_CMD(aclnnDispatchLayout, round_topk_idx, round_num_tokens, num_ranks, num_experts, num_topk,
+                         local_ranksize, per_round_tokens, rank_id, round_tokens_per_rank, round_tokens_per_expert,
+                         round_is_token_in_rank, round_send_data, round_send_token_idx);
+            num_tokens_per_rank.add_(round_tokens_per_rank);
+        }
+    }
 
     this->notify_send_data = notify_send_data;
     this->send_token_idx_small = send_token_idx_small;
     this->notify_send_data_size = notify_send_data_size;
 
     std::optional<torch::Tensor> num_tokens_per_rdma_rank = std::nullopt;
-    std::optional<EventHandle> output_event = std::nullopt;
 
     auto num_tokens_per_expert_one_dim = num_tokens_per_expert.flatten();
+    auto output_event = release_to_compute_stream(compute_stream, async, {topk_idx},
+                                                  {num_tokens_per_rank, num_tokens_per_expert, is_token_in_rank});
     return std::make_tuple(num_tokens_per_rank, num_tokens_per_rdma_rank, num_tokens_per_expert_one_dim,
                            is_token_in_rank, output_event);
 }
@@ -155,6 +260,99 @@ torch::Tensor Buffer::get_notify_send_data()
     return this->notify_send_data;
 }
 
+void Buffer::set_expert_location_map(const at::Tensor &physical_map, const at::Tensor &replica_count)
+{
+    EP_HOST_ASSERT(physical_map.dim() == 2 and replica_count.dim() == 1);
+    EP_HOST_ASSERT(physical_map.size(0) == replica_count.size(0) and physical_map.size(1) > 0);
+
+    // Validated on the host once per swap, so the dispatch path never has to synchronize to check the table or the ids
+    const int64_t num_logical_experts = physical_map.size(0);
+    const int64_t max_replicas = physical_map.size(1);
+    auto map_cpu = physical_map.to(at::kCPU, at::kLong).contiguous();
+    auto count_cpu = replica_count.to(at::kCPU, at::kLong).contiguous();
+    const int64_t *map_ptr = map_cpu.data_ptr<int64_t>();
+    const int64_t *count_ptr = count_cpu.data_ptr<int64_t>();
+    int64_t max_id = -1;
+    for (int64_t i = 0; i < num_logical_experts; ++i) {
+        EP_HOST_ASSERT_S(count_ptr[i] >= 1 and count_ptr[i] <= max_replicas,
+                         "logical expert ", i, " has ", count_ptr[i], " replicas, expected [1, ", max_replicas, "]");
+        for (int64_t j = 0; j < count_ptr[i]; ++j) {
+            EP_HOST_ASSERT(map_ptr[i * max_replicas + j] >= 0);
+            max_id = std::max(max_id, map_ptr[i * max_replicas + j]);
+        }
+    }
+
+    // Swap on the communication stream, behind the dispatches already issued with the previous table
+    std::optional<EventHandle> no_previous_event;
+    auto compute_stream = wait_on_comm_stream(no_previous_event, false, false);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    auto options = at::dtype(at::kLong).device(physical_map.device());
+    if (not expert_location_map.defined() or not expert_location_map.sizes().equals(physical_map.sizes())) {
+        expert_location_map = at::empty(physical_map.sizes(), options);
+        expert_replica_count = at::empty({num_logical_experts}, options);
+    }
+    if (not expert_load_stats.defined() or expert_load_stats.size(0) != num_logical_experts) {
+        expert_load_stats = at::zeros({num_logical_experts}, options);
+    }
+    expert_location_map.copy_(physical_map);
+    expert_replica_count.copy_(replica_count);
+    max_physical_expert_id = max_id;
+    release_to_compute_stream(compute_stream, false, {physical_map, replica_count}, {});
+}
+
+void Buffer::clear_expert_location_map()
+{
+    // Released on the communication stream, behind the dispatches already issued with the table
+    std::optional<EventHandle> no_previous_event;
+    auto compute_stream = wait_on_comm_stream(no_previous_event, false, false);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    expert_location_map = at::Tensor();
+    expert_replica_count = at::Tensor();
+    expert_load_stats = at::Tensor();
+    max_physical_expert_id = -1;
+    release_to_compute_stream(compute_stream, false, {}, {});
+}
+
+at::Tensor Buffer::get_expert_load_stats(bool reset)
+{
+    EP_HOST_ASSERT_S(expert_load_stats.defined(), "set_expert_location_map must be called before reading expert load");
+
+    std::optional<EventHandle> no_previous_event;
+    auto compute_stream = wait_on_comm_stream(no_previous_event, false, false);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    auto stats = expert_load_stats.clone();
+    if (reset) {
+        expert_load_stats.zero_();
+    }
+    release_to_compute_stream(compute_stream, false, {}, {stats});
+    return stats;
+}
+
+at::Tensor Buffer::to_physical_expert_ids(const at::Tensor &topk_idx, int64_t num_experts, bool record_load)
+{
+    if (not expert_location_map.defined()) {
+        return topk_idx;
+    }
+    EP_HOST_ASSERT_S(num_experts <= 0 or max_physical_expert_id < num_experts,
+                     "expert location map refers to physical expert ", max_physical_expert_id,
+                     ", but num_experts is ", num_experts);
+
+    // -1 marks an unselected slot. Ids outside the map are dropped the same way on the device instead of being checked
+    // on the host, which would synchronize every dispatch and break graph capture.
+    const int64_t num_logical_experts = expert_location_map.size(0);
+    auto valid = topk_idx.ge(0).logical_and_(topk_idx.lt(num_logical_experts));
+    auto logical = at::where(valid, topk_idx, 0).to(at::kLong).flatten();
+    if (record_load) {
+        expert_load_stats.index_add_(0, logical, valid.flatten().to(at::kLong));
+    }
+    // Spread the selections of a logical expert round-robin over its replicas, starting from a different replica on
+    // every rank. The choice only depends on the position in `topk_idx`, so dispatch and combine agree on it.
+    auto slot = at::arange(topk_idx.numel(), logical.options()).add_(rank);
+    slot.remainder_(expert_replica_count.index_select(0, logical));
+    auto physical = expert_location_map.flatten().index_select(0, logical * expert_location_map.size(1) + slot);
+    return at::where(valid, physical.view(topk_idx.sizes()).to(topk_idx.scalar_type()), -1);
+}
+
 int Buffer::get_num_rdma_ranks() const
 {
     return num_rdma_ranks;
@@ -165,8 +363,86 @@ int Buffer::get_rdma_rank() const
     return rdma_rank;
 }
 
+WindowLayout Buffer::get_window_layout() const
+{
+    if (soc_version != op::SocVersion::ASCEND910B) {
+        return WindowLayout::A3;
+    }
+    const char *hcclIntraPcieEnable = getenv("HCCL_INTRA_PCIE_ENABLE");
+    const char *hcclIntraRoceEnable = getenv("HCCL_INTRA_ROCE_ENABLE");
+    if (hcclIntraPcieEnable != nullptr && hcclIntraRoceEnable != nullptr && strcmp(hcclIntraPcieEnable, "1") == 0 &&
+        strcmp(hcclIntraRoceEnable, "0") == 0) {
+        return WindowLayout::A2_LAYERED;
+    }
+    return WindowLayout::A2_FULLMESH;
+}
+
+void Buffer::check_window_size(int64_t required_bytes, const char *op_name) const
+{
+    // The operators check the same size in their tiling, but only report it from inside the launch
+    constexpr int64_t MB_SIZE = 1024 * 1024;
+    int64_t window_bytes = get_hccl_window_bytes();
+    EP_HOST_ASSERT_S(required_bytes <= window_bytes, op_name, " needs an HCCL window of ",
+                     (required_bytes + MB_SIZE - 1) / MB_SIZE, "MB, but HCCL_BUFFSIZE/DEEPEP_HCCL_BUFFSIZE is ",
+                     window_bytes / MB_SIZE, "MB");
+}
+
+void Buffer::check_low_latency_window(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden, int64_t num_experts,
+                                      int64_t num_topk, int64_t num_scales, const char *op_name) const
+{
+    int64_t num_local_experts = rank < shared_expert_rank_num ? 1 : num_experts / (num_ranks - shared_expert_rank_num);
+    // Tokens also get a combine slot for every shared expert, which the operators only count with shared expert ranks
+    int64_t num_slots = num_topk + (shared_expert_rank_num > 0 ? shared_expert_num : 0);
+    check_window_size(get_low_latency_window_bytes(num_max_dispatch_tokens_per_rank, hidden, num_ranks, num_experts,
+                                                   num_local_experts, num_slots, num_scales, get_window_layout()),
+                      op_name);
+}
+
+int Buffer::get_internode_rounds() const
+{
+    // The A2 internode kernels lay their metadata out for MAX_BATCH_SIZE tokens per rank. Longer batches are cut into
+    // the configured rounds on the host, each with its own layout, notify, dispatch and combine.
+    if (soc_version != op::SocVersion::ASCEND910B or num_rdma_ranks <= 1 or round <= 1) {
+        return 1;
+    }
+    EP_HOST_ASSERT_S(per_round_tokens <= MAX_BATCH_SIZE, "A2 internode rounds hold at most ", MAX_BATCH_SIZE,
+                     " tokens per rank, but DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS is ", per_round_tokens);
+    return round;
+}
+
+std::tuple<int, int> Buffer::fit_normal_rounds(int64_t hidden, int64_t num_topk)
+{
+    // Rounds set through the environment are a contract between all ranks, only validate them
+    auto layout = get_window_layout();
+    if (normal_rounds_from_env) {
+        check_window_size(get_normal_dispatch_window_bytes(per_round_tokens, hidden, num_topk, round, layout),
+                          "intranode_dispatch");
+        return {round, per_round_tokens};
+    }
+
+    // Otherwise keep the same number of tokens, split into the largest rounds the window holds. Every rank computes
+    // the same split from the same window, hidden and top-k, so the notify stays consistent across ranks.
+    int64_t window_bytes = get_hccl_window_bytes();
+    int64_t tokens = std::min(normal_total_tokens, static_cast<int64_t>(MAX_TOKENS_PER_ROUND));
+    tokens = tokens / MIN_TOKENS_PER_ROUND * MIN_TOKENS_PER_ROUND;
+    for (; tokens >= MIN_TOKENS_PER_ROUND; tokens -= MIN_TOKENS_PER_ROUND) {
+        int64_t rounds = (normal_total_tokens + tokens - 1) / tokens;
+        if (rounds <= MAX_ROUNDS and
+            get_normal_dispatch_window_bytes(tokens, hidden, num_topk, rounds, layout) <= window_bytes) {
+            round = static_cast<int32_t>(rounds);
+            per_round_tokens = static_cast<int32_t>(tokens);
+            return {round, per_round_tokens};
+        }
+    }
+    check_window_size(get_normal_dispatch_window_bytes(MIN_TOKENS_PER_ROUND, hidden, num_topk, MAX_ROUNDS, layout),
+                      "intranode_dispatch");
+    EP_HOST_ASSERT_S(false, normal_total_tokens, " tokens need more than ", MAX_ROUNDS, " rounds");
+    return {round, per_round_tokens};
+}
+
 std::tuple<at::Tensor, std::optional<at::Tensor>, std::optional<at::Tensor>, std::optional<at::Tensor>,
-           std::vector<int>, at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor, std::optional<EventHandle>>
+           std::vector<int>, std::optional<at::Tensor>, at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor,
+           std::optional<EventHandle>>
 Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor> &x_scales,
                            const std::optional<at::Tensor> &topk_idx, const std::optional<at::Tensor> &topk_weights,
                            const std::optional<at::Tensor> &num_tokens_per_rank, const at::Tensor &is_token_in_rank,
@@ -187,7 +463,8 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
     auto recv_topk_idx = std::optional<at::Tensor>();
     auto recv_topk_weights = std::optional<at::Tensor>();
     // Wait streams
-    std::optional<EventHandle> event;
+    auto compute_stream = wait_on_comm_stream(previous_event, async, allocate_on_comm_stream);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
     auto rank_prefix_matrix = at::empty({num_ranks, num_ranks}, at::dtype(at::kInt).device(x.device()));
     auto channel_prefix_matrix = at::empty({num_ranks, num_channels}, at::dtype(at::kInt).device(x.device()));
     auto recv_channel_prefix_matrix = at::empty({num_ranks, num_channels}, at::dtype(at::kInt).device(x.device()));
@@ -214,7 +491,7 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
     // Top-k checks
     int num_topk = 0;
     EP_HOST_ASSERT(topk_idx.has_value());
-    at::Tensor expert_ids = topk_idx.value().to(at::kInt);
+    at::Tensor expert_ids = to_physical_expert_ids(topk_idx.value(), 0, false).to(at::kInt);
     if (topk_idx.has_value()) {
         num_topk = static_cast<int>(topk_idx->size(1));
         EP_HOST_ASSERT(num_experts > 0);
@@ -249,11 +526,13 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
 
     int send_per_group = 3;  // (send_to_expert_num, send_to_expert_offset, send_rank_tokens)
 
-    auto send_data = torch::empty({round, num_experts * send_per_group}, at::dtype(at::kInt).device(x.device()));
+    // The notify metadata never leaves this call, so it lives in the workspace arena.
+    workspace.begin(comm_stream);
+    auto send_data = workspace.take({round, num_experts * send_per_group}, at::kInt);
     int64_t send_count = send_per_group * num_local_experts * num_ranks * round;
 
-    auto send_data_offset = torch::empty({round, num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor recv_data = torch::empty({round, num_experts * send_per_group}, at::dtype(at::kInt).device(x.device()));
+    auto send_data_offset = workspace.take({round, num_experts}, at::kInt);
+    at::Tensor recv_data = workspace.take({round, num_experts * send_per_group}, at::kInt);
     // get ep name
     char hcom_ep_name[HCOMM_NAME_LEN];
     if (!moe_all_to_all_group_name.empty()) {
@@ -261,17 +540,14 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
     } else {
         HCCL_CHECK(HcclGetCommName(ep_comm, hcom_ep_name));
     }
-    at::Tensor total_recv_token = torch::empty({1}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor recv_offset = at::empty({round, num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor recv_count = at::empty({round, num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor max_bs = torch::empty({1}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor recv_tokens_per_expert =
-        torch::empty({round * num_local_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor expert_global_offset = at::empty({num_local_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor srcrank_in_expert_offset =
-        at::empty({num_local_experts * num_ranks}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor r_in_srcrank_offset =
-        at::empty({num_local_experts * num_ranks * round}, at::dtype(at::kInt).device(x.device()));
+    at::Tensor total_recv_token = workspace.take({1}, at::kInt);
+    at::Tensor recv_offset = workspace.take({round, num_experts}, at::kInt);
+    at::Tensor recv_count = workspace.take({round, num_experts}, at::kInt);
+    at::Tensor max_bs = workspace.take({1}, at::kInt);
+    at::Tensor recv_tokens_per_expert = workspace.take({round * num_local_experts}, at::kInt);
+    at::Tensor expert_global_offset = workspace.take({num_local_experts}, at::kInt);
+    at::Tensor srcrank_in_expert_offset = workspace.take({num_local_experts * num_ranks}, at::kInt);
+    at::Tensor r_in_srcrank_offset = workspace.take({num_local_experts * num_ranks * round}, at::kInt);
 
     int64_t local_rank_size = num_ranks;
     int64_t local_rank_id = rank % local_rank_size;
@@ -292,12 +568,25 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
                  max_bs, recv_tokens_per_expert);
     auto send_token_idx_small = this->send_token_idx_small;
 
-    real_max_bs = static_cast<int64_t>(std::max(max_bs.item<int>(), static_cast<int>(num_worst_tokens)));
+    // With `num_worst_tokens` set, outputs are sized from upper bounds and the counts stay on device, so the host
+    // never waits for the notify kernel and the whole dispatch can be queued ahead of the device.
+    bool sync_free = num_worst_tokens > 0;
+    int64_t trt = 0;
+    if (sync_free) {
+        EP_HOST_ASSERT(num_tokens <= sync_free_max_bs);
+        real_max_bs = sync_free_max_bs;
+        trt = num_worst_tokens;
+    } else {
+        real_max_bs = static_cast<int64_t>(max_bs.item<int>());
+        trt = total_recv_token.item<int>();
+    }
 
     // dispatch算子内部按照 min(per_round_tokens, real_max_bs)来预留显存
     int64_t global_bs = static_cast<int64_t>(std::min(static_cast<int64_t>(per_round_tokens), real_max_bs) * num_ranks);
+    auto window_bytes =
+        get_normal_dispatch_window_bytes(global_bs / num_ranks, hidden, num_topk, round, get_window_layout());
+    check_window_size(window_bytes, "intranode_dispatch");
 
-    int64_t trt = total_recv_token.item<int>();
     int num_recv_tokens = (trt == 0) ? 1 : trt;
     auto expandx_out = use_quant ? torch::empty({num_recv_tokens, hidden}, at::dtype(at::kChar).device(x.device()))
                                  : torch::empty({num_recv_tokens, hidden}, x.options());
@@ -314,35 +603,50 @@ Buffer::intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor>
                  rank,       // rankId
                  hcom_ep_name, tp_size, tp_rank, num_experts, quant_mode, real_max_bs, global_bs, round,
                  per_round_tokens, expandx_out, dynamic_scales_out, expand_idx_out, dispatch_wait_recv_cost_stats_out);
-    auto recv_token_per_exp_cpu = recv_tokens_per_expert.to(at::kCPU);
-    auto recv_token_per_exp_ptr = recv_token_per_exp_cpu.data_ptr<int32_t>();
 
-    int token_cnt = 0;
-    // 多轮处理为一维
-    std::vector<int> round_recv_tokens_per_expert;
-    round_recv_tokens_per_expert.resize(num_local_experts);
-    for (int r = 0; r < round; r++) {
-        for (int local_e = 0; local_e < num_local_experts; ++local_e) {
-            int current_tokens = static_cast<int>(recv_token_per_exp_ptr[r * num_local_experts + local_e]);
-            token_cnt = round_recv_tokens_per_expert[local_e] + current_tokens;
-            round_recv_tokens_per_expert[local_e] = token_cnt;
+    std::optional<at::Tensor> num_recv_tokens_per_expert;
+    if (sync_free) {
+        // 多轮处理为一维, folded on device
+        auto folded = recv_tokens_per_expert.view({round, num_local_experts}).sum(0, false, at::kLong);
+        num_recv_tokens_per_expert = (expert_token_nums_type == 0) ? folded.cumsum(0) : folded;
+    } else {
+        auto recv_token_per_exp_cpu = recv_tokens_per_expert.to(at::kCPU);
+        auto recv_token_per_exp_ptr = recv_token_per_exp_cpu.data_ptr<int32_t>();
+
+        int token_cnt = 0;
+        // 多轮处理为一维
+        std::vector<int> round_recv_tokens_per_expert;
+        round_recv_tokens_per_expert.resize(num_local_experts);
+        for (int r = 0; r < round; r++) {
+            for (int local_e = 0; local_e < num_local_experts; ++local_e) {
+                int current_tokens = static_cast<int>(recv_token_per_exp_ptr[r * num_local_experts + local_e]);
+                token_cnt = round_recv_tokens_per_expert[local_e] + current_tokens;
+                round_recv_tokens_per_expert[local_e] = token_cnt;
+            }
         }
-    }
 
-    token_cnt = 0;
-    for (int local_e = 0; local_e < num_local_experts; ++local_e) {
-        int current_tokens = static_cast<int>(round_recv_tokens_per_expert[local_e]);
-        token_cnt = (expert_token_nums_type == 0) ? token_cnt + current_tokens : current_tokens;
-        num_recv_tokens_per_expert_list.emplace_back(token_cnt);
+        token_cnt = 0;
+        for (int local_e = 0; local_e < num_local_experts; ++local_e) {
+            int current_tokens = static_cast<int>(round_recv_tokens_per_expert[local_e]);
+            token_cnt = (expert_token_nums_type == 0) ? token_cnt + current_tokens : current_tokens;
+            num_recv_tokens_per_expert_list.emplace_back(token_cnt);
+        }
     }
 
     auto recv_count_one_dim = recv_count.sum(0, false).to(at::kInt);
+    auto event = release_to_compute_stream(
+        compute_stream, async,
+        {x, x_scales, topk_idx, topk_weights, num_tokens_per_rank, is_token_in_rank, num_tokens_per_expert,
+         cached_rank_prefix_matrix, cached_channel_prefix_matrix, dispatch_wait_recv_cost_stats},
+        {expandx_out, dynamic_scales_out, recv_topk_idx, recv_topk_weights, num_recv_tokens_per_expert,
+         rank_prefix_matrix, channel_prefix_matrix, recv_channel_prefix_matrix, expand_idx_out, recv_count_one_dim});
     // Return values
     return {expandx_out,
             dynamic_scales_out,
             recv_topk_idx,
             recv_topk_weights,
             num_recv_tokens_per_expert_list,
+            num_recv_tokens_per_expert,
             rank_prefix_matrix,
             channel_prefix_matrix,
             recv_channel_prefix_matrix,
@@ -399,7 +703,7 @@ Buffer::notify_verify(const at::Tensor &x, const std::optional<at::Tensor> &x_sc
     // Top-k checks
     int num_topk = 0;
     EP_HOST_ASSERT(topk_idx.has_value());
-    at::Tensor expert_ids = topk_idx.value().to(at::kInt);
+    at::Tensor expert_ids = to_physical_expert_ids(topk_idx.value(), 0, false).to(at::kInt);
     if (topk_idx.has_value()) {
         num_topk = static_cast<int>(topk_idx->size(1));
         EP_HOST_ASSERT(num_experts > 0);
@@ -485,14 +789,44 @@ void Buffer::clean_low_latency_buffer(int num_max_dispatch_tokens_per_rank, int
     return;
 }
 
+int64_t Buffer::get_low_latency_num_max_tokens(int64_t num_max_dispatch_tokens_per_rank, int64_t num_experts,
+                                               int64_t num_topk) const
+{
+    int64_t global_bs = num_max_dispatch_tokens_per_rank * num_ranks;
+    if (rank < shared_expert_rank_num) {
+        return global_bs / shared_expert_rank_num;
+    }
+    int64_t num_local_experts = num_experts / (num_ranks - shared_expert_rank_num);
+    return global_bs * std::min(num_topk, num_local_experts);
+}
+
+at::Tensor Buffer::get_next_low_latency_combine_buffer(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden,
+                                                       int64_t num_experts, int64_t num_topk)
+{
+    EP_HOST_ASSERT(low_latency_mode);
+    auto num_max_tokens = get_low_latency_num_max_tokens(num_max_dispatch_tokens_per_rank, num_experts, num_topk);
+    auto &buffer = low_latency_combine_buffers[low_latency_combine_buffer_idx];
+    if (not buffer.defined() or buffer.size(0) < num_max_tokens or buffer.size(1) != hidden) {
+        // A combine queued on the communication stream may still read the buffer being replaced
+        if (buffer.defined()) {
+            buffer.record_stream(comm_stream.unwrap());
+        }
+        buffer = at::empty({num_max_tokens, hidden}, at::dtype(at::kBFloat16).device(comm_stream.device()));
+    }
+    return buffer.narrow(0, 0, num_max_tokens);
+}
+
 std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandle>>
 Buffer::intranode_combine(const torch::Tensor &x, const torch::Tensor &topk_idx,
                           const std::optional<torch::Tensor> &topk_weights, const torch::Tensor &src_idx,
-                          const torch::Tensor &send_head, const std::optional<at::Tensor> &combine_send_cost_stats)
+                          const torch::Tensor &send_head, const std::optional<at::Tensor> &combine_send_cost_stats,
+                          std::optional<EventHandle> &previous_event, bool async, bool allocate_on_comm_stream)
 {
     EP_HOST_ASSERT(x.dim() == 2 and x.is_contiguous());
+    auto compute_stream = wait_on_comm_stream(previous_event, async, allocate_on_comm_stream);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
     at::Tensor recv_x = x;
-    auto topk_idx_int32 = topk_idx.to(at::kInt);
+    auto topk_idx_int32 = to_physical_expert_ids(topk_idx, 0, false).to(at::kInt);
     at::Tensor token_src_info = src_idx;
     at::Tensor ep_send_counts = send_head;
     auto device = x.device();
@@ -516,7 +850,8 @@ Buffer::intranode_combine(const torch::Tensor &x, const torch::Tensor &topk_idx,
     }
 
     int64_t hidden = static_cast<int>(recv_x.size(1));
-    at::Tensor tp_send_counts = at::empty({1}, at::dtype(at::kInt).device(device));
+    workspace.begin(comm_stream);
+    at::Tensor tp_send_counts = workspace.take({1}, at::kInt);
     int64_t tp_world_size = 1;
     int64_t tp_rankId = 0;
     int64_t moe_expert_number = send_head.size(0);
@@ -532,20 +867,132 @@ Buffer::intranode_combine(const torch::Tensor &x, const torch::Tensor &topk_idx,
     // Combine data
     auto combined_x = torch::empty({expert_scales.size(0), hidden}, x.options());
     std::optional<torch::Tensor> recv_topk_weights;
-    std::optional<EventHandle> event;
 
-    int32_t round = this->combine_enable_long_seq ? this->round : 1;
-    int32_t per_round_tokens = this->combine_enable_long_seq ? this->per_round_tokens : MAX_TOKENS_PER_ROUND;
+    // Unless the combine is pinned to the dispatch rounds, 0 lets the tiling size the rounds from HCCL_BUFFSIZE, hidden
+    // and topk. Batches longer than one round then pipeline their rounds instead of needing one huge window.
+    int32_t round = this->combine_enable_long_seq ? this->round : 0;
+    int32_t per_round_tokens = this->combine_enable_long_seq ? this->per_round_tokens : 0;
+    // Rounds left to the tiling only need room for its smallest round
+    int64_t combine_window_bytes =
+        this->combine_enable_long_seq
+            ? get_normal_combine_window_bytes(std::min(static_cast<int64_t>(per_round_tokens), real_max_bs), hidden,
+                                              num_topk, round > 1, get_window_layout())
+            : get_normal_combine_window_bytes(MIN_TOKENS_PER_ROUND, hidden, num_topk, true, get_window_layout());
+    check_window_size(combine_window_bytes, "intranode_combine");
     EXEC_NPU_CMD(aclnnCamMoeCombineNormal, recv_x, token_src_info, ep_send_counts, expert_scales, topk_idx_int32,
                  tp_send_counts, hcom_ep_name, num_ranks, rank, hcom_ep_name, tp_world_size, tp_rankId,
                  moe_expert_number, real_max_bs, round, per_round_tokens, combined_x, combine_send_cost_stats_out);
 
+    auto event = release_to_compute_stream(compute_stream, async,
+                                           {x, topk_idx, topk_weights, src_idx, send_head, combine_send_cost_stats},
+                                           {combined_x});
     return {combined_x, recv_topk_weights, event};
 }
 
+InternodeDispatchRound Buffer::internode_dispatch_round(const at::Tensor &x, const std::optional<at::Tensor> &x_scales,
+                                                        const at::Tensor &expert_ids, const at::Tensor &topk_weights,
+                                                        const at::Tensor &send_data,
+                                                        const at::Tensor &num_tokens_per_expert, int64_t num_experts,
+                                                        bool use_quant)
+{
+    auto num_tokens = static_cast<int>(x.size(0)), hidden = static_cast<int>(x.size(1));
+    auto num_topk = static_cast<int>(expert_ids.size(1));
+    auto num_local_experts = static_cast<int>(num_experts / num_ranks);
+
+    // dispatch normal param
+    int64_t tp_size = 1;
+    int64_t tp_rank = 0;
+    int64_t expertShardType = 0;
+    int64_t sharedExpertNum = 1;
+    int64_t sharedExpertRankNum = 0;
+    int64_t expertTokenNumsType = 0;
+
+    int64_t quant_mode = use_quant ? DYNAMIC_SCALES : NO_SCALES;
+    int64_t global_bs = static_cast<int64_t>(MAX_BATCH_SIZE * num_ranks);
+    // Everything that is not handed back to the caller is carved out of the workspace arena.
+    workspace.begin(comm_stream);
+    at::Tensor xActiveMask = workspace.take({1}, at::kInt);
+    auto expertTokenNums = workspace.take({1}, at::kLong).zero_();
+    auto epRecvCount = workspace.take({1}, at::kInt).zero_();
+    auto tpRecvCount = workspace.take({1}, at::kInt).zero_();
+    at::Tensor dispatch_wait_recv_cost_stats_out;
+
+    int64_t local_rank_size = A2_MAX_HCCS_PEERS;
+    int32_t server_num = num_ranks / local_rank_size;
+    int64_t local_rank_id = rank % local_rank_size;
+
+    // Corresponding to the output data and length of the layout
+    int send_count = this->notify_send_data_size;
+
+    auto send_data_offset = workspace.take({num_experts}, at::kInt);
+    at::Tensor tmp_data = workspace.take({send_count * num_ranks}, at::kInt);  // 给notify算子用来临时存数的空间
+    at::Tensor recv_data = workspace.take({send_count * num_ranks}, at::kInt);
+    at::Tensor token_server_idx =
+        at::empty({MAX_BATCH_SIZE, server_num}, at::dtype(at::kInt).device(x.device()));  // offset_outer
+    at::Tensor token_unique_per_server = workspace.take({server_num}, at::kInt);
+    at::Tensor ep_rank_token_cnt =
+        at::empty({num_experts, num_ranks}, at::dtype(at::kInt).device(x.device()));  // 包含全局的
+    // The number of tokens received by each expert on this rank, not a prefix sum
+    at::Tensor recv_tokens_per_expert = workspace.take({num_local_experts}, at::kLong);
+    at::Tensor src_offset_rank_token_idx = workspace.take({num_experts, num_ranks, MAX_BATCH_SIZE}, at::kInt);
+    at::Tensor dst_offset_rank_token_idx = workspace.take({num_experts, num_ranks, MAX_BATCH_SIZE}, at::kInt);
+    // The offsetInner for the current rank and the peer rank
+    at::Tensor offset_inner = at::empty({2, MAX_BATCH_SIZE, num_experts}, at::dtype(at::kInt).device(x.device()));
+    at::Tensor count_outer = at::empty({MAX_BATCH_SIZE}, at::dtype(at::kInt).device(x.device()));
+    at::Tensor expand_idx = at::empty({MAX_BATCH_SIZE, num_experts}, at::dtype(at::kInt).device(x.device()));
+    at::Tensor total_recv_token = workspace.take({1}, at::kInt);
+
+    // get ep name
+    char hcom_ep_name[HCOMM_NAME_LEN];
+    if (!moe_all_to_all_group_name.empty()) {
+        std::memcpy(hcom_ep_name, moe_all_to_all_group_name.data(), moe_all_to_all_group_name.size() + 1);
+    } else {
+        HCCL_CHECK(HcclGetCommName(ep_comm, hcom_ep_name));
+    }
+
+    EXEC_NPU_CMD(aclnnNotifyDispatchA2, send_data, num_tokens_per_expert, tmp_data, send_count, num_tokens, num_topk,
+                 num_experts,
+                 hcom_ep_name,  // commGroup
+                 num_ranks,     // rankSize
+                 rank,          // rankId
+                 local_rank_size, local_rank_id,
+                 send_data_offset,  // A2 not use
+                 recv_data, token_server_idx, token_unique_per_server, ep_rank_token_cnt, recv_tokens_per_expert,
+                 src_offset_rank_token_idx, dst_offset_rank_token_idx, offset_inner, count_outer, expand_idx,
+                 total_recv_token);
+
+    int total_count = total_recv_token.item<int>();
+    int num_recv_tokens = (total_count == 0) ? 1 : total_count;
+
+    auto expandx_out = use_quant ? at::empty({num_recv_tokens, hidden}, at::dtype(at::kChar).device(x.device()))
+                                 : at::empty({num_recv_tokens, hidden}, x.options());
+    auto dynamic_scales_out = at::empty({num_recv_tokens}, at::dtype(at::kFloat).device(x.device()));
+    auto expand_scales = at::empty({num_recv_tokens}, at::dtype(at::kFloat).device(x.device()));
+
+    EXEC_NPU_CMD(aclnnDispatchNormalA2, x, expert_ids, x_scales, xActiveMask, topk_weights, token_server_idx,
+                 token_unique_per_server, ep_rank_token_cnt, src_offset_rank_token_idx, dst_offset_rank_token_idx,
+                 hcom_ep_name, num_ranks, rank, num_experts, hcom_ep_name, tp_size, tp_rank, expertShardType,
+                 sharedExpertNum, sharedExpertRankNum, quant_mode, global_bs, expertTokenNumsType, expandx_out,
+                 dynamic_scales_out, expand_idx, expertTokenNums, epRecvCount, expand_scales,
+                 dispatch_wait_recv_cost_stats_out);
+
+    InternodeDispatchRound result;
+    result.recv_x = expandx_out;
+    result.dynamic_scales = dynamic_scales_out;
+    result.expand_scales = expand_scales;
+    result.expand_idx = expand_idx;
+    result.ep_rank_token_cnt = ep_rank_token_cnt;
+    result.offset_inner = offset_inner;
+    result.token_server_idx = token_server_idx;
+    result.count_outer = count_outer;
+    result.recv_tokens_per_expert = recv_tokens_per_expert.to(at::kCPU);
+    result.num_recv_tokens = total_count;
+    return result;
+}
+
 std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<torch::Tensor>, std::optional<torch::Tensor>,
            std::vector<int>, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor,
-           std::optional<EventHandle>>
+           std::optional<torch::Tensor>, std::optional<torch::Tensor>, std::optional<EventHandle>>
 Buffer::internode_dispatch(
     const torch::Tensor &x, const std::optional<torch::Tensor> &x_scales, const std::optional<torch::Tensor> &topk_idx,
     const std::optional<torch::Tensor> &topk_weights, const std::optional<torch::Tensor> &num_tokens_per_rank,
@@ -557,6 +1004,8 @@ Buffer::internode_dispatch(
     EP_HOST_ASSERT(config.num_sms % 2 == 0);
     int num_channels = config.num_sms / 2;
 
+    auto compute_stream = wait_on_comm_stream(previous_event, async, allocate_on_comm_stream);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
     at::Tensor new_x = x;
     EP_HOST_ASSERT(num_tokens_per_rank.has_value());
     EP_HOST_ASSERT(num_tokens_per_expert.has_value());
@@ -566,20 +1015,27 @@ Buffer::internode_dispatch(
     EP_HOST_ASSERT(num_tokens_per_rank->scalar_type() == at::kInt);
 
     // Shape and contiguous checks
+    const int internode_rounds = get_internode_rounds();
     EP_HOST_ASSERT(new_x.dim() == 2 and new_x.is_contiguous());
     EP_HOST_ASSERT(num_tokens_per_expert->dim() == 1 and num_tokens_per_expert->is_contiguous());
-    EP_HOST_ASSERT(num_tokens_per_expert->size(0) % num_ranks == 0);
+    EP_HOST_ASSERT(num_tokens_per_expert->size(0) % (num_ranks * internode_rounds) == 0);
     EP_HOST_ASSERT(num_tokens_per_rank->dim() == 1 and num_tokens_per_rank->is_contiguous());
     EP_HOST_ASSERT(num_tokens_per_rank->size(0) == num_ranks);
 
     auto num_tokens = static_cast<int>(new_x.size(0)), hidden = static_cast<int>(new_x.size(1));
-    auto num_experts = static_cast<int64_t>(num_tokens_per_expert->size(0));
+    auto num_experts = static_cast<int64_t>(num_tokens_per_expert->size(0) / internode_rounds);
     auto num_local_experts = static_cast<int>(num_experts / num_ranks);
+    // Every rank runs all rounds, the ones past the end of its tokens dispatch nothing
+    const int round_tokens = internode_rounds == 1 ? num_tokens : per_round_tokens;
+    EP_HOST_ASSERT(num_tokens <= internode_rounds * round_tokens);
+    EP_HOST_ASSERT_S(round_tokens <= MAX_BATCH_SIZE, "A2 internode dispatch holds at most ", MAX_BATCH_SIZE,
+                     " tokens per rank in a round, but got ", round_tokens,
+                     ", set DEEPEP_NORMAL_LONG_SEQ_ROUND to split the batch");
 
     // Top-k checks
     int num_topk = 0;
     EP_HOST_ASSERT(topk_idx.has_value());
-    at::Tensor expert_ids = topk_idx.value().to(at::kInt);
+    at::Tensor expert_ids = to_physical_expert_ids(topk_idx.value(), 0, false).to(at::kInt);
     if (topk_idx.has_value()) {
         num_topk = static_cast<int>(topk_idx->size(1));
         EP_HOST_ASSERT(num_experts > 0);
@@ -612,30 +1068,8 @@ Buffer::internode_dispatch(
         scale_hidden_stride = static_cast<int>(x_scales->stride(1));
     }
 
-    // dispatch normal param
-    int64_t tp_size = 1;
-    int64_t tp_rank = 0;
-    int64_t expertShardType = 0;
-    int64_t sharedExpertNum = 1;
-    int64_t sharedExpertRankNum = 0;
-    int64_t expertTokenNumsType = 0;
-
-    int64_t quant_mode = use_quant ? DYNAMIC_SCALES : NO_SCALES;
-    int64_t global_bs = static_cast<int64_t>(MAX_BATCH_SIZE * num_ranks);
-    at::Tensor xActiveMask = at::empty({1}, at::dtype(at::kInt).device(x.device()));
-    auto expertTokenNums = at::zeros({1}, at::dtype(at::kLong).device(x.device()));
-    auto epRecvCount = at::zeros({1}, at::dtype(at::kInt).device(x.device()));
-    auto tpRecvCount = at::zeros({1}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor dispatch_wait_recv_cost_stats_out;
     auto recv_topk_idx = std::optional<at::Tensor>();
     auto recv_topk_weights = std::optional<at::Tensor>();
-    // Wait streams
-    std::optional<EventHandle> event;
-
-    int64_t local_rank_size = A2_MAX_HCCS_PEERS;
-    int32_t server_num = num_ranks / local_rank_size;
-    int64_t local_rank_id = rank % local_rank_size;
-    auto new_num_tokens_per_expert = num_tokens_per_expert.value();
     std::vector<int> num_recv_tokens_per_expert_list;
     // indicates the value type of the output num_recv_tokens_per_expert_list, with a range of [0, 1]
     // 0 means the prefix sum of the number of tokens received by each expert;
@@ -643,79 +1077,109 @@ Buffer::internode_dispatch(
     int expert_token_nums_type = get_value_from_env("MOE_EXPERT_TOKEN_NUMS_TYPE", 1);
     EP_HOST_ASSERT(expert_token_nums_type == 1 or expert_token_nums_type == 0);
 
-    // Corresponding to the output data and length of the layout
-    auto new_send_data = this->notify_send_data;
-    int send_count = this->notify_send_data_size;
-
-    auto send_data_offset = at::empty({num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor tmp_data =
-        at::empty({send_count * num_ranks}, at::dtype(at::kInt).device(x.device()));  // 给notify算子用来临时存数的空间
-    at::Tensor recv_data = at::empty({send_count * num_ranks}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor token_server_idx =
-        at::empty({MAX_BATCH_SIZE, server_num}, at::dtype(at::kInt).device(x.device()));  // offset_outer
-    at::Tensor token_unique_per_server = at::empty({server_num}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor ep_rank_token_cnt =
-        at::empty({num_experts, num_ranks}, at::dtype(at::kInt).device(x.device()));  // 包含全局的
-    // The number of tokens received by each expert on this rank, not a prefix sum
-    at::Tensor recv_tokens_per_expert = at::empty({num_local_experts}, at::dtype(at::kLong).device(x.device()));
-    at::Tensor src_offset_rank_token_idx =
-        at::empty({num_experts, num_ranks, MAX_BATCH_SIZE}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor dst_offset_rank_token_idx =
-        at::empty({num_experts, num_ranks, MAX_BATCH_SIZE}, at::dtype(at::kInt).device(x.device()));
-    // The offsetInner for the current rank and the peer rank
-    at::Tensor offset_inner = at::empty({2, MAX_BATCH_SIZE, num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor count_outer = at::empty({MAX_BATCH_SIZE}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor expand_idx = at::empty({MAX_BATCH_SIZE, num_experts}, at::dtype(at::kInt).device(x.device()));
-    at::Tensor total_recv_token = torch::empty({1}, at::dtype(at::kInt).device(x.device()));
-
-    // get ep name
-    char hcom_ep_name[HCOMM_NAME_LEN];
-    if (!moe_all_to_all_group_name.empty()) {
-        std::memcpy(hcom_ep_name, moe_all_to_all_group_name.data(), moe_all_to_all_group_name.size() + 1);
-    } else {
-        HCCL_CHECK(HcclGetCommName(ep_comm, hcom_ep_name));
+    check_window_size(get_internode_dispatch_window_bytes(MAX_BATCH_SIZE, hidden, num_ranks, num_local_experts),
+                      "internode_dispatch");
+    std::vector<InternodeDispatchRound> rounds;
+    for (int r = 0; r < internode_rounds; ++r) {
+        const int begin = std::min(r * round_tokens, num_tokens);
+        const int end = std::min(begin + round_tokens, num_tokens);
+        std::optional<at::Tensor> round_x_scales;
+        if (x_scales.has_value()) {
+            round_x_scales = x_scales->slice(0, begin, end);
+        }
+        auto send_data = internode_rounds == 1 ? this->notify_send_data : this->notify_send_data[r];
+        rounds.emplace_back(internode_dispatch_round(
+            new_x.slice(0, begin, end), round_x_scales, expert_ids.slice(0, begin, end),
+            new_topk_weights.slice(0, begin, end), send_data,
+            num_tokens_per_expert->slice(0, r * num_experts, (r + 1) * num_experts), num_experts, use_quant));
     }
 
-    EXEC_NPU_CMD(aclnnNotifyDispatchA2, new_send_data, new_num_tokens_per_expert, tmp_data, send_count, num_tokens,
-                 num_topk, num_experts,
-                 hcom_ep_name,  // commGroup
-                 num_ranks,     // rankSize
-                 rank,          // rankId
-                 local_rank_size, local_rank_id,
-                 send_data_offset,  // A2 not use
-                 recv_data, token_server_idx, token_unique_per_server, ep_rank_token_cnt, recv_tokens_per_expert,
-                 src_offset_rank_token_idx, dst_offset_rank_token_idx, offset_inner, count_outer, expand_idx,
-                 total_recv_token);
-
-    int total_count = total_recv_token.item<int>();
-    int num_recv_tokens = (total_count == 0) ? 1 : total_count;
-
-    auto expandx_out = use_quant ? at::empty({num_recv_tokens, hidden}, at::dtype(at::kChar).device(x.device()))
-                                 : at::empty({num_recv_tokens, hidden}, x.options());
-    auto dynamic_scales_out = at::empty({num_recv_tokens}, at::dtype(at::kFloat).device(x.device()));
-    auto expand_scales = at::empty({num_recv_tokens}, at::dtype(at::kFloat).device(x.device()));
+    int64_t total_count = 0;
+    std::vector<int64_t> recv_tokens_per_expert(num_local_experts, 0);
+    for (const auto &dispatched : rounds) {
+        total_count += dispatched.num_recv_tokens;
+        auto recv_token_per_exp_ptr = dispatched.recv_tokens_per_expert.data_ptr<int64_t>();
+        for (int local_e = 0; local_e < num_local_experts; ++local_e) {
+            recv_tokens_per_expert[local_e] += recv_token_per_exp_ptr[local_e];
+        }
+    }
+    int token_cnt = 0;
+    for (int local_e = 0; local_e < num_local_experts; ++local_e) {
+        int current_tokens = static_cast<int>(recv_tokens_per_expert[local_e]);
+        token_cnt = (expert_token_nums_type == 0) ? token_cnt + current_tokens : current_tokens;
+        num_recv_tokens_per_expert_list.emplace_back(token_cnt);
+    }
     if (topk_idx.has_value()) {
         recv_topk_idx = at::empty({total_count, num_topk}, topk_idx->options());
         recv_topk_weights = at::empty({total_count, num_topk}, topk_weights->options());
     }
 
-    EXEC_NPU_CMD(aclnnDispatchNormalA2, new_x, expert_ids, x_scales, xActiveMask, new_topk_weights, token_server_idx,
-                 token_unique_per_server, ep_rank_token_cnt, src_offset_rank_token_idx, dst_offset_rank_token_idx,
-                 hcom_ep_name, num_ranks, rank, num_experts, hcom_ep_name, tp_size, tp_rank, expertShardType,
-                 sharedExpertNum, sharedExpertRankNum, quant_mode, global_bs, expertTokenNumsType, expandx_out,
-                 dynamic_scales_out, expand_idx, expertTokenNums, epRecvCount, expand_scales,
-                 dispatch_wait_recv_cost_stats_out);
-
-    auto recv_token_per_exp_cpu = recv_tokens_per_expert.to(at::kCPU);
-    auto recv_token_per_exp_ptr = recv_token_per_exp_cpu.data_ptr<int64_t>();
+    at::Tensor expandx_out, dynamic_scales_out, expand_scales;
+    at::Tensor expand_idx, ep_rank_token_cnt, offset_inner, token_server_idx, count_outer;
+    std::optional<at::Tensor> recv_round_perm, recv_round_offsets;
+    if (internode_rounds == 1) {
+        auto &dispatched = rounds.front();
+        expandx_out = dispatched.recv_x;
+        dynamic_scales_out = dispatched.dynamic_scales;
+        expand_scales = dispatched.expand_scales;
+        expand_idx = dispatched.expand_idx;
+        ep_rank_token_cnt = dispatched.ep_rank_token_cnt;
+        offset_inner = dispatched.offset_inner;
+        token_server_idx = dispatched.token_server_idx;
+        count_outer = dispatched.count_outer;
+    } else {
+        // Each round receives its tokens grouped by local expert. Gather the rounds so that the tokens of an expert are
+        // contiguous over all of them, the combine scatters them back with the same permutation.
+        auto offsets_cpu = at::empty({internode_rounds + 1}, at::kLong);
+        auto offsets_ptr = offsets_cpu.data_ptr<int64_t>();
+        offsets_ptr[0] = 0;
+        std::vector<at::Tensor> recv_x_list, dynamic_scales_list, expand_scales_list;
+        std::vector<at::Tensor> expand_idx_list, ep_rank_token_cnt_list, offset_inner_list, token_server_idx_list,
+            count_outer_list;
+        for (int r = 0; r < internode_rounds; ++r) {
+            offsets_ptr[r + 1] = offsets_ptr[r] + rounds[r].recv_x.size(0);
+            recv_x_list.emplace_back(rounds[r].recv_x);
+            dynamic_scales_list.emplace_back(rounds[r].dynamic_scales);
+            expand_scales_list.emplace_back(rounds[r].expand_scales);
+            expand_idx_list.emplace_back(rounds[r].expand_idx);
+            ep_rank_token_cnt_list.emplace_back(rounds[r].ep_rank_token_cnt);
+            offset_inner_list.emplace_back(rounds[r].offset_inner);
+            token_server_idx_list.emplace_back(rounds[r].token_server_idx);
+            count_outer_list.emplace_back(rounds[r].count_outer);
+        }
 
-    int token_cnt = 0;
-    for (int local_e = 0; local_e < num_local_experts; ++local_e) {
-        int current_tokens = static_cast<int>(recv_token_per_exp_ptr[local_e]);
-        token_cnt = (expert_token_nums_type == 0) ? token_cnt + current_tokens : current_tokens;
-        num_recv_tokens_per_expert_list.emplace_back(token_cnt);
+        // Without any received token the output keeps the single padding row of the first round
+        auto perm_cpu = at::zeros({std::max<int64_t>(total_count, 1)}, at::kLong);
+        auto perm_ptr = perm_cpu.data_ptr<int64_t>();
+        std::vector<int64_t> round_cursor(offsets_ptr, offsets_ptr + internode_rounds);
+        int64_t row = 0;
+        for (int local_e = 0; local_e < num_local_experts; ++local_e) {
+            for (int r = 0; r < internode_rounds; ++r) {
+                int64_t count = rounds[r].recv_tokens_per_expert.data_ptr<int64_t>()[local_e];
+                for (int64_t i = 0; i < count; ++i) {
+                    perm_ptr[row++] = round_cursor[r]++;
+                }
+            }
+        }
+        EP_HOST_ASSERT(row == total_count);
+
+        auto perm = perm_cpu.to(device);
+        expandx_out = at::cat(recv_x_list).index_select(0, perm);
+        dynamic_scales_out = at::cat(dynamic_scales_list).index_select(0, perm);
+        expand_scales = at::cat(expand_scales_list);
+        expand_idx = at::stack(expand_idx_list);
+        ep_rank_token_cnt = at::stack(ep_rank_token_cnt_list);
+        offset_inner = at::stack(offset_inner_list);
+        token_server_idx = at::stack(token_server_idx_list);
+        count_outer = at::stack(count_outer_list);
+        recv_round_perm = perm;
+        recv_round_offsets = offsets_cpu;
     }
 
+    auto event = release_to_compute_stream(
+        compute_stream, async, {x, x_scales, topk_idx, topk_weights, num_tokens_per_rank, num_tokens_per_expert},
+        {expandx_out, dynamic_scales_out, recv_topk_idx, recv_topk_weights, expand_idx, ep_rank_token_cnt, offset_inner,
+         token_server_idx, count_outer, expand_scales, recv_round_perm});
     return {expandx_out,
             dynamic_scales_out,
             recv_topk_idx,
@@ -727,32 +1191,23 @@ Buffer::internode_dispatch(
             token_server_idx,
             count_outer,
             expand_scales,
+            recv_round_perm,
+            recv_round_offsets,
             event};
 }
 
-std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandle>> Buffer::internode_combine(
-    const torch::Tensor &x, const torch::Tensor &topk_idx, const std::optional<torch::Tensor> &topk_weights,
-    const torch::Tensor &src_idx, const torch::Tensor &send_head, const torch::Tensor &offsetInner,
-    const torch::Tensor &offsetOuter, const torch::Tensor &countOuter, const torch::Tensor &expand_scales)
+void Buffer::internode_combine_round(const at::Tensor &x, const at::Tensor &expert_ids, const at::Tensor &expand_idx,
+                                     const at::Tensor &ep_send_counts, const at::Tensor &expand_scales,
+                                     const at::Tensor &offset_inner, const at::Tensor &offset_outer,
+                                     const at::Tensor &count_outer, const at::Tensor &combined_x)
 {
-    EP_HOST_ASSERT(x.dim() == 2 and x.is_contiguous());
-    at::Tensor recv_x = x;
-    at::Tensor expert_ids = topk_idx.to(at::kInt);
-    // In the A2 implementation, the tensor is expanded from [bs, k] to [bs, num_expert].
-    at::Tensor expand_idx = src_idx;
-    // A2 needs global send counts, [num_expert, num_rank]
-    at::Tensor ep_send_counts = send_head;
-    auto device = x.device();
-
-    const int num_tokens = topk_idx.size(0);
-    const int num_topk = topk_idx.size(1);
     at::Tensor expert_scales = at::empty({1}, at::dtype(at::kFloat).device(x.device()));
 
-    int64_t hidden = static_cast<int>(recv_x.size(1));
-    at::Tensor tp_send_counts = at::empty({1}, at::dtype(at::kInt).device(device));
+    workspace.begin(comm_stream);
+    at::Tensor tp_send_counts = workspace.take({1}, at::kInt);
     int64_t tp_world_size = 1;
     int64_t tp_rankId = 0;
-    int64_t moe_expert_number = send_head.size(0);
+    int64_t moe_expert_number = ep_send_counts.size(0);
     int64_t global_bs = static_cast<int64_t>(MAX_BATCH_SIZE * num_ranks);
 
     // get ep & tp name
@@ -764,9 +1219,6 @@ std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandl
     }
 
     // Combine data
-    auto combined_x = torch::empty({topk_idx.size(0), hidden}, x.options());
-    std::optional<torch::Tensor> recv_topk_weights;
-    std::optional<EventHandle> event;
     at::Tensor x_active_mask, activation_scale, weight_scale, group_list;
     int64_t expert_shared_type = 0;
     int64_t out_dtype = 0;
@@ -774,12 +1226,58 @@ std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandl
     int64_t group_list_type = 0;
     at::Tensor combine_send_cost_stats_out;
 
-    EXEC_NPU_CMD(aclnnMoeDistributeCombineA2, recv_x, expert_ids, expand_idx, ep_send_counts, expert_scales,
-                 tp_send_counts, x_active_mask, activation_scale, weight_scale, group_list, expand_scales, offsetInner,
-                 offsetOuter, countOuter, hcom_ep_name, num_ranks, rank, moe_expert_number, hcom_ep_name, tp_world_size,
-                 tp_rankId, expert_shared_type, shared_expert_num, shared_expert_rank_num, global_bs, out_dtype,
-                 comm_quant_mode, group_list_type, combined_x, combine_send_cost_stats_out);
+    EXEC_NPU_CMD(aclnnMoeDistributeCombineA2, x, expert_ids, expand_idx, ep_send_counts, expert_scales, tp_send_counts,
+                 x_active_mask, activation_scale, weight_scale, group_list, expand_scales, offset_inner, offset_outer,
+                 count_outer, hcom_ep_name, num_ranks, rank, moe_expert_number, hcom_ep_name, tp_world_size, tp_rankId,
+                 expert_shared_type, shared_expert_num, shared_expert_rank_num, global_bs, out_dtype, comm_quant_mode,
+                 group_list_type, combined_x, combine_send_cost_stats_out);
+}
+
+std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandle>> Buffer::internode_combine(
+    const torch::Tensor &x, const torch::Tensor &topk_idx, const std::optional<torch::Tensor> &topk_weights,
+    const torch::Tensor &src_idx, const torch::Tensor &send_head, const torch::Tensor &offsetInner,
+    const torch::Tensor &offsetOuter, const torch::Tensor &countOuter, const torch::Tensor &expand_scales,
+    const std::optional<torch::Tensor> &recv_round_perm, const std::optional<torch::Tensor> &recv_round_offsets,
+    std::optional<EventHandle> &previous_event, bool async, bool allocate_on_comm_stream)
+{
+    EP_HOST_ASSERT(x.dim() == 2 and x.is_contiguous());
+    EP_HOST_ASSERT(recv_round_perm.has_value() == recv_round_offsets.has_value());
+    auto compute_stream = wait_on_comm_stream(previous_event, async, allocate_on_comm_stream);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    at::Tensor expert_ids = to_physical_expert_ids(topk_idx, 0, false).to(at::kInt);
 
+    const int num_tokens = topk_idx.size(0);
+    int64_t hidden = static_cast<int>(x.size(1));
+    auto combined_x = torch::empty({num_tokens, hidden}, x.options());
+    std::optional<torch::Tensor> recv_topk_weights;
+
+    if (not recv_round_perm.has_value()) {
+        // In the A2 implementation, `src_idx` is expanded from [bs, k] to [bs, num_expert] and `send_head` holds the
+        // global send counts [num_expert, num_rank]
+        internode_combine_round(x, expert_ids, src_idx, send_head, expand_scales, offsetInner, offsetOuter, countOuter,
+                                combined_x);
+    } else {
+        // Scatter the expert-grouped tokens back into the order of the dispatch rounds, then combine round by round
+        const int internode_rounds = static_cast<int>(recv_round_offsets->size(0)) - 1;
+        const int64_t *offsets_ptr = recv_round_offsets->data_ptr<int64_t>();
+        EP_HOST_ASSERT(x.size(0) == recv_round_perm->size(0));
+        EP_HOST_ASSERT(src_idx.size(0) == internode_rounds and expand_scales.size(0) == offsets_ptr[internode_rounds]);
+        auto round_x = at::empty({offsets_ptr[internode_rounds], hidden}, x.options());
+        round_x.index_copy_(0, recv_round_perm.value(), x);
+        for (int r = 0; r < internode_rounds; ++r) {
+            const int begin = std::min(r * per_round_tokens, num_tokens);
+            const int end = std::min(begin + per_round_tokens, num_tokens);
+            internode_combine_round(round_x.slice(0, offsets_ptr[r], offsets_ptr[r + 1]),
+                                    expert_ids.slice(0, begin, end), src_idx[r], send_head[r],
+                                    expand_scales.slice(0, offsets_ptr[r], offsets_ptr[r + 1]), offsetInner[r],
+                                    offsetOuter[r], countOuter[r], combined_x.slice(0, begin, end));
+        }
+    }
+
+    auto event = release_to_compute_stream(compute_stream, async,
+                                           {x, topk_idx, topk_weights, src_idx, send_head, offsetInner, offsetOuter,
+                                            countOuter, expand_scales, recv_round_perm},
+                                           {combined_x});
     return {combined_x, recv_topk_weights, event};
 }
 
@@ -788,40 +1286,63 @@ std::tuple<at::Tensor, std::optional<at::Tensor>, at::Tensor, at::Tensor, at::Te
 Buffer::low_latency_dispatch(const at::Tensor &x, const at::Tensor &topk_idx,
                              const std::optional<at::Tensor> &cumulative_local_expert_recv_stats,
                              int64_t num_max_dispatch_tokens_per_rank, int64_t num_experts, bool use_fp8,
-                             bool round_scale, bool use_ue8m0, bool async, bool return_recv_hook)
+                             bool round_scale, bool use_ue8m0, bool use_block_scales, bool async,
+                             bool return_recv_hook)
 {
     EP_HOST_ASSERT(low_latency_mode);
+    EP_HOST_ASSERT(not(async and return_recv_hook));
     at::Tensor new_x = x;
     EP_HOST_ASSERT(num_max_dispatch_tokens_per_rank >= x.size(0));
 
+    // The kernel always runs on the communication stream, ordered after the work already queued on the compute stream
+    std::optional<EventHandle> no_previous_event;
+    auto compute_stream = wait_on_comm_stream(no_previous_event, false, false);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
+    auto expert_ids = to_physical_expert_ids(topk_idx, num_experts, true);
+
     auto num_tokens = static_cast<int>(x.size(0)), hidden = static_cast<int>(x.size(1));
-    auto num_scales = hidden / 128, num_topk = static_cast<int>(topk_idx.size(1));
+    auto num_scales = hidden / SCALE_BLOCK_SIZE, num_topk = static_cast<int>(topk_idx.size(1));
     int32_t num_local_experts = num_experts / (num_ranks - shared_expert_rank_num);
     int64_t global_bs = num_max_dispatch_tokens_per_rank * num_ranks;
-    auto num_max_tokens = 0;
+    auto num_max_tokens =
+        static_cast<int>(get_low_latency_num_max_tokens(num_max_dispatch_tokens_per_rank, num_experts, num_topk));
     if (rank < shared_expert_rank_num) {
-        num_max_tokens = global_bs / shared_expert_rank_num;
         num_local_experts = 1;
-    } else {  // moe expert
-        num_max_tokens = global_bs * std::min(num_topk, num_local_experts);
     }
     auto max_size = std::max(num_tokens * num_topk, num_max_tokens * 128);
 
+    // Only the A3 dispatch kernel can quantize every 128-channel block of a token with its own scale. Without
+    // use_block_scales the scales keep the per-token [num_max_tokens] layout on both SoCs
+    EP_HOST_ASSERT_S(not use_block_scales or (use_fp8 and soc_version != op::SocVersion::ASCEND910B),
+                     "use_block_scales needs use_fp8 and is not supported on Ascend 910B");
+    EP_HOST_ASSERT(not round_scale or use_block_scales);
+    EP_HOST_ASSERT(not use_ue8m0 or round_scale);
+    if (use_block_scales) {
+        EP_HOST_ASSERT(hidden % SCALE_BLOCK_SIZE == 0);
+        EP_HOST_ASSERT(not use_ue8m0 or num_scales % UE8M0_PER_INT32 == 0);
+    }
+
     // Allocate packed tensors
     auto device = x.device();
     auto packed_recv_x = at::empty({num_max_tokens, hidden}, x.options().dtype(use_fp8 ? at::kChar : at::kBFloat16));
-    auto packed_recv_x_scales = at::empty({num_max_tokens}, at::dtype(at::kFloat).device(device));
+    auto packed_recv_x_scales = use_block_scales
+                                    ? at::empty({num_max_tokens, num_scales}, at::dtype(at::kFloat).device(device))
+                                    : at::empty({num_max_tokens}, at::dtype(at::kFloat).device(device));
     auto expandIdx = at::empty({max_size}, at::dtype(at::kInt).device(device));
 
     int32_t server_num = num_ranks / LOCAL_RANK_SIZE;
     at::Tensor ep_recv_count =
         at::empty({num_local_experts * num_ranks}, at::dtype(at::kInt).device(device));  // A2 non-layered / A3
-    auto tp_recv_count = at::empty({1}, at::dtype(at::kInt).device(device));
+    workspace.begin(comm_stream);
+    auto tp_recv_count = workspace.take({1}, at::kInt);
     auto packed_recv_count = at::empty({num_local_experts}, at::dtype(at::kLong).device(device));
     at::Tensor scales;
     at::Tensor active_mask;
     int enable_neg_one = get_value_from_env("MOE_ENABLE_TOPK_NEG_ONE", 0);
-    int64_t quant_mode = use_fp8 ? 2 : 0;
+    int64_t quant_mode = NO_SCALES;
+    if (use_fp8) {
+        quant_mode = use_block_scales ? (round_scale ? PER_BLOCK_POW2_SCALES : PER_BLOCK_SCALES) : DYNAMIC_SCALES;
+    }
     int64_t tp_size = 1;
     int64_t tp_rank = 0;
     int64_t expert_shard_type = 0;
@@ -837,19 +1358,11 @@ Buffer::low_latency_dispatch(const at::Tensor &x, const at::Tensor &topk_idx,
         HCCL_CHECK(HcclGetCommName(ep_comm, hcom_ep_name));
     }
     char hcom_tp_name[HCOMM_NAME_LEN] = {0};
-    // Wait streams
-    std::optional<EventHandle> event;
-    bool isLayered = false;
+    bool isLayered = get_window_layout() == WindowLayout::A2_LAYERED;
 
-    if (soc_version == op::SocVersion::ASCEND910B) {
-        const char *hcclIntraPcieEnable = getenv("HCCL_INTRA_PCIE_ENABLE");
-        const char *hcclIntraRoceEnable = getenv("HCCL_INTRA_ROCE_ENABLE");
-        if (hcclIntraPcieEnable != nullptr && hcclIntraRoceEnable != nullptr && strcmp(hcclIntraPcieEnable, "1") == 0 &&
-            strcmp(hcclIntraRoceEnable, "0") == 0) {  // A2 layered
-            isLayered = true;
-            int64_t recv_count_tensor_size = num_experts + 2 * global_bs * num_topk * server_num;
-            ep_recv_count = at::empty({recv_count_tensor_size}, at::dtype(at::kInt).device(device));
-        }
+    if (isLayered) {
+        int64_t recv_count_tensor_size = num_experts + 2 * global_bs * num_topk * server_num;
+        ep_recv_count = at::empty({recv_count_tensor_size}, at::dtype(at::kInt).device(device));
     }
 
     if (soc_version == op::SocVersion::ASCEND910B) {
@@ -860,10 +1373,12 @@ Buffer::low_latency_dispatch(const at::Tensor &x, const at::Tensor &topk_idx,
 
     if (enable_neg_one) {
         EP_HOST_ASSERT(isLayered == false);
-        active_mask = (topk_idx >= 0).to(torch::kBool);
+        active_mask = (expert_ids >= 0).to(torch::kBool);
     }
+    check_low_latency_window(num_max_dispatch_tokens_per_rank, hidden, num_experts, num_topk,
+                             use_block_scales ? num_scales : 1, "low_latency_dispatch");
 
-    EXEC_NPU_CMD(aclnnMoeDistributeDispatchV2, x, topk_idx,
+    EXEC_NPU_CMD(aclnnMoeDistributeDispatchV2, x, expert_ids,
                  scales,        // smooth scales,
                  active_mask,   // active_mask
                  hcom_ep_name,  // ep
@@ -885,9 +1400,28 @@ Buffer::low_latency_dispatch(const at::Tensor &x, const at::Tensor &topk_idx,
                  packed_recv_count,  // expertTokenNumsOut
                  ep_recv_count, tp_recv_count);
 
+    if (use_ue8m0) {
+        // Rounded scales are exact powers of two, so the biased exponent byte is the UE8M0 value; pack four per int32
+        packed_recv_x_scales =
+            packed_recv_x_scales.view(at::kInt).bitwise_right_shift(FP32_MANTISSA_BITS).to(at::kByte).view(at::kInt);
+    }
+
+    if (cumulative_local_expert_recv_stats.has_value()) {
+        auto &stats = cumulative_local_expert_recv_stats.value();
+        EP_HOST_ASSERT(stats.dim() == 1 and stats.size(0) == num_local_experts);
+        // expert_token_nums_type 0 reports a prefix sum over the local experts, 1 the count of each expert
+        auto recv_count = expert_token_nums_type == 0
+                              ? at::diff(packed_recv_count, 1, 0, at::zeros({1}, packed_recv_count.options()))
+                              : packed_recv_count;
+        stats.add_(recv_count.to(stats.scalar_type()));
+    }
+
     // Return values
-    return {packed_recv_x, packed_recv_x_scales,        packed_recv_count, expandIdx, ep_recv_count,
-            event,         std::function<void()>([] {})};
+    auto event = release_to_compute_stream(compute_stream, async or return_recv_hook, {x, topk_idx},
+                                           {packed_recv_x, packed_recv_x_scales, packed_recv_count, expandIdx,
+                                            ep_recv_count});
+    auto recv_hook = make_recv_hook(event, return_recv_hook);
+    return {packed_recv_x, packed_recv_x_scales, packed_recv_count, expandIdx, ep_recv_count, event, recv_hook};
 }
 
 std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<void()>>> Buffer::low_latency_combine(
@@ -899,6 +1433,11 @@ std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<v
     // Tensor checks
     EP_HOST_ASSERT(x.dim() == 2 and x.is_contiguous() and x.scalar_type() == at::kBFloat16);
     EP_HOST_ASSERT(num_max_dispatch_tokens_per_rank >= topk_idx.size(0));
+    EP_HOST_ASSERT(not(async and return_recv_hook));
+
+    std::optional<EventHandle> no_previous_event;
+    auto compute_stream = wait_on_comm_stream(no_previous_event, false, false);
+    c10_npu::NPUStreamGuard comm_guard(comm_stream);
 
     // get ep & tp name
     char hcom_ep_name[HCOMM_NAME_LEN];
@@ -911,11 +1450,12 @@ std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<v
 
     auto device = x.device();
     at::Tensor expand_x = x;
-    at::Tensor expert_ids = topk_idx;
+    at::Tensor expert_ids = to_physical_expert_ids(topk_idx, num_experts, false);
     at::Tensor expand_idx = src_info;  // handle[0] = src_info
     at::Tensor ep_send_counts = layout_range;
     at::Tensor expert_scales = topk_weights;
-    at::Tensor tp_send_counts = at::empty({1}, at::dtype(at::kInt).device(device));
+    workspace.begin(comm_stream);
+    at::Tensor tp_send_counts = workspace.take({1}, at::kInt);
     at::Tensor x_active_mask, activation_scale, weight_scale, group_list, expand_scales;
     int enable_neg_one = get_value_from_env("MOE_ENABLE_TOPK_NEG_ONE", 0);
     int64_t tp_world_size = 1;
@@ -925,23 +1465,30 @@ std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<v
     int64_t out_dtype = 0;
     int64_t comm_quant_mode = 0;
     int64_t group_list_type = 0;
-    bool isLayered = false;
     char *comm_alg;
     at::Tensor combine_send_cost_stats_out;
 
     auto num_combined_tokens = static_cast<int>(topk_weights.size(0));
     auto hidden = static_cast<int>(x.size(1));
     at::Tensor shared_expert_x{nullptr};
-    at::Tensor combined_x = at::empty({num_combined_tokens, hidden}, x.options());
-    std::optional<EventHandle> event;
-    if (soc_version == op::SocVersion::ASCEND910B) {
-        const char *hcclIntraPcieEnable = getenv("HCCL_INTRA_PCIE_ENABLE");
-        const char *hcclIntraRoceEnable = getenv("HCCL_INTRA_ROCE_ENABLE");
-        if (hcclIntraPcieEnable != nullptr && hcclIntraRoceEnable != nullptr && strcmp(hcclIntraPcieEnable, "1") == 0 &&
-            strcmp(hcclIntraRoceEnable, "0") == 0) {  // A2 layered
-            isLayered = true;
-        }
+
+    // The kernel reads the expert outputs straight from `x`, so a zero-copy combine only has to check that the GEMM
+    // wrote them into the buffer handed out by `get_next_low_latency_combine_buffer`
+    if (zero_copy) {
+        auto &buffer = low_latency_combine_buffers[low_latency_combine_buffer_idx];
+        EP_HOST_ASSERT(buffer.defined() and x.data_ptr() == buffer.data_ptr());
+        low_latency_combine_buffer_idx ^= 1;
+    }
+
+    at::Tensor combined_x;
+    if (out.has_value()) {
+        EP_HOST_ASSERT(out->dim() == 2 and out->is_contiguous() and out->scalar_type() == x.scalar_type());
+        EP_HOST_ASSERT(out->size(0) >= num_combined_tokens and out->size(1) == hidden);
+        combined_x = out->narrow(0, 0, num_combined_tokens);
+    } else {
+        combined_x = at::empty({num_combined_tokens, hidden}, x.options());
     }
+    bool isLayered = get_window_layout() == WindowLayout::A2_LAYERED;
 
     if (soc_version == op::SocVersion::ASCEND910B) {
         comm_alg = "fullmesh";
@@ -953,6 +1500,8 @@ std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<v
         EP_HOST_ASSERT(isLayered == false);
         x_active_mask = (expert_ids >= 0).to(torch::kBool);
     }
+    check_low_latency_window(num_max_dispatch_tokens_per_rank, hidden, num_experts, topk_idx.size(1), 1,
+                             "low_latency_combine");
 
     EXEC_NPU_CMD(aclnnMoeDistributeCombineV2, expand_x, expert_ids, expand_idx, ep_send_counts, expert_scales,
                  tp_send_counts, x_active_mask, activation_scale, weight_scale, group_list, expand_scales,
@@ -960,7 +1509,10 @@ std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<v
                  expert_shared_type, shared_expert_num, shared_expert_rank_num, global_bs, out_dtype, comm_quant_mode,
                  group_list_type, comm_alg, combined_x, combine_send_cost_stats_out);
 
-    return {combined_x, event, std::function<void()>([] {})};
+    auto event = release_to_compute_stream(compute_stream, async or return_recv_hook,
+                                           {x, topk_idx, topk_weights, src_info, layout_range, out}, {combined_x});
+    auto recv_hook = make_recv_hook(event, return_recv_hook);
+    return {combined_x, event, recv_hook};
 }
 
 std::vector<at::Tensor> Buffer::fused_deep_moe(const at::Tensor &x, const at::Tensor &expert_ids,
@@ -982,6 +1534,7 @@ std::vector<at::Tensor> Buffer::fused_deep_moe(const at::Tensor &x, const at::Te
     }
 
     int64_t global_bs = std::max(expert_ids.size(0), num_max_dispatch_tokens_per_rank) * num_ranks;
+    auto physical_expert_ids = to_physical_expert_ids(expert_ids, num_experts, true);
 
     auto x_shape = x.sizes();
     int h = x_shape[1];
@@ -995,7 +1548,8 @@ std::vector<at::Tensor> Buffer::fused_deep_moe(const at::Tensor &x, const at::Te
 
     EXEC_NPU_CMD(aclnnFusedDeepMoe,
                  // input
-                 x, expert_ids, gmm1_permuted_weight, gmm1_permuted_weight_scale, gmm2_weight, gmm2_weight_scale,
+                 x, physical_expert_ids, gmm1_permuted_weight, gmm1_permuted_weight_scale, gmm2_weight,
+                 gmm2_weight_scale,
                  static_cast<const std::nullptr_t &>(nullptr), expert_scales_optional,
                  // attr
                  hcom_ep_name, num_ranks, rank, num_experts, shared_expert_num, shared_expert_rank_num, quant_mode,
@@ -1007,8 +1561,10 @@ std::vector<at::Tensor> Buffer::fused_deep_moe(const at::Tensor &x, const at::Te
 }
 
 std::vector<at::Tensor> Buffer::dispatch_ffn_combine(const at::Tensor &x, const at::Tensor &expert_ids,
-                                                     const at::Tensor &weight1, const at::Tensor &scale1,
-                                                     const at::Tensor &weight2, const at::Tensor &scale2,
+                                                     const at::Tensor &weight1,
+                                                     const c10::optional<at::Tensor> &scale1,
+                                                     const at::Tensor &weight2,
+                                                     const c10::optional<at::Tensor> &scale2,
                                                      const at::Tensor &expert_scales, int64_t max_output_size,
                                                      int64_t num_experts, int quant_mode) const
 {
@@ -1030,14 +1586,22 @@ std::vector<at::Tensor> Buffer::dispatch_ffn_combine(const at::Tensor &x, const
     int64_t num_local_experts = num_experts / num_ranks;
     at::Tensor expert_token_nums = at::empty({num_local_experts}, expert_ids.options());
 
+    // fp16/bf16 weights take the unquantized kernel of the same op; scale1/scale2 are then optional and ignored
     bool is_int8 = weight1.scalar_type() == at::ScalarType::Char;
+    EP_HOST_ASSERT_S(is_int8 || weight1.scalar_type() == x.scalar_type(),
+                     "dispatch_ffn_combine weights must be int8 or match the dtype of x");
+    EP_HOST_ASSERT(weight2.scalar_type() == weight1.scalar_type());
     if (is_int8) {
-        EXEC_NPU_CMD(aclnnDispatchFFNCombine, x, weight1, weight2, expert_ids, scale1, scale2, expert_scales,
-                     hcom_ep_name, num_ranks, rank, max_output_size, output, expert_token_nums);
+        TORCH_CHECK(scale1.has_value() && scale2.has_value(),
+                    "dispatch_ffn_combine: int8 weights need scale1 and scale2");
     } else {
-        // TODO: Implement aclnnDispatchFFNCombineBF16 when available
-        EP_HOST_ASSERT_S(false, "BF16 mode not yet supported for dispatch_ffn_combine");
+        TORCH_CHECK(at_npu::native::NPUNativeFunctions::get_npu_format(weight1) == ACL_FORMAT_FRACTAL_NZ &&
+                        at_npu::native::NPUNativeFunctions::get_npu_format(weight2) == ACL_FORMAT_FRACTAL_NZ,
+                    "dispatch_ffn_combine: fp16/bf16 weights must be FRACTAL_NZ, cast them with "
+                    "torch_npu.npu_format_cast(weight, 29)");
     }
+    EXEC_NPU_CMD(aclnnDispatchFFNCombine, x, weight1, weight2, expert_ids, scale1, scale2, expert_scales,
+                 hcom_ep_name, num_ranks, rank, max_output_size, output, expert_token_nums);
     return {output, expert_token_nums};
 }
 }  // namespace deep_ep
@@ -11,9 +11,18 @@
 
 #include "config.hpp"
 #include "event.hpp"
+#include "workspace.hpp"
 
 namespace deep_ep {
 
+// Outputs of one A2 internode notify + dispatch pass, every rank sends at most MAX_BATCH_SIZE tokens in it
+struct InternodeDispatchRound {
+    at::Tensor recv_x, dynamic_scales, expand_scales;  // [max(num_recv_tokens, 1)] rows
+    at::Tensor expand_idx, ep_rank_token_cnt, offset_inner, token_server_idx, count_outer;
+    at::Tensor recv_tokens_per_expert;  // [num_local_experts] on the CPU, not a prefix sum
+    int64_t num_recv_tokens;
+};
+
 struct Buffer {
     int64_t rank, rdma_rank, nvl_rank;
     int64_t num_ranks, num_rdma_ranks, num_nvl_ranks;
@@ -24,7 +33,11 @@ struct Buffer {
 
     int32_t round;
     int32_t per_round_tokens;
-    bool combine_enable_long_seq = false;  // Whether to enable the Combine Ant Migration feature
+    // Whether the combine reuses the dispatch rounds above instead of sizing its own rounds from the HCCL window
+    bool combine_enable_long_seq = false;
+    // Whether the rounds above were set through the environment, `fit_normal_rounds` only validates those
+    bool normal_rounds_from_env = false;
+    int64_t normal_total_tokens;
 
     bool low_latency_mode = false;
     at::Tensor notify_send_data;  // only for internode notify
@@ -34,16 +47,65 @@ struct Buffer {
     int64_t shared_expert_rank_num;
     int64_t shared_expert_num = 1;
     int64_t real_max_bs;
+    int64_t sync_free_max_bs;
+
+    // Expert-parallel load balancing: `topk_idx` holds logical experts, each served by one or more physical replicas
+    at::Tensor expert_location_map;   // [num_logical_experts, max_replicas], physical expert ids
+    at::Tensor expert_replica_count;  // [num_logical_experts], valid columns of each row of the map
+    at::Tensor expert_load_stats;     // [num_logical_experts], tokens routed to each logical expert by this rank
+    int64_t max_physical_expert_id = -1;
 
 private:
     std::string moe_all_to_all_group_name;
 
+    // Stream for communication kernels
+    c10_npu::NPUStream comm_stream;
+
     int device_id;
 
     HcclComm ep_comm;
 
     bool available = false;
 
+    // Persistent device memory for per-call metadata tensors of dispatch/combine
+    WorkspaceArena workspace;
+
+    // Expert output buffers the GEMM writes into before a zero-copy low-latency combine, handed out alternately
+    at::Tensor low_latency_combine_buffers[2];
+    int low_latency_combine_buffer_idx = 0;
+
+    c10_npu::NPUStream wait_on_comm_stream(const std::optional<EventHandle> &previous_event, bool async,
+                                           bool allocate_on_comm_stream);
+
+    std::optional<EventHandle> release_to_compute_stream(const c10_npu::NPUStream &compute_stream, bool async,
+                                                         const std::vector<std::optional<at::Tensor>> &inputs,
+                                                         const std::vector<std::optional<at::Tensor>> &outputs);
+
+    at::Tensor to_physical_expert_ids(const at::Tensor &topk_idx, int64_t num_experts, bool record_load);
+
+    int64_t get_low_latency_num_max_tokens(int64_t num_max_dispatch_tokens_per_rank, int64_t num_experts,
+                                           int64_t num_topk) const;
+
+    WindowLayout get_window_layout() const;
+
+    void check_window_size(int64_t required_bytes, const char *op_name) const;
+
+    void check_low_latency_window(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden, int64_t num_experts,
+                                  int64_t num_topk, int64_t num_scales, const char *op_name) const;
+
+    int get_internode_rounds() const;
+
+    InternodeDispatchRound internode_dispatch_round(const at::Tensor &x, const std::optional<at::Tensor> &x_scales,
+                                                    const at::Tensor &expert_ids, const at::Tensor &topk_weights,
+                                                    const at::Tensor &send_data,
+                                                    const at::Tensor &num_tokens_per_expert, int64_t num_experts,
+                                                    bool use_quant);
+
+    void internode_combine_round(const at::Tensor &x, const at::Tensor &expert_ids, const at::Tensor &expand_idx,
+                                 const at::Tensor &ep_send_counts, const at::Tensor &expand_scales,
+                                 const at::Tensor &offset_inner, const at::Tensor &offset_outer,
+                                 const at::Tensor &count_outer, const at::Tensor &combined_x);
+
 public:
     Buffer(int64_t rank, int64_t num_ranks, int64_t num_nvl_bytes, int64_t num_rdma_bytes, bool low_latency_mode,
            std::string moe_all_to_all_group_name);
@@ -62,8 +124,17 @@ public:
 
     torch::Tensor get_notify_send_data();
 
+    void set_expert_location_map(const at::Tensor &physical_map, const at::Tensor &replica_count);
+
+    void clear_expert_location_map();
+
+    at::Tensor get_expert_load_stats(bool reset);
+
+    std::tuple<int, int> fit_normal_rounds(int64_t hidden, int64_t num_topk);
+
     std::tuple<at::Tensor, std::optional<at::Tensor>, std::optional<at::Tensor>, std::optional<at::Tensor>,
-               std::vector<int>, at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor, std::optional<EventHandle>>
+               std::vector<int>, std::optional<at::Tensor>, at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor,
+               std::optional<EventHandle>>
     intranode_dispatch(const at::Tensor &x, const std::optional<at::Tensor> &x_scales,
                        const std::optional<at::Tensor> &topk_idx, const std::optional<at::Tensor> &topk_weights,
                        const std::optional<at::Tensor> &num_tokens_per_rank, const at::Tensor &is_token_in_rank,
@@ -88,14 +159,18 @@ public:
 
     void clean_low_latency_buffer(int num_max_dispatch_tokens_per_rank, int hidden, int num_experts);
 
+    at::Tensor get_next_low_latency_combine_buffer(int64_t num_max_dispatch_tokens_per_rank, int64_t hidden,
+                                                   int64_t num_experts, int64_t num_topk);
+
     std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandle>>
     intranode_combine(const torch::Tensor &x, const torch::Tensor &topk_idx,
                       const std::optional<torch::Tensor> &topk_weights, const torch::Tensor &src_idx,
-                      const torch::Tensor &send_head, const std::optional<at::Tensor> &combine_send_cost_stats);
+                      const torch::Tensor &send_head, const std::optional<at::Tensor> &combine_send_cost_stats,
+                      std::optional<EventHandle> &previous_event, bool async, bool allocate_on_comm_stream);
 
     std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<torch::Tensor>, std::optional<torch::Tensor>,
                std::vector<int>, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor,
-               torch::Tensor, std::optional<EventHandle>>
+               torch::Tensor, std::optional<torch::Tensor>, std::optional<torch::Tensor>, std::optional<EventHandle>>
     internode_dispatch(const torch::Tensor &x, const std::optional<torch::Tensor> &x_scales,
                        const std::optional<torch::Tensor> &topk_idx, const std::optional<torch::Tensor> &topk_weights,
                        const std::optional<torch::Tensor> &num_tokens_per_rank,
@@ -107,14 +182,16 @@ public:
     std::tuple<torch::Tensor, std::optional<torch::Tensor>, std::optional<EventHandle>> internode_combine(
         const torch::Tensor &x, const torch::Tensor &topk_idx, const std::optional<torch::Tensor> &topk_weights,
         const torch::Tensor &src_idx, const torch::Tensor &send_head, const torch::Tensor &offsetInner,
-        const torch::Tensor &offsetOuter, const torch::Tensor &countOuter, const torch::Tensor &expand_scales);
+        const torch::Tensor &offsetOuter, const torch::Tensor &countOuter, const torch::Tensor &expand_scales,
+        const std::optional<torch::Tensor> &recv_round_perm, const std::optional<torch::Tensor> &recv_round_offsets,
+        std::optional<EventHandle> &previous_event, bool async, bool allocate_on_comm_stream);
 
     std::tuple<at::Tensor, std::optional<at::Tensor>, at::Tensor, at::Tensor, at::Tensor, std::optional<EventHandle>,
                std::optional<std::function<void()>>>
     low_latency_dispatch(const at::Tensor &x, const at::Tensor &topk_idx,
                          const std::optional<at::Tensor> &cumulative_local_expert_recv_stats,
                          int64_t num_max_dispatch_tokens_per_rank, int64_t num_experts, bool use_fp8, bool round_scale,
-                         bool use_ue8m0, bool async, bool return_recv_hook);
+                         bool use_ue8m0, bool use_block_scales, bool async, bool return_recv_hook);
 
     std::tuple<at::Tensor, std::optional<EventHandle>, std::optional<std::function<void()>>> low_latency_combine(
         const at::Tensor &x, const at::Tensor &topk_idx, const at::Tensor &topk_weights, const at::Tensor &src_info,
@@ -130,8 +207,8 @@ public:
                                            int quant_mode);
 
     std::vector<at::Tensor> dispatch_ffn_combine(const at::Tensor &x, const at::Tensor &expert_ids,
-                                                 const at::Tensor &weight1, const at::Tensor &scale1,
-                                                 const at::Tensor &weight2, const at::Tensor &scale2,
+                                                 const at::Tensor &weight1, const c10::optional<at::Tensor> &scale1,
+                                                 const at::Tensor &weight2, const c10::optional<at::Tensor> &scale2,
                                                  const at::Tensor &expert_scales, int64_t max_output_size,
                                                  int64_t num_experts, int quant_mode) const;
 };
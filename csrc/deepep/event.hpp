@@ -1,16 +1,46 @@
 #pragma once
 #include <memory>
 
+#include "torch_npu/csrc/core/npu/NPUEvent.h"
+#include "torch_npu/csrc/core/npu/NPUStream.h"
+#include "exception.hpp"
+
 namespace deep_ep {
 
 struct EventHandle {
-    EventHandle() {}
+    std::shared_ptr<c10_npu::NPUEvent> event;
+
+    // Record on the current stream
+    EventHandle()
+    {
+        event = std::make_shared<c10_npu::NPUEvent>();
+        event->record(c10_npu::getCurrentNPUStream());
+    }
+
+    explicit EventHandle(const c10_npu::NPUStream &stream)
+    {
+        event = std::make_shared<c10_npu::NPUEvent>();
+        event->record(stream);
+    }
 
     EventHandle(const EventHandle &other) = default;
 
     void current_stream_wait() const
     {
-        return;
+        event->block(c10_npu::getCurrentNPUStream());
     }
 };
+
+// Make `s_0` wait for all the work queued on `s_1` so far
+inline void stream_wait(const c10_npu::NPUStream &s_0, const c10_npu::NPUStream &s_1)
+{
+    EP_HOST_ASSERT(s_0.id() != s_1.id());
+    EventHandle(s_1).event->block(s_0);
+}
+
+inline void stream_wait(const c10_npu::NPUStream &s, const EventHandle &event)
+{
+    event.event->block(s);
+}
+
 }  // namespace deep_ep
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <queue>
 #include <vector>
 #include <dlfcn.h>
@@ -73,6 +74,8 @@ constexpr uint64_t MAX_OUT_DTYPE_SIZE = 2UL;
 constexpr uint64_t UB_ALIGN = 32UL;
 constexpr int64_t DISPATCH_STATUS_MAX_SUPPORT_NUM = 1280UL;
 constexpr uint64_t INIT_TILINGKEY = 10000UL;
+constexpr uint64_t MIN_PER_ROUND_TOKENS = 32UL;
+constexpr uint64_t MAX_PER_ROUND_TOKENS = 8192UL;
 
 enum class CommQuantMode : int32_t { NON_QUANT = 0, INT12_QUANT = 1, INT8_QUANT = 2 };
 using CommQuantModeType = std::underlying_type<CommQuantMode>;
@@ -469,6 +472,36 @@ static bool CheckAttrs(gert::TilingContext *context, CamMoeCombineNormalTilingDa
     return true;
 }
 
+// perRoundTokens == 0 lets the tiling pick the round size: the largest multiple of MIN_PER_ROUND_TOKENS, capped at
+// MAX_PER_ROUND_TOKENS, whose two round buffers fit in the HCCL window and whose k status flags of UB_ALIGN bytes per
+// token fit in the status half of its round. The multi-round kernel splits its STATE_WIN_SIZE, which equals
+// COMBINE_STATE_WIN_OFFSET, into two such halves. Every rank derives the same rounds from the same window size, h, k
+// and realMaxBs, and a batch longer than one round pipelines its rounds.
+static bool SelectCombineRounds(CamMoeCombineNormalTilingData &tilingData, uint64_t maxWindowSize,
+                                uint64_t tokenNeedSizeCombine, const char *nodeName)
+{
+    uint64_t k = static_cast<uint64_t>(tilingData.camMoeCombineNormalInfo.k);
+    uint64_t reservedSize = COMBINE_STATE_WIN_OFFSET + NOTIFY_DISPATCH_WIN_OFFSET;
+    uint64_t halfWindowSize = maxWindowSize / DOUBLE_DATA_BUFFER;
+    OP_TILING_CHECK(halfWindowSize <= reservedSize,
+                    OP_LOGE(nodeName, "HCCL_BUFFSIZE is too SMALL, HCCL_BUFFSIZE=%luMB, needs more than %luMB.",
+                            maxWindowSize / MB_SIZE, reservedSize * DOUBLE_DATA_BUFFER / MB_SIZE),
+                    return false);
+    uint64_t fitTokens = (halfWindowSize - reservedSize) / (k * tokenNeedSizeCombine * DOUBLE_DATA_BUFFER);
+    uint64_t stateTokens = COMBINE_STATE_WIN_OFFSET / DOUBLE_DATA_BUFFER / (k * UB_ALIGN);
+    uint64_t perRoundTokens = std::min({fitTokens, stateTokens, MAX_PER_ROUND_TOKENS}) / MIN_PER_ROUND_TOKENS *
+                              MIN_PER_ROUND_TOKENS;
+    OP_TILING_CHECK(perRoundTokens == 0UL,
+                    OP_LOGE(nodeName, "HCCL_BUFFSIZE=%luMB cannot hold %lu tokens per round, k = %lu.",
+                            maxWindowSize / MB_SIZE, MIN_PER_ROUND_TOKENS, k),
+                    return false);
+    uint64_t realMaxBs = static_cast<uint64_t>(tilingData.camMoeCombineNormalInfo.realMaxBs);
+    tilingData.camMoeCombineNormalInfo.perRoundTokens = static_cast<uint32_t>(perRoundTokens);
+    tilingData.camMoeCombineNormalInfo.maxRound =
+        static_cast<uint32_t>((realMaxBs + perRoundTokens - 1) / perRoundTokens);
+    return true;
+}
+
 static ge::graphStatus TilingCheckCamMoeCombineNormal(gert::TilingContext *context, const char *nodeName,
                                                       const bool isEnableDiagnose)
 {
@@ -550,13 +583,25 @@ static ge::graphStatus CamMoeCombineNormalA3TilingFuncImpl(gert::TilingContext *
     uint64_t h = static_cast<uint64_t>(tilingData->camMoeCombineNormalInfo.h);
     uint64_t epWorldSize = static_cast<uint64_t>(tilingData->camMoeCombineNormalInfo.epWorldSize);
     uint64_t k = static_cast<uint64_t>(tilingData->camMoeCombineNormalInfo.k);
+    // combine数据区 token首地址对齐512
+    uint64_t tokenNeedSizeCombine = ((h * MAX_OUT_DTYPE_SIZE + WIN_ADDR_ALIGN - 1UL) / WIN_ADDR_ALIGN) * WIN_ADDR_ALIGN;
+    if (tilingData->camMoeCombineNormalInfo.perRoundTokens == 0U) {
+        OP_TILING_CHECK(!SelectCombineRounds(*tilingData, maxWindowSize, tokenNeedSizeCombine, nodeName),
+                        OP_LOGE(nodeName, "select combine rounds failed."), return ge::GRAPH_FAILED);
+    }
     uint64_t perRoundTokens = tilingData->camMoeCombineNormalInfo.perRoundTokens;
+    OP_TILING_CHECK(perRoundTokens == 0UL, OP_LOGE(nodeName, "perRoundTokens should not be 0."),
+                    return ge::GRAPH_FAILED);
     uint64_t realMaxBs = tilingData->camMoeCombineNormalInfo.realMaxBs;
     uint64_t realBs = std::min(perRoundTokens, realMaxBs);
     uint32_t maxRound = tilingData->camMoeCombineNormalInfo.maxRound;
-    // combine数据区 token首地址对齐512
-    uint64_t tokenNeedSizeCombine = ((h * MAX_OUT_DTYPE_SIZE + WIN_ADDR_ALIGN - 1UL) / WIN_ADDR_ALIGN) * WIN_ADDR_ALIGN;
-    tokenNeedSizeCombine = maxRound > 1 ? maxRound * 2 : maxRound;
+    // A single round may use the whole status window, multiple rounds alternate between its halves
+    uint64_t stateWinSize = maxRound > 1 ? COMBINE_STATE_WIN_OFFSET / DOUBLE_DATA_BUFFER : COMBINE_STATE_WIN_OFFSET;
+    OP_TILING_CHECK(realBs * k * UB_ALIGN > stateWinSize,
+                    OP_LOGE(nodeName, "%lu tokens per round with k = %lu do not fit the %luMB round status window.",
+                            realBs, k, stateWinSize / MB_SIZE),
+                    return ge::GRAPH_FAILED);
+    tokenNeedSizeCombine = maxRound > 1 ? tokenNeedSizeCombine * 2 : tokenNeedSizeCombine;
     uint64_t actualSize = (realBs * k * tokenNeedSizeCombine + COMBINE_STATE_WIN_OFFSET + NOTIFY_DISPATCH_WIN_OFFSET) *
                           DOUBLE_DATA_BUFFER;
     OP_TILING_CHECK(
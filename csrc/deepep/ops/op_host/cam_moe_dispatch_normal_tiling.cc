@@ -96,6 +96,7 @@ static void PrintTilingDataInfo(const char *nodeName, CamMoeDispatchNormalTiling
     OP_LOGD(nodeName, "quantMode is %u.", tilingData.camMoeDispatchNormalInfo.quantMode);
     OP_LOGD(nodeName, "realMaxBs is %u.", tilingData.camMoeDispatchNormalInfo.realMaxBs);
     OP_LOGD(nodeName, "globalBs is %u.", tilingData.camMoeDispatchNormalInfo.globalBs);
+    OP_LOGD(nodeName, "recvTokenCap is %u.", tilingData.camMoeDispatchNormalInfo.recvTokenCap);
     OP_LOGD(nodeName, "bs is %u.", tilingData.camMoeDispatchNormalInfo.bs);
     OP_LOGD(nodeName, "k is %u.", tilingData.camMoeDispatchNormalInfo.k);
     OP_LOGD(nodeName, "h is %u.", tilingData.camMoeDispatchNormalInfo.h);
@@ -454,6 +455,9 @@ static ge::graphStatus CheckTensorShape(gert::TilingContext *context, const char
                             "xShape's dim1 is %ld, expandX's dim1 is %ld.",
                             xDim1, expandXDim1),
                     return ge::GRAPH_FAILED);
+    OP_TILING_CHECK(expandXDim0 <= 0, OP_LOGE(nodeName, "expandX's dim0 should be positive, but got %ld.", expandXDim0),
+                    return ge::GRAPH_FAILED);
+    tilingData.camMoeDispatchNormalInfo.recvTokenCap = static_cast<uint32_t>(expandXDim0);
 
     // 校验dynamicScales的维度
     if (quantMode != NO_SCALES) {
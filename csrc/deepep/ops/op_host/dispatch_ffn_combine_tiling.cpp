@@ -27,6 +27,7 @@ using namespace AscendC;
 using namespace ge;
 
 #define HCCL_BUFFSIZE "HCCL_BUFFSIZE"
+#define DEEPEP_DISABLE_COUNT_SORT "DEEPEP_DISABLE_COUNT_SORT"
 
 namespace {
 // 1. Constant definitions
@@ -40,6 +41,7 @@ constexpr uint32_t ATTR_WEIGHT_NZ = 5;
 constexpr uint64_t INIT_TILINGKEY = 1000000;
 constexpr uint64_t TILINGKEY_TRANS_B = 1U;
 constexpr uint64_t TILINGKEY_WEIGHT_NZ = 10;
+constexpr uint64_t TILINGKEY_UNQUANT = 100;
 constexpr uint32_t X_INDEX = 0;
 constexpr uint32_t WEIGHT_INDEX = 1;
 constexpr uint32_t WEIGHT2_INDEX = 2;
@@ -83,6 +85,13 @@ static uint64_t GetMaxWindowSize()
     return maxWindowSize;
 }
 
+// Setting DEEPEP_DISABLE_COUNT_SORT to a non-zero value routes tokens with the merge sort even for <= 512 experts
+static bool IsCountSortDisabled()
+{
+    const char *env = getenv(DEEPEP_DISABLE_COUNT_SORT);
+    return env != nullptr && std::string(env) != "0";
+}
+
 // Parse and validate rankId, group, worldSize, and isTransB attributes
 static ge::graphStatus DispatchFFNCombineCheckAttrAndSetTiling(gert::TilingContext *context,
                                                                DispatchFFNCombineInfo &info)
@@ -226,10 +235,21 @@ static ge::graphStatus DispatchFFNCombineTilingFuncImpl(gert::TilingContext *con
     blockDim = ascendcPlatform.CalcTschBlockDim(aivNum, aicNum, aivNum);
     context->SetBlockDim(blockDim);
 
-    // 3. set tilingKey
+    // 3. set tilingKey, fp16/bf16 weights select the unquantized kernel
+    auto xDesc = context->GetInputDesc(X_INDEX);
+    auto weightDesc = context->GetInputDesc(WEIGHT_INDEX);
+    OP_TILING_CHECK(xDesc == nullptr || weightDesc == nullptr, OP_LOGE(nodeName, "input desc is nullptr."),
+                    return ge::GRAPH_FAILED);
+    bool isQuant = weightDesc->GetDataType() == ge::DT_INT8;
+    OP_TILING_CHECK(!isQuant && weightDesc->GetDataType() != xDesc->GetDataType(),
+                    OP_LOGE(nodeName, "weight dtype %d must be int8 or match x dtype %d.",
+                            static_cast<ge::DataType>(weightDesc->GetDataType()),
+                            static_cast<ge::DataType>(xDesc->GetDataType())),
+                    return ge::GRAPH_FAILED);
     uint64_t tilingKey = INIT_TILINGKEY;
     tilingKey += info.isTransposeB ? TILINGKEY_TRANS_B : 0;
     tilingKey += info.isWeightNz ? TILINGKEY_WEIGHT_NZ : 0;
+    tilingKey += isQuant ? 0 : TILINGKEY_UNQUANT;
     context->SetTilingKey(tilingKey);
 
     OP_LOGD(K_INNER_DEBUG, "tilingKey=%d", tilingKey);
@@ -244,8 +264,9 @@ static ge::graphStatus DispatchFFNCombineTilingFuncImpl(gert::TilingContext *con
     int64_t dropPadMode = 0;
     int64_t expertTokensCountOrCumsumFlag = 2;
     bool expertTokensBeforeCapacityFlag = false;
-    int64_t quantMode = 1;
+    int64_t quantMode = isQuant ? QUANT_MODE_DYNAMIC : QUANT_MODE_NONE;
     uint32_t aivNumInitRouting = 2 * BLOCK_NUM;
+    moeInitRoutingQuantV2TilingBase.enableCountSort = !IsCountSortDisabled();
     moeInitRoutingQuantV2TilingBase.DoTiling(info.M, info.K, info.topK, expertCapacity, expertNum, activeNum,
                                              dropPadMode, expertTokensCountOrCumsumFlag, expertTokensBeforeCapacityFlag,
                                              inuptXDtypeSize, quantMode, scaleDim0, aivNumInitRouting, ubSize);
@@ -268,13 +289,15 @@ static ge::graphStatus DispatchFFNCombineTilingFuncImpl(gert::TilingContext *con
     tilingData->cocTiling.initRoutingQuantTilingKey = initRoutingQuantTilingKey;
 
     uint64_t maxWindowSize = GetMaxWindowSize();
-    uint64_t actualSize = static_cast<uint64_t>(info.M) * info.topK * info.K * sizeof(int8_t) * 3 + 10 * MB_SIZE;
+    // Dispatched activations keep the input dtype when unquantized
+    uint64_t aDtypeSize = isQuant ? sizeof(int8_t) : sizeof(int16_t);
+    uint64_t actualSize = static_cast<uint64_t>(info.M) * info.topK * info.K * aDtypeSize * 3 + 10 * MB_SIZE;
     OP_TILING_CHECK(
         (actualSize > maxWindowSize),
         OP_LOGE(nodeName,
                 "HCCL_BUFFSIZE is too SMALL, m = %lu, k = %lu, topK = %lu"
-                " expected HCCL_BUFFSIZE is ((m * k * topK * sizeof(int8_t)) * 3 + 3MB)= %luMB, HCCL_BUFFSIZE=%luMB.",
-                info.M, info.K, info.topK, (actualSize + MB_SIZE - 1) / MB_SIZE, maxWindowSize / MB_SIZE),
+                " expected HCCL_BUFFSIZE is ((m * k * topK * %lu) * 3 + 10MB)= %luMB, HCCL_BUFFSIZE=%luMB.",
+                info.M, info.K, info.topK, aDtypeSize, (actualSize + MB_SIZE - 1) / MB_SIZE, maxWindowSize / MB_SIZE),
         return ge::GRAPH_FAILED);
 
     // 4. workspace
@@ -287,8 +310,8 @@ static ge::graphStatus DispatchFFNCombineTilingFuncImpl(gert::TilingContext *con
     uint64_t cocWorkspace = (info.M + 256 - 1) / 256 * 256 * info.topK * sizeof(int32_t) +
                             info.worldSize * info.worldSize * info.expertPerRank * sizeof(int32_t) * 3 +
                             info.maxOutputSize * sizeof(float) * 2 + info.maxOutputSize * info.N * sizeof(int16_t) +
-                            info.maxOutputSize * n2 * sizeof(int16_t) + info.maxOutputSize * info.K * sizeof(int8_t) +
-                            info.maxOutputSize * k2 * sizeof(int8_t) + info.worldSize * sizeof(int32_t) * 16 +
+                            info.maxOutputSize * n2 * sizeof(int16_t) + info.maxOutputSize * info.K * aDtypeSize +
+                            info.maxOutputSize * k2 * aDtypeSize + info.worldSize * sizeof(int32_t) * 16 +
                             (info.expertPerRank + info.worldSize) * sizeof(int32_t) * 16;
 
     workSpaces[0] = SYSTEM_NEED_WORKSPACE + std::max(cocWorkspace, initRoutingWorkspace);
@@ -6,6 +6,7 @@
  * Note:
  * History: 2025-07-19 create FusedDeepMoe tiling function implementation file
  */
+#include <algorithm>
 #include <cstdio>
 #include <cstdint>
 #include <string>
@@ -83,9 +84,14 @@ constexpr uint32_t ATTR_QUANT_MODE_INDEX = 6;
 constexpr uint32_t ATTR_GLOBAL_BS_INDEX = 7;
 
 constexpr uint32_t MIN_BATCH_SIZE = 0;
-constexpr uint32_t MAX_BATCH_SIZE = 256;
+constexpr uint32_t MAX_BATCH_SIZE = 4096;
+constexpr uint32_t MAX_ROUND_BATCH_SIZE = 256;
+// bs * k per round. The bs * k UB tables of dispatch/combine/gmm1 stay below the old 256 * 12 footprint, so top-k 16
+// fits as long as a round holds at most this many pairs
+constexpr uint32_t MAX_ROUND_TOKEN_TOPK = 2048;
+// gmm1 sends the expert status with a fixed 512B stride, more than 512 experts would reach its self state at 256KB
 constexpr uint32_t MAX_MOE_EXERT_NUM = 512;
-constexpr uint32_t SUPPORT_TOP_K = 12;
+constexpr uint32_t SUPPORT_TOP_K = 16;
 constexpr uint32_t TWO_DIMS = 2;
 constexpr uint32_t MIN_TOKEN_LENGTH = 512;
 constexpr uint32_t MAX_TOKEN_LENGTH = 7168;
@@ -187,6 +193,10 @@ static ge::graphStatus CheckData(const char *nodeName, FusedDeepMoeTilingData &t
         OPS_ERR_IF(globalBatchSize < 0, OPS_LOG_E(nodeName, "globalBatchSize must >= 0."), return ge::GRAPH_FAILED);
         OPS_ERR_IF(globalBatchSize % epRankSize > 0,
                    OPS_LOG_E(nodeName, "globalBatchSize must be divisible by epRankSize."), return ge::GRAPH_FAILED);
+        OPS_ERR_IF(batchSize > globalBatchSize / epRankSize,
+                   OPS_LOG_E(nodeName, "batchSize(bs) must <= globalBatchSize / epRankSize(%u).",
+                             globalBatchSize / epRankSize),
+                   return ge::GRAPH_FAILED);
     }
     uint32_t moeExpertNumPerRank = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.moeExpertNumPerRank;
     uint32_t recvAivNum = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.aivNum / 2;
@@ -256,6 +266,42 @@ static void SetHcommCfg(const gert::TilingContext *context, FusedDeepMoeTilingDa
     mc2CcTilingConfig.GetTiling(tiling->mc2CcTiling);
 }
 
+static ge::graphStatus SetRoundInfo(const char *nodeName, FusedDeepMoeTilingData &tilingData, uint64_t maxWindowSize)
+{
+    uint64_t epRankSize = static_cast<uint64_t>(tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.epRankSize);
+    uint64_t maxBs = static_cast<uint64_t>(tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.globalBs) / epRankSize;
+    uint64_t moeExpertNumPerRank =
+        static_cast<uint64_t>(tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.moeExpertNumPerRank);
+    uint64_t tokenLength = static_cast<uint64_t>(tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.h);
+    uint64_t topK = std::max(tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.k, 1U);
+
+    // every round owns the whole window, so the round size is whatever one token per rank per expert leaves room for
+    uint64_t tokenWinSize = epRankSize * moeExpertNumPerRank * tokenLength * TOKEN_DTYPE_BYTE_SIZE * DOUBLE_BUFFER;
+    uint64_t winRoundBs = maxWindowSize / tokenWinSize;
+    OPS_ERR_IF((winRoundBs == 0),
+               OPS_LOG_E(nodeName,
+                         "HCCL_BUFFSIZE is too SMALL, epRankSize = %lu, moeExpertNumPerRank = %lu, tokenLength = %lu, "
+                         " NEEDED_HCCL_BUFFSIZE(epRankSize * moeExpertNumPerRank * tokenLength * "
+                         " TOKEN_DTYPE_BYTE_SIZE * DOUBLE_BUFFER) = %luMB, HCCL_BUFFSIZE=%luMB.",
+                         epRankSize, moeExpertNumPerRank, tokenLength, tokenWinSize / MB_SIZE + 1UL,
+                         maxWindowSize / MB_SIZE),
+               return ge::GRAPH_FAILED);
+    uint64_t roundBs = std::min({winRoundBs, static_cast<uint64_t>(MAX_ROUND_BATCH_SIZE),
+                                 static_cast<uint64_t>(MAX_ROUND_TOKEN_TOPK) / topK});
+    uint64_t roundNum = 1;
+    if (maxBs > roundBs) {
+        roundNum = (maxBs + roundBs - 1) / roundBs;
+        // spread the tokens evenly so the last round is not a short tail
+        roundBs = (maxBs + roundNum - 1) / roundNum;
+    } else {
+        roundBs = maxBs;
+    }
+    tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.roundNum = static_cast<uint32_t>(roundNum);
+    tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.roundBs = static_cast<uint32_t>(roundBs);
+    OPS_LOG_I(nodeName, "maxBs = %lu, roundBs = %lu, roundNum = %lu", maxBs, roundBs, roundNum);
+    return ge::GRAPH_SUCCESS;
+}
+
 static ge::graphStatus SetWorkSpace(gert::TilingContext *context, const char *nodeName,
                                     FusedDeepMoeTilingData &tilingData)
 {
@@ -265,9 +311,7 @@ static ge::graphStatus SetWorkSpace(gert::TilingContext *context, const char *no
     uint32_t epRankSize = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.epRankSize;
     uint32_t epRankId = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.epRankId;
     uint32_t sharedExpertRankNum = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.sharedExpertRankNum;
-    uint32_t batchSize = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.bs;
-    uint32_t globalBs = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.globalBs;
-    uint32_t maxBatchSize = globalBs / epRankSize;
+    uint32_t maxBatchSize = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.roundBs;
     uint32_t topK = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.k;
     uint32_t moeExpertNumPerRank = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.moeExpertNumPerRank;
     uint32_t h = tilingData.disGmmDeqSwigluQuantGmmDeqComInfo.h;
@@ -285,14 +329,15 @@ static ge::graphStatus SetWorkSpace(gert::TilingContext *context, const char *no
         CeilUp(aicNum * L1_TILE_BYTE_SIZE * CUBE_WORKSPACE_STAGE * sizeof(int32_t), GM_ALIGN_SIZE);
     size_t swigluOutSize = CeilUp(maxTokenNum * gmm2HLen * sizeof(float), GM_ALIGN_SIZE);
     size_t groupListSize = CeilUp(moeExpertNumPerRank * sizeof(int64_t), GM_ALIGN_SIZE);
-    size_t expandIdxSize = CeilUp(batchSize * topK * sizeof(int32_t), GM_ALIGN_SIZE);
+    size_t expandIdxSize = CeilUp(maxBatchSize * topK * sizeof(int32_t), GM_ALIGN_SIZE);
     size_t epSendCountSize = CeilUp(epRankSize * moeExpertNumPerRank * sizeof(int32_t), GM_ALIGN_SIZE);
     size_t x1TokenSize = CeilUp(maxTokenNum * h * sizeof(int8_t), GM_ALIGN_SIZE);
     size_t x1ScaleSize = CeilUp(maxTokenNum * sizeof(float), GM_ALIGN_SIZE);
     size_t gmm2DepOutSize = CeilUp(maxTokenNum * h * TOKEN_DTYPE_BYTE_SIZE, GM_ALIGN_SIZE);
     size_t resveredSize = CeilUp(RESERVED_WORKSPACE_SIZE, GM_ALIGN_SIZE);
+    size_t roundRecvCountSize = epSendCountSize;
     size_t usrSize = x2TokenSize + x2ScaleSize + CVSwapBufferSize + swigluOutSize + groupListSize + expandIdxSize +
-                     epSendCountSize + x1TokenSize + x1ScaleSize + gmm2DepOutSize + resveredSize;
+                     epSendCountSize + x1TokenSize + x1ScaleSize + gmm2DepOutSize + resveredSize + roundRecvCountSize;
 
     workSpaces[0] = SYSTEM_NEED_WORKSPACE + usrSize;
     return ge::GRAPH_SUCCESS;
@@ -337,28 +382,13 @@ static ge::graphStatus FusedDeepMoeTilingFuncImpl(gert::TilingContext *context)
     tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.aicNum = aicNum;
     tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.aivNum = aivNum;
 
-    uint64_t maxWindowSize = Mc2TilingUtils::GetMaxWindowSize(nodeName);
-    uint64_t epRankSize = static_cast<uint64_t>(tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.epRankSize);
-    uint64_t maxBs = static_cast<uint64_t>(tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.globalBs) / epRankSize;
-    uint64_t moeExpertNumPerRank =
-        static_cast<uint64_t>(tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.moeExpertNumPerRank);
-    uint64_t tokenLength = static_cast<uint64_t>(tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.h);
-    uint64_t actualSize =
-        epRankSize * maxBs * moeExpertNumPerRank * tokenLength * TOKEN_DTYPE_BYTE_SIZE * DOUBLE_BUFFER;
-    OPS_ERR_IF((actualSize > maxWindowSize),
-               OPS_LOG_E(nodeName,
-                         "HCCL_BUFFSIZE is too SMALL, epRankSize = %lu, maxBs = %lu, moeExpertNumPerRank = %lu, "
-                         " tokenLength = %lu, "
-                         " NEEDED_HCCL_BUFFSIZE(epRankSize * maxBs * moeExpertNumPerRank * tokenLength * "
-                         " TOKEN_DTYPE_BYTE_SIZE * DOUBLE_BUFFER) = %luMB, HCCL_BUFFSIZE=%luMB.",
-                         epRankSize, maxBs, moeExpertNumPerRank, tokenLength, actualSize / MB_SIZE + 1UL,
-                         maxWindowSize / MB_SIZE),
-               return ge::GRAPH_FAILED);
-
 #ifdef ENABLE_TILING_CHECK
     OPS_ERR_IF(CheckData(nodeName, *tilingData) != ge::GRAPH_SUCCESS, OPS_LOG_E(nodeName, "CheckData failed."),
                return ge::GRAPH_FAILED);
 #endif
+    uint64_t maxWindowSize = Mc2TilingUtils::GetMaxWindowSize(nodeName);
+    OPS_ERR_IF(SetRoundInfo(nodeName, *tilingData, maxWindowSize) != ge::GRAPH_SUCCESS,
+               OPS_LOG_E(nodeName, "Tiling set round info failed."), return ge::GRAPH_FAILED);
     OPS_ERR_IF(SetWorkSpace(context, nodeName, *tilingData) != ge::GRAPH_SUCCESS,
                OPS_LOG_E(nodeName, "Tiling set workspace failed."), return ge::GRAPH_FAILED);
     SetHcommCfg(context, tilingData, groupEp);
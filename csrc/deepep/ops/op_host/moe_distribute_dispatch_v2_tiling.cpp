@@ -72,6 +72,8 @@ constexpr uint32_t OP_TYPE_ALL_TO_ALL = 8;
 constexpr uint32_t NO_SCALES = 0;
 constexpr uint32_t STATIC_SCALES = 1;
 constexpr uint32_t DYNAMIC_SCALES = 2;
+constexpr uint32_t PER_BLOCK_SCALES = 3;       // 每token按128通道分块动态量化
+constexpr uint32_t PER_BLOCK_POW2_SCALES = 4;  // 分块动态量化，scale向上取整到2的幂(UE8M0可无损表示)
 constexpr uint32_t OP_TYPE_ALL_GATHER = 6;
 
 constexpr uint32_t UNQUANT_MODE = 0;
@@ -104,7 +106,7 @@ constexpr uint64_t MB_SIZE = 1024UL * 1024UL;
 constexpr uint64_t TRIPLE = 3;
 constexpr uint64_t WIN_ADDR_ALIGN = 512UL;
 constexpr uint64_t FULL_MESH_DATA_ALIGN = 480UL;
-constexpr uint64_t SCALE_EXPAND_IDX_BUFFER = 44UL;  // scale32B + 3*4expandIdx
+constexpr uint64_t QUANT_BLOCK_SIZE = 128UL;
 constexpr uint64_t DOUBLE_DATA_BUFFER = 2UL;
 constexpr uint64_t MAX_OUT_DTYPE_SIZE = 2UL;
 constexpr uint64_t UB_ALIGN = 32UL;
@@ -210,13 +212,15 @@ static bool CheckTensorDim(const gert::TilingContext *context, const char *nodeN
     OP_LOGD(nodeName, "expandX dim0 = %ld", expandXStorageShape->GetStorageShape().GetDim(0));
     OP_LOGD(nodeName, "expandX dim1 = %ld", expandXStorageShape->GetStorageShape().GetDim(1));
 
-    if (quantMode == DYNAMIC_SCALES) {
+    if (quantMode >= DYNAMIC_SCALES) {
         const gert::StorageShape *dynamicScalesStorageShape = context->GetOutputShape(OUTPUT_DYNAMIC_SCALES_INDEX);
         OP_TILING_CHECK(dynamicScalesStorageShape == nullptr, OP_LOGE(nodeName, "dynamicScalesShape is null."),
                         return false);
-        OP_TILING_CHECK(dynamicScalesStorageShape->GetStorageShape().GetDimNum() != DYNAMIC_SCALE_DIM_NUM,
+        // 分块量化时每个token输出h/128个scale
+        uint32_t dynamicScaleDimNum = (quantMode == DYNAMIC_SCALES) ? DYNAMIC_SCALE_DIM_NUM : TWO_DIMS;
+        OP_TILING_CHECK(dynamicScalesStorageShape->GetStorageShape().GetDimNum() != dynamicScaleDimNum,
                         OP_LOGE(nodeName, "dynamicScalesShape dims must be %u, but current dim num is %lu.",
-                                DYNAMIC_SCALE_DIM_NUM, dynamicScalesStorageShape->GetStorageShape().GetDimNum()),
+                                dynamicScaleDimNum, dynamicScalesStorageShape->GetStorageShape().GetDimNum()),
                         return false);
         OP_LOGD(nodeName, "dynamicScales dim0 = %ld", dynamicScalesStorageShape->GetStorageShape().GetDim(0));
     }
@@ -317,7 +321,7 @@ static bool CheckTensorDataType(const gert::TilingContext *context, const char *
             return false);
     }
 
-    if (quantMode == DYNAMIC_SCALES) {
+    if (quantMode >= DYNAMIC_SCALES) {
         auto dynamicScalesDesc = context->GetOutputDesc(OUTPUT_DYNAMIC_SCALES_INDEX);
         OP_TILING_CHECK(dynamicScalesDesc == nullptr, OP_LOGE(nodeName, "dynamicScalesDesc is null."), return false);
         OP_TILING_CHECK(dynamicScalesDesc->GetDataType() != ge::DT_FLOAT,
@@ -401,7 +405,7 @@ static bool CheckTensorFormat(const gert::TilingContext *context, const char *no
         static_cast<ge::Format>(ge::GetPrimaryFormat(expandXDesc->GetStorageFormat())) == ge::FORMAT_FRACTAL_NZ,
         OP_LOGE(nodeName, "expandX format is invalid."), return false);
 
-    if (quantMode == DYNAMIC_SCALES) {
+    if (quantMode >= DYNAMIC_SCALES) {
         auto dynamicScalesDesc = context->GetOutputDesc(OUTPUT_DYNAMIC_SCALES_INDEX);
         OP_TILING_CHECK(dynamicScalesDesc == nullptr, OP_LOGE(nodeName, "dynamicScalesDesc is null."), return false);
         OP_TILING_CHECK(static_cast<ge::Format>(ge::GetPrimaryFormat(dynamicScalesDesc->GetStorageFormat())) ==
@@ -536,8 +540,9 @@ static ge::graphStatus CheckAndSetExpertInfo(const gert::TilingContext *context,
                             MOE_EXPERT_MAX_NUM, moeExpertNum),
                     return ge::GRAPH_FAILED);
     OP_TILING_CHECK(
-        (*quantModePtr < static_cast<int64_t>(NO_SCALES)) || (*quantModePtr > static_cast<int64_t>(DYNAMIC_SCALES)),
-        OP_LOGE(nodeName, "quantMode is invalid, only support [0, %u], but got quantMode=%ld.", DYNAMIC_SCALES,
+        (*quantModePtr < static_cast<int64_t>(NO_SCALES)) ||
+            (*quantModePtr > static_cast<int64_t>(PER_BLOCK_POW2_SCALES)),
+        OP_LOGE(nodeName, "quantMode is invalid, only support [0, %u], but got quantMode=%ld.", PER_BLOCK_POW2_SCALES,
                 *quantModePtr),
         return ge::GRAPH_FAILED);
     OP_TILING_CHECK((*expertTokenNumsTypePtr != 0) && (*expertTokenNumsTypePtr != 1),
@@ -822,6 +827,10 @@ static ge::graphStatus CheckTensorShape(const gert::TilingContext *context, cons
     OP_TILING_CHECK((xDim1 < H_MIN) || (xDim1 > H_MAX),
                     OP_LOGE(nodeName, "xShape dims1(H) should be in [%ld, %ld], but got %ld.", H_MIN, H_MAX, xDim1),
                     return ge::GRAPH_FAILED);  // 32字节对齐
+    OP_TILING_CHECK((quantMode > DYNAMIC_SCALES) && (xDim1 % static_cast<int64_t>(QUANT_BLOCK_SIZE) != 0),
+                    OP_LOGE(nodeName, "xShape dims1(H) should be divisible by %lu when quantMode is %u, but got %ld.",
+                            QUANT_BLOCK_SIZE, quantMode, xDim1),
+                    return ge::GRAPH_FAILED);
     tilingData.moeDistributeDispatchV2Info.h = static_cast<uint32_t>(xDim1);
 
     // 校验expert_id的维度并设k
@@ -923,6 +932,15 @@ static ge::graphStatus CheckTensorShape(const gert::TilingContext *context, cons
                 "A*tpWorldSize is %ld.",
                 dynamicScalesDim0, A * tpWorldSize),
             return ge::GRAPH_FAILED);
+        if (quantMode > DYNAMIC_SCALES) {
+            const int64_t dynamicScalesDim1 = dynamicScalesStorageShape->GetStorageShape().GetDim(1);
+            OP_TILING_CHECK(dynamicScalesDim1 != xDim1 / static_cast<int64_t>(QUANT_BLOCK_SIZE),
+                            OP_LOGE(nodeName,
+                                    "dynamicScales's dim1 should be equal to H / %lu, "
+                                    "dynamicScales's dim1 is %ld, H is %ld.",
+                                    QUANT_BLOCK_SIZE, dynamicScalesDim1, xDim1),
+                            return ge::GRAPH_FAILED);
+        }
     }
 
     // 校验assistInfo的维度
@@ -1011,7 +1029,8 @@ static ge::graphStatus TilingCheckMoeDistributeDispatch(gert::TilingContext *con
 static void CalTilingKey(uint64_t &tilingKey, const bool isScales, const uint32_t quantMode, const uint32_t tpWorldSize,
                          const bool isSetCommAlg)
 {
-    tilingKey += static_cast<uint64_t>(quantMode);
+    // 分块量化复用动态量化模板，kernel内按tiling中的quantMode区分
+    tilingKey += static_cast<uint64_t>(std::min(quantMode, DYNAMIC_SCALES));
     if (isScales) {
         tilingKey += static_cast<uint64_t>(TILINGKEY_SCALES);
     }
@@ -1058,11 +1077,14 @@ static ge::graphStatus CheckWinSize(MoeDistributeDispatchV2TilingData &tilingDat
     uint64_t k = static_cast<uint64_t>(tilingData.moeDistributeDispatchV2Info.k);
     uint64_t epWorldSize = static_cast<uint64_t>(tilingData.moeDistributeDispatchV2Info.epWorldSize);
     uint64_t maxBs = static_cast<uint64_t>(tilingData.moeDistributeDispatchV2Info.globalBs) / epWorldSize;
+    uint32_t quantMode = tilingData.moeDistributeDispatchV2Info.quantMode;
+    uint64_t scaleNum = (quantMode > DYNAMIC_SCALES) ? h / QUANT_BLOCK_SIZE : 1UL;  // 分块量化每token h/128个scale
     // combine数据区 token首地址对齐512
     uint64_t tokenNeedSizeCombine = ((h * MAX_OUT_DTYPE_SIZE + WIN_ADDR_ALIGN - 1UL) / WIN_ADDR_ALIGN) * WIN_ADDR_ALIGN;
-    // dispatch数据区 token首对齐512，有效token长度h_align_32b + scale(32b) + 三元组(3*4b)
-    uint64_t tokenActualLen =
-        ((h * MAX_OUT_DTYPE_SIZE + UB_ALIGN - 1UL) / UB_ALIGN) * UB_ALIGN + SCALE_EXPAND_IDX_BUFFER;
+    // dispatch数据区 token首对齐512，有效token长度h_align_32b + scale_align_32b + 三元组(3*4b)
+    uint64_t tokenActualLen = ((h * MAX_OUT_DTYPE_SIZE + UB_ALIGN - 1UL) / UB_ALIGN) * UB_ALIGN +
+                              ((scaleNum * sizeof(float) + UB_ALIGN - 1UL) / UB_ALIGN) * UB_ALIGN +
+                              TRIPLE * sizeof(int32_t);
     uint64_t tokenNeedSizeDispatch = 0;
     if (isSetCommAlg) {
         tokenNeedSizeDispatch = ((tokenActualLen + FULL_MESH_DATA_ALIGN - 1UL) / FULL_MESH_DATA_ALIGN) * WIN_ADDR_ALIGN;
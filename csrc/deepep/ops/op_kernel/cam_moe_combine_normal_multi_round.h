@@ -78,9 +78,10 @@ private:
         return (GM_ADDR)(bufferAddr + winDataSizeOffset_ + Moe::NOTIFY_DISPATCH_BUFF_OFFSET);
     }
 
-    __aicore__ GM_ADDR GetBufferAddrByRankId(const int32_t rankId)
+    // Round r uses data buffer and token states r % 2, so round r+1 can be put while round r is received
+    __aicore__ GM_ADDR GetBufferAddrByRankId(const int32_t rankId, const uint32_t roundIdx)
     {
-        return GetStateAddrByRankId(rankId) + STATE_WIN_SIZE + roundMagic_ * combineDataBuffSize_;
+        return GetStateAddrByRankId(rankId) + STATE_WIN_SIZE + (roundIdx & 1U) * combineDataBuffSize_;
     }
 
     __aicore__ inline GM_ADDR GetRoundStateAddrByRankId(const int32_t rankId)
@@ -128,7 +129,8 @@ private:
     uint32_t h32AlignRecvXLen_{0};
     uint32_t h512AlignRecvXLen_{0};
     uint32_t tokenIdx32AlignLen_{0};
-    uint32_t roundIndex_{0};
+    uint32_t roundIndex_{0};      // round being received
+    uint32_t sendRoundIndex_{0};  // round being sent, runs one round ahead of roundIndex_
     uint32_t realMaxBs_{0};
     uint32_t perRoundTokens_{0};
     uint32_t maxRound_{0};
@@ -392,7 +394,7 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::CopyB
             uint32_t srcInfoIdx = tokenIdxInBatch * TOKEN_SRC_INFO_LEN;
             uint32_t srcRankId = static_cast<uint32_t>(srcInfoLT_(srcInfoIdx + RANK_ID_OFFSET_IN_SRC_INFO));
             uint32_t srcTokenId = static_cast<uint32_t>(srcInfoLT_(srcInfoIdx + TOKEN_IDX_OFFSET_IN_SRC_INFO));
-            if (srcTokenId >= (roundIndex_ + 1) * perRoundTokens_) {
+            if (srcTokenId >= (sendRoundIndex_ + 1) * perRoundTokens_) {
                 // 这一轮实际发送的token数，接收方一轮最多接收perRoundTokens_个token
                 break;
             }
@@ -438,7 +440,8 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::CopyB
                                                                                              uint32_t tkIndex)
 {
     uint32_t tokenOffset = tkIndex * axisH_;
-    GM_ADDR dstGM = GetBufferAddrByRankId(srcRankId) + (srcTokenId * axisK_ + srcTopkId) * h512AlignRecvXLen_;
+    GM_ADDR dstGM =
+        GetBufferAddrByRankId(srcRankId, sendRoundIndex_) + (srcTokenId * axisK_ + srcTopkId) * h512AlignRecvXLen_;
     GlobalTensor<XType> dstWindow;
     dstWindow.SetGlobalBuffer((__gm__ XType *)dstGM);
     DataCopyExtParams xOutCopyParams{1U, static_cast<uint32_t>(hRecvXTypeLen_), 0U, 0U, 0U};
@@ -458,7 +461,7 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::SetSt
                                                                                               uint32_t srcTokenId,
                                                                                               uint32_t srcTopkId)
 {
-    uint32_t stateOffset = roundMagic_ * STATE_WIN_SIZE_HALF;
+    uint32_t stateOffset = (sendRoundIndex_ & 1U) * STATE_WIN_SIZE_HALF;
     GM_ADDR stateGM = GetStateAddrByRankId(srcRankId) + stateOffset + (srcTokenId * axisK_ + srcTopkId) * UB_32_ALIGN;
     GlobalTensor<uint32_t> stateGMTensor;
     stateGMTensor.SetGlobalBuffer((__gm__ uint32_t *)stateGM);
@@ -478,7 +481,7 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::WaitB
         ++tempValidCount;
     }
     uint32_t calCount = axisK_ * FLOAT_NUM_PER_ALIGN;
-    uint32_t stateOffset = roundMagic_ * STATE_WIN_SIZE_HALF;
+    uint32_t stateOffset = (roundIndex_ & 1U) * STATE_WIN_SIZE_HALF;
     GM_ADDR stateGM =
         GetStateAddrByRankId(epRankId_) + stateOffset + recvXTokenIdx * axisK_ * UB_32_ALIGN;  // 计算地址偏移
     GlobalTensor<float> stateGMTensor;
@@ -520,7 +523,7 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::ReadB
         }
         float scale = topkWeightsLT_.GetValue(topkWeightTokenIdx * axisK_ + topkId);
         GM_ADDR localTokenAddr =
-            GetBufferAddrByRankId(epRankId_) + (recvXTokenIdx * axisK_ + topkId) * h512AlignRecvXLen_;
+            GetBufferAddrByRankId(epRankId_, roundIndex_) + (recvXTokenIdx * axisK_ + topkId) * h512AlignRecvXLen_;
         GlobalTensor<XType> localTokenTensor;
         localTokenTensor.SetGlobalBuffer((__gm__ XType *)localTokenAddr);
 
@@ -552,6 +555,9 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::ReadB
     roundTotalRecvTokenCnt_ = min(perRoundTokens_, totalNeedRecvTokenCnt_);
     SplitCoreCal(roundTotalRecvTokenCnt_, roundRecvTokenCnt_, roundRecvStartTokenIdx_, roundRecvEndTokenIdx_);
     if (roundRecvTokenCnt_ == 0) {
+        // a core without tokens in this round still has to move on to the next one
+        totalNeedRecvTokenCnt_ -= roundTotalRecvTokenCnt_;
+        xOutTokenOffset_ += roundTotalRecvTokenCnt_;
         return;
     }
     const DataCopyExtParams bskParams{1U, static_cast<uint32_t>(roundRecvTokenCnt_ * axisK_ * sizeof(float)), 0U, 0U,
@@ -634,10 +640,20 @@ __aicore__ inline void CamMoeCombineNormalMultiRound<TemplateMC2TypeFunc>::Proce
 {
     if ASCEND_IS_AIV {  // 全aiv处理
         uint32_t realRound = (realMaxBs_ + perRoundTokens_ - 1) / perRoundTokens_;
+        // Round r+1 is put into the peers before round r is received, so the HCCS writes of the next round overlap
+        // the local weighted sum of this one. The round barrier keeps the send at most one round ahead, which is
+        // what the two data buffers allow.
+        CopyBufferToShareAndSetStatus();
         while (roundIndex_ < realRound) {
-            CopyBufferToShareAndSetStatus();
+            sendRoundIndex_ = roundIndex_ + 1;
+            if (sendRoundIndex_ < realRound) {
+                CopyBufferToShareAndSetStatus();
+            }
             ReadBufferFromRemote();
             if (realRound > 1) {
+                // every core must be done with this round's buffers before the peers may refill them
+                SyncFunc<AscendC::HardEvent::MTE3_S>();
+                SyncAll<true>();
                 SetRoundStatus();
                 WaitRoundStatus();
                 roundMagic_ = roundMagic_ == 0 ? 1 : 0;
@@ -155,6 +155,7 @@ private:
     uint32_t globalBatchSize{0};
     uint32_t round{4};
     uint32_t perRoundTokens{1024};
+    uint32_t recvTokenCap{0};
     uint32_t h{0};
     uint32_t topK{0};
     uint32_t blockNum{0};
@@ -219,6 +220,7 @@ __aicore__ inline void CamMoeDispatchNormal<CamTypeFunc>::Init(
     globalBatchSize = tilingData->camMoeDispatchNormalInfo.globalBs;
     round = tilingData->camMoeDispatchNormalInfo.round;
     perRoundTokens = tilingData->camMoeDispatchNormalInfo.perRoundTokens;
+    recvTokenCap = tilingData->camMoeDispatchNormalInfo.recvTokenCap;
     h = tilingData->camMoeDispatchNormalInfo.h;
     topK = tilingData->camMoeDispatchNormalInfo.k;
     blockNum = tilingData->camMoeDispatchNormalInfo.aivNum;
@@ -723,6 +725,13 @@ __aicore__ inline void CamMoeDispatchNormal<CamTypeFunc>::ShareToOutputLongSeq()
         int32_t srcrankInExpertOffset = srcrankInExpertOffsetTensor(i);
         int32_t rInSrcrankOffset = rInSrcrankOffsetTensor(rInSrcrankIndex);
         int32_t writeOffset = expertGlobalOffset + srcrankInExpertOffset + rInSrcrankOffset;
+        // A receive count above the expandX rows (an undersized num_worst_tokens) drops the overflowing tokens
+        // instead of writing past the outputs
+        if (static_cast<uint32_t>(writeOffset) >= recvTokenCap) {
+            count = 0;
+        } else if (count > recvTokenCap - static_cast<uint32_t>(writeOffset)) {
+            count = recvTokenCap - static_cast<uint32_t>(writeOffset);
+        }
 
         GM_ADDR recvStart =
             (__gm__ uint8_t *)(GetWindAddrByRankId(COMM_EP_IDX, fromRank)) + recvOffset * hOutGMAlignSize;
@@ -25,6 +25,7 @@ extern "C" __global__ __aicore__ void dispatch_ffn_combine(GM_ADDR x, GM_ADDR w1
                                                            GM_ADDR tilingGM)
 {
     REGISTER_TILING_DEFAULT(DispatchFFNCombineTilingData);
+#if (ORIG_DTYPE_W1 == DT_INT8)
     if (TILING_KEY_IS(1000010)) {
         KERNEL_TASK_TYPE(1000010, KERNEL_TYPE_MIX_AIC_1_2);
         GET_TILING_DATA_WITH_STRUCT(DispatchFFNCombineTilingData, tilingData, tilingGM);
@@ -32,4 +33,13 @@ extern "C" __global__ __aicore__ void dispatch_ffn_combine(GM_ADDR x, GM_ADDR w1
         op.Init(x, w1, w2, expertId, scale1, scale2, probs, c, expertTokenNums, workspaceGM, tilingGM);
         op.Process();
     }
+#elif (ORIG_DTYPE_W1 == DT_BF16 || ORIG_DTYPE_W1 == DT_FLOAT16)
+    if (TILING_KEY_IS(1000110)) {
+        KERNEL_TASK_TYPE(1000110, KERNEL_TYPE_MIX_AIC_1_2);
+        GET_TILING_DATA_WITH_STRUCT(DispatchFFNCombineTilingData, tilingData, tilingGM);
+        DispatchFFNCombine<DTYPE_A, DTYPE_W1, DTYPE_OUT, false, true> op;
+        op.Init(x, w1, w2, expertId, scale1, scale2, probs, c, expertTokenNums, workspaceGM, tilingGM);
+        op.Process();
+    }
+#endif
 }
@@ -192,7 +192,10 @@ __aicore__ inline void DispatchFFNCombine<TemplateMMA2ACFunc>::Process()
     LayoutB layoutB1 = LayoutBInitializer<LayoutB, BType_>::create(k, n);
     LayoutB layoutB2 = LayoutBInitializer<LayoutB, BType_>::create(k2, n2);
     using LayoutC = layout::RowMajor;
-    using L1TileShape = GemmShape<128, 256, 512>;  // M, N, K
+    // int8 runs GMM with per-channel dequant in fixpipe; fp16/bf16 runs it plain and keeps C in the activation dtype
+    constexpr bool isQuant = std::is_same_v<AType_, int8_t>;
+    // 16-bit A/B halve the K depth that fits in L1/L0A/L0B
+    using L1TileShape = typename std::conditional<isQuant, GemmShape<128, 256, 512>, GemmShape<128, 256, 256>>::type;
 
     constexpr uint32_t workspaceStages = 2;
     constexpr uint32_t preloadStages = 1;
@@ -204,11 +207,12 @@ __aicore__ inline void DispatchFFNCombine<TemplateMMA2ACFunc>::Process()
     using DispatchPolicy = Gemm::MmadAtlasA2PreloadAsyncFixpipe<preloadStages, l1Stages, l0AStages, l0BStages,
                                                                 l0CStages, enableUnitFlag, enableShuffleK>;
 
-    using L0TileShape = GemmShape<128, 256, 128>;
-    using AType = Gemm::GemmType<int8_t, layout::RowMajor>;
-    using BType = Gemm::GemmType<int8_t, LayoutB>;
-    using CType = Gemm::GemmType<float16_t, layout::RowMajor>;
-    using D1Type = Gemm::GemmType<int8_t, layout::RowMajor>;
+    using L0TileShape = typename std::conditional<isQuant, GemmShape<128, 256, 128>, GemmShape<128, 256, 64>>::type;
+    using AType = Gemm::GemmType<AType_, layout::RowMajor>;
+    using BType = Gemm::GemmType<BType_, LayoutB>;
+    using CType = typename std::conditional<isQuant, Gemm::GemmType<float16_t, layout::RowMajor>,
+                                            Gemm::GemmType<CType_, layout::RowMajor>>::type;
+    using D1Type = Gemm::GemmType<AType_, layout::RowMajor>;
 
     using D2Type =
         typename std::conditional<std::is_same_v<CType_, bfloat16_t>, Gemm::GemmType<bfloat16_t, layout::RowMajor>,
@@ -217,21 +221,24 @@ __aicore__ inline void DispatchFFNCombine<TemplateMMA2ACFunc>::Process()
     using BlockMmad = Gemm::Block::BlockMmad<DispatchPolicy, L1TileShape, L0TileShape, AType, BType, CType>;
     constexpr uint32_t ubStages = 2;
 
-    using EpilogueDispatchPolicy1 = Epilogue::EpilogueAtlasA2PerTokenDequantSwigluQuant<ubStages>;
-
     using ScaleType = Gemm::GemmType<uint64_t, layout::VectorLayout>;
     using PerTokenScaleType = Gemm::GemmType<float, layout::VectorLayout>;
     using ElementMulType = Gemm::GemmType<float, layout::RowMajor>;
     using TileElemWiseMuls = Epilogue::Tile::TileElemWiseMuls<ArchTag, ElementMulType, 0>;
 
     using TileCopy1 = Epilogue::Tile::TileCopy<ArchTag, CType, ScaleType, PerTokenScaleType, D1Type>;
-    using BlockEpilogue1 = Epilogue::Block::BlockEpilogue<EpilogueDispatchPolicy1, CType, PerTokenScaleType, D1Type,
-                                                          TileElemWiseMuls, TileCopy1>;
+    using BlockEpilogue1 = typename std::conditional<
+        isQuant,
+        Epilogue::Block::BlockEpilogue<Epilogue::EpilogueAtlasA2PerTokenDequantSwigluQuant<ubStages>, CType,
+                                       PerTokenScaleType, D1Type, TileElemWiseMuls, TileCopy1>,
+        Epilogue::Block::BlockEpilogue<Epilogue::EpilogueAtlasA2Swiglu<ubStages>, CType, D1Type, TileCopy1>>::type;
 
-    using EpilogueDispatchPolicy2 = Epilogue::EpilogueAtlasA2PerTokenDequantV2<ubStages>;
     using TileCopy2 = Epilogue::Tile::TileCopy<ArchTag, CType, ScaleType, PerTokenScaleType, D2Type>;
-    using BlockEpilogue2 =
-        Epilogue::Block::BlockEpilogue<EpilogueDispatchPolicy2, CType, PerTokenScaleType, D2Type, TileCopy2>;
+    using BlockEpilogue2 = typename std::conditional<
+        isQuant,
+        Epilogue::Block::BlockEpilogue<Epilogue::EpilogueAtlasA2PerTokenDequantV2<ubStages>, CType, PerTokenScaleType,
+                                       D2Type, TileCopy2>,
+        Epilogue::Block::BlockEpilogue<Epilogue::EpilogueAtlasA2UnQuant<ubStages>, CType, D2Type, TileCopy2>>::type;
 
     using BlockScheduler = typename Gemm::Block::GemmIdentityBlockSwizzle<9, 1>;
     using ElementGroupList = int64_t;
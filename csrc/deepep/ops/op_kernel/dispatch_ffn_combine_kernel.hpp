@@ -29,6 +29,8 @@
 #include "block_epilogue_pertoken_row.hpp"
 #include "block_epilogue_pertoken_v2.hpp"
 #include "block_epilogue_pertoken_swiglu.hpp"
+#include "block_epilogue_swiglu.hpp"
+#include "block_epilogue_unquant_v2.hpp"
 #include "hccl_shmem.hpp"
 #include "const_args.hpp"
 #include "layout3d.hpp"
@@ -47,6 +49,8 @@ inline __gm__ struct OpSystemRunCfg g_opSystemRunCfg {
 #include "dispatch_ffn_combine_kernel/utils/block_epilogue_pertoken_row.hpp"
 #include "dispatch_ffn_combine_kernel/utils/block_epilogue_pertoken_v2.hpp"
 #include "dispatch_ffn_combine_kernel/utils/block_epilogue_pertoken_swiglu.hpp"
+#include "dispatch_ffn_combine_kernel/utils/block_epilogue_swiglu.hpp"
+#include "dispatch_ffn_combine_kernel/utils/block_epilogue_unquant_v2.hpp"
 #include "dispatch_ffn_combine_kernel/utils/hccl_shmem.hpp"
 #include "dispatch_ffn_combine_kernel/utils/const_args.hpp"
 #include "dispatch_ffn_combine_kernel/utils/layout3d.hpp"
@@ -90,6 +94,8 @@ public:
     using LayoutD1 = typename BlockEpilogue1::LayoutD;
     using ElementD2 = typename BlockEpilogue2::ElementD;
     using LayoutD2 = typename BlockEpilogue2::LayoutD;
+    // int8 activations carry per-token scales through dispatch and both epilogues; fp16/bf16 carry none
+    static constexpr bool IS_QUANT = std::is_same_v<ElementA, int8_t>;
 
     /// Parameters structure
     struct Params {
@@ -739,6 +745,17 @@ private:
         AscendC::SetFlag<AscendC::HardEvent::MTE3_V>(EVENT_ID1);
     }
 
+    CATLASS_DEVICE
+    void Swiglu(BlockEpilogue1 &blockEpilogue, AscendC::GlobalTensor<ElementC> const &gmC, MatrixCoord const &shapeC,
+                uint32_t rowStart, AscendC::GlobalTensor<ElementD1> const &gmD, uint32_t epilogueCoreNum)
+    {
+        if constexpr (IS_QUANT) {
+            blockEpilogue(gmC, shapeC, gmPerTokenScale1[rowStart], gmD, gmPerTokenScale2[rowStart], epilogueCoreNum);
+        } else {
+            blockEpilogue(gmC, shapeC, gmD, epilogueCoreNum);
+        }
+    }
+
     CATLASS_DEVICE
     void DispatchAndCombine(Params const &params)
     {
@@ -805,12 +822,17 @@ private:
                     gmRemoteA.SetGlobalBuffer(reinterpret_cast<__gm__ ElementA *>(otherRankPtr + peermemInfo.offsetA));
 
                     MatrixCoord offsetA{rowStart, 0};
-                    MatrixCoord offsetPeer{rowSrc, 0};
                     int64_t gmOffsetA = params.layoutA.GetOffset(offsetA);
-                    int64_t gmOffsetPeer = rowSrc * (params.problemShape.k() + ALIGN_512);
                     // Communication data
-                    CopyGMToGMPerToken(gmA[gmOffsetA], gmPerTokenScale1[rowStart], gmRemoteA[gmOffsetPeer], rows,
-                                       params.problemShape.k());
+                    if constexpr (IS_QUANT) {
+                        int64_t gmOffsetPeer = rowSrc * (params.problemShape.k() + ALIGN_512);
+                        CopyGMToGMPerToken(gmA[gmOffsetA], gmPerTokenScale1[rowStart], gmRemoteA[gmOffsetPeer], rows,
+                                           params.problemShape.k());
+                    } else {
+                        int64_t gmOffsetPeer = rowSrc * params.problemShape.k();
+                        CopyGMToGM(gmA[gmOffsetA], gmRemoteA[gmOffsetPeer], rows * params.problemShape.k(),
+                                   params.ubMoveNum);
+                    }
                 }
             }
             AscendC::SyncAll<true>();
@@ -865,8 +887,8 @@ private:
             LayoutC layoutC{dequantSum1, params.problemShape.n()};
             int64_t gmOffsetC = layoutC.GetOffset(offsetC);
             int64_t gmOffsetD = params.layoutD1.GetOffset(offsetC);
-            blockEpilogue1(gmC[gmOffsetC], shapeC, gmPerTokenScale1[rowStartThisCore], gmPermutedToken[gmOffsetD],
-                           gmPerTokenScale2[rowStartThisCore], params.epilogueCoreNum);
+            Swiglu(blockEpilogue1, gmC[gmOffsetC], shapeC, rowStartThisCore, gmPermutedToken[gmOffsetD],
+                   params.epilogueCoreNum);
         }
         AscendC::SyncAll<true>();
         // Synchronization signal: SwiGLU notifies GMM2 [1]
@@ -884,8 +906,7 @@ private:
                 LayoutC layoutC{dequantLen, params.problemShape.n()};
                 int64_t gmOffsetC = layoutC.GetOffset(offsetC);
                 int64_t gmOffsetD = params.layoutD1.GetOffset(offsetC);
-                blockEpilogue1(gmC[gmOffsetC], shapeC, gmPerTokenScale1[rowStartThisCore], gmPermutedToken[gmOffsetD],
-                               gmPerTokenScale2[rowStartThisCore], coreNum);
+                Swiglu(blockEpilogue1, gmC[gmOffsetC], shapeC, rowStartThisCore, gmPermutedToken[gmOffsetD], coreNum);
             }
             AscendC::SyncAll<true>();
             // Synchronization signal: SwiGLU notifies GMM2 [2]
@@ -894,7 +915,9 @@ private:
 
         blockEpilogue1.Finalize();
 
-        CombineSetFlag();
+        if constexpr (IS_QUANT) {
+            CombineSetFlag();
+        }
 
         CombineV2(params, blockEpilogue2);
 
@@ -987,8 +1010,12 @@ private:
                         actualm = actualBlockShape.m() - (m_rows / 2) * m0 - cur_row * m0;
                     }
                     GemmCoord realTileShape{actualm, actualBlockShape.n(), 1};
-                    blockEpilogue(gmC2, gmPerTokenScale2, realTileCoord, realTileShape, groupIdx, preSrcExpertSum,
-                                  preSumBeforeRank);
+                    if constexpr (IS_QUANT) {
+                        blockEpilogue(gmC2, gmPerTokenScale2, realTileCoord, realTileShape, groupIdx, preSrcExpertSum,
+                                      preSumBeforeRank);
+                    } else {
+                        blockEpilogue(gmC2, realTileCoord, realTileShape, groupIdx, preSrcExpertSum, preSumBeforeRank);
+                    }
                     m_offset += m0;
                 }
             }
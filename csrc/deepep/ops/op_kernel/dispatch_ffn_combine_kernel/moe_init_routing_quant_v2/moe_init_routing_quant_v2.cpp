@@ -14,6 +14,7 @@
  */
 #include "moe_v2_sort_one_core.h"
 #include "moe_v2_sort_multi_core.h"
+#include "moe_v2_count_sort.h"
 #include "moe_v2_mrgsort_out.h"
 #include "moe_v2_mrgsort.h"
 #include "moe_v2_expert_token_out.h"
@@ -23,6 +24,7 @@
 #include "moe_v2_fullload_dynamic_quant.h"
 #include "moe_v2_gather_quant.h"
 #include "moe_v2_gather_dynamic_quant.h"
+#include "moe_v2_gather_out.h"
 #include "moe_v2_src_to_dst_and_gather.h"
 
 using namespace AscendC;
@@ -65,23 +67,38 @@ __aicore__ inline void moe_init_routing_quant_v2(GM_ADDR x, GM_ADDR expertIdx, G
     }
 
     // sort
-    if (tilingKey == 10000 || tilingKey == 10100 || tilingKey == 11000 || tilingKey == 11100) {
+    if (tilingKey == 10000 || tilingKey == 10100 || tilingKey == 11000 || tilingKey == 11100 || tilingKey == 12000) {
         TPipe sortPipe;
         MoeV2SortOneCore op;
         op.Init<MoeInitRoutingQuantV2TilingData>(expertIdx, expertTokensCountOrCumsum, expertTokensBeforeCapacity,
                                                  workspace, tilingData, &sortPipe);
         op.Process();
         sortPipe.Destroy();
-    } else if (tilingKey == 10010 || tilingKey == 10110 || tilingKey == 11010 || tilingKey == 11110) {
+    } else if (tilingKey == 10010 || tilingKey == 10110 || tilingKey == 11010 || tilingKey == 11110 ||
+               tilingKey == 12010) {
         TPipe sortPipe;
         MoeV2SortMultiCore op;
         op.Init<MoeInitRoutingQuantV2TilingData>(expertIdx, expertTokensCountOrCumsum, expertTokensBeforeCapacity,
                                                  workspace, tilingData, &sortPipe);
         op.Process();
         sortPipe.Destroy();
+    } else if (tilingKey == 10020 || tilingKey == 11020 || tilingKey == 12020) {  // Counting sort, emits counts itself
+        TPipe sortPipe;
+        MoeV2CountSort op;
+        op.Init<MoeInitRoutingQuantV2TilingData>(expertIdx, expertTokensCountOrCumsum, workspace, tilingData,
+                                                 &sortPipe);
+        op.Process();
+        sortPipe.Destroy();
     }
 
-    if (tilingKey == 10000 || tilingKey == 10010 || tilingKey == 11000 || tilingKey == 11010) {  // No drop scenario
+    if (tilingKey == 10020 || tilingKey == 11020 || tilingKey == 12020) {
+        TPipe srcToDstPipe;
+        MoeV2SrcToDstOp srcToDstOp;
+        srcToDstOp.Init<MoeInitRoutingQuantV2TilingData>(expandedRowIdx, workspace, tilingData, &srcToDstPipe);
+        srcToDstOp.Process();
+        srcToDstPipe.Destroy();
+    } else if (tilingKey == 10000 || tilingKey == 10010 || tilingKey == 11000 || tilingKey == 11010 ||
+               tilingKey == 12000 || tilingKey == 12010) {  // No drop
         if (tilingData->expertTokensCountOrCumsumFlag != EXERPT_TOKENS_NONE) {
             TPipe expertTokenOutPipe;
             MoeV2ExpertTokenOut expertTokenOutOp;
@@ -121,18 +138,25 @@ __aicore__ inline void moe_init_routing_quant_v2(GM_ADDR x, GM_ADDR expertIdx, G
         }
     }
 
-    if (tilingKey == 10000 || tilingKey == 10010 || tilingKey == 10100 || tilingKey == 10110) {
+    if (tilingKey == 10000 || tilingKey == 10010 || tilingKey == 10020 || tilingKey == 10100 || tilingKey == 10110) {
         TPipe gatherPipe;
         MoeV2GatherQuant<DTYPE_X> gatherQuantOp;
         gatherQuantOp.Init(x, scale, offset, expandedRowIdx, expandedX, workspace, tilingData, &gatherPipe);
         gatherQuantOp.Process();
         gatherPipe.Destroy();
-    } else if (tilingKey == 11000 || tilingKey == 11010) {
+    } else if (tilingKey == 11000 || tilingKey == 11010 || tilingKey == 11020) {
         TPipe gatherPipe;
         MoeV2GatherDynamicQuant<DTYPE_X> gatherDynamicQuantOp;
         gatherDynamicQuantOp.Init(x, scale, expandedRowIdx, expandedX, dynamicQuantScale, workspace, tilingData,
                                   &gatherPipe);
         gatherDynamicQuantOp.Process();
         gatherPipe.Destroy();
+    } else if (tilingKey == 12000 || tilingKey == 12010 || tilingKey == 12020) {  // No quant, rows keep DTYPE_X
+        TPipe gatherPipe;
+        MoeV2GatherOut<DTYPE_X> gatherOutOp;
+        gatherOutOp.Init<MoeInitRoutingQuantV2TilingData>(x, expandedRowIdx, expandedX, workspace, tilingData,
+                                                          &gatherPipe);
+        gatherOutOp.Process();
+        gatherPipe.Destroy();
     }
 }
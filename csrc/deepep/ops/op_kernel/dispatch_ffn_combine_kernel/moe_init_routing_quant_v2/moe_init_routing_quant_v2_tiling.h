@@ -9,6 +9,13 @@ const static int64_t TILING_KEY_PERF_BASE = 20000;
 const static int64_t TILING_KEY_QUANT_BASE = 1000;
 const static int64_t TILING_KEY_DROP_MODE_BASE = 100;
 const static int64_t TILING_KEY_SORT_BASE = 10;
+const static int64_t SORT_MODE_ONE_CORE = 0;
+const static int64_t SORT_MODE_MULTI_CORE = 1;
+const static int64_t SORT_MODE_COUNT = 2;
+const static int64_t QUANT_MODE_STATIC = 0;
+const static int64_t QUANT_MODE_DYNAMIC = 1;
+// Rows are gathered in the input dtype, used by the BF16/FP16 dispatch_ffn_combine
+const static int64_t QUANT_MODE_NONE = 2;
 const static int64_t FOUR_BLOCK_BYTE = 128;
 const static int64_t MAX_COLS_ONE_LOOP_QUANT = 8192;
 const static int64_t INDEX_SCALE = 2;
@@ -49,6 +56,7 @@ struct MoeInitRoutingQuantV2TilingData {
     InnerMoeV2VBSComputeTilingData vbsComputeParamsOp;
     InnerMoeV2VMSMiddleComputeTilingData vmsMiddleComputeParamsOp;
     InnerMoeV2SortOutComputeTilingData sortOutComputeParamsOp;
+    InnerMoeV2CountSortComputeTilingData countSortComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData srcToDstComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData srcToDstCapacityComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData gatherOutComputeParamsOp;
@@ -78,6 +86,7 @@ public:
                                  int64_t lastCoreRows, int64_t basePerLoopMaxRows);
     void Tiling4GatherQuant();
     void Tiling4GatherDynamicQuant();
+    void Tiling4GatherNoQuant();
     void Tiling4SrcToDstCapacityCompute() override;
     void Tiling4GatherOutCompute() override;
     void CopyGatherOutTiling(InnerMoeV2GatherOutComputeTilingData &dst, InnerMoeV2GatherOutComputeTilingData &src);
@@ -111,7 +120,7 @@ bool MoeInitRoutingQuantV2TilingBase::IsFullLoadDynamicQuant(int64_t space)
 bool MoeInitRoutingQuantV2TilingBase::IsFullLoad()
 {
     if (totalLength > sortLoopMaxElement || moeInitRoutingTilingData.cols > MAX_COLS_ONE_LOOP_QUANT ||
-        this->dropPadMode == 1) {
+        this->dropPadMode == 1 || quantMode == QUANT_MODE_NONE) {
         return false;
     }
     int64_t sortSpace = AlignOneBlockByte(this->totalLength) * sizeof(int32_t) * ONE_CORE_SORT_BUFFER;
@@ -150,8 +159,12 @@ uint64_t MoeInitRoutingQuantV2TilingBase::GetTilingKey() const
     if (isFullLoad) {
         return TILING_KEY_PERF_BASE + quantMode * TILING_KEY_QUANT_BASE;
     }
+    int64_t sortMode = totalLength > sortLoopMaxElement ? SORT_MODE_MULTI_CORE : SORT_MODE_ONE_CORE;
+    if (isCountSort) {
+        sortMode = SORT_MODE_COUNT;
+    }
     return TILING_KEY_BASE + quantMode * TILING_KEY_QUANT_BASE + dropPadMode * TILING_KEY_DROP_MODE_BASE +
-           (totalLength > sortLoopMaxElement) * TILING_KEY_SORT_BASE;
+           sortMode * TILING_KEY_SORT_BASE;
 }
 
 bool MoeInitRoutingQuantV2TilingBase::PostTiling()
@@ -207,6 +220,8 @@ void MoeInitRoutingQuantV2TilingBase::CopyTilingData()
         (InnerMoeInitRoutingV2TilingBase::moeInitRoutingTilingData.vmsMiddleComputeParamsOp.needCoreNum);
     quantTilingData.sortOutComputeParamsOp.oneLoopMaxElements =
         (InnerMoeInitRoutingV2TilingBase::moeInitRoutingTilingData.sortOutComputeParamsOp.oneLoopMaxElements);
+    quantTilingData.countSortComputeParamsOp =
+        InnerMoeInitRoutingV2TilingBase::moeInitRoutingTilingData.countSortComputeParamsOp;
 
     CopyGatherOutTiling(quantTilingData.srcToDstComputeParamsOp,
                         InnerMoeInitRoutingV2TilingBase::moeInitRoutingTilingData.srcToDstComputeParamsOp);
@@ -265,7 +280,7 @@ void MoeInitRoutingQuantV2TilingBase::SetGatherTilingDataRows(InnerMoeV2GatherOu
 
 void MoeInitRoutingQuantV2TilingBase::Tiling4SrcToDstCapacityCompute()
 {
-    if (quantMode == 0 || dropPadMode == 0) {
+    if (quantMode != QUANT_MODE_DYNAMIC || dropPadMode == 0) {
         InnerMoeInitRoutingV2TilingBase::Tiling4SrcToDstCapacityCompute();
         return;
     }
@@ -418,10 +433,51 @@ void MoeInitRoutingQuantV2TilingBase::Tiling4GatherDynamicQuant()
     }
 }
 
+void MoeInitRoutingQuantV2TilingBase::Tiling4GatherNoQuant()
+{
+    auto tilingData = &quantTilingData.gatherOutComputeParamsOp;
+    tilingData->activateRows = totalLength;
+    if (dropPadMode == 0 && activateNum > 0) {
+        tilingData->activateRows = (std::min(activateNum, totalLength));
+    }
+    int64_t perCoreRows = CeilDiv(totalLength, aivNum);
+    if (perCoreRows <= 0) {
+        tilingData->needCoreNum = 0;
+        return;
+    }
+
+    tilingData->needCoreNum = (CeilDiv(totalLength, perCoreRows));
+    int64_t cols = moeInitRoutingTilingData.cols;
+    tilingData->perCoreRows = perCoreRows;
+    int64_t lastCoreRows = totalLength - perCoreRows * (tilingData->needCoreNum - 1);
+    tilingData->lastCoreRows = lastCoreRows;
+
+    // Double-buffered row indices and input rows, nothing else is kept in UB
+    int64_t ubSize = static_cast<int64_t>(aicoreParams_.ubSize);
+    int64_t rowSize = AlignOneBlockByte(perCoreRows * sizeof(int32_t)) * NUM_TWO;
+    int64_t colSize = AlignOneBlockByte(cols * inuptXDtypeSize_) * NUM_TWO;
+    if (rowSize + colSize < ubSize) {
+        SetGatherTilingData(tilingData, perCoreRows, lastCoreRows, cols);
+    } else {
+        int64_t baseMaxCols = MAX_COLS_ONE_LOOP_QUANT;
+        int64_t baseMaxColsSize = AlignOneBlockByte(baseMaxCols * inuptXDtypeSize_) * NUM_TWO;
+        int64_t basePerLoopMaxRows = AlignOneBlockByteCeil((ubSize - baseMaxColsSize) / NUM_TWO / sizeof(int32_t));
+        if (cols < MAX_COLS_ONE_LOOP_QUANT) {
+            basePerLoopMaxRows = AlignOneBlockByteCeil((ubSize - colSize) / NUM_TWO / sizeof(int32_t));
+        } else if (perCoreRows < basePerLoopMaxRows) {
+            baseMaxCols = AlignOneBlockByteCeil((ubSize - rowSize) / NUM_TWO / inuptXDtypeSize_);
+        }
+        SetGatherTilingDataCols(tilingData, baseMaxCols, cols);
+        SetGatherTilingDataRows(tilingData, perCoreRows, lastCoreRows, basePerLoopMaxRows);
+    }
+}
+
 void MoeInitRoutingQuantV2TilingBase::Tiling4GatherOutCompute()
 {
-    if (quantMode == 0) {
+    if (quantMode == QUANT_MODE_STATIC) {
         Tiling4GatherQuant();
+    } else if (quantMode == QUANT_MODE_NONE) {
+        Tiling4GatherNoQuant();
     } else {
         Tiling4GatherDynamicQuant();
     }
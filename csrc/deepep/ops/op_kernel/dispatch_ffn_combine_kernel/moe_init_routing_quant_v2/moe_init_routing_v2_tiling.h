@@ -36,6 +36,11 @@ const static int64_t OUTOUT_EXPERT_TOKENS_BEFORE_CAPACITY = 3;
 const static int64_t KV_FACTOR = 2;
 const static int64_t ONE_CORE_SORT_BUFFER = 6;
 const static int64_t EXPERT_TOKENS_COUNT = 2;
+// Counting sort keeps one int32 counter per expert and per core, so it is limited to small expert counts
+const static int64_t COUNT_SORT_MAX_EXPERT_NUM = 512;
+const static int64_t COUNT_SORT_EXPERT_BUFFER = 6;
+const static int64_t COUNT_SORT_ROW_BUFFER = 3;
+const static int64_t INT32_ONE_BLOCK_ELEMENT = 8;
 
 inline static int64_t CeilLog4(int64_t x)
 {
@@ -77,6 +82,13 @@ struct InnerMoeV2SortOutComputeTilingData {
     int64_t oneLoopMaxElements = 0;
 };
 
+struct InnerMoeV2CountSortComputeTilingData {
+    int64_t needCoreNum = 0;
+    int64_t perCoreRows = 0;
+    int64_t lastCoreRows = 0;
+    int64_t perLoopRows = 0;
+};
+
 struct InnerMoeV2GatherOutComputeTilingData {
     int64_t needCoreNum = 0;
     int64_t activateRows = 0;
@@ -106,6 +118,7 @@ struct InnerMoeInitRoutingV2TilingData {
     InnerMoeV2VBSComputeTilingData vbsComputeParamsOp;
     InnerMoeV2VMSMiddleComputeTilingData vmsMiddleComputeParamsOp;
     InnerMoeV2SortOutComputeTilingData sortOutComputeParamsOp;
+    InnerMoeV2CountSortComputeTilingData countSortComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData srcToDstComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData srcToDstCapacityComputeParamsOp;
     InnerMoeV2GatherOutComputeTilingData gatherOutComputeParamsOp;
@@ -113,6 +126,10 @@ struct InnerMoeInitRoutingV2TilingData {
 
 class InnerMoeInitRoutingV2TilingBase : public TilingBaseClass
 {
+public:
+    // Set to false before DoTiling to force the merge sort, e.g. to cross-check the counting sort
+    bool enableCountSort = true;
+
 protected:
     bool GetPlatformInfo(int64_t aivCoreNum, int64_t ubSizePlatForm) override;
     bool GetShapeAttrsInfo(int64_t m, int64_t cols, int64_t topK, int64_t expertCapacity, int64_t expertNum,
@@ -131,6 +148,7 @@ protected:
     void Tiling4SrcToDstCompute();
     virtual void Tiling4SrcToDstCapacityCompute();
     void Tiling4SortOutCompute();
+    void Tiling4CountSortCompute();
     void Tiling4VMSMiddleCompute();
     void Tiling4VBSCompute();
     void ShowTilingData();
@@ -150,6 +168,7 @@ protected:
     bool expertTokensBeforeCapacityFlag = false;
     int64_t inuptXDtypeSize_ = 0;
     bool isFullLoad = false;
+    bool isCountSort = false;
 
     InnerMoeInitRoutingV2TilingData moeInitRoutingTilingData;
 };
@@ -162,6 +181,7 @@ bool InnerMoeInitRoutingV2TilingBase::DoOpTiling()
     Tiling4VBSCompute();
     Tiling4VMSMiddleCompute();
     Tiling4SortOutCompute();
+    Tiling4CountSortCompute();
     Tiling4SrcToDstCompute();
     Tiling4SrcToDstCapacityCompute();
     Tiling4GatherOutCompute();
@@ -238,6 +258,11 @@ bool InnerMoeInitRoutingV2TilingBase::GetWorkspaceSize()
     size_t expertTokenFlagSize = aivNum * 2 * sizeof(int32_t);
     workspaceSize_ =
         sortWorkspaceSize + scatterWorkspaceSize + expertTokenFlagSize + SIZE_16 * LENGTH_1024 * LENGTH_1024;
+    if (isCountSort) {
+        // Per-core expert histograms plus the out-of-range bucket, placed after the sorted expert ids and row indices
+        workspaceSize_ += aivNum * CeilDiv(expertNum + 1, INT32_ONE_BLOCK_ELEMENT) * INT32_ONE_BLOCK_ELEMENT *
+                          sizeof(int32_t);
+    }
     return true;
 }
 
@@ -323,6 +348,39 @@ void InnerMoeInitRoutingV2TilingBase::Tiling4SortOutCompute()
     tilingData->oneLoopMaxElements = mrgSortListMaxElement;
 }
 
+void InnerMoeInitRoutingV2TilingBase::Tiling4CountSortCompute()
+{
+    auto tilingData = &moeInitRoutingTilingData.countSortComputeParamsOp;
+    // Expert ids are bounded, so in dropless mode a histogram + prefix sum + scatter replaces the merge sort
+    isCountSort = enableCountSort && !isFullLoad && dropPadMode == 0 && expertNum > 0 &&
+                  expertNum <= COUNT_SORT_MAX_EXPERT_NUM;
+    int64_t perCoreRows = CeilDiv(totalLength, aivNum);
+    if (!isCountSort || perCoreRows <= 0) {
+        isCountSort = false;
+        tilingData->needCoreNum = 0;
+        return;
+    }
+
+    tilingData->needCoreNum = CeilDiv(totalLength, perCoreRows);
+    tilingData->perCoreRows = perCoreRows;
+    tilingData->lastCoreRows = totalLength - perCoreRows * (tilingData->needCoreNum - 1);
+
+    // Every expert run of a loop starts on a 32B boundary, which costs up to one block per expert. Ids outside
+    // [0, expertNum) get one more bucket after the last expert.
+    int64_t expertNumAlign = CeilDiv(expertNum + 1, INT32_ONE_BLOCK_ELEMENT) * INT32_ONE_BLOCK_ELEMENT;
+    int64_t expertSpace = expertNumAlign * sizeof(int32_t) * COUNT_SORT_EXPERT_BUFFER;
+    int64_t runPadSpace = expertNumAlign * INT32_ONE_BLOCK_ELEMENT * sizeof(int32_t) * NUM_TWO;
+    int64_t perLoopMaxRows = (static_cast<int64_t>(aicoreParams_.ubSize) - expertSpace - runPadSpace) /
+                             static_cast<int64_t>(sizeof(int32_t) * COUNT_SORT_ROW_BUFFER) / INT32_ONE_BLOCK_ELEMENT *
+                             INT32_ONE_BLOCK_ELEMENT;
+    if (perLoopMaxRows <= 0) {
+        isCountSort = false;
+        tilingData->needCoreNum = 0;
+        return;
+    }
+    tilingData->perLoopRows = std::min(perLoopMaxRows, perCoreRows);
+}
+
 void InnerMoeInitRoutingV2TilingBase::Tiling4SrcToDstCompute()
 {
     auto tilingData = &moeInitRoutingTilingData.srcToDstComputeParamsOp;
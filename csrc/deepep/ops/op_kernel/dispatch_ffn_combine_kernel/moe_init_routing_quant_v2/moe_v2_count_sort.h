@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2025 Huawei Technologies Co., Ltd.
+ * This file is a part of the CANN Open Software.
+ * Licensed under CANN Open Software License Agreement Version 1.0 (the "License").
+ * Please refer to the License for details. You may not use this file except in compliance with the License.
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY, OR FITNESS FOR A PARTICULAR PURPOSE.
+ * See LICENSE in the root of the software repository for the full text of the License.
+ */
+
+/*!
+ * \file moe_v2_count_sort.h
+ * \brief Dropless expert routing by counting sort: per-core histogram, prefix sum over cores, stable scatter.
+ */
+#ifndef INNER_MOE_V2_COUNT_SORT_H
+#define INNER_MOE_V2_COUNT_SORT_H
+
+#include "moe_v2_common.h"
+#include "moe_v2_sort_base.h"
+
+namespace MoeInitRoutingQuantV2 {
+using namespace AscendC;
+using namespace optiling;
+class MoeV2CountSort : public MoeV2SortBase
+{
+public:
+    __aicore__ inline MoeV2CountSort(){};
+    template <typename TilingData>
+    __aicore__ inline void Init(GM_ADDR expertIdx, GM_ADDR expertTokensCountOrCumsum, GM_ADDR workspace,
+                                const TilingData *tilingData, TPipe *tPipe);
+    __aicore__ inline void Process();
+
+private:
+    __aicore__ inline void CopyIn(int64_t rowOffset, int64_t rows);
+    __aicore__ inline void Histogram();
+    __aicore__ inline void ComputeOffsets();
+    __aicore__ inline void CopyOutExpertTokens();
+    __aicore__ inline void Scatter();
+    __aicore__ inline void ScatterLoop(int64_t rowOffset, int64_t rows);
+    __aicore__ inline int64_t Bucket(int32_t expertId) const;
+
+private:
+    TBuf<TPosition::VECCALC> expertIdxBuffer;
+    TBuf<TPosition::VECCALC> dstRowBuffer;
+    TBuf<TPosition::VECCALC> dstExpertBuffer;
+    TBuf<TPosition::VECCALC> expertBuffer;
+
+    LocalTensor<int32_t> expertIdxLocal;
+    LocalTensor<int32_t> dstRowLocal;
+    LocalTensor<int32_t> dstExpertLocal;
+    LocalTensor<int32_t> countLocal;
+    LocalTensor<int32_t> totalLocal;
+    LocalTensor<int32_t> offsetLocal;
+    LocalTensor<int32_t> loadLocal;
+    LocalTensor<int32_t> runStartLocal;
+    LocalTensor<int32_t> runCursorLocal;
+
+    GlobalTensor<int32_t> histGm;
+
+    const InnerMoeV2CountSortComputeTilingData *countSortTilingData;
+    int64_t blockIdx;
+    int64_t needCoreNum;
+    int64_t coreRows;
+    int64_t perLoopRows;
+    int64_t expertNumAlign;
+
+    static constexpr int64_t EXPERT_BUFFER_NUM = 6;
+};
+
+__aicore__ inline void MoeV2CountSort::CopyIn(int64_t rowOffset, int64_t rows)
+{
+    DataCopyExtParams dataCopyParams{1, static_cast<uint32_t>(rows * sizeof(int32_t)), 0, 0, 0};
+    DataCopyPadExtParams<int32_t> dataCopyPadParams{false, 0, 0, 0};
+    DataCopyPad(expertIdxLocal, expertIdxGm[rowOffset], dataCopyParams, dataCopyPadParams);
+    SetWaitFlag<HardEvent::MTE2_S>(HardEvent::MTE2_S);
+}
+
+__aicore__ inline int64_t MoeV2CountSort::Bucket(int32_t expertId) const
+{
+    // Ids outside [0, expertNum) share the bucket after the last expert, so their rows land after every valid row
+    return (expertId >= 0 && expertId < this->expertNum) ? expertId : this->expertNum;
+}
+
+__aicore__ inline void MoeV2CountSort::Histogram()
+{
+    Duplicate<int32_t>(countLocal, 0, this->expertNumAlign);
+    SetWaitFlag<HardEvent::V_S>(HardEvent::V_S);
+
+    int64_t rowStart = this->blockIdx * this->countSortTilingData->perCoreRows;
+    for (int64_t done = 0; done < this->coreRows; done += this->perLoopRows) {
+        int64_t rows = Min(this->perLoopRows, this->coreRows - done);
+        CopyIn(rowStart + done, rows);
+        for (int64_t i = 0; i < rows; i++) {
+            int64_t bucket = Bucket(expertIdxLocal.GetValue(i));
+            countLocal.SetValue(bucket, countLocal.GetValue(bucket) + 1);
+        }
+        SetWaitFlag<HardEvent::S_MTE2>(HardEvent::S_MTE2);
+    }
+
+    SetWaitFlag<HardEvent::S_MTE3>(HardEvent::S_MTE3);
+    DataCopy(histGm[this->blockIdx * this->expertNumAlign], countLocal, this->expertNumAlign);
+}
+
+__aicore__ inline void MoeV2CountSort::ComputeOffsets()
+{
+    Duplicate<int32_t>(totalLocal, 0, this->expertNumAlign);
+    Duplicate<int32_t>(offsetLocal, 0, this->expertNumAlign);
+    for (int64_t core = 0; core < this->needCoreNum; core++) {
+        SetWaitFlag<HardEvent::V_MTE2>(HardEvent::V_MTE2);
+        DataCopy(loadLocal, histGm[core * this->expertNumAlign], this->expertNumAlign);
+        SetWaitFlag<HardEvent::MTE2_V>(HardEvent::MTE2_V);
+        Add(totalLocal, totalLocal, loadLocal, this->expertNumAlign);
+        if (core < this->blockIdx) {
+            Add(offsetLocal, offsetLocal, loadLocal, this->expertNumAlign);
+        }
+        pipe_barrier(PIPE_V);
+    }
+    SetWaitFlag<HardEvent::V_S>(HardEvent::V_S);
+
+    // Exclusive scan of the expert totals gives every expert's first row; add the rows owned by earlier cores
+    int32_t expertStart = 0;
+    for (int64_t bucket = 0; bucket <= this->expertNum; bucket++) {
+        int32_t expertTokens = totalLocal.GetValue(bucket);
+        offsetLocal.SetValue(bucket, offsetLocal.GetValue(bucket) + expertStart);
+        expertStart += expertTokens;
+        if (bucket < this->expertNum && this->expertTokensCountOrCumsumFlag == EXERPT_TOKENS_CUMSUM) {
+            totalLocal.SetValue(bucket, expertStart);
+        }
+    }
+}
+
+__aicore__ inline void MoeV2CountSort::CopyOutExpertTokens()
+{
+    if (this->blockIdx != 0 || this->expertTokensCountOrCumsumFlag == EXERPT_TOKENS_NONE) {
+        return;
+    }
+    SetWaitFlag<HardEvent::S_MTE3>(HardEvent::S_MTE3);
+    DataCopyExtParams copyParams{1, static_cast<uint32_t>(this->expertNum * sizeof(int32_t)), 0, 0, 0};
+    DataCopyPad(expertTokensCountOrCumsumGm, totalLocal, copyParams);
+}
+
+__aicore__ inline void MoeV2CountSort::ScatterLoop(int64_t rowOffset, int64_t rows)
+{
+    CopyIn(rowOffset, rows);
+    SetWaitFlag<HardEvent::S_V>(HardEvent::S_V);
+    Duplicate<int32_t>(countLocal, 0, this->expertNumAlign);
+    SetWaitFlag<HardEvent::V_S>(HardEvent::V_S);
+    for (int64_t i = 0; i < rows; i++) {
+        int64_t bucket = Bucket(expertIdxLocal.GetValue(i));
+        countLocal.SetValue(bucket, countLocal.GetValue(bucket) + 1);
+    }
+
+    // Each expert's run starts on a 32B boundary so it can be copied out with a single DataCopyPad
+    int32_t runStart = 0;
+    for (int64_t bucket = 0; bucket <= this->expertNum; bucket++) {
+        runStartLocal.SetValue(bucket, runStart);
+        runCursorLocal.SetValue(bucket, runStart);
+        runStart += static_cast<int32_t>(Align(countLocal.GetValue(bucket), sizeof(int32_t)));
+    }
+
+    SetWaitFlag<HardEvent::MTE3_S>(HardEvent::MTE3_S);
+    for (int64_t i = 0; i < rows; i++) {
+        int32_t expertId = expertIdxLocal.GetValue(i);
+        int64_t bucket = Bucket(expertId);
+        int32_t dst = runCursorLocal.GetValue(bucket);
+        runCursorLocal.SetValue(bucket, dst + 1);
+        dstRowLocal.SetValue(dst, static_cast<int32_t>(rowOffset + i));
+        dstExpertLocal.SetValue(dst, expertId);
+    }
+    SetWaitFlag<HardEvent::S_MTE3>(HardEvent::S_MTE3);
+
+    for (int64_t bucket = 0; bucket <= this->expertNum; bucket++) {
+        int32_t expertTokens = countLocal.GetValue(bucket);
+        if (expertTokens == 0) {
+            continue;
+        }
+        int32_t srcOffset = runStartLocal.GetValue(bucket);
+        int32_t dstOffset = offsetLocal.GetValue(bucket);
+        DataCopyExtParams copyParams{1, static_cast<uint32_t>(expertTokens * sizeof(int32_t)), 0, 0, 0};
+        DataCopyPad(expandDstToSrcRowGm[dstOffset], dstRowLocal[srcOffset], copyParams);
+        DataCopyPad(sortedexpertIdxGm[dstOffset], dstExpertLocal[srcOffset], copyParams);
+        offsetLocal.SetValue(bucket, dstOffset + expertTokens);
+    }
+    SetWaitFlag<HardEvent::S_MTE2>(HardEvent::S_MTE2);
+}
+
+__aicore__ inline void MoeV2CountSort::Scatter()
+{
+    int64_t rowStart = this->blockIdx * this->countSortTilingData->perCoreRows;
+    for (int64_t done = 0; done < this->coreRows; done += this->perLoopRows) {
+        ScatterLoop(rowStart + done, Min(this->perLoopRows, this->coreRows - done));
+    }
+}
+
+template <typename TilingData>
+__aicore__ inline void MoeV2CountSort::Init(GM_ADDR expertIdx, GM_ADDR expertTokensCountOrCumsum, GM_ADDR workspace,
+                                            const TilingData *tilingData, TPipe *tPipe)
+{
+    this->pipe = tPipe;
+    this->blockIdx = get_block_idx() + get_subblockid() * get_block_num();
+    this->countSortTilingData = &(tilingData->countSortComputeParamsOp);
+    this->totalLength = tilingData->n * tilingData->k;
+    this->coreNum = tilingData->coreNum;
+    this->n = tilingData->n;
+    this->k = tilingData->k;
+    this->expertNum = tilingData->expertNum;
+    this->expertNumAlign = Align(this->expertNum + 1, sizeof(int32_t));
+    this->expertTokensCountOrCumsumFlag = tilingData->expertTokensCountOrCumsumFlag;
+    this->needCoreNum = this->countSortTilingData->needCoreNum;
+    this->perLoopRows = this->countSortTilingData->perLoopRows;
+    if (this->blockIdx == this->needCoreNum - 1) {
+        this->coreRows = this->countSortTilingData->lastCoreRows;
+    } else {
+        this->coreRows = this->countSortTilingData->perCoreRows;
+    }
+
+    int64_t totalLengthAlign = Align(this->totalLength, sizeof(int32_t));
+    expertIdxGm.SetGlobalBuffer((__gm__ int32_t *)expertIdx, this->totalLength);
+    sortedexpertIdxGm.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(workspace), totalLengthAlign);
+    expandDstToSrcRowGm.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(workspace) + totalLengthAlign,
+                                        totalLengthAlign);
+    histGm.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(workspace) + totalLengthAlign * WORK_GM_NUM,
+                           this->coreNum * this->expertNumAlign);
+    if (this->expertTokensCountOrCumsumFlag > EXERPT_TOKENS_NONE) {
+        expertTokensCountOrCumsumGm.SetGlobalBuffer((__gm__ int32_t *)expertTokensCountOrCumsum,
+                                                    this->expertNumAlign);
+    }
+
+    int64_t dstBufferSize = (this->perLoopRows + this->expertNumAlign * INT32_ONE_BLOCK_NUM) * sizeof(int32_t);
+    pipe->InitBuffer(expertIdxBuffer, AlignBytes(this->perLoopRows, sizeof(int32_t)));
+    pipe->InitBuffer(dstRowBuffer, dstBufferSize);
+    pipe->InitBuffer(dstExpertBuffer, dstBufferSize);
+    pipe->InitBuffer(expertBuffer, this->expertNumAlign * sizeof(int32_t) * EXPERT_BUFFER_NUM);
+
+    expertIdxLocal = expertIdxBuffer.Get<int32_t>();
+    dstRowLocal = dstRowBuffer.Get<int32_t>();
+    dstExpertLocal = dstExpertBuffer.Get<int32_t>();
+    LocalTensor<int32_t> expertLocal = expertBuffer.Get<int32_t>();
+    countLocal = expertLocal;
+    totalLocal = expertLocal[this->expertNumAlign];
+    offsetLocal = expertLocal[this->expertNumAlign * 2];
+    loadLocal = expertLocal[this->expertNumAlign * 3];
+    runStartLocal = expertLocal[this->expertNumAlign * 4];
+    runCursorLocal = expertLocal[this->expertNumAlign * 5];
+}
+
+__aicore__ inline void MoeV2CountSort::Process()
+{
+    if (this->blockIdx < this->needCoreNum) {
+        Histogram();
+    }
+    this->SyncAll();
+    if (this->blockIdx < this->needCoreNum) {
+        ComputeOffsets();
+        CopyOutExpertTokens();
+        Scatter();
+    }
+    this->SyncAll();
+}
+}  // namespace MoeInitRoutingQuantV2
+#endif  // INNER_MOE_V2_COUNT_SORT_H
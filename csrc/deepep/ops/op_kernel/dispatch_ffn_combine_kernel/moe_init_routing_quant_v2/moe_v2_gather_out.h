@@ -21,15 +21,15 @@
 namespace MoeInitRoutingQuantV2 {
 using namespace AscendC;
 using namespace optiling;
-constexpr int64_t BUFFER_NUM = 2;
 
 template <typename T>
 class MoeV2GatherOut
 {
 public:
     __aicore__ inline MoeV2GatherOut(){};
+    template <typename TilingData>
     __aicore__ inline void Init(GM_ADDR inputX, GM_ADDR expandedRowIdx, GM_ADDR expandedX, GM_ADDR workspace,
-                                const InnerMoeInitRoutingV2TilingData *tilingData, TPipe *tPipe);
+                                const TilingData *tilingData, TPipe *tPipe);
     __aicore__ inline void Process();
 
 private:
@@ -37,6 +37,8 @@ private:
     __aicore__ inline void CopyOut(int64_t progress);
 
 private:
+    static constexpr int64_t BUFFER_NUM = 2;
+
     TPipe *pipe;
     TQueBind<QuePosition::VECIN, QuePosition::VECOUT, BUFFER_NUM> inputActivationsCopyInQueue;
     TQue<QuePosition::VECIN, BUFFER_NUM> expandDstToSrcRowCopyInQueue;
@@ -129,9 +131,9 @@ __aicore__ inline void MoeV2GatherOut<T>::CopyOut(int64_t progress)
 }
 
 template <typename T>
+template <typename TilingData>
 __aicore__ inline void MoeV2GatherOut<T>::Init(GM_ADDR inputX, GM_ADDR expandedRowIdx, GM_ADDR expandedX,
-                                               GM_ADDR workspace, const InnerMoeInitRoutingV2TilingData *tilingData,
-                                               TPipe *tPipe)
+                                               GM_ADDR workspace, const TilingData *tilingData, TPipe *tPipe)
 {
     this->pipe = tPipe;
     this->blockIdx = get_block_idx() + get_subblockid() * get_block_num();
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Huawei Technologies Co., Ltd.
+ * This file is a part of the CANN Open Software.
+ * Licensed under CANN Open Software License Agreement Version 1.0 (the "License").
+ * Please refer to the License for details. You may not use this file except in compliance with the License.
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY, OR FITNESS FOR A PARTICULAR PURPOSE.
+ * See LICENSE in the root of the software repository for the full text of the License.
+ */
+
+#ifndef CATLASS_EPILOGUE_BLOCK_EPILOGUE_SWIGLU_HPP
+#define CATLASS_EPILOGUE_BLOCK_EPILOGUE_SWIGLU_HPP
+
+#include "catlass/catlass.hpp"
+#include "catlass/arch/resource.hpp"
+#include "catlass/epilogue/dispatch_policy.hpp"
+#include "catlass/gemm_coord.hpp"
+#include "catlass/matrix_coord.hpp"
+#include "catlass/layout/layout.hpp"
+#include "catlass/detail/callback.hpp"
+
+namespace Catlass::Epilogue::Block {
+
+// Unquantized swiglu, C and D share the activation dtype (fp16 / bf16)
+template <uint32_t UB_STAGES_, class CType_, class DType_, class TileCopy_>
+class BlockEpilogue<EpilogueAtlasA2Swiglu<UB_STAGES_>, CType_, DType_, TileCopy_>
+{
+public:
+    using DispatchPolicy = EpilogueAtlasA2Swiglu<UB_STAGES_>;
+    using ArchTag = typename DispatchPolicy::ArchTag;
+    static constexpr uint32_t UB_STAGES = UB_STAGES_;
+
+    // Data infos
+    using ElementC = typename CType_::Element;
+    using LayoutC = typename CType_::Layout;
+    using ElementD = typename DType_::Element;
+    using LayoutD = typename DType_::Layout;
+
+    // Check data infos
+    static_assert((std::is_same_v<ElementC, half> || std::is_same_v<ElementC, bfloat16_t>) &&
+                      std::is_same_v<ElementC, ElementD>,
+                  "The element type template parameters of BlockEpilogue are wrong");
+    static_assert(std::is_same_v<LayoutC, layout::RowMajor> && std::is_same_v<LayoutD, layout::RowMajor>,
+                  "The layout template parameters of BlockEpilogue are wrong");
+
+    // Tile copy
+    using CopyGmToUbC = typename TileCopy_::CopyGmToUbC;
+    using CopyUbToGmD = typename TileCopy_::CopyUbToGmD;
+
+    CATLASS_DEVICE
+    BlockEpilogue(Arch::Resource<ArchTag> const &resource, int32_t n)
+    {
+        size_t ubOffset = 0;
+        uint32_t blockN = n;
+        uint32_t chunkTileLen = blockN / 2;
+
+        for (uint32_t i = 0; i < UB_STAGES; ++i) {
+            ubCList[i] = resource.ubBuf.template GetBufferByByte<ElementC>(ubOffset);
+            ubOffset += blockN * sizeof(ElementC);
+            ubDList[i] = resource.ubBuf.template GetBufferByByte<ElementD>(ubOffset);
+            ubOffset += chunkTileLen * sizeof(ElementD);
+            ubCFp32List[i] = resource.ubBuf.template GetBufferByByte<float>(ubOffset);
+            ubOffset += blockN * sizeof(float);
+            ubCFp32ChunkNList[i] = resource.ubBuf.template GetBufferByByte<float>(ubOffset);
+            ubOffset += chunkTileLen * sizeof(float);
+
+            eventUbCVMTE2List[i] = i;
+            eventUbCMTE2VList[i] = i;
+            eventUbDMTE3VList[i] = i;
+            eventUbDVMTE3List[i] = i;
+
+            AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventUbCVMTE2List[i]);
+            AscendC::SetFlag<AscendC::HardEvent::MTE3_V>(eventUbDMTE3VList[i]);
+        }
+    }
+
+    CATLASS_DEVICE
+    void Finalize()
+    {
+        for (uint32_t i = 0; i < UB_STAGES; ++i) {
+            AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventUbCVMTE2List[i]);
+            AscendC::WaitFlag<AscendC::HardEvent::MTE3_V>(eventUbDMTE3VList[i]);
+        }
+    }
+
+    CATLASS_DEVICE
+    ~BlockEpilogue() {}
+
+    // Each tile is one token row [1, n]; the gate half is activated and multiplied by the up half
+    CATLASS_DEVICE
+    void operator()(AscendC::GlobalTensor<ElementC> const &gmC, MatrixCoord const &shapeC,
+                    AscendC::GlobalTensor<ElementD> const &gmD, uint32_t epilogueCoreNum = 40)
+    {
+        uint32_t blockM = shapeC.row();
+        uint32_t blockN = shapeC.column();
+        uint32_t subblockIdx = get_block_idx() + get_subblockid() * get_block_num();
+        uint32_t subblockNum = get_block_num() * 2;
+        uint32_t moveDataCoreNum = subblockNum - epilogueCoreNum;
+
+        if (subblockIdx < moveDataCoreNum) {
+            return;
+        }
+        uint32_t epilogueCoreIdx = subblockIdx - moveDataCoreNum;
+
+        uint32_t perCoreData = blockM / epilogueCoreNum;
+        uint32_t remainderData = blockM % epilogueCoreNum;
+        uint32_t tasksForIdx = epilogueCoreIdx < remainderData ? perCoreData + 1 : perCoreData;
+        uint32_t loopStartIdx =
+            epilogueCoreIdx * perCoreData + (epilogueCoreIdx < remainderData ? epilogueCoreIdx : remainderData);
+
+        uint32_t chunkTileLen = blockN / 2;
+        LayoutC layoutUbC{1, blockN};
+        LayoutD layoutUbD{1, chunkTileLen};
+
+        for (uint32_t loopIdx = loopStartIdx; loopIdx < loopStartIdx + tasksForIdx; ++loopIdx) {
+            auto &ubC = ubCList[ubListId];
+            auto &ubD = ubDList[ubListId];
+            auto &ubCFp32 = ubCFp32List[ubListId];
+            auto &ubCFp32ChunkN = ubCFp32ChunkNList[ubListId];
+
+            AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventUbCVMTE2List[ubListId]);
+            copyGmToUbC(ubC, gmC[loopIdx * blockN], layoutUbC, layoutUbC);
+            AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(eventUbCMTE2VList[ubListId]);
+
+            AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(eventUbCMTE2VList[ubListId]);
+            AscendC::Cast(ubCFp32, ubC, AscendC::RoundMode::CAST_NONE, blockN);
+            AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventUbCVMTE2List[ubListId]);
+            AscendC::PipeBarrier<PIPE_V>();
+
+            // silu(gate) = gate / (1 + exp(-gate))
+            AscendC::Muls(ubCFp32ChunkN, ubCFp32, -1.0f, chunkTileLen);
+            AscendC::PipeBarrier<PIPE_V>();
+            AscendC::Exp(ubCFp32ChunkN, ubCFp32ChunkN, chunkTileLen);
+            AscendC::PipeBarrier<PIPE_V>();
+            AscendC::Adds(ubCFp32ChunkN, ubCFp32ChunkN, 1.0f, chunkTileLen);
+            AscendC::PipeBarrier<PIPE_V>();
+            AscendC::Div(ubCFp32ChunkN, ubCFp32, ubCFp32ChunkN, chunkTileLen);
+            AscendC::PipeBarrier<PIPE_V>();
+            AscendC::Mul(ubCFp32ChunkN, ubCFp32ChunkN, ubCFp32[chunkTileLen], chunkTileLen);
+            AscendC::PipeBarrier<PIPE_V>();
+
+            AscendC::WaitFlag<AscendC::HardEvent::MTE3_V>(eventUbDMTE3VList[ubListId]);
+            AscendC::Cast(ubD, ubCFp32ChunkN, AscendC::RoundMode::CAST_RINT, chunkTileLen);
+            AscendC::SetFlag<AscendC::HardEvent::V_MTE3>(eventUbDVMTE3List[ubListId]);
+
+            AscendC::WaitFlag<AscendC::HardEvent::V_MTE3>(eventUbDVMTE3List[ubListId]);
+            copyUbToGmD(gmD[loopIdx * chunkTileLen], ubD, layoutUbD, layoutUbD);
+            AscendC::SetFlag<AscendC::HardEvent::MTE3_V>(eventUbDMTE3VList[ubListId]);
+            ubListId = (ubListId + 1 < UB_STAGES) ? (ubListId + 1) : 0;
+        }
+    }
+
+private:
+    AscendC::LocalTensor<ElementC> ubCList[UB_STAGES];
+    AscendC::LocalTensor<ElementD> ubDList[UB_STAGES];
+    AscendC::LocalTensor<float> ubCFp32List[UB_STAGES];
+    AscendC::LocalTensor<float> ubCFp32ChunkNList[UB_STAGES];
+
+    int32_t eventUbCVMTE2List[UB_STAGES];
+    int32_t eventUbCMTE2VList[UB_STAGES];
+    int32_t eventUbDMTE3VList[UB_STAGES];
+    int32_t eventUbDVMTE3List[UB_STAGES];
+
+    uint32_t ubListId{0};
+
+    CopyGmToUbC copyGmToUbC;
+    CopyUbToGmD copyUbToGmD;
+};
+
+}  // namespace Catlass::Epilogue::Block
+
+#endif  // CATLASS_EPILOGUE_BLOCK_EPILOGUE_SWIGLU_HPP
@@ -0,0 +1,161 @@
+#ifndef CATLASS_EPILOGUE_BLOCK_EPILOGUE_UNQUANT_V2_HPP
+#define CATLASS_EPILOGUE_BLOCK_EPILOGUE_UNQUANT_V2_HPP
+
+#include "catlass/catlass.hpp"
+#include "catlass/arch/resource.hpp"
+#include "catlass/epilogue/dispatch_policy.hpp"
+#include "catlass/gemm_coord.hpp"
+#include "catlass/matrix_coord.hpp"
+#include "catlass/layout/layout.hpp"
+#include "catlass/detail/callback.hpp"
+
+#include "hccl_shmem.hpp"
+#include "layout3d.hpp"
+
+namespace Catlass::Epilogue::Block {
+// GMM2 already wrote C in the output dtype, so the combine only scatters each tile to its source rank
+template <uint32_t UB_STAGES_, class CType_, class DType_, class TileCopy_>
+class BlockEpilogue<EpilogueAtlasA2UnQuant<UB_STAGES_>, CType_, DType_, TileCopy_>
+{
+public:
+    using DispatchPolicy = EpilogueAtlasA2UnQuant<UB_STAGES_>;
+    using ArchTag = typename DispatchPolicy::ArchTag;
+    static constexpr uint32_t UB_STAGES = UB_STAGES_;
+
+    // Data infos
+    using ElementC = typename CType_::Element;
+    using LayoutC = typename CType_::Layout;
+    using ElementD = typename DType_::Element;
+    using LayoutD = typename DType_::Layout;
+
+    static_assert(std::is_same_v<ElementC, ElementD>,
+                  "The element type template parameters of BlockEpilogue are wrong");
+
+    using CopyGmToUbC = typename TileCopy_::CopyGmToUbC;
+    using CopyUbToGmD = typename TileCopy_::CopyUbToGmD;
+
+    struct Params {
+        __gm__ int32_t *ptrTokenPerExpert{nullptr};
+        int32_t EP;
+        int32_t expertPerRank;
+        int32_t n2;
+        LayoutC layoutC;
+        int32_t n0;
+        int32_t rank;
+        HcclShmem shmem;
+        int32_t offsetD;
+
+        CATLASS_DEVICE
+        Params() {};
+        CATLASS_DEVICE
+        Params(int32_t EP_, int32_t expertPerRank_, int32_t rank_, __gm__ int32_t *ptrTokenPerExpert_, LayoutC layoutC_,
+               int32_t n2_, int32_t n0_, HcclShmem &shmem_, int32_t offsetD_)
+            : ptrTokenPerExpert(ptrTokenPerExpert_),
+              EP(EP_),
+              expertPerRank(expertPerRank_),
+              rank(rank_),
+              layoutC(layoutC_),
+              n2(n2_),
+              n0(n0_),
+              shmem(shmem_),
+              offsetD(offsetD_)
+        {}
+    };
+
+    CATLASS_DEVICE
+    BlockEpilogue(Arch::Resource<ArchTag> const &resource, Params const &params = Params{}) : params(params)
+    {
+        n0 = params.n0;
+        size_t ubOffset = 0;
+        for (int32_t i = 0; i < UB_STAGES; i++) {
+            ubCList[i] = resource.ubBuf.template GetBufferByByte<ElementC>(ubOffset);
+            ubOffset += max_len * sizeof(ElementC);
+            AscendC::SetFlag<AscendC::HardEvent::MTE3_MTE2>(i);
+        }
+        tokenPerExpert.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(params.ptrTokenPerExpert));
+        tokenPerExpertLayout = Layout3D(AlignUp(params.EP * params.expertPerRank, 128), params.expertPerRank);
+    }
+
+    CATLASS_DEVICE
+    void Finalize()
+    {
+        for (int32_t i = 0; i < UB_STAGES; i++) {
+            AscendC::WaitFlag<AscendC::HardEvent::MTE3_MTE2>(i);
+        }
+    }
+    CATLASS_DEVICE
+    ~BlockEpilogue() {}
+    CATLASS_DEVICE
+    void operator()(AscendC::GlobalTensor<ElementC> const &gmC, GemmCoord &blockCoord, GemmCoord &actualBlockShape,
+                    int32_t groupIdx, int32_t preSrcExpertSum, AscendC::GlobalTensor<int32_t> preSumBeforeRank)
+    {
+        auto event_id = ubListId;
+        auto &ubC = ubCList[ubListId];
+        ubListId = (ubListId + 1 < UB_STAGES) ? (ubListId + 1) : 0;
+
+        int32_t gmCOffset = preSrcExpertSum * params.n2 + blockCoord.m() * params.n2 + blockCoord.n();
+        LayoutC layoutGM{actualBlockShape.m(), actualBlockShape.n(), params.n2};
+        LayoutC layoutUB{actualBlockShape.m(), actualBlockShape.n(), n0};
+
+        AscendC::WaitFlag<AscendC::HardEvent::MTE3_MTE2>(event_id);
+        copyGmToUbC(ubC, gmC[gmCOffset], layoutUB, layoutGM);
+        AscendC::SetFlag<AscendC::HardEvent::MTE2_MTE3>(event_id);
+
+        int32_t lenTile = actualBlockShape.m();
+        int32_t stTile = blockCoord.m();
+        int32_t edTile = stTile + lenTile;
+        int32_t preSumRankInExpert = 0;
+        int32_t tileOffset = 0;
+
+        AscendC::WaitFlag<AscendC::HardEvent::MTE2_MTE3>(event_id);
+        for (int32_t dstEpIdx = 0; dstEpIdx < params.EP; dstEpIdx++) {
+            int32_t lenRankInExpert = tokenPerExpert(tokenPerExpertLayout(dstEpIdx, params.rank, groupIdx));
+            int32_t dstExpertOffset = preSumBeforeRank(dstEpIdx * params.expertPerRank + groupIdx);
+            int32_t stRankInExpert = preSumRankInExpert;
+            int32_t edRankInExpert = stRankInExpert + lenRankInExpert;
+            preSumRankInExpert += lenRankInExpert;
+            if (stRankInExpert >= edTile) {
+                break;
+            } else if (edRankInExpert <= stTile) {
+                continue;
+            }
+            int32_t stData = max(stRankInExpert, stTile);
+            int32_t edData = min(edRankInExpert, edTile);
+            uint32_t lenData = edData - stData;
+            if (lenData <= 0) {
+                continue;
+            }
+
+            uint32_t dstOffsetInExpert = 0;
+            if (stTile > stRankInExpert) {
+                dstOffsetInExpert = stTile - stRankInExpert;
+            }
+            AscendC::GlobalTensor<ElementD> gmRemotePeer;
+            __gm__ void *dstPeermemPtr = params.shmem(params.offsetD, dstEpIdx);
+            gmRemotePeer.SetGlobalBuffer(reinterpret_cast<__gm__ ElementD *>(dstPeermemPtr));
+            MatrixCoord dstOffset{dstOffsetInExpert + dstExpertOffset, blockCoord.n()};
+            int64_t gmDstOffset = params.layoutC.GetOffset(dstOffset);
+            LayoutC layoutGM2{lenData, actualBlockShape.n(), params.n2};
+            LayoutC layoutUB2{lenData, actualBlockShape.n(), n0};
+            copyUbToGmD(gmRemotePeer[gmDstOffset], ubC[tileOffset * n0], layoutGM2, layoutUB2);
+            tileOffset += lenData;
+        }
+        AscendC::SetFlag<AscendC::HardEvent::MTE3_MTE2>(event_id);
+    }
+
+private:
+    Params params;
+    AscendC::LocalTensor<ElementC> ubCList[UB_STAGES];
+    uint32_t ubListId{0};
+
+    int32_t max_len = 8 * 32 / 4 * 128;
+    int32_t n0;
+
+    CopyGmToUbC copyGmToUbC;
+    CopyUbToGmD copyUbToGmD;
+
+    AscendC::GlobalTensor<int32_t> tokenPerExpert;
+    Layout3D tokenPerExpertLayout;
+};
+}  // namespace Catlass::Epilogue::Block
+#endif
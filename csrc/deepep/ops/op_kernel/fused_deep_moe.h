@@ -250,6 +250,8 @@ public:
     __aicore__ inline void Process();
 
 private:
+    __aicore__ inline void AccumulateRecvCount(GM_ADDR gmRoundRecvCount);
+
     GM_ADDR gmX_;
     GM_ADDR gmexpertIds_;
     GM_ADDR gmPermuteWeight1_;
@@ -282,6 +284,7 @@ private:
     uint32_t bs_{0};
     uint32_t maxBs_{0};
     uint32_t topK_{0};
+    uint32_t roundNum_{0};
 
     AscendC::TPipe *tpipe_{nullptr};
     __gm__ HcclOpResParam *winContext_{nullptr};
@@ -324,7 +327,9 @@ __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Init(
     globalBs_ = tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.globalBs;
     bs_ = tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.bs;
     topK_ = tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.k;
-    maxBs_ = globalBs_ / epRankSize_;
+    roundNum_ = tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.roundNum;
+    // workspace and window are sized for one round, all rounds reuse them
+    maxBs_ = tilingData->disGmmDeqSwigluQuantGmmDeqComInfo.roundBs;
 
     bool isShareExpert = (epRankId_ < sharedExpertRankNum_);
     if (isShareExpert) {
@@ -340,6 +345,38 @@ __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Init(
     k2_ = n_ / 2;
 }
 
+template <TemplateMC2TypeClass>
+__aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::AccumulateRecvCount(GM_ADDR gmRoundRecvCount)
+{
+    if (AscendC::GetBlockIdx() != 0) {
+        return;
+    }
+    uint32_t recvCountNum = epRankSize_ * groupCount_;
+    uint32_t recvCountSize = RoundUp<UB_ALIGN_BYTE>(recvCountNum * static_cast<uint32_t>(sizeof(int32_t)));
+    AscendC::TPipe tpipe;
+    AscendC::TBuf<> recvCountBuf;
+    tpipe.InitBuffer(recvCountBuf, recvCountSize * 2);
+    AscendC::LocalTensor<int32_t> totalLocal = recvCountBuf.Get<int32_t>();
+    AscendC::LocalTensor<int32_t> roundLocal = totalLocal[recvCountSize / sizeof(int32_t)];
+    AscendC::GlobalTensor<int32_t> totalGm;
+    AscendC::GlobalTensor<int32_t> roundGm;
+    totalGm.SetGlobalBuffer((__gm__ int32_t *)gmOutputRecvCount_);
+    roundGm.SetGlobalBuffer((__gm__ int32_t *)gmRoundRecvCount);
+
+    AscendC::DataCopyExtParams copyParams{1U, static_cast<uint32_t>(recvCountNum * sizeof(int32_t)), 0U, 0U, 0U};
+    AscendC::DataCopyPadExtParams<int32_t> padParams{false, 0U, 0U, 0U};
+    AscendC::DataCopyPad(totalLocal, totalGm, copyParams, padParams);
+    AscendC::DataCopyPad(roundLocal, roundGm, copyParams, padParams);
+    AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(0);
+    AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(0);
+    AscendC::Add(totalLocal, totalLocal, roundLocal, recvCountNum);
+    AscendC::SetFlag<AscendC::HardEvent::V_MTE3>(0);
+    AscendC::WaitFlag<AscendC::HardEvent::V_MTE3>(0);
+    AscendC::DataCopyPad(totalGm, totalLocal, copyParams);
+    AscendC::PipeBarrier<PIPE_ALL>();
+    tpipe.Destroy();
+}
+
 template <TemplateMC2TypeClass>
 __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Process()
 {
@@ -372,7 +409,7 @@ __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Process()
     GM_ADDR gmGroupList = workspaceGM_ + workspaceOffset;
     workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(groupCount_) * sizeof(int64_t));
     GM_ADDR gmExpandIdx = workspaceGM_ + workspaceOffset;
-    workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(bs_) * topK_ * sizeof(int32_t));
+    workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(maxBs_) * topK_ * sizeof(int32_t));
     GM_ADDR gmEpSendCount = workspaceGM_ + workspaceOffset;
     workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(epRankSize_) * groupCount_ * sizeof(int32_t));
     GM_ADDR gmX1Token = workspaceGM_ + workspaceOffset;
@@ -383,20 +420,65 @@ __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Process()
     workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(m_) * k_ * sizeof(ExpandXType));
     GM_ADDR gmResvered = workspaceGM_ + workspaceOffset;
     workspaceOffset += RoundUp<GM_ALIGN_BYTE>(resveredWorkSpaceSize);
+    GM_ADDR gmRoundRecvCount = workspaceGM_ + workspaceOffset;
+    workspaceOffset += RoundUp<GM_ALIGN_BYTE>(static_cast<size_t>(epRankSize_) * groupCount_ * sizeof(int32_t));
 
-    if constexpr (EXEC_FLAG == 0) {
-        if constexpr (g_coreType == AscendC::AIV) {
-            AscendC::TPipe tpipe;
-            MoeDistributeDispatchImpl::CamMoeDistributeDispatch<ExpandXType, int8_t, false, true, false, false>
-                dispatcher;
-            dispatcher.Init(gmX_, gmexpertIds_, gmSmoothScales_, gmX1Token, gmX1Scale, gmExpandIdx, gmGroupList,
-                            gmEpSendCount, gmOutputRecvCount_, nullptr, gmWorkspace, &tpipe, tilingData_);
-            dispatcher.Process();
-            tpipe.Destroy();
-            icache_preload(8);
+    // Each round is a full dispatch -> gmm1 -> gmm2 -> combine over at most maxBs_ tokens per rank. Dispatch and
+    // combine flip the window data state on every Init, so a round behaves exactly like a separate launch.
+    for (uint32_t roundIdx = 0; roundIdx < roundNum_; ++roundIdx) {
+        if (roundIdx > 0) {
+            // the previous combine must be done with the workspace before the next dispatch overwrites it
+            AscendC::PipeBarrier<PIPE_ALL>();
+            AscendC::SyncAll<false>();
         }
-
+        uint32_t roundStart = roundIdx * maxBs_;
+        uint32_t roundBs = (bs_ > roundStart) ? ((bs_ - roundStart < maxBs_) ? (bs_ - roundStart) : maxBs_) : 0;
+        FusedDeepMoeTilingData roundTilingData = *tilingData_;
+        roundTilingData.disGmmDeqSwigluQuantGmmDeqComInfo.bs = roundBs;
+        roundTilingData.disGmmDeqSwigluQuantGmmDeqComInfo.globalBs = maxBs_ * epRankSize_;
+        GM_ADDR gmX = gmX_ + static_cast<size_t>(roundStart) * k_ * sizeof(ExpandXType);
+        GM_ADDR gmExpertIds = gmexpertIds_ + static_cast<size_t>(roundStart) * topK_ * sizeof(ExpandIdxType);
+        GM_ADDR gmExpertScales = gmexpertScales_ + static_cast<size_t>(roundStart) * topK_ * sizeof(float);
+        GM_ADDR gmOutput = gmOutput_ + static_cast<size_t>(roundStart) * k_ * sizeof(ExpandXType);
+        GM_ADDR gmRecvCount = (roundIdx == 0) ? gmOutputRecvCount_ : gmRoundRecvCount;
+
+        if constexpr (EXEC_FLAG == 0) {
+            if constexpr (g_coreType == AscendC::AIV) {
+                AscendC::TPipe tpipe;
+                MoeDistributeDispatchImpl::CamMoeDistributeDispatch<ExpandXType, int8_t, false, true, false, false>
+                    dispatcher;
+                dispatcher.Init(gmX, gmExpertIds, gmSmoothScales_, gmX1Token, gmX1Scale, gmExpandIdx, gmGroupList,
+                                gmEpSendCount, gmRecvCount, nullptr, gmWorkspace, &tpipe, &roundTilingData);
+                dispatcher.Process();
+                tpipe.Destroy();
+                icache_preload(8);
+            }
+
+            AscendC::PipeBarrier<PIPE_ALL>();
+            Arch::CrossCoreFlag gmm1AivFinished{0};
+            if constexpr (g_coreType == AscendC::AIV) {
+                Arch::CrossCoreBarrier<0x0, PIPE_MTE3>();
+                Arch::CrossCoreSetFlag<0x2, PIPE_MTE3>(gmm1AivFinished);
+            } else {
+                Arch::CrossCoreWaitFlag(gmm1AivFinished);
+            }
+        }
+        GmmDeqSwigluQuant<EXEC_FLAG, ExpandXType, Gmm1L1TileShape, Gmm1L0TileShape, Gmm1EpilogueTileShape,
+                          Gmm1BlockScheduler>(
+            gmm1ProblemShape, groupCount_, gmGroupList, gmX1Token, layoutX1, gmPermuteWeight1_, layoutWeight1,
+            gmPermuteScale1_, layoutScale1, gmX1Scale, layoutPerTokenScale1, gmX2, layoutX2, gmPerTokenScale2,
+            layoutPerTokenScale2, gmWorkspace, gmX, gmSmoothScales_, gmExpertIds, gmExpandIdx, gmEpSendCount,
+            gmResvered, gmRecvCount, epRankSize_, epRankId_, moeExpertNum_, moeExpertNumPerRank_, sharedExpertNum_,
+            sharedExpertRankNum_, quantMode_, maxBs_ * epRankSize_, roundBs, topK_, k_);
         AscendC::PipeBarrier<PIPE_ALL>();
+        if constexpr (g_coreType == AscendC::AIV) {
+            if (roundIdx > 0) {
+                // the recv counts of this round are complete once every AIV core is past gmm1
+                Arch::CrossCoreBarrier<0x0, PIPE_MTE3>();
+                AccumulateRecvCount(gmRoundRecvCount);
+            }
+        }
+#ifdef ENABLE_GMM2_COMBINE
         Arch::CrossCoreFlag gmm1AivFinished{0};
         if constexpr (g_coreType == AscendC::AIV) {
             Arch::CrossCoreBarrier<0x0, PIPE_MTE3>();
@@ -404,33 +486,17 @@ __aicore__ inline void FusedDeepMoe<TemplateMC2TypeFunc>::Process()
         } else {
             Arch::CrossCoreWaitFlag(gmm1AivFinished);
         }
-    }
-    GmmDeqSwigluQuant<EXEC_FLAG, ExpandXType, Gmm1L1TileShape, Gmm1L0TileShape, Gmm1EpilogueTileShape,
-                      Gmm1BlockScheduler>(
-        gmm1ProblemShape, groupCount_, gmGroupList, gmX1Token, layoutX1, gmPermuteWeight1_, layoutWeight1,
-        gmPermuteScale1_, layoutScale1, gmX1Scale, layoutPerTokenScale1, gmX2, layoutX2, gmPerTokenScale2,
-        layoutPerTokenScale2, gmWorkspace, gmX_, gmSmoothScales_, gmexpertIds_, gmExpandIdx, gmEpSendCount, gmResvered,
-        gmOutputRecvCount_, epRankSize_, epRankId_, moeExpertNum_, moeExpertNumPerRank_, sharedExpertNum_,
-        sharedExpertRankNum_, quantMode_, globalBs_, bs_, topK_, k_);
-#ifdef ENABLE_GMM2_COMBINE
-    AscendC::PipeBarrier<PIPE_ALL>();
-    Arch::CrossCoreFlag gmm1AivFinished{0};
-    if constexpr (g_coreType == AscendC::AIV) {
-        Arch::CrossCoreBarrier<0x0, PIPE_MTE3>();
-        Arch::CrossCoreSetFlag<0x2, PIPE_MTE3>(gmm1AivFinished);
-    } else {
-        Arch::CrossCoreWaitFlag(gmm1AivFinished);
-    }
 
-    MoeDistributeCombineImpl::CamMoeDistributeCombine<TemplateMC2TypeFunc> combiner;
-    if (g_coreType == AscendC::AIV) {
-        combiner.Init(gmGmm2DepOut, gmexpertIds_, gmExpandIdx, gmEpSendCount, nullptr, gmexpertScales_, gmOutput_,
-                      workspaceGM_, nullptr, tilingData_);
-    }
-    GmmDeq<TemplateMC2TypeFunc, Gmm2L1TileShape, Gmm2L0TileShape, Gmm2EpilogueTileShape, Gmm2BlockScheduler,
-           Gmm2DispatchPolicy>(gmm2ProblemShape, groupCount_, gmGroupList, gmX2, layoutX2, gmWeight2_, layoutWeight2,
-                               gmScale2_, layoutScale2, gmPerTokenScale2, layoutPerTokenScale2, gmGmm2DepOut,
-                               layoutOutput, gmWorkspace, &combiner);
+        MoeDistributeCombineImpl::CamMoeDistributeCombine<TemplateMC2TypeFunc> combiner;
+        if (g_coreType == AscendC::AIV) {
+            combiner.Init(gmGmm2DepOut, gmExpertIds, gmExpandIdx, gmEpSendCount, nullptr, gmExpertScales, gmOutput,
+                          workspaceGM_, nullptr, &roundTilingData);
+        }
+        GmmDeq<TemplateMC2TypeFunc, Gmm2L1TileShape, Gmm2L0TileShape, Gmm2EpilogueTileShape, Gmm2BlockScheduler,
+               Gmm2DispatchPolicy>(gmm2ProblemShape, groupCount_, gmGroupList, gmX2, layoutX2, gmWeight2_,
+                                   layoutWeight2, gmScale2_, layoutScale2, gmPerTokenScale2, layoutPerTokenScale2,
+                                   gmGmm2DepOut, layoutOutput, gmWorkspace, &combiner);
 #endif
+    }
 }
 #endif  // FUSED_DEEP_MOE_H
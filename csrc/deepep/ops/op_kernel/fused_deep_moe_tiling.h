@@ -26,6 +26,8 @@ struct FusedDeepMoeInfo {
     uint32_t h;                    // h
     uint32_t aicNum;               // aivNum
     uint32_t aivNum;               // aivNum
+    uint32_t roundNum;             // dispatch/combine rounds over the HCCL window
+    uint32_t roundBs;              // max tokens per rank in one round
     uint64_t totalUbSize;
     uint64_t totalWinSize;
     uint64_t gmm1HLen;
@@ -38,6 +40,7 @@ struct FusedDeepMoeTilingData {
 };
 
 constexpr uint32_t GM_ALIGN_BYTE = 512;
+constexpr uint32_t UB_ALIGN_BYTE = 32;
 constexpr uint32_t CUSTOM_PRELOAD_STAGES = 1;
 constexpr uint32_t CUSTOM_L1_STAGES = 2;
 constexpr uint32_t CUSTOM_L0A_STAGES = 2;
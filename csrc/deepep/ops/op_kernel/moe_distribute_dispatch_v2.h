@@ -37,6 +37,16 @@ constexpr uint8_t SHARE_RANK_NUM_IDX = 2;
 constexpr uint8_t MOE_NUM_IDX = 3;
 constexpr int32_t BITS_PER_BYTE = 8;
 constexpr uint32_t MAX_UB_SIZE = 170U * 1024U;
+constexpr uint32_t PER_BLOCK_QUANT_MODE = 3U;       // 每token按128通道分块动态量化
+constexpr uint32_t PER_BLOCK_POW2_QUANT_MODE = 4U;  // 分块动态量化，scale向上取整到2的幂
+constexpr uint32_t QUANT_BLOCK_SIZE = 128U;
+constexpr uint32_t QUANT_HALF_BLOCK_SIZE = 64U;  // 一次repeat处理的float个数
+constexpr uint32_t MAX_QUANT_BLOCK_NUM = 64U;    // H_MAX / QUANT_BLOCK_SIZE
+constexpr uint32_t BLOCK_BRCB_NUM = 8U;          // Brcb将一个scale广播为32B
+constexpr int32_t FP32_MANTISSA_BITS = 23;
+constexpr int32_t FP32_MANTISSA_MASK = 0x7FFFFF;
+constexpr float INT8_MAX_RECIPROCAL = 1.0f / 127.0f;
+constexpr float MIN_BLOCK_SCALE = 1e-10f;  // 全0 block保护，避免倒数为inf
 
 #define TemplateMC2TypeClass                                                                               \
     typename XType, typename ExpandXOutType, bool StaticQuant, bool DynamicQuant, bool IsSmoothScaleExist, \
@@ -72,6 +82,7 @@ private:
     __aicore__ inline void ZeroComputeExpertMaskCal();
     __aicore__ inline void ReduceMaxInplace(const LocalTensor<float> &srcLocal, uint32_t count);
     __aicore__ inline void QuantProcess(uint32_t expertIndex);
+    __aicore__ inline void BlockQuantProcess(const LocalTensor<float> &floatLocalTemp);
     __aicore__ inline void SetStatus();
     __aicore__ inline void BufferInit();
     __aicore__ inline void InitElasticInfo(bool isWaitDispatch = false);
@@ -166,6 +177,7 @@ private:
     TBuf<> sumContinueBuf_;
     TBuf<> scalarBuf_;  // 辅助gather tensor定义
     TBuf<> rowMaxBuf_;
+    TBuf<> blockScaleBuf_;
     TBuf<> receiveDataCastFloatBuf_;
     TBuf<> smoothScalesBuf_;
     TBuf<> dstExpBuf_;
@@ -224,6 +236,8 @@ private:
     uint32_t hAlignWinCnt_{0};
     uint32_t hOutAlignUbSize_{0};
     uint32_t hOutSizeAlign_{0};
+    uint32_t scaleNum_{1};  // 每个token的scale个数，分块量化时为h/128
+    uint32_t quantBlockNum_{0};
     uint32_t startExpertId_;
     uint32_t endExpertId_;
     uint32_t sendExpertNum_;
@@ -242,6 +256,8 @@ private:
     bool hasElasticInfoFlag_ = false;
     bool isScalingDownFlag_ = false;
     bool isShareExpertRankFlag_ = false;
+    bool isBlockQuant_ = false;
+    bool isPow2Scale_ = false;
     float sumTarget_;
     uint64_t totalWinSize_{0};
     uint32_t gatherCount_{0};
@@ -362,11 +378,17 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::Init(
     sendTpCountOutGM_ = tpSendCountsOut;
     recvCntWorkspaceGM_ = workspaceGM;
 
+    uint32_t quantMode = tilingData->moeDistributeDispatchV2Info.quantMode;
+    isBlockQuant_ = (quantMode == PER_BLOCK_QUANT_MODE) || (quantMode == PER_BLOCK_POW2_QUANT_MODE);
+    isPow2Scale_ = (quantMode == PER_BLOCK_POW2_QUANT_MODE);
+    quantBlockNum_ = axisH_ / QUANT_BLOCK_SIZE;
+    scaleNum_ = isBlockQuant_ ? quantBlockNum_ : 1U;
     hOutSize_ = axisH_ * sizeof(ExpandXOutType);
     hOutSizeAlign_ = Ceil(hOutSize_, UB_ALIGN) * UB_ALIGN;  // scale起始放置偏移
-    uint32_t hScaleSizeAlign = hOutSizeAlign_ + UB_ALIGN;   // 填充三元组起始偏移
+    // 填充三元组起始偏移
+    uint32_t hScaleSizeAlign = hOutSizeAlign_ + Ceil(scaleNum_ * sizeof(float), UB_ALIGN) * UB_ALIGN;
     tokenQuantAlign_ = hScaleSizeAlign / sizeof(int32_t);
-    // 实际搬运大小，搬运token_align32B + 32B(float) + 3*4B(三元组)
+    // 实际搬运大小，搬运token_align32B + scale_align32B(1个或h/128个float) + 3*4B(三元组)
     uint32_t hScaleIdxSize = hScaleSizeAlign + EXPAND_IDX_INFO * sizeof(int32_t);
     hAlignWinSize_ = Ceil(hScaleIdxSize, WIN_ADDR_ALIGN) * WIN_ADDR_ALIGN;  // win区token起始地址对齐512
     hAlignWinCnt_ = hAlignWinSize_ / sizeof(ExpandXOutType);
@@ -498,7 +520,7 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::Init(
     subExpIdTensor_ = subExpBuf_.Get<int32_t>();
 
     uint32_t axisHCommu = hScaleIdxSize / sizeof(ExpandXOutType);  // 有效搬运长度
-    floatDataCopyParams_ = {1U, sizeof(float), 0U, 0U, 0U};
+    floatDataCopyParams_ = {1U, static_cast<uint32_t>(scaleNum_ * sizeof(float)), 0U, 0U, 0U};
     xCopyParams_ = {1U, static_cast<uint32_t>(axisH_ * sizeof(XType)), 0U, 0U, 0U};
     hCommuCopyOutParams_ = {1U, static_cast<uint32_t>(axisHCommu * sizeof(ExpandXOutType)), 0U, 0U, 0U};
     expandXCopyParams_ = {1U, static_cast<uint32_t>(axisH_ * sizeof(ExpandXOutType)), 0U, 0U, 0U};
@@ -516,6 +538,12 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::QuantInit(G
     scalesGMTensor_.SetGlobalBuffer((__gm__ float *)scales);
     if constexpr (DynamicQuant) {
         tpipe_->InitBuffer(rowMaxBuf_, UB_ALIGN);  // 32B
+        if (isBlockQuant_) {
+            // block量化系数 + Brcb广播结果
+            uint32_t blockScaleSize = MAX_QUANT_BLOCK_NUM * (1U + BLOCK_BRCB_NUM) * sizeof(float);
+            tpipe_->InitBuffer(blockScaleBuf_, blockScaleSize);  // 2.25K
+            totalUsedUB_ += blockScaleSize;
+        }
     }
     uint32_t tmpTotalUB = totalUsedUB_ + BUFFER_NUM * hAlignSize + hOutAlignUbSize_ * BUFFER_NUM;
     bufferNum_ = tmpTotalUB > MAX_UB_SIZE ? BUFFER_SINGLE : BUFFER_NUM;
@@ -1013,18 +1041,22 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::QuantProces
     }
 
     if constexpr (DynamicQuant) {
-        LocalTensor<float> floatLocalAbsTemp = smoothScalesBuf_.Get<float>();
-        rowMaxTensor_ = rowMaxBuf_.Get<float>();
-
-        Abs(floatLocalAbsTemp, floatLocalTemp, axisH_);
-        PipeBarrier<PIPE_V>();
-        ReduceMaxInplace(floatLocalAbsTemp, axisH_);
-
-        SyncFunc<AscendC::HardEvent::V_S>();
-        dynamicScale = float(127.0) / floatLocalAbsTemp.GetValue(0);
-        SyncFunc<AscendC::HardEvent::S_V>();
-        Muls(floatLocalTemp, floatLocalTemp, dynamicScale, axisH_);
-        PipeBarrier<PIPE_V>();
+        if (isBlockQuant_) {
+            BlockQuantProcess(floatLocalTemp);
+        } else {
+            LocalTensor<float> floatLocalAbsTemp = smoothScalesBuf_.Get<float>();
+            rowMaxTensor_ = rowMaxBuf_.Get<float>();
+
+            Abs(floatLocalAbsTemp, floatLocalTemp, axisH_);
+            PipeBarrier<PIPE_V>();
+            ReduceMaxInplace(floatLocalAbsTemp, axisH_);
+
+            SyncFunc<AscendC::HardEvent::V_S>();
+            dynamicScale = float(127.0) / floatLocalAbsTemp.GetValue(0);
+            SyncFunc<AscendC::HardEvent::S_V>();
+            Muls(floatLocalTemp, floatLocalTemp, dynamicScale, axisH_);
+            PipeBarrier<PIPE_V>();
+        }
     }
     LocalTensor<half> halfLocalTemp = floatLocalTemp.ReinterpretCast<half>();
     LocalTensor<int32_t> int32LocalTemp = floatLocalTemp.ReinterpretCast<int32_t>();
@@ -1038,8 +1070,55 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::QuantProces
     PipeBarrier<PIPE_V>();
     Cast(xOutTensor_, halfLocalTemp, RoundMode::CAST_TRUNC, axisH_);
 
-    floatLocalTemp = xOutTensor_.template ReinterpretCast<float>();
-    floatLocalTemp.SetValue(hOutSizeAlign_ / sizeof(float), float(1.0) / dynamicScale);  // int8->float32
+    if (!isBlockQuant_) {  // 分块量化的scale已在BlockQuantProcess中写入
+        floatLocalTemp = xOutTensor_.template ReinterpretCast<float>();
+        floatLocalTemp.SetValue(hOutSizeAlign_ / sizeof(float), float(1.0) / dynamicScale);  // int8->float32
+    }
+}
+
+// 每token按128通道分块量化，反量化scale(absmax/127)直接写入xOutTensor_的scale区
+template <TemplateMC2TypeClass>
+__aicore__ inline void
+MoeDistributeDispatchV2<TemplateMC2TypeFunc>::BlockQuantProcess(const LocalTensor<float> &floatLocalTemp)
+{
+    LocalTensor<float> floatLocalAbsTemp = smoothScalesBuf_.Get<float>();
+    LocalTensor<float> blockScaleTensor = xOutTensor_.template ReinterpretCast<float>()[hOutSizeAlign_ / sizeof(float)];
+    LocalTensor<float> blockQuantScaleTensor = blockScaleBuf_.Get<float>();
+    LocalTensor<float> blockBrcbTensor = blockQuantScaleTensor[MAX_QUANT_BLOCK_NUM];
+    uint8_t blockNum = static_cast<uint8_t>(quantBlockNum_);
+
+    Abs(floatLocalAbsTemp, floatLocalTemp, axisH_);
+    PipeBarrier<PIPE_V>();
+    // block前后两半取max，结果留在前半，再逐block规约
+    Max(floatLocalAbsTemp, floatLocalAbsTemp, floatLocalAbsTemp[QUANT_HALF_BLOCK_SIZE], QUANT_HALF_BLOCK_SIZE,
+        blockNum, {1, 1, 1, 16, 16, 16});
+    PipeBarrier<PIPE_V>();
+    WholeReduceMax(blockScaleTensor, floatLocalAbsTemp, QUANT_HALF_BLOCK_SIZE, blockNum, 1, 1, 16,
+                   ReduceOrder::ORDER_ONLY_VALUE);
+    PipeBarrier<PIPE_V>();
+    Muls(blockScaleTensor, blockScaleTensor, INT8_MAX_RECIPROCAL, quantBlockNum_);
+    PipeBarrier<PIPE_V>();
+    Maxs(blockScaleTensor, blockScaleTensor, MIN_BLOCK_SCALE, quantBlockNum_);
+    PipeBarrier<PIPE_V>();
+    if (isPow2Scale_) {
+        // 尾数非0时指数进1后清零尾数，即向上取整到2的幂，保证量化后不溢出
+        LocalTensor<int32_t> scaleBitsTensor = blockScaleTensor.template ReinterpretCast<int32_t>();
+        Adds(scaleBitsTensor, scaleBitsTensor, FP32_MANTISSA_MASK, quantBlockNum_);
+        PipeBarrier<PIPE_V>();
+        ShiftRight(scaleBitsTensor, scaleBitsTensor, FP32_MANTISSA_BITS, quantBlockNum_);
+        PipeBarrier<PIPE_V>();
+        ShiftLeft(scaleBitsTensor, scaleBitsTensor, FP32_MANTISSA_BITS, quantBlockNum_);
+        PipeBarrier<PIPE_V>();
+    }
+    Reciprocal(blockQuantScaleTensor, blockScaleTensor, quantBlockNum_);
+    PipeBarrier<PIPE_V>();
+    // 每个量化系数广播为一个32B datablock，按block相乘时src1的datablock步长为0
+    Brcb(blockBrcbTensor, blockQuantScaleTensor, static_cast<uint8_t>(Ceil(quantBlockNum_, BLOCK_BRCB_NUM)), {1, 8});
+    PipeBarrier<PIPE_V>();
+    Mul(floatLocalTemp, floatLocalTemp, blockBrcbTensor, QUANT_HALF_BLOCK_SIZE, blockNum, {1, 1, 0, 16, 16, 1});
+    Mul(floatLocalTemp[QUANT_HALF_BLOCK_SIZE], floatLocalTemp[QUANT_HALF_BLOCK_SIZE], blockBrcbTensor,
+        QUANT_HALF_BLOCK_SIZE, blockNum, {1, 1, 0, 16, 16, 1});
+    PipeBarrier<PIPE_V>();
 }
 
 template <TemplateMC2TypeClass>
@@ -1289,8 +1368,8 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::LocalWindow
                         dataCopyExpandIdxParams);
             if constexpr (DynamicQuant || StaticQuant) {
                 xOutFp32Tensor_ = xTmpTensor_.template ReinterpretCast<float>();
-                DataCopyPad(dynamicScalesOutGMTensor_[beginIdx + j], xOutFp32Tensor_[hOutSizeAlign_ / sizeof(float)],
-                            floatDataCopyParams_);
+                DataCopyPad(dynamicScalesOutGMTensor_[(beginIdx + j) * scaleNum_],
+                            xOutFp32Tensor_[hOutSizeAlign_ / sizeof(float)], floatDataCopyParams_);
             }
             if constexpr (IsNeedAllgather) {
                 DataCopyPad(winTpGatherOutGMTensor_[(beginIdx + j) * hAlignWinCnt_], xTmpTensor_, hCommuCopyOutParams_);
@@ -1403,7 +1482,7 @@ __aicore__ inline void MoeDistributeDispatchV2<TemplateMC2TypeFunc>::AllgatherPr
         DataCopyPad(expandXOutGlobal, xTmpTensor_, expandXCopyParams_);
         if constexpr (StaticQuant || DynamicQuant) {
             xOutFp32Tensor_ = xTmpTensor_.template ReinterpretCast<float>();
-            DataCopyPad(dynamicScalesOutGMTensor_[preCount + totalCnt_ + i],
+            DataCopyPad(dynamicScalesOutGMTensor_[(preCount + totalCnt_ + i) * scaleNum_],
                         xOutFp32Tensor_[hOutSizeAlign_ / sizeof(float)], floatDataCopyParams_);
         }
         xQueue_.FreeTensor(xTmpTensor_);
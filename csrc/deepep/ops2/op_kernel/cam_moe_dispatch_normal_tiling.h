@@ -12,6 +12,7 @@ struct CamMoeDispatchNormalInfo {
     uint32_t globalBs;      // globalBs = BS * worldSize
     uint32_t round;
     uint32_t perRoundTokens;
+    uint32_t recvTokenCap;  // expandX rows, the kernel never writes past them
     uint32_t bs;            // bs
     uint32_t k;             // k
     uint32_t h;             // h
@@ -20,9 +20,14 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m)
         .def(pybind11::init<int, int, int, int, int>(), py::arg("num_sms") = 20,
              py::arg("num_max_nvl_chunked_send_tokens") = 6, py::arg("num_max_nvl_chunked_recv_tokens") = 256,
              py::arg("num_max_rdma_chunked_send_tokens") = 6, py::arg("num_max_rdma_chunked_recv_tokens") = 256)
-        .def("get_nvl_buffer_size_hint", &deep_ep::Config::get_nvl_buffer_size_hint)
-        .def("get_rdma_buffer_size_hint", &deep_ep::Config::get_rdma_buffer_size_hint);
-    m.def("get_low_latency_rdma_size_hint", &deep_ep::get_low_latency_rdma_size_hint);
+        .def("get_nvl_buffer_size_hint", &deep_ep::Config::get_nvl_buffer_size_hint, py::arg("hidden_bytes"),
+             py::arg("num_ranks"), py::arg("num_topk") = deep_ep::NUM_MAX_TOPK)
+        .def("get_rdma_buffer_size_hint", &deep_ep::Config::get_rdma_buffer_size_hint, py::arg("hidden_bytes"),
+             py::arg("num_ranks"), py::arg("num_experts") = 0);
+    m.def("get_low_latency_rdma_size_hint", &deep_ep::get_low_latency_rdma_size_hint,
+          py::arg("num_max_dispatch_tokens_per_rank"), py::arg("hidden"), py::arg("num_ranks"), py::arg("num_experts"),
+          py::arg("num_topk") = deep_ep::NUM_MAX_TOPK);
+    m.def("get_hccl_window_bytes", &deep_ep::get_hccl_window_bytes);
 
     pybind11::class_<deep_ep::EventHandle>(m, "EventHandle")
         .def(pybind11::init<>())
@@ -35,6 +40,10 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m)
         .def("get_rdma_rank", &deep_ep::Buffer::get_rdma_rank)
         .def("get_dispatch_layout", &deep_ep::Buffer::get_dispatch_layout)
         .def("get_notify_send_data", &deep_ep::Buffer::get_notify_send_data)
+        .def("set_expert_location_map", &deep_ep::Buffer::set_expert_location_map)
+        .def("clear_expert_location_map", &deep_ep::Buffer::clear_expert_location_map)
+        .def("get_expert_load_stats", &deep_ep::Buffer::get_expert_load_stats)
+        .def("fit_normal_rounds", &deep_ep::Buffer::fit_normal_rounds)
         .def("clean_low_latency_buffer", &deep_ep::Buffer::clean_low_latency_buffer)
         .def("intranode_dispatch", &deep_ep::Buffer::intranode_dispatch)
         .def("notify_verify", &deep_ep::Buffer::notify_verify)
@@ -43,6 +52,7 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m)
         .def("internode_combine", &deep_ep::Buffer::internode_combine)
         .def("low_latency_dispatch", &deep_ep::Buffer::low_latency_dispatch)
         .def("low_latency_combine", &deep_ep::Buffer::low_latency_combine)
+        .def("get_next_low_latency_combine_buffer", &deep_ep::Buffer::get_next_low_latency_combine_buffer)
         .def("fused_deep_moe", &deep_ep::Buffer::fused_deep_moe)
         .def("dispatch_ffn_combine", &deep_ep::Buffer::dispatch_ffn_combine);
 }
@@ -242,7 +242,11 @@ inline aclTensor *ConvertType(const at::Tensor &at_tensor)
             format = ACL_FORMAT_ND;
     }
 
-    if (acl_data_type == ACL_INT8 && dimNum == 3) {
+    // 3-D int8 weights are always NZ; fp16/bf16 weights carry NZ only when they were cast to it
+    if (dimNum == 3 &&
+        (acl_data_type == ACL_INT8 || (at_tensor.device().is_privateuseone() &&
+                                       at_npu::native::NPUNativeFunctions::get_npu_format(at_tensor) ==
+                                           ACL_FORMAT_FRACTAL_NZ))) {
         format = ACL_FORMAT_FRACTAL_NZ;
     }
 
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <c10/util/accumulate.h>
+
+#include "torch_npu/csrc/core/npu/NPUGuard.h"
+#include "workspace.hpp"
+#include "exception.hpp"
+
+namespace deep_ep {
+
+void WorkspaceArena::begin(const c10_npu::NPUStream &stream)
+{
+    high_water = std::max(high_water, requested);
+    if (!this->stream.has_value() or this->stream.value() != stream or capacity() < high_water) {
+        this->stream = stream;
+        reserve(high_water);
+    }
+    offset = 0;
+    requested = 0;
+}
+
+at::Tensor WorkspaceArena::take(at::IntArrayRef sizes, at::ScalarType dtype)
+{
+    EP_HOST_ASSERT(storage.defined());
+    int64_t num_bytes = c10::multiply_integers(sizes) * static_cast<int64_t>(c10::elementSize(dtype));
+    int64_t aligned_bytes = std::max((num_bytes + ALIGN_BYTES - 1) / ALIGN_BYTES * ALIGN_BYTES, ALIGN_BYTES);
+    requested += aligned_bytes;
+
+    // First call of a new mode or shape: views already taken keep the old storage alive, the rest of this call is
+    // served from a fresh allocation and the next `begin` settles on the high-water mark.
+    if (offset + aligned_bytes > capacity()) {
+        reserve(std::max(capacity() * 2, aligned_bytes));
+    }
+
+    auto view = storage.narrow(0, offset, num_bytes).view(dtype).view(sizes);
+    offset += aligned_bytes;
+    return view;
+}
+
+int64_t WorkspaceArena::capacity() const
+{
+    return storage.defined() ? storage.numel() : 0;
+}
+
+void WorkspaceArena::reserve(int64_t num_bytes)
+{
+    // Allocate on the owning stream, so the caching allocator does not hand a released block to another stream
+    // while kernels of the owning stream may still use it.
+    c10_npu::NPUStreamGuard guard(stream.value());
+    num_bytes = std::max(num_bytes, ALIGN_BYTES);
+    storage = at::empty({num_bytes}, at::dtype(at::kByte).device(stream->device()));
+    offset = 0;
+}
+
+}  // namespace deep_ep
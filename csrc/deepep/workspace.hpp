@@ -0,0 +1,42 @@
+#pragma once
+#include <optional>
+#include <torch/types.h>
+
+#include "torch_npu/csrc/core/npu/NPUStream.h"
+
+namespace deep_ep {
+
+/*
+A device memory arena owned by a Buffer. Metadata tensors that never leave a dispatch/combine call are carved out
+of one persistent allocation instead of going through the caching allocator on every call.
+
+The arena only grows: the first call of each mode records the number of bytes it took, and the next `begin` resizes
+the backing storage to that high-water mark once. Afterwards every call is served from the same allocation.
+Views returned by `take` are valid until the next `begin`. The arena belongs to the stream passed to `begin`, which
+must be the stream every kernel using the views is queued on, so stream order guarantees they are finished before
+the memory is reused.
+*/
+class WorkspaceArena
+{
+public:
+    // Reset the cursor, growing the backing storage to the high-water mark if it is too small.
+    void begin(const c10_npu::NPUStream &stream);
+
+    // Uninitialized view of `sizes` elements of `dtype`, aligned to ALIGN_BYTES.
+    at::Tensor take(at::IntArrayRef sizes, at::ScalarType dtype);
+
+    int64_t capacity() const;
+
+private:
+    static constexpr int64_t ALIGN_BYTES = 512;
+
+    void reserve(int64_t num_bytes);
+
+    std::optional<c10_npu::NPUStream> stream;
+    at::Tensor storage;
+    int64_t offset = 0;
+    int64_t requested = 0;
+    int64_t high_water = 0;
+};
+
+}  // namespace deep_ep
@@ -18,6 +18,7 @@
 
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 #include "aclrtlaunch_sgemmv_expand_half.h"
 #include "aclrtlaunch_sgemmv_expand_bfloat16_t.h"
@@ -25,6 +26,9 @@
 namespace sglang {
 namespace npu_kernel {
 
+// Rows of x and weight staged in UB are sized for this rank
+constexpr int MAX_LORA_RANK = 512;
+
 extern void sgemmv_expand_impl(at::ScalarType type, void *stream, void *x, void *weight, void *loraIndices,
                                uint32_t loraIndicesSize, void *seqLen, uint32_t seqLenSize, void *loraRanks,
                                uint32_t loraRanksSize, void *sliceOffsets, uint32_t sliceOffsetsSize, void *yIn,
@@ -73,18 +77,17 @@ HOST_API at::Tensor sgemmv_expand(at::Tensor &x, at::Tensor &weight, at::Tensor
     int slice_count = slice_offsets_size - 1;
     int batch_size = x.size(0);
     int max_lora_rank = x.size(1) / slice_count;
+    TORCH_CHECK(max_lora_rank <= MAX_LORA_RANK, "lora rank should be no greater than ", MAX_LORA_RANK);
     int output_full_dim = y.size(1);
+    int64_t aiv_num = PlatformInfoRegistry::Get(x.get_device()).coreNumAiv;
+    int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
+    TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
     aclrtStream stream = c10_npu::getCurrentNPUStream().stream();
     at_npu::native::OpCommand cmd;
     cmd.Name("sgemmv_expand");
     cmd.SetCustomHandler([scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                           seq_len_size, lora_ranks_ptr, lora_ranks_size, slice_offsets_ptr, slice_offsets_size, y_ptr,
-                          y_out_ptr, batch_size, max_lora_rank, output_full_dim]() -> int {
-        int device_id = 0;
-        int64_t aiv_num = 0;
-        TORCH_CHECK(aclGetDeviceCapability(device_id, ACL_DEVICE_INFO_VECTOR_CORE_NUM, &aiv_num) == ACL_SUCCESS);
-        int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
-        TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
+                          y_out_ptr, batch_size, max_lora_rank, output_full_dim, num_tokens_per_core]() -> int {
         sgemmv_expand_impl(scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                            seq_len_size, lora_ranks_ptr, lora_ranks_size, slice_offsets_ptr, slice_offsets_size, y_ptr,
                            y_out_ptr, batch_size, num_tokens_per_core, max_lora_rank, output_full_dim);
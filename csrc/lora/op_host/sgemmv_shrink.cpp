@@ -18,6 +18,7 @@
 
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 #include "aclrtlaunch_sgemmv_shrink_half.h"
 #include "aclrtlaunch_sgemmv_shrink_bfloat16_t.h"
@@ -25,6 +26,9 @@
 namespace sglang {
 namespace npu_kernel {
 
+// The per-token output rows staged in UB are sized for this rank
+constexpr int MAX_LORA_RANK = 512;
+
 extern void sgemmv_shrink_impl(at::ScalarType type, void *stream, void *x, void *weight, void *loraIndices,
                                uint32_t loraIndicesSize, void *seqLen, uint32_t seqLenSize, void *loraRanks,
                                uint32_t loraRanksSize, void *loraScales, uint32_t loraScalesSize, void *y,
@@ -71,17 +75,17 @@ HOST_API void sgemmv_shrink(at::Tensor &x, at::Tensor &weight, at::Tensor &lora_
     int batch_size = x.size(0);
     int input_hidden_token = x.size(1);
     uint32_t max_lora_rank = y.size(1);
+    TORCH_CHECK(max_lora_rank <= static_cast<uint32_t>(MAX_LORA_RANK), "lora rank should be no greater than ",
+                MAX_LORA_RANK);
+    int64_t aiv_num = PlatformInfoRegistry::Get(x.get_device()).coreNumAiv;
+    int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
+    TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
     aclrtStream stream = c10_npu::getCurrentNPUStream().stream();
     at_npu::native::OpCommand cmd;
     cmd.Name("sgemmv_shrink");
     cmd.SetCustomHandler([scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                           seq_len_size, lora_ranks_ptr, lora_ranks_size, lora_scales_ptr, lora_scales_size, y_ptr,
-                          batch_size, input_hidden_token, max_lora_rank]() -> int {
-        int device_id = 0;
-        int64_t aiv_num = 0;
-        TORCH_CHECK(aclGetDeviceCapability(device_id, ACL_DEVICE_INFO_VECTOR_CORE_NUM, &aiv_num) == ACL_SUCCESS);
-        int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
-        TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
+                          batch_size, input_hidden_token, max_lora_rank, num_tokens_per_core]() -> int {
         sgemmv_shrink_impl(scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                            seq_len_size, lora_ranks_ptr, lora_ranks_size, lora_scales_ptr, lora_scales_size, y_ptr,
                            batch_size, num_tokens_per_core, input_hidden_token, max_lora_rank);
@@ -18,6 +18,7 @@
 
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 #include "aclrtlaunch_sgmv_expand_half.h"
 #include "aclrtlaunch_sgmv_expand_bfloat16_t.h"
@@ -69,18 +70,19 @@ HOST_API at::Tensor sgmv_expand(at::Tensor &x, at::Tensor &weight, at::Tensor &l
     void *y_out_ptr = y_out.data_ptr();
     int batch_size = x.size(0);
     int lora_rank = x.size(1);
+    TORCH_CHECK(lora_rank == 8 || lora_rank == 16 || lora_rank == 32 || lora_rank == 64,
+                "sgmv_expand supports lora rank 8, 16, 32 or 64, got ", lora_rank,
+                ", use sgemmv_expand for other ranks");
     int output_full_dim = y.size(1);
+    int64_t aiv_num = PlatformInfoRegistry::Get(x.get_device()).coreNumAiv;
+    int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
+    TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
     aclrtStream stream = c10_npu::getCurrentNPUStream().stream();
     at_npu::native::OpCommand cmd;
     cmd.Name("sgmv_expand");
     cmd.SetCustomHandler([scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                           seq_len_size, y_ptr, y_out_ptr, batch_size, lora_rank, slice_offset, slice_size,
-                          output_full_dim]() -> int {
-        int device_id = 0;
-        int64_t aiv_num = 0;
-        TORCH_CHECK(aclGetDeviceCapability(device_id, ACL_DEVICE_INFO_VECTOR_CORE_NUM, &aiv_num) == ACL_SUCCESS);
-        int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
-        TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
+                          output_full_dim, num_tokens_per_core]() -> int {
         sgmv_expand_impl(scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                          seq_len_size, y_ptr, y_out_ptr, batch_size, num_tokens_per_core, lora_rank, slice_size,
                          slice_offset, output_full_dim);
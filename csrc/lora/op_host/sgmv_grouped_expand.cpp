@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "defines.h"
+#include "torch_helper.h"
+#include "platform_info.h"
+
+#include "aclrtlaunch_sgmv_grouped_expand_half.h"
+#include "aclrtlaunch_sgmv_grouped_expand_bfloat16_t.h"
+
+namespace sglang {
+namespace npu_kernel {
+
+// Keep in sync with SGMVGroupedExpand::TOKEN_BLOCK
+constexpr int SGMV_GROUPED_EXPAND_TOKEN_BLOCK = 8;
+// Rows of x and weight staged in UB are sized for this rank
+constexpr int MAX_LORA_RANK = 512;
+
+extern void sgmv_grouped_expand_impl(at::ScalarType type, void *stream, void *x, void *weight, void *loraIndices,
+                                     uint32_t loraIndicesSize, void *seqLen, uint32_t seqLenSize, void *loraRanks,
+                                     uint32_t loraRanksSize, void *sliceOffsets, uint32_t sliceOffsetsSize, void *yIn,
+                                     void *yOut, uint32_t blockDim, uint32_t batchSize, uint32_t maxLoRARank,
+                                     uint32_t outputFullDim)
+{
+    if (type == at::ScalarType::Float) {
+        return;
+    } else if (type == at::ScalarType::BFloat16) {
+        ACLRT_LAUNCH_KERNEL(sgmv_grouped_expand_bfloat16_t)
+        (blockDim, stream, x, weight, loraIndices, loraIndicesSize, seqLen, seqLenSize, loraRanks, loraRanksSize,
+         sliceOffsets, sliceOffsetsSize, yIn, yOut, batchSize, maxLoRARank, outputFullDim);
+    } else {
+        ACLRT_LAUNCH_KERNEL(sgmv_grouped_expand_half)
+        (blockDim, stream, x, weight, loraIndices, loraIndicesSize, seqLen, seqLenSize, loraRanks, loraRanksSize,
+         sliceOffsets, sliceOffsetsSize, yIn, yOut, batchSize, maxLoRARank, outputFullDim);
+    }
+}
+
+HOST_API at::Tensor sgmv_grouped_expand(at::Tensor &x, at::Tensor &weight, at::Tensor &lora_indices,
+                                        at::Tensor &seq_len, at::Tensor &lora_ranks, at::Tensor &slice_offsets,
+                                        at::Tensor &y)
+{
+    at::ScalarType scalar_type = y.scalar_type();
+    TORCH_CHECK(scalar_type == at::kHalf || scalar_type == at::kBFloat16, "only support half and bf16");
+    TORCH_CHECK(x.dim() == 2, "x should be [batch_size, hidden_in]");
+    TORCH_CHECK(weight.dim() == 3 || weight.dim() == 4,
+                "weight should be [num_loras, hidden_out, hidden_in] or [num_loras, 1, hidden_out, hidden_in]");
+    TORCH_CHECK(y.dim() == 2, "y should be [batch_size, hidden_out]");
+
+    at::Tensor y_out = y;
+    void *x_ptr = x.data_ptr();
+    void *weight_ptr = weight.data_ptr();
+    void *y_ptr = y.data_ptr();
+    void *y_out_ptr = y_out.data_ptr();
+
+    void *lora_indices_ptr = lora_indices.data_ptr();
+    int lora_indices_size = lora_indices.size(0);
+    void *seq_len_ptr = seq_len.data_ptr();
+    int seq_len_size = seq_len.size(0);
+    void *lora_ranks_ptr = lora_ranks.data_ptr();
+    int lora_ranks_size = lora_ranks.size(0);
+    void *slice_offsets_ptr = slice_offsets.data_ptr();
+    int slice_offsets_size = slice_offsets.size(0);
+    int slice_count = slice_offsets_size - 1;
+    int batch_size = x.size(0);
+    int max_lora_rank = x.size(1) / slice_count;
+    TORCH_CHECK(max_lora_rank <= MAX_LORA_RANK, "lora rank should be no greater than ", MAX_LORA_RANK);
+    int output_full_dim = y.size(1);
+    // Every segment ends in at most one partial token block, this bounds the work items without reading seq_len
+    int64_t max_work_items =
+        ((batch_size + SGMV_GROUPED_EXPAND_TOKEN_BLOCK - 1) / SGMV_GROUPED_EXPAND_TOKEN_BLOCK + seq_len_size) *
+        slice_count;
+    int64_t aiv_num = PlatformInfoRegistry::Get(x.get_device()).coreNumAiv;
+    uint32_t block_dim = static_cast<uint32_t>(std::min(aiv_num, max_work_items));
+    TORCH_CHECK(block_dim != 0, "block_dim should not be 0");
+    aclrtStream stream = c10_npu::getCurrentNPUStream().stream();
+    at_npu::native::OpCommand cmd;
+    cmd.Name("sgmv_grouped_expand");
+    cmd.SetCustomHandler([scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
+                          seq_len_size, lora_ranks_ptr, lora_ranks_size, slice_offsets_ptr, slice_offsets_size, y_ptr,
+                          y_out_ptr, batch_size, max_lora_rank, output_full_dim, block_dim]() -> int {
+        sgmv_grouped_expand_impl(scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size,
+                                 seq_len_ptr, seq_len_size, lora_ranks_ptr, lora_ranks_size, slice_offsets_ptr,
+                                 slice_offsets_size, y_ptr, y_out_ptr, block_dim, batch_size, max_lora_rank,
+                                 output_full_dim);
+        return 0;
+    });
+    cmd.Run();
+    return y_out;
+}
+
+}  // namespace npu_kernel
+}  // namespace sglang
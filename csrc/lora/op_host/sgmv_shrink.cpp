@@ -18,6 +18,7 @@
 
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 #include "aclrtlaunch_sgmv_shrink_half.h"
 #include "aclrtlaunch_sgmv_shrink_bfloat16_t.h"
@@ -64,16 +65,15 @@ HOST_API void sgmv_shrink(at::Tensor &x, at::Tensor &weight, at::Tensor &lora_in
     int input_hidden_token = x.size(1);
     uint32_t lora_rank = y.size(1);
     float scale_f = static_cast<float>(scale);
+    int64_t aiv_num = PlatformInfoRegistry::Get(x.get_device()).coreNumAiv;
+    int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
+    TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
     aclrtStream stream = c10_npu::getCurrentNPUStream().stream();
     at_npu::native::OpCommand cmd;
     cmd.Name("sgmv_shrink");
     cmd.SetCustomHandler([scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
-                          seq_len_size, y_ptr, batch_size, input_hidden_token, lora_rank, scale_f]() -> int {
-        int device_id = 0;
-        int64_t aiv_num = 0;
-        TORCH_CHECK(aclGetDeviceCapability(device_id, ACL_DEVICE_INFO_VECTOR_CORE_NUM, &aiv_num) == ACL_SUCCESS);
-        int num_tokens_per_core = (batch_size + aiv_num - 1) / aiv_num;
-        TORCH_CHECK(num_tokens_per_core != 0, "num_tokens_per_core should not be 0");
+                          seq_len_size, y_ptr, batch_size, input_hidden_token, lora_rank, scale_f,
+                          num_tokens_per_core]() -> int {
         sgmv_shrink_impl(scalar_type, stream, x_ptr, weight_ptr, lora_indices_ptr, lora_indices_size, seq_len_ptr,
                          seq_len_size, y_ptr, batch_size, num_tokens_per_core, input_hidden_token, lora_rank, scale_f);
         return 0;
@@ -34,6 +34,8 @@ public:
     static constexpr uint64_t LORA_RANK_32 = 32;
     static constexpr uint64_t LORA_RANK_64 = 64;
     static constexpr uint64_t SUPPORTED_RANKS[] = {LORA_RANK_8, LORA_RANK_16, LORA_RANK_32, LORA_RANK_64};
+    // Other ranks are padded in UB to a power of two row of whole repeats
+    static constexpr int32_t MAX_LORA_RANK = 512;
     static constexpr int32_t BUFFER_NUM = 2;
     static constexpr int32_t DATA_VECTOR_BLOCK = 32;
 
@@ -53,7 +55,7 @@ public:
     static constexpr int32_t PAIR_REDUCE_NUM_REPEATS_16 =
         (BLOCK_REDUCE_NUM_REPEATS * NUM_BLOCKS_PER_REPEAT + NUM_ELEMENTS_PER_REPEAT - 1) / NUM_ELEMENTS_PER_REPEAT;
     // The second PairReduceSum for rank=32, needs half of the repetition that happened for rank=16.
-    // Same for rank=64, we do not support ranks greater than 64.
+    // Same for rank=64, larger ranks are reduced per weight row instead, see ComputeLongRank.
     static constexpr int32_t PAIR_REDUCE_NUM_REPEATS_32 = (PAIR_REDUCE_NUM_REPEATS_16 + 1) / 2;
 
 public:
@@ -81,15 +83,17 @@ public:
         loraRanksGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(loraRanks), loraRanksSize);
         sliceOffsetsGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(sliceOffsets), sliceOffsetsSize);
 
-        pipe_->InitBuffer(inQueueX_, 1, NUM_ELEMENTS_PER_REPEAT * sizeof(X_T));
+        pipe_->InitBuffer(inQueueX_, 1, MAX_LORA_RANK * sizeof(X_T));
         pipe_->InitBuffer(inQueueW_, BUFFER_NUM, W_IN_TILE_NUM_ELEMENTS * sizeof(W_T));
         pipe_->InitBuffer(inQueueY_, BUFFER_NUM, Y_OUT_TILE_NUM_ELEMENTS * sizeof(Y_T));
         pipe_->InitBuffer(outQueueY_, BUFFER_NUM, Y_OUT_TILE_NUM_ELEMENTS * sizeof(Y_T));
 
-        pipe_->InitBuffer(dupBufferX_, NUM_ELEMENTS_PER_REPEAT * sizeof(float));
+        pipe_->InitBuffer(dupBufferX_, MAX_LORA_RANK * sizeof(float));
         pipe_->InitBuffer(tmpBufferW_, W_IN_TILE_NUM_ELEMENTS * sizeof(float));
         pipe_->InitBuffer(inBufferY_, Y_OUT_TILE_NUM_ELEMENTS * sizeof(float));
         pipe_->InitBuffer(tmpBufferY_, Y_OUT_TILE_NUM_ELEMENTS * sizeof(float));
+
+        ClearWeightBuffers();
     }
 
     __aicore__ inline void Process()
@@ -121,11 +125,12 @@ public:
             }
 
             reqLoRAWeightOffset_ = reqLoRAIndex_ * singleLoRAWeightLen_ + sliceOffset_ * maxLoRARank_;
+            SetUpWeightRow();
 
             // Each compute iteration would generate not one, but several output elements.
             // Therefore, the following variable would determine how many output elements are calculated in each
             // iteration.
-            numOutputElementsPerInputTile_ = BLOCK_REDUCE_NUM_REPEATS * (NUM_ELEMENTS_PER_REPEAT / reqLoRARank_);
+            numOutputElementsPerInputTile_ = W_IN_TILE_NUM_ELEMENTS / weightRowLen_;
             numStreamInPerOutputTile_ = Y_OUT_TILE_NUM_ELEMENTS / numOutputElementsPerInputTile_;
 
             CopyInX(idx);
@@ -144,6 +149,39 @@ public:
     }
 
 private:
+    __aicore__ inline void ClearWeightBuffers()
+    {
+        // The padding lanes of long-rank rows are never written by the weight copy, keep them finite so that they
+        // vanish against the zero padding of x
+        AscendC::LocalTensor<W_T> wLocals[BUFFER_NUM];
+        for (int32_t i = 0; i < BUFFER_NUM; i++) {
+            wLocals[i] = inQueueW_.AllocTensor<W_T>();
+            Duplicate(wLocals[i].template ReinterpretCast<half>(), static_cast<half>(0), W_IN_TILE_NUM_ELEMENTS);
+        }
+        pipe_barrier(PIPE_V);
+        for (int32_t i = 0; i < BUFFER_NUM; i++) {
+            inQueueW_.FreeTensor(wLocals[i]);
+        }
+        event_t eventIDVToMTE2 = static_cast<event_t>(GetTPipePtr()->FetchEventID(AscendC::HardEvent::V_MTE2));
+        AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventIDVToMTE2);
+        AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventIDVToMTE2);
+    }
+
+    __aicore__ inline void SetUpWeightRow()
+    {
+        // Ranks dividing one repeat share it between several weight rows, the others are padded to whole repeats
+        packedRank_ = reqLoRARank_ <= LORA_RANK_64 && NUM_ELEMENTS_PER_REPEAT % reqLoRARank_ == 0;
+        weightRowLen_ = packedRank_ ? reqLoRARank_ : NUM_ELEMENTS_PER_REPEAT;
+        if (reqLoRARank_ == LORA_RANK_8 && maxLoRARank_ != LORA_RANK_8) {
+            // A rank 8 row is half a block and strided rows cannot share one, so each gets a block of its own and is
+            // reduced like a rank 16 row against a zero padded x
+            weightRowLen_ = LORA_RANK_16;
+        }
+        while (weightRowLen_ < reqLoRARank_) {
+            weightRowLen_ *= 2;
+        }
+    }
+
     __aicore__ inline void CopyInIndex(const int64_t idx)
     {
         // Look up the LoRA index
@@ -167,7 +205,7 @@ private:
             return;
         }
         int32_t numStreamOut = outputHiddenDim_ / Y_OUT_TILE_NUM_ELEMENTS;
-        int32_t remainingW = remainingY * reqLoRARank_;
+        int32_t remainingW = remainingY * weightRowLen_;
         int32_t numCompleteWTileInForLastIteration = remainingW / W_IN_TILE_NUM_ELEMENTS;
         int32_t remainingWForLastRepeat = remainingW % W_IN_TILE_NUM_ELEMENTS;
 
@@ -197,23 +235,33 @@ private:
     __aicore__ inline void CopyInX(const int64_t idx)
     {
         AscendC::LocalTensor<X_T> xLocal = inQueueX_.AllocTensor<X_T>();
-        if constexpr (std::is_same_v<X_T, float>) {
-            DataCopy(xLocal, xGm_[sliceCount_ * maxLoRARank_ * idx + reqLoRARank_ * reqSlice_], reqLoRARank_);
-        } else {
-            uint16_t blockLen = static_cast<uint16_t>(reqLoRARank_ * sizeof(X_T));
-            DataCopyPad(xLocal, xGm_[sliceCount_ * maxLoRARank_ * idx + reqLoRARank_ * reqSlice_], {1, blockLen, 0, 0},
-                        {});
-        }
+        uint16_t blockLen = static_cast<uint16_t>(reqLoRARank_ * sizeof(X_T));
+        DataCopyPad(xLocal, xGm_[sliceCount_ * maxLoRARank_ * idx + reqLoRARank_ * reqSlice_], {1, blockLen, 0, 0}, {});
         inQueueX_.EnQue(xLocal);
         xLocal = inQueueX_.DeQue<X_T>();
         AscendC::LocalTensor<float> xDup = dupBufferX_.Get<float>();
 
+        if (!packedRank_) {
+            // One copy of x per weight row, zero padded like the rows
+            Duplicate(xDup, 0.0f, weightRowLen_);
+            pipe_barrier(PIPE_V);
+            if constexpr (std::is_same_v<X_T, float>) {
+                Adds(xDup, xLocal, 0.0f, reqLoRARank_);
+            } else {
+                Cast(xDup, xLocal, AscendC::RoundMode::CAST_NONE, reqLoRARank_);
+            }
+            pipe_barrier(PIPE_V);
+            inQueueX_.FreeTensor(xLocal);
+            return;
+        }
+
         // As we are generating multiple output elements with one API invocation,
         // we need to duplicate the X vector multiple times to fill one NUM_BYTES_PER_REPEAT
+        int32_t rowLen = weightRowLen_;
         if constexpr (std::is_same_v<X_T, float>) {
-            for (int32_t i = 0; i < NUM_ELEMENTS_PER_REPEAT; i += reqLoRARank_) {
-                for (int32_t j = 0; j < reqLoRARank_; j++) {
-                    float entry = xLocal.GetValue(j);
+            for (int32_t i = 0; i < NUM_ELEMENTS_PER_REPEAT; i += rowLen) {
+                for (int32_t j = 0; j < rowLen; j++) {
+                    float entry = j < reqLoRARank_ ? xLocal.GetValue(j) : 0.0f;
                     xDup.SetValue(i + j, entry);
                 }
             }
@@ -221,8 +269,11 @@ private:
             Cast(xDup, xLocal, AscendC::RoundMode::CAST_NONE, reqLoRARank_);
             pipe_barrier(PIPE_V);
 
-            for (int32_t i = reqLoRARank_; i < NUM_ELEMENTS_PER_REPEAT; i += reqLoRARank_) {
-                for (int32_t j = 0; j < reqLoRARank_; j++) {
+            for (int32_t j = reqLoRARank_; j < rowLen; j++) {
+                xDup.SetValue(j, 0.0f);
+            }
+            for (int32_t i = rowLen; i < NUM_ELEMENTS_PER_REPEAT; i += rowLen) {
+                for (int32_t j = 0; j < rowLen; j++) {
                     float entry = xDup.GetValue(j);
                     xDup.SetValue(i + j, entry);
                 }
@@ -241,10 +292,24 @@ private:
     __aicore__ inline void CopyInW(int32_t progress, int32_t numElements = W_IN_TILE_NUM_ELEMENTS)
     {
         AscendC::LocalTensor<W_T> wLocal = inQueueW_.AllocTensor<W_T>();
-        DataCopy(wLocal, wGm_[reqLoRAWeightOffset_ + progress * (W_IN_TILE_NUM_ELEMENTS / reqLoRARank_) * maxLoRARank_],
-                 {static_cast<uint16_t>(numElements / reqLoRARank_),
-                  static_cast<uint16_t>((reqLoRARank_ * sizeof(W_T) + DATA_VECTOR_BLOCK - 1) / DATA_VECTOR_BLOCK),
-                  static_cast<uint16_t>((maxLoRARank_ - reqLoRARank_) * sizeof(W_T) / DATA_VECTOR_BLOCK), 0});
+        uint64_t wOffset = reqLoRAWeightOffset_ + progress * numOutputElementsPerInputTile_ * maxLoRARank_;
+        uint16_t numRows = static_cast<uint16_t>(numElements / weightRowLen_);
+        uint32_t rowBytes = reqLoRARank_ * sizeof(W_T);
+        if (weightRowLen_ * sizeof(W_T) < DATA_VECTOR_BLOCK) {
+            // Rank 8 rows of a rank 8 weight are contiguous in GM and stay packed two per block
+            AscendC::DataCopyExtParams copyParams{1, numRows * rowBytes, 0, 0, 0};
+            DataCopyPad(wLocal, wGm_[wOffset], copyParams, AscendC::DataCopyPadExtParams<W_T>{false, 0, 0, 0});
+        } else {
+            // Strides in bytes on the GM side, so that any rank and max rank work. Each row is zero padded to the next
+            // 32B block and then placed at the start of its weightRowLen_ slot.
+            uint32_t paddedRowBytes = (rowBytes + DATA_VECTOR_BLOCK - 1) / DATA_VECTOR_BLOCK * DATA_VECTOR_BLOCK;
+            uint32_t srcStride = (maxLoRARank_ - reqLoRARank_) * sizeof(W_T);
+            uint32_t dstStride = (weightRowLen_ * sizeof(W_T) - paddedRowBytes) / DATA_VECTOR_BLOCK;
+            AscendC::DataCopyExtParams copyParams{numRows, rowBytes, srcStride, dstStride, 0};
+            AscendC::DataCopyPadExtParams<W_T> padParams{
+                true, 0, static_cast<uint8_t>((paddedRowBytes - rowBytes) / sizeof(W_T)), 0};
+            DataCopyPad(wLocal, wGm_[wOffset], copyParams, padParams);
+        }
         inQueueW_.EnQue(wLocal);
     }
 
@@ -280,21 +345,26 @@ private:
         pipe_barrier(PIPE_V);
         inQueueW_.FreeTensor(wLocal);
 
+        if (!packedRank_) {
+            ComputeLongRank(yLocal[progress], blockReduceRepeatCount);
+            return;
+        }
+
         Mul(wTmpTensor, xDup, wTmpTensor, MASK_COUNT, blockReduceRepeatCount, dotProductParams_);
         pipe_barrier(PIPE_V);
 
-        if (reqLoRARank_ == LORA_RANK_8) {
+        if (weightRowLen_ == LORA_RANK_8) {
             BlockReduceSum(yLocal[progress], wTmpTensor, blockReduceRepeatCount, MASK_COUNT,
                            reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
-        } else if (reqLoRARank_ == LORA_RANK_16) {
+        } else if (weightRowLen_ == LORA_RANK_16) {
             BlockReduceSum(wTmpTensor, wTmpTensor, blockReduceRepeatCount, MASK_COUNT, reduceSumParams_.dstRepStride,
                            reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
             PairReduceSum(yLocal[progress], wTmpTensor, pairReduceRepeat16, MASK_COUNT, reduceSumParams_.dstRepStride,
                           reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
-        } else if (reqLoRARank_ == LORA_RANK_32) {
+        } else if (weightRowLen_ == LORA_RANK_32) {
             BlockReduceSum(wTmpTensor, wTmpTensor, blockReduceRepeatCount, MASK_COUNT, reduceSumParams_.dstRepStride,
                            reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
@@ -304,7 +374,7 @@ private:
             PairReduceSum(yLocal[progress], wTmpTensor, pairReduceRepeat32, MASK_COUNT, reduceSumParams_.dstRepStride,
                           reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
-        } else if (reqLoRARank_ == LORA_RANK_64) {
+        } else if (weightRowLen_ == LORA_RANK_64) {
             BlockReduceSum(wTmpTensor, wTmpTensor, blockReduceRepeatCount, MASK_COUNT, reduceSumParams_.dstRepStride,
                            reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
             pipe_barrier(PIPE_V);
@@ -314,6 +384,29 @@ private:
         }
     }
 
+    __aicore__ inline void ComputeLongRank(const AscendC::LocalTensor<float> &yLocal, int32_t numRepeats)
+    {
+        // Every weight row spans numChunks repeats, chunk c of all rows is multiplied with chunk c of x in one call
+        AscendC::LocalTensor<float> xDup = dupBufferX_.Get<float>();
+        AscendC::LocalTensor<float> wTmpTensor = tmpBufferW_.Get<float>();
+        int32_t numChunks = weightRowLen_ / NUM_ELEMENTS_PER_REPEAT;
+        int32_t numRows = numRepeats / numChunks;
+        uint8_t rowStride = static_cast<uint8_t>(numChunks * NUM_BLOCKS_PER_REPEAT);
+        AscendC::BinaryRepeatParams rowProductParams = {1, 1, 1, rowStride, 0, rowStride};
+        for (int32_t c = 0; c < numChunks; c++) {
+            Mul(wTmpTensor[c * NUM_ELEMENTS_PER_REPEAT], xDup[c * NUM_ELEMENTS_PER_REPEAT],
+                wTmpTensor[c * NUM_ELEMENTS_PER_REPEAT], MASK_COUNT, numRows, rowProductParams);
+        }
+        pipe_barrier(PIPE_V);
+
+        // 8 partial sums per repeat, then the numChunks * 8 of one row are summed into its output element
+        BlockReduceSum(wTmpTensor, wTmpTensor, numRepeats, MASK_COUNT, reduceSumParams_.dstRepStride,
+                       reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
+        pipe_barrier(PIPE_V);
+        WholeReduceSum(yLocal, wTmpTensor, numChunks * NUM_BLOCKS_PER_REPEAT, numRows, 1, 1, numChunks);
+        pipe_barrier(PIPE_V);
+    }
+
     __aicore__ inline void CopyOut(int32_t progress, int32_t numElements = Y_OUT_TILE_NUM_ELEMENTS)
     {
         AscendC::LocalTensor<Y_T> yOutLocal = outQueueY_.DeQue<Y_T>();
@@ -347,6 +440,8 @@ private:
     int32_t reqLoRARank_;
     uint64_t reqLoRAWeightOffset_;
     int32_t reqSlice_;
+    bool packedRank_;
+    uint32_t weightRowLen_;
     uint32_t numOutputElementsPerInputTile_;
     uint32_t numStreamInPerOutputTile_;
     uint64_t yOffset_;
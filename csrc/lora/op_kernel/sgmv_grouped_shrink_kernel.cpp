@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SGL_KERNEL_NPU_KERNEL_SGMV_GROUPED_SHRINK_H
+#define SGL_KERNEL_NPU_KERNEL_SGMV_GROUPED_SHRINK_H
+
+#include "kernel_operator.h"
+
+// Segment-grouped SGEMMVShrink: the work is split into blocks of consecutive tokens of one segment instead of single
+// tokens, and every tile of the adapter weight is read from GM once per block and applied to all of its tokens.
+template <typename scalar_t>
+class SGMVGroupedShrink
+{
+public:
+    using X_T = scalar_t;
+    using W_T = scalar_t;
+    using Y_T = float;
+
+    static constexpr uint64_t BUFFER_NUM = 2;
+    // Tokens of one segment that share a pass over the weight, their fp32 x tiles stay resident in UB
+    static constexpr int32_t TOKEN_BLOCK = 8;
+    static constexpr int32_t TILE_LENGTH = 2048;
+
+public:
+    __aicore__ inline SGMVGroupedShrink(AscendC::TPipe *pipe) : pipe_(pipe) {}
+    __aicore__ inline void Init(GM_ADDR x, GM_ADDR weight, GM_ADDR loraIndices, uint32_t loraIndicesSize,
+                                GM_ADDR seqLen, uint32_t seqLenSize, GM_ADDR loraRanks, uint32_t loraRanksSize,
+                                GM_ADDR loraScales, uint32_t loraScalesSize, GM_ADDR y, uint32_t batchSize,
+                                uint32_t inputHiddenDim, uint32_t maxLoRARank)
+    {
+        batchSize_ = batchSize;
+        inputHiddenDim_ = inputHiddenDim;
+        maxLoRARank_ = maxLoRARank;
+        singleLoRAWeightLen_ = inputHiddenDim_ * maxLoRARank_;
+
+        xGm_.SetGlobalBuffer(reinterpret_cast<__gm__ X_T *>(x));
+        yOutGm_.SetGlobalBuffer(reinterpret_cast<__gm__ Y_T *>(y));
+        wGm_.SetGlobalBuffer(reinterpret_cast<__gm__ W_T *>(weight));
+        loraIndicesGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(loraIndices), loraIndicesSize);
+        seqLenGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(seqLen), seqLenSize);
+        loraRanksGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(loraRanks), loraRanksSize);
+        loraScalesGm_.SetGlobalBuffer(reinterpret_cast<__gm__ half *>(loraScales), loraScalesSize);
+
+        pipe_->InitBuffer(inQueueX_, 1, TILE_LENGTH * sizeof(X_T));
+        pipe_->InitBuffer(inQueueW_, BUFFER_NUM, TILE_LENGTH * sizeof(W_T));
+        pipe_->InitBuffer(tmpBufferX_, TOKEN_BLOCK * TILE_LENGTH * sizeof(float));
+        pipe_->InitBuffer(tmpBufferW_, TILE_LENGTH * sizeof(float));
+        pipe_->InitBuffer(tmpBufferProd_, TILE_LENGTH * sizeof(float));
+
+        pipe_->InitBuffer(outQueueY_, 1, maxLoRARank_ * sizeof(Y_T));
+        pipe_->InitBuffer(accBufferY_, TOKEN_BLOCK * maxLoRARank_ * sizeof(float));
+    }
+
+    __aicore__ inline void Process()
+    {
+        // Token blocks are dealt out round-robin over the cores in segment order, so every core derives its own
+        // share from seq_len without a host-side schedule
+        int64_t blockIdx = AscendC::GetBlockIdx();
+        int64_t blockNum = AscendC::GetBlockNum();
+        int64_t workIdx = 0;
+        int64_t segmentStart = 0;
+        for (uint64_t i = 0; i < seqLenGm_.GetSize() && segmentStart < batchSize_; i++) {
+            int64_t segmentEnd = segmentStart + seqLenGm_.GetValue(i);
+            if (segmentEnd > batchSize_) {
+                segmentEnd = batchSize_;
+            }
+            for (int64_t idx = segmentStart; idx < segmentEnd; idx += TOKEN_BLOCK, workIdx++) {
+                if (workIdx % blockNum != blockIdx) {
+                    continue;
+                }
+                numTokens_ = (segmentEnd - idx < TOKEN_BLOCK) ? segmentEnd - idx : TOKEN_BLOCK;
+                ProcessBlock(loraIndicesGm_.GetValue(i), idx);
+            }
+            segmentStart = segmentEnd;
+        }
+    }
+
+private:
+    __aicore__ inline void ProcessBlock(int32_t loraIndex, int64_t startIdx)
+    {
+        if (loraIndex < 0) {
+            return;
+        }
+        reqLoRARank_ = loraRanksGm_.GetValue(loraIndex);
+        if (reqLoRARank_ == 0) {
+            return;
+        }
+        reqLoRAScale_ = loraScalesGm_.GetValue(loraIndex);
+        reqLoRAWeightOffset_ = static_cast<uint64_t>(loraIndex) * singleLoRAWeightLen_;
+
+        AscendC::LocalTensor<float> accLocal = accBufferY_.Get<float>();
+        Duplicate(accLocal, 0.0f, TOKEN_BLOCK * maxLoRARank_);
+        pipe_barrier(PIPE_V);
+
+        for (int32_t colIdx = 0; colIdx * TILE_LENGTH < inputHiddenDim_; colIdx++) {
+            int32_t numElements = inputHiddenDim_ - colIdx * TILE_LENGTH;
+            if (numElements > TILE_LENGTH) {
+                numElements = TILE_LENGTH;
+            }
+            for (int32_t k = 0; k < numTokens_; k++) {
+                CopyInX(startIdx + k, k, colIdx, numElements);
+            }
+            // Prefetch the next weight row while the current one is applied to the block
+            CopyInW(0, colIdx, numElements);
+            for (int32_t i = 0; i < reqLoRARank_; i++) {
+                if (i + 1 < reqLoRARank_) {
+                    CopyInW(i + 1, colIdx, numElements);
+                }
+                Compute(i, numElements);
+            }
+        }
+
+        for (int32_t k = 0; k < numTokens_; k++) {
+            ScaleOutput(k);
+            CopyOut(startIdx + k);
+        }
+    }
+
+    __aicore__ inline void CopyInX(const int64_t idx, int32_t tokenSlot, int32_t colIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<X_T> xLocal = inQueueX_.AllocTensor<X_T>();
+        DataCopy(xLocal, xGm_[inputHiddenDim_ * idx + colIdx * TILE_LENGTH], numElements);
+        inQueueX_.EnQue(xLocal);
+        xLocal = inQueueX_.DeQue<X_T>();
+        AscendC::LocalTensor<float> xTmpTensor = tmpBufferX_.Get<float>();
+        Cast(xTmpTensor[tokenSlot * TILE_LENGTH], xLocal, AscendC::RoundMode::CAST_NONE, numElements);
+        pipe_barrier(PIPE_V);
+        inQueueX_.FreeTensor(xLocal);
+    }
+
+    __aicore__ inline void CopyInW(int32_t rowIdx, int32_t colIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.AllocTensor<W_T>();
+        DataCopy(wLocal, wGm_[reqLoRAWeightOffset_ + rowIdx * inputHiddenDim_ + colIdx * TILE_LENGTH], numElements);
+        inQueueW_.EnQue(wLocal);
+    }
+
+    __aicore__ inline void Compute(int32_t rowIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.DeQue<W_T>();
+        AscendC::LocalTensor<float> xTmpTensor = tmpBufferX_.Get<float>();
+        AscendC::LocalTensor<float> wTmpTensor = tmpBufferW_.Get<float>();
+        AscendC::LocalTensor<float> prodTensor = tmpBufferProd_.Get<float>();
+        AscendC::LocalTensor<float> accLocal = accBufferY_.Get<float>();
+
+        Cast(wTmpTensor, wLocal, AscendC::RoundMode::CAST_NONE, numElements);
+        pipe_barrier(PIPE_V);
+        inQueueW_.FreeTensor(wLocal);
+
+        for (int32_t k = 0; k < numTokens_; k++) {
+            // dot product of one tile of X and W, reduced to a single number
+            Mul(prodTensor, xTmpTensor[k * TILE_LENGTH], wTmpTensor, numElements);
+            pipe_barrier(PIPE_V);
+            ReduceSum<float>(prodTensor, prodTensor, prodTensor, numElements);
+            pipe_barrier(PIPE_V);
+
+            int32_t accIdx = k * maxLoRARank_ + rowIdx;
+            accLocal.SetValue(accIdx, accLocal.GetValue(accIdx) + prodTensor.GetValue(0));
+        }
+    }
+
+    __aicore__ inline void ScaleOutput(int32_t tokenSlot)
+    {
+        AscendC::LocalTensor<float> accLocal = accBufferY_.Get<float>();
+        AscendC::LocalTensor<Y_T> yOutLocal = outQueueY_.AllocTensor<Y_T>();
+
+        Muls(yOutLocal, accLocal[tokenSlot * maxLoRARank_], reqLoRAScale_, reqLoRARank_);
+        pipe_barrier(PIPE_V);
+
+        outQueueY_.EnQue<Y_T>(yOutLocal);
+    }
+
+    __aicore__ inline void CopyOut(const int64_t idx)
+    {
+        AscendC::LocalTensor<Y_T> yOutLocal = outQueueY_.DeQue<Y_T>();
+        DataCopy(yOutGm_[maxLoRARank_ * idx], yOutLocal, reqLoRARank_);
+        outQueueY_.FreeTensor(yOutLocal);
+    }
+
+private:
+    AscendC::TPipe *pipe_;
+    AscendC::TQue<AscendC::QuePosition::VECIN, 1> inQueueX_;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueW_;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, 1> outQueueY_;
+    AscendC::TBuf<AscendC::QuePosition::VECCALC> tmpBufferX_, tmpBufferW_, tmpBufferProd_, accBufferY_;
+    AscendC::GlobalTensor<X_T> xGm_;
+    AscendC::GlobalTensor<W_T> wGm_;
+    AscendC::GlobalTensor<int32_t> loraIndicesGm_;
+    AscendC::GlobalTensor<int32_t> seqLenGm_;
+    AscendC::GlobalTensor<int32_t> loraRanksGm_;
+    AscendC::GlobalTensor<half> loraScalesGm_;
+    AscendC::GlobalTensor<Y_T> yOutGm_;
+    uint32_t batchSize_;
+    uint32_t inputHiddenDim_;
+    uint32_t maxLoRARank_;
+    uint32_t singleLoRAWeightLen_;
+
+    uint64_t reqLoRAWeightOffset_;
+    int32_t reqLoRARank_;
+    float reqLoRAScale_;
+    int32_t numTokens_;
+};
+
+#define SGMV_GROUPED_SHRINK_TYPE_DECLARE(TYPE)                                                                         \
+    extern "C" __global__ __aicore__ void sgmv_grouped_shrink_##TYPE(                                                  \
+        GM_ADDR x, GM_ADDR weight, GM_ADDR loraIndices, uint32_t loraIndicesSize, GM_ADDR seqLen, uint32_t seqLenSize, \
+        GM_ADDR loraRanks, uint32_t loraRanksSize, GM_ADDR loraScales, uint32_t loraScalesSize, GM_ADDR y,             \
+        uint32_t batchSize, uint32_t inputHiddenDim, uint32_t maxLoRARank)                                             \
+    {                                                                                                                  \
+        AscendC::TPipe pipe;                                                                                           \
+        SGMVGroupedShrink<TYPE> op(&pipe);                                                                             \
+        op.Init(x, weight, loraIndices, loraIndicesSize, seqLen, seqLenSize, loraRanks, loraRanksSize, loraScales,     \
+                loraScalesSize, y, batchSize, inputHiddenDim, maxLoRARank);                                            \
+        op.Process();                                                                                                  \
+    }
+
+// declare all dtype kernel
+SGMV_GROUPED_SHRINK_TYPE_DECLARE(half)
+#if (__CCE_AICORE__ >= 220)
+SGMV_GROUPED_SHRINK_TYPE_DECLARE(bfloat16_t)
+#endif
+
+#endif  // SGL_KERNEL_NPU_KERNEL_SGMV_GROUPED_SHRINK_H
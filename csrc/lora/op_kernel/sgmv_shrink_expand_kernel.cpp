@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SGL_KERNEL_NPU_KERNEL_SGMV_SHRINK_EXPAND_H
+#define SGL_KERNEL_NPU_KERNEL_SGMV_SHRINK_EXPAND_H
+
+#include "kernel_operator.h"
+
+// Fused SGMVGroupedShrink + SGMVGroupedExpand: a work item is a block of consecutive tokens of one segment and one
+// slice. The scaled x * A of the block stays in UB as the fp32 input of the expand, nothing goes through GM.
+template <typename scalar_t>
+class SGMVShrinkExpand
+{
+public:
+    using X_T = scalar_t;
+    using W_T = scalar_t;
+    using Y_T = scalar_t;
+
+    static constexpr uint64_t LORA_RANK_8 = 8;
+    static constexpr uint64_t LORA_RANK_16 = 16;
+    static constexpr uint64_t LORA_RANK_32 = 32;
+    static constexpr uint64_t LORA_RANK_64 = 64;
+    static constexpr int32_t MAX_LORA_RANK = 512;
+    static constexpr int32_t BUFFER_NUM = 2;
+    static constexpr int32_t DATA_VECTOR_BLOCK = 32;
+    static constexpr int32_t TOKEN_BLOCK = 8;
+
+    static constexpr int32_t NUM_BYTES_PER_REPEAT = 256;
+    static constexpr int32_t NUM_BLOCKS_PER_REPEAT = 8;
+    static constexpr int32_t NUM_ELEMENTS_PER_REPEAT = NUM_BYTES_PER_REPEAT / sizeof(float);
+    static constexpr int32_t MASK_COUNT = NUM_BYTES_PER_REPEAT / sizeof(float);
+    // The shrink x tiles and the expand y tiles of the block share one buffer, so both are 1024 per token
+    static constexpr int32_t SHRINK_TILE_LENGTH = 1024;
+    static constexpr int32_t W_IN_TILE_NUM_ELEMENTS = 8192;
+    static constexpr int32_t Y_OUT_TILE_NUM_ELEMENTS = 1024;
+    static constexpr int32_t BLOCK_REDUCE_NUM_REPEATS = W_IN_TILE_NUM_ELEMENTS / NUM_ELEMENTS_PER_REPEAT;
+    static constexpr int32_t PAIR_REDUCE_NUM_REPEATS_16 =
+        (BLOCK_REDUCE_NUM_REPEATS * NUM_BLOCKS_PER_REPEAT + NUM_ELEMENTS_PER_REPEAT - 1) / NUM_ELEMENTS_PER_REPEAT;
+    static constexpr int32_t PAIR_REDUCE_NUM_REPEATS_32 = (PAIR_REDUCE_NUM_REPEATS_16 + 1) / 2;
+
+public:
+    __aicore__ inline SGMVShrinkExpand(AscendC::TPipe *pipe) : pipe_(pipe) {}
+
+    __aicore__ inline void Init(GM_ADDR x, GM_ADDR weightA, GM_ADDR weightB, GM_ADDR loraIndices,
+                                uint32_t loraIndicesSize, GM_ADDR seqLen, uint32_t seqLenSize, GM_ADDR loraRanks,
+                                uint32_t loraRanksSize, GM_ADDR loraScales, uint32_t loraScalesSize,
+                                GM_ADDR sliceOffsets, uint32_t sliceOffsetsSize, GM_ADDR yIn, GM_ADDR yOut,
+                                uint32_t batchSize, uint32_t inputHiddenDim, uint32_t maxLoRARank,
+                                uint32_t outputFullDim)
+    {
+        batchSize_ = batchSize;
+        inputHiddenDim_ = inputHiddenDim;
+        maxLoRARank_ = maxLoRARank;
+        sliceCount_ = sliceOffsetsSize - 1;
+        outputFullDim_ = outputFullDim;
+        singleLoRAWeightALen_ = sliceCount_ * maxLoRARank_ * inputHiddenDim_;
+        singleLoRAWeightBLen_ = maxLoRARank_ * outputFullDim_;
+
+        xGm_.SetGlobalBuffer(reinterpret_cast<__gm__ X_T *>(x));
+        wAGm_.SetGlobalBuffer(reinterpret_cast<__gm__ W_T *>(weightA));
+        wBGm_.SetGlobalBuffer(reinterpret_cast<__gm__ W_T *>(weightB));
+        yInGm_.SetGlobalBuffer(reinterpret_cast<__gm__ Y_T *>(yIn));
+        yOutGm_.SetGlobalBuffer(reinterpret_cast<__gm__ Y_T *>(yOut));
+        loraIndicesGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(loraIndices), loraIndicesSize);
+        seqLenGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(seqLen), seqLenSize);
+        loraRanksGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(loraRanks), loraRanksSize);
+        loraScalesGm_.SetGlobalBuffer(reinterpret_cast<__gm__ half *>(loraScales), loraScalesSize);
+        sliceOffsetsGm_.SetGlobalBuffer(reinterpret_cast<__gm__ int32_t *>(sliceOffsets), sliceOffsetsSize);
+
+        pipe_->InitBuffer(inQueueX_, 1, SHRINK_TILE_LENGTH * sizeof(X_T));
+        pipe_->InitBuffer(inQueueW_, BUFFER_NUM, W_IN_TILE_NUM_ELEMENTS * sizeof(W_T));
+        pipe_->InitBuffer(inQueueY_, BUFFER_NUM, Y_OUT_TILE_NUM_ELEMENTS * sizeof(Y_T));
+        pipe_->InitBuffer(outQueueY_, BUFFER_NUM, Y_OUT_TILE_NUM_ELEMENTS * sizeof(Y_T));
+
+        pipe_->InitBuffer(tmpBufferW_, W_IN_TILE_NUM_ELEMENTS * sizeof(float));
+        pipe_->InitBuffer(prodBufferW_, W_IN_TILE_NUM_ELEMENTS * sizeof(float));
+        pipe_->InitBuffer(blockBuffer_, TOKEN_BLOCK * Y_OUT_TILE_NUM_ELEMENTS * sizeof(float));
+        pipe_->InitBuffer(inBufferY_, Y_OUT_TILE_NUM_ELEMENTS * sizeof(float));
+        pipe_->InitBuffer(accBufferX_, TOKEN_BLOCK * MAX_LORA_RANK * sizeof(float));
+        pipe_->InitBuffer(dupBufferX_, TOKEN_BLOCK * MAX_LORA_RANK * sizeof(float));
+
+        ClearWeightBuffers();
+    }
+
+    __aicore__ inline void Process()
+    {
+        // (token block, slice) items are dealt out round-robin over the cores in segment order, the slices are
+        // independent since slice s only needs rows [s * rank, (s + 1) * rank) of A
+        int64_t blockIdx = AscendC::GetBlockIdx();
+        int64_t blockNum = AscendC::GetBlockNum();
+        int64_t workIdx = 0;
+        int64_t segmentStart = 0;
+        for (uint64_t i = 0; i < seqLenGm_.GetSize() && segmentStart < batchSize_; i++) {
+            int64_t segmentEnd = segmentStart + seqLenGm_.GetValue(i);
+            if (segmentEnd > batchSize_) {
+                segmentEnd = batchSize_;
+            }
+            for (int64_t idx = segmentStart; idx < segmentEnd; idx += TOKEN_BLOCK) {
+                for (int32_t slice = 0; slice < sliceCount_; slice++, workIdx++) {
+                    if (workIdx % blockNum != blockIdx) {
+                        continue;
+                    }
+                    numTokens_ = (segmentEnd - idx < TOKEN_BLOCK) ? segmentEnd - idx : TOKEN_BLOCK;
+                    ProcessBlock(loraIndicesGm_.GetValue(i), idx, slice);
+                }
+            }
+            segmentStart = segmentEnd;
+        }
+    }
+
+private:
+    __aicore__ inline void ProcessBlock(int32_t loraIndex, int64_t startIdx, int32_t slice)
+    {
+        if (loraIndex < 0) {
+            return;
+        }
+        reqLoRARank_ = loraRanksGm_.GetValue(loraIndex);
+        if (reqLoRARank_ == 0) {
+            return;
+        }
+        reqLoRAScale_ = loraScalesGm_.GetValue(loraIndex);
+        reqSlice_ = slice;
+        sliceOffset_ = sliceOffsetsGm_.GetValue(reqSlice_);
+        outputHiddenDim_ = sliceOffsetsGm_.GetValue(reqSlice_ + 1) - sliceOffset_;
+        startIdx_ = startIdx;
+        reqLoRAWeightAOffset_ = static_cast<uint64_t>(loraIndex) * singleLoRAWeightALen_ +
+                                static_cast<uint64_t>(reqSlice_) * reqLoRARank_ * inputHiddenDim_;
+        reqLoRAWeightBOffset_ = static_cast<uint64_t>(loraIndex) * singleLoRAWeightBLen_ + sliceOffset_ * maxLoRARank_;
+        SetUpWeightRow();
+
+        Shrink();
+        for (int32_t k = 0; k < numTokens_; k++) {
+            DuplicateX(k);
+        }
+        Expand();
+    }
+
+    __aicore__ inline void ClearWeightBuffers()
+    {
+        // Padding lanes of long-rank rows are never written by the weight copy, see SGEMMVExpand
+        AscendC::LocalTensor<W_T> wLocals[BUFFER_NUM];
+        for (int32_t i = 0; i < BUFFER_NUM; i++) {
+            wLocals[i] = inQueueW_.AllocTensor<W_T>();
+            Duplicate(wLocals[i].template ReinterpretCast<half>(), static_cast<half>(0), W_IN_TILE_NUM_ELEMENTS);
+        }
+        pipe_barrier(PIPE_V);
+        for (int32_t i = 0; i < BUFFER_NUM; i++) {
+            inQueueW_.FreeTensor(wLocals[i]);
+        }
+        event_t eventIDVToMTE2 = static_cast<event_t>(GetTPipePtr()->FetchEventID(AscendC::HardEvent::V_MTE2));
+        AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventIDVToMTE2);
+        AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventIDVToMTE2);
+    }
+
+    __aicore__ inline void SetUpWeightRow()
+    {
+        // Ranks dividing one repeat share it between several weight rows, the others are padded to whole repeats
+        packedRank_ = reqLoRARank_ <= LORA_RANK_64 && NUM_ELEMENTS_PER_REPEAT % reqLoRARank_ == 0;
+        weightRowLen_ = packedRank_ ? reqLoRARank_ : NUM_ELEMENTS_PER_REPEAT;
+        if (reqLoRARank_ == LORA_RANK_8 && maxLoRARank_ != LORA_RANK_8) {
+            // A rank 8 row is half a block and strided rows cannot share one, so each gets a block of its own and is
+            // reduced like a rank 16 row against a zero padded x
+            weightRowLen_ = LORA_RANK_16;
+        }
+        while (weightRowLen_ < reqLoRARank_) {
+            weightRowLen_ *= 2;
+        }
+        numOutputElementsPerInputTile_ = W_IN_TILE_NUM_ELEMENTS / weightRowLen_;
+        numStreamInPerOutputTile_ = Y_OUT_TILE_NUM_ELEMENTS / numOutputElementsPerInputTile_;
+    }
+
+    __aicore__ inline void Shrink()
+    {
+        // acc = scale * x * A of the slice, one row of A per output element as in SGMVGroupedShrink
+        AscendC::LocalTensor<float> accLocal = accBufferX_.Get<float>();
+        Duplicate(accLocal, 0.0f, TOKEN_BLOCK * MAX_LORA_RANK);
+        pipe_barrier(PIPE_V);
+
+        for (int32_t colIdx = 0; colIdx * SHRINK_TILE_LENGTH < inputHiddenDim_; colIdx++) {
+            int32_t numElements = inputHiddenDim_ - colIdx * SHRINK_TILE_LENGTH;
+            if (numElements > SHRINK_TILE_LENGTH) {
+                numElements = SHRINK_TILE_LENGTH;
+            }
+            for (int32_t k = 0; k < numTokens_; k++) {
+                CopyInShrinkX(k, colIdx, numElements);
+            }
+            // Prefetch the next row of A while the current one is applied to the block
+            CopyInShrinkW(0, colIdx, numElements);
+            for (int32_t i = 0; i < reqLoRARank_; i++) {
+                if (i + 1 < reqLoRARank_) {
+                    CopyInShrinkW(i + 1, colIdx, numElements);
+                }
+                ComputeShrink(i, numElements);
+            }
+        }
+
+        Muls(accLocal, accLocal, reqLoRAScale_, numTokens_ * MAX_LORA_RANK);
+        pipe_barrier(PIPE_V);
+    }
+
+    __aicore__ inline void CopyInShrinkX(int32_t tokenSlot, int32_t colIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<X_T> xLocal = inQueueX_.AllocTensor<X_T>();
+        DataCopy(xLocal, xGm_[inputHiddenDim_ * (startIdx_ + tokenSlot) + colIdx * SHRINK_TILE_LENGTH], numElements);
+        inQueueX_.EnQue(xLocal);
+        xLocal = inQueueX_.DeQue<X_T>();
+        AscendC::LocalTensor<float> xTmpTensor = blockBuffer_.Get<float>();
+        Cast(xTmpTensor[tokenSlot * SHRINK_TILE_LENGTH], xLocal, AscendC::RoundMode::CAST_NONE, numElements);
+        pipe_barrier(PIPE_V);
+        inQueueX_.FreeTensor(xLocal);
+    }
+
+    __aicore__ inline void CopyInShrinkW(int32_t rowIdx, int32_t colIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.AllocTensor<W_T>();
+        DataCopy(wLocal, wAGm_[reqLoRAWeightAOffset_ + rowIdx * inputHiddenDim_ + colIdx * SHRINK_TILE_LENGTH],
+                 numElements);
+        inQueueW_.EnQue(wLocal);
+    }
+
+    __aicore__ inline void ComputeShrink(int32_t rowIdx, int32_t numElements)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.DeQue<W_T>();
+        AscendC::LocalTensor<float> xTmpTensor = blockBuffer_.Get<float>();
+        AscendC::LocalTensor<float> wTmpTensor = tmpBufferW_.Get<float>();
+        AscendC::LocalTensor<float> prodTensor = prodBufferW_.Get<float>();
+        AscendC::LocalTensor<float> accLocal = accBufferX_.Get<float>();
+
+        Cast(wTmpTensor, wLocal, AscendC::RoundMode::CAST_NONE, numElements);
+        pipe_barrier(PIPE_V);
+        inQueueW_.FreeTensor(wLocal);
+
+        for (int32_t k = 0; k < numTokens_; k++) {
+            Mul(prodTensor, xTmpTensor[k * SHRINK_TILE_LENGTH], wTmpTensor, numElements);
+            pipe_barrier(PIPE_V);
+            ReduceSum<float>(prodTensor, prodTensor, prodTensor, numElements);
+            pipe_barrier(PIPE_V);
+
+            int32_t accIdx = k * MAX_LORA_RANK + rowIdx;
+            accLocal.SetValue(accIdx, accLocal.GetValue(accIdx) + prodTensor.GetValue(0));
+        }
+    }
+
+    __aicore__ inline void DuplicateX(int32_t tokenSlot)
+    {
+        AscendC::LocalTensor<float> xLocal = accBufferX_.Get<float>()[tokenSlot * MAX_LORA_RANK];
+        AscendC::LocalTensor<float> xDup = dupBufferX_.Get<float>()[tokenSlot * MAX_LORA_RANK];
+
+        if (!packedRank_) {
+            // One copy of x per weight row, zero padded like the rows
+            Duplicate(xDup, 0.0f, weightRowLen_);
+            pipe_barrier(PIPE_V);
+            Adds(xDup, xLocal, 0.0f, reqLoRARank_);
+            pipe_barrier(PIPE_V);
+            return;
+        }
+
+        // Duplicate x to fill one NUM_BYTES_PER_REPEAT, each weight row of the tile then meets its own copy
+        int32_t rowLen = weightRowLen_;
+        for (int32_t i = 0; i < NUM_ELEMENTS_PER_REPEAT; i += rowLen) {
+            for (int32_t j = 0; j < rowLen; j++) {
+                float entry = j < reqLoRARank_ ? xLocal.GetValue(j) : 0.0f;
+                xDup.SetValue(i + j, entry);
+            }
+        }
+    }
+
+    __aicore__ inline void Expand()
+    {
+        // y += acc * B of the slice, tiled as in SGMVGroupedExpand
+        int32_t numStreamOut = outputHiddenDim_ / Y_OUT_TILE_NUM_ELEMENTS;
+        for (int32_t i = 0; i < numStreamOut; i++) {
+            for (int32_t j = 0; j < numStreamInPerOutputTile_; j++) {
+                CopyInExpandW(i * numStreamInPerOutputTile_ + j);
+                ComputeExpand(j * numOutputElementsPerInputTile_);
+            }
+            for (int32_t k = 0; k < numTokens_; k++) {
+                CopyInY(k, i);
+                AddOutput(k);
+                CopyOut(k, i);
+            }
+        }
+
+        int32_t remainingY = outputHiddenDim_ % Y_OUT_TILE_NUM_ELEMENTS;
+        if (remainingY == 0) {
+            return;
+        }
+        int32_t remainingW = remainingY * weightRowLen_;
+        int32_t numCompleteWTileInForLastIteration = remainingW / W_IN_TILE_NUM_ELEMENTS;
+        int32_t remainingWForLastRepeat = remainingW % W_IN_TILE_NUM_ELEMENTS;
+
+        int32_t outputIdx = 0;
+        for (outputIdx = 0; outputIdx < numCompleteWTileInForLastIteration; outputIdx++) {
+            CopyInExpandW(numStreamOut * numStreamInPerOutputTile_ + outputIdx);
+            ComputeExpand(outputIdx * numOutputElementsPerInputTile_);
+        }
+
+        if (remainingWForLastRepeat != 0) {
+            CopyInExpandW(numStreamOut * numStreamInPerOutputTile_ + numCompleteWTileInForLastIteration,
+                          remainingWForLastRepeat);
+            int32_t lastRepeatCount = remainingWForLastRepeat / NUM_ELEMENTS_PER_REPEAT;
+            int32_t pairReduceRepeat16 =
+                (lastRepeatCount * NUM_BLOCKS_PER_REPEAT + NUM_ELEMENTS_PER_REPEAT - 1) / NUM_ELEMENTS_PER_REPEAT;
+            int32_t pairReduceRepeat32 = (pairReduceRepeat16 + 1) / 2;
+            int32_t lastComputeOutputElement = outputIdx * numOutputElementsPerInputTile_;
+            ComputeExpand(lastComputeOutputElement, lastRepeatCount, pairReduceRepeat16, pairReduceRepeat32);
+        }
+
+        for (int32_t k = 0; k < numTokens_; k++) {
+            CopyInY(k, numStreamOut, remainingY);
+            AddOutput(k, remainingY);
+            CopyOut(k, numStreamOut, remainingY);
+        }
+    }
+
+    __aicore__ inline void CopyInExpandW(int32_t progress, int32_t numElements = W_IN_TILE_NUM_ELEMENTS)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.AllocTensor<W_T>();
+        uint64_t wOffset = reqLoRAWeightBOffset_ + progress * numOutputElementsPerInputTile_ * maxLoRARank_;
+        uint16_t numRows = static_cast<uint16_t>(numElements / weightRowLen_);
+        uint32_t rowBytes = reqLoRARank_ * sizeof(W_T);
+        if (weightRowLen_ * sizeof(W_T) < DATA_VECTOR_BLOCK) {
+            // Rank 8 rows of a rank 8 B are contiguous in GM and stay packed two per block
+            AscendC::DataCopyExtParams copyParams{1, numRows * rowBytes, 0, 0, 0};
+            DataCopyPad(wLocal, wBGm_[wOffset], copyParams, AscendC::DataCopyPadExtParams<W_T>{false, 0, 0, 0});
+        } else {
+            // Strides in bytes on the GM side, so that any rank and max rank work. Each row is zero padded to the next
+            // 32B block and then placed at the start of its weightRowLen_ slot.
+            uint32_t paddedRowBytes = (rowBytes + DATA_VECTOR_BLOCK - 1) / DATA_VECTOR_BLOCK * DATA_VECTOR_BLOCK;
+            uint32_t srcStride = (maxLoRARank_ - reqLoRARank_) * sizeof(W_T);
+            uint32_t dstStride = (weightRowLen_ * sizeof(W_T) - paddedRowBytes) / DATA_VECTOR_BLOCK;
+            AscendC::DataCopyExtParams copyParams{numRows, rowBytes, srcStride, dstStride, 0};
+            AscendC::DataCopyPadExtParams<W_T> padParams{
+                true, 0, static_cast<uint8_t>((paddedRowBytes - rowBytes) / sizeof(W_T)), 0};
+            DataCopyPad(wLocal, wBGm_[wOffset], copyParams, padParams);
+        }
+        inQueueW_.EnQue(wLocal);
+    }
+
+    __aicore__ inline void ComputeExpand(int32_t progress, int32_t blockReduceRepeatCount = BLOCK_REDUCE_NUM_REPEATS,
+                                         int32_t pairReduceRepeat16 = PAIR_REDUCE_NUM_REPEATS_16,
+                                         int32_t pairReduceRepeat32 = PAIR_REDUCE_NUM_REPEATS_32)
+    {
+        AscendC::LocalTensor<W_T> wLocal = inQueueW_.DeQue<W_T>();
+        AscendC::LocalTensor<float> wTmpTensor = tmpBufferW_.Get<float>();
+        AscendC::LocalTensor<float> prodTensor = prodBufferW_.Get<float>();
+
+        Cast(wTmpTensor, wLocal, AscendC::RoundMode::CAST_NONE, MASK_COUNT, blockReduceRepeatCount, castParams_);
+        pipe_barrier(PIPE_V);
+        inQueueW_.FreeTensor(wLocal);
+
+        for (int32_t k = 0; k < numTokens_; k++) {
+            AscendC::LocalTensor<float> yLocal = blockBuffer_.Get<float>()[k * Y_OUT_TILE_NUM_ELEMENTS];
+            AscendC::LocalTensor<float> xDup = dupBufferX_.Get<float>()[k * MAX_LORA_RANK];
+            if (!packedRank_) {
+                ComputeLongRank(yLocal[progress], xDup, blockReduceRepeatCount);
+                continue;
+            }
+
+            Mul(prodTensor, xDup, wTmpTensor, MASK_COUNT, blockReduceRepeatCount, dotProductParams_);
+            pipe_barrier(PIPE_V);
+
+            if (weightRowLen_ == LORA_RANK_8) {
+                BlockReduceSum(yLocal[progress], prodTensor, blockReduceRepeatCount, MASK_COUNT,
+                               reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                               reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+            } else if (weightRowLen_ == LORA_RANK_16) {
+                BlockReduceSum(prodTensor, prodTensor, blockReduceRepeatCount, MASK_COUNT,
+                               reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                               reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+                PairReduceSum(yLocal[progress], prodTensor, pairReduceRepeat16, MASK_COUNT,
+                              reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                              reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+            } else if (weightRowLen_ == LORA_RANK_32) {
+                BlockReduceSum(prodTensor, prodTensor, blockReduceRepeatCount, MASK_COUNT,
+                               reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                               reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+                PairReduceSum(prodTensor, prodTensor, pairReduceRepeat16, MASK_COUNT, reduceSumParams_.dstRepStride,
+                              reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+                PairReduceSum(yLocal[progress], prodTensor, pairReduceRepeat32, MASK_COUNT,
+                              reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                              reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+            } else if (weightRowLen_ == LORA_RANK_64) {
+                BlockReduceSum(prodTensor, prodTensor, blockReduceRepeatCount, MASK_COUNT,
+                               reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                               reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+                BlockReduceSum(yLocal[progress], prodTensor, pairReduceRepeat16, MASK_COUNT,
+                               reduceSumParams_.dstRepStride, reduceSumParams_.srcBlkStride,
+                               reduceSumParams_.srcRepStride);
+                pipe_barrier(PIPE_V);
+            }
+        }
+    }
+
+    __aicore__ inline void ComputeLongRank(const AscendC::LocalTensor<float> &yLocal,
+                                           const AscendC::LocalTensor<float> &xDup, int32_t numRepeats)
+    {
+        // Same row-wise reduction as SGEMMVExpand::ComputeLongRank, into prodTensor so that the tile stays intact
+        AscendC::LocalTensor<float> wTmpTensor = tmpBufferW_.Get<float>();
+        AscendC::LocalTensor<float> prodTensor = prodBufferW_.Get<float>();
+        int32_t numChunks = weightRowLen_ / NUM_ELEMENTS_PER_REPEAT;
+        int32_t numRows = numRepeats / numChunks;
+        uint8_t rowStride = static_cast<uint8_t>(numChunks * NUM_BLOCKS_PER_REPEAT);
+        AscendC::BinaryRepeatParams rowProductParams = {1, 1, 1, rowStride, 0, rowStride};
+        for (int32_t c = 0; c < numChunks; c++) {
+            Mul(prodTensor[c * NUM_ELEMENTS_PER_REPEAT], xDup[c * NUM_ELEMENTS_PER_REPEAT],
+                wTmpTensor[c * NUM_ELEMENTS_PER_REPEAT], MASK_COUNT, numRows, rowProductParams);
+        }
+        pipe_barrier(PIPE_V);
+
+        BlockReduceSum(prodTensor, prodTensor, numRepeats, MASK_COUNT, reduceSumParams_.dstRepStride,
+                       reduceSumParams_.srcBlkStride, reduceSumParams_.srcRepStride);
+        pipe_barrier(PIPE_V);
+        WholeReduceSum(yLocal, prodTensor, numChunks * NUM_BLOCKS_PER_REPEAT, numRows, 1, 1, numChunks);
+        pipe_barrier(PIPE_V);
+    }
+
+    __aicore__ inline void CopyInY(int32_t tokenSlot, int32_t progress, int32_t numElements = Y_OUT_TILE_NUM_ELEMENTS)
+    {
+        AscendC::LocalTensor<Y_T> yInLocal = inQueueY_.AllocTensor<Y_T>();
+        DataCopy(yInLocal, yInGm_[YOffset(tokenSlot) + progress * Y_OUT_TILE_NUM_ELEMENTS], numElements);
+        inQueueY_.EnQue(yInLocal);
+    }
+
+    __aicore__ inline void AddOutput(int32_t tokenSlot, int32_t numElements = Y_OUT_TILE_NUM_ELEMENTS)
+    {
+        AscendC::LocalTensor<float> yLocal = blockBuffer_.Get<float>()[tokenSlot * Y_OUT_TILE_NUM_ELEMENTS];
+        AscendC::LocalTensor<Y_T> yInLocal = inQueueY_.DeQue<Y_T>();
+        AscendC::LocalTensor<float> yInLocalFP32 = inBufferY_.Get<float>();
+        Cast(yInLocalFP32, yInLocal, AscendC::RoundMode::CAST_NONE, numElements);
+        pipe_barrier(PIPE_V);
+        inQueueY_.FreeTensor(yInLocal);
+
+        Add(yLocal, yLocal, yInLocalFP32, numElements);
+        pipe_barrier(PIPE_V);
+
+        AscendC::LocalTensor<Y_T> yOutLocal = outQueueY_.AllocTensor<Y_T>();
+        Cast(yOutLocal, yLocal, AscendC::RoundMode::CAST_RINT, numElements);
+        pipe_barrier(PIPE_V);
+
+        outQueueY_.EnQue<Y_T>(yOutLocal);
+    }
+
+    __aicore__ inline void CopyOut(int32_t tokenSlot, int32_t progress, int32_t numElements = Y_OUT_TILE_NUM_ELEMENTS)
+    {
+        AscendC::LocalTensor<Y_T> yOutLocal = outQueueY_.DeQue<Y_T>();
+        DataCopy(yOutGm_[YOffset(tokenSlot) + progress * Y_OUT_TILE_NUM_ELEMENTS], yOutLocal, numElements);
+        outQueueY_.FreeTensor(yOutLocal);
+    }
+
+    __aicore__ inline uint64_t YOffset(int32_t tokenSlot)
+    {
+        return static_cast<uint64_t>(outputFullDim_) * (startIdx_ + tokenSlot) + sliceOffset_;
+    }
+
+private:
+    AscendC::TPipe *pipe_;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueY_, inQueueW_;
+    AscendC::TQue<AscendC::QuePosition::VECIN, 1> inQueueX_;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueY_;
+    // blockBuffer_ holds the fp32 x tiles of the block during the shrink and its fp32 y tiles during the expand
+    AscendC::TBuf<AscendC::QuePosition::VECCALC> tmpBufferW_, prodBufferW_, blockBuffer_, inBufferY_, accBufferX_,
+        dupBufferX_;
+    AscendC::GlobalTensor<X_T> xGm_;
+    AscendC::GlobalTensor<W_T> wAGm_;
+    AscendC::GlobalTensor<W_T> wBGm_;
+    AscendC::GlobalTensor<Y_T> yInGm_;
+    AscendC::GlobalTensor<Y_T> yOutGm_;
+    AscendC::GlobalTensor<int32_t> loraIndicesGm_;
+    AscendC::GlobalTensor<int32_t> seqLenGm_;
+    AscendC::GlobalTensor<int32_t> loraRanksGm_;
+    AscendC::GlobalTensor<half> loraScalesGm_;
+    AscendC::GlobalTensor<int32_t> sliceOffsetsGm_;
+    uint32_t batchSize_;
+    uint32_t inputHiddenDim_;
+    uint32_t sliceCount_;
+    uint32_t maxLoRARank_;
+    uint32_t outputHiddenDim_;
+    uint32_t sliceOffset_;
+    uint32_t outputFullDim_;
+    uint32_t singleLoRAWeightALen_;
+    uint32_t singleLoRAWeightBLen_;
+    int32_t reqLoRARank_;
+    float reqLoRAScale_;
+    uint64_t reqLoRAWeightAOffset_;
+    uint64_t reqLoRAWeightBOffset_;
+    int32_t reqSlice_;
+    int64_t startIdx_;
+    int32_t numTokens_;
+    bool packedRank_;
+    uint32_t weightRowLen_;
+    uint32_t numOutputElementsPerInputTile_;
+    uint32_t numStreamInPerOutputTile_;
+
+    // Same repeat layout as SGEMMVExpand
+    AscendC::UnaryRepeatParams castParams_ = {1, 1, 8, 4};
+    AscendC::UnaryRepeatParams reduceSumParams_ = {1, 1, 1, 8};
+    AscendC::BinaryRepeatParams dotProductParams_ = {1, 1, 1, 8, 0, 8};
+};
+
+#define SGMV_SHRINK_EXPAND_TYPE_DECLARE(TYPE)                                                                          \
+    extern "C" __global__ __aicore__ void sgmv_shrink_expand_##TYPE(                                                   \
+        GM_ADDR x, GM_ADDR weightA, GM_ADDR weightB, GM_ADDR loraIndices, uint32_t loraIndicesSize, GM_ADDR seqLen,    \
+        uint32_t seqLenSize, GM_ADDR loraRanks, uint32_t loraRanksSize, GM_ADDR loraScales, uint32_t loraScalesSize,   \
+        GM_ADDR sliceOffsets, uint32_t sliceOffsetsSize, GM_ADDR yIn, GM_ADDR yOut, uint32_t batchSize,                \
+        uint32_t inputHiddenDim, uint32_t maxLoRARank, uint32_t outputFullDim)                                         \
+    {                                                                                                                  \
+        AscendC::TPipe pipe;                                                                                           \
+        SGMVShrinkExpand<TYPE> op(&pipe);                                                                              \
+        op.Init(x, weightA, weightB, loraIndices, loraIndicesSize, seqLen, seqLenSize, loraRanks, loraRanksSize,       \
+                loraScales, loraScalesSize, sliceOffsets, sliceOffsetsSize, yIn, yOut, batchSize, inputHiddenDim,      \
+                maxLoRARank, outputFullDim);                                                                           \
+        op.Process();                                                                                                  \
+    }
+
+// declare all dtype kernel
+SGMV_SHRINK_EXPAND_TYPE_DECLARE(half)
+#if (__CCE_AICORE__ >= 220)
+SGMV_SHRINK_EXPAND_TYPE_DECLARE(bfloat16_t)
+#endif
+
+#endif  // SGL_KERNEL_NPU_KERNEL_SGMV_SHRINK_EXPAND_H
@@ -11,6 +11,7 @@
 // See LICENSE in the root of the software repository for the full text of the License.
 //
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <math.h>
@@ -18,7 +19,8 @@
 #include "acl/acl.h"
 #include "defines.h"
 #include "torch_helper.h"
-#include "tiling/platform/platform_ascendc.h"
+#include "tiling_cache.h"
+#include "platform_info.h"
 #include "tiling/mla_preprocess_tiling.h"
 
 #include "aclrtlaunch_mla_preprocess.h"
@@ -41,13 +43,9 @@ constexpr uint32_t L0AB_PINGPONG_BUFFER_LEN = 131072;
 constexpr uint32_t L1_SCALE_SIZE = 4096;
 constexpr uint32_t L1_BIAS_SIZE = 2048;
 constexpr uint32_t L0C_SIZE = 128 * 1024;
-constexpr uint32_t CONCAT_SIZE = 512;
 
-constexpr uint32_t HIDDEN_STRATE_ROPE = 192;
-constexpr uint32_t HIDDEN_STRATE_MM = 2112;
-constexpr uint32_t HIDDEN_STRATE_RMS = 1536;
 constexpr uint32_t UB_SIZE = 196352;
-constexpr uint32_t HEADDIM = 64;
+constexpr uint32_t SLOT_MAPPING_UB_SIZE = 4096 * 32;
 constexpr uint32_t FP32_REPEAT_MASK = 64;
 constexpr uint32_t FP16_REPEAT_MASK = 128;
 
@@ -60,9 +58,6 @@ constexpr uint32_t INDEX_WDQKV = 5;
 constexpr uint32_t INDEX_WUQ = 18;
 constexpr uint32_t INDEX_WUK = 20;
 
-constexpr uint32_t MAX_SUPPORT_TOKEN_NUMS = 1024;
-constexpr uint32_t MAX_CACHE_MODE_NUMS = 3;
-
 inline uint32_t CeilDiv(const uint32_t dividend, const uint32_t divisor)
 {
     if (divisor == 0) {
@@ -125,6 +120,10 @@ struct OpParam {
     uint32_t hiddenStateDim;
     uint32_t N;
     uint32_t headNum;
+    uint32_t qLoraRank;
+    uint32_t kvLoraRank;
+    uint32_t qkNopeHeadDim;
+    uint32_t qkRopeHeadDim;
     int32_t cacheMode;
     QuantMode quantMode;
     caffe2::TypeMeta inDtype;
@@ -384,6 +383,15 @@ public:
     void SetMlapoWorkSpace();
 
 private:
+    uint32_t Mm1OutSize() const
+    {
+        return opParam.qLoraRank + opParam.kvLoraRank + opParam.qkRopeHeadDim;
+    }
+    uint32_t QHeadDim() const
+    {
+        return opParam.qkNopeHeadDim + opParam.qkRopeHeadDim;
+    }
+
     MlaTilingData *tilingData;
     struct PlatformInfo platformInfo;
     struct OpParam opParam;
@@ -396,7 +404,7 @@ void MlaPreprocessTiling::RmsNormQuantTiling()
     tilingData->rmsNumRow1 = opParam.N;
     tilingData->rmsQuantMin1 = -CONST_128;
     tilingData->rmsNumCore2 = platformInfo.coreNumAiv;
-    tilingData->rmsNumCol2 = HIDDEN_STRATE_MM;
+    tilingData->rmsNumCol2 = Mm1OutSize();
     tilingData->rmsNumRow2 = opParam.N;
     tilingData->rmsQuantMin2 = -CONST_128;
 }
@@ -404,10 +412,10 @@ void MlaPreprocessTiling::RmsNormQuantTiling()
 void MlaPreprocessTiling::RopeConcatTiling()
 {
     uint32_t ntokens = opParam.N;
-    uint32_t hiddenSizeQ = HEADDIM * opParam.headNum;
-    uint32_t headDim = HEADDIM;
+    uint32_t hiddenSizeQ = opParam.qkRopeHeadDim * opParam.headNum;
+    uint32_t headDim = opParam.qkRopeHeadDim;
     uint32_t headNumQ = hiddenSizeQ / headDim;
-    uint32_t concatSize = CONCAT_SIZE;
+    uint32_t concatSize = opParam.kvLoraRank;
     uint32_t maxCore = platformInfo.coreNumAiv;
     uint32_t maxUbSize = platformInfo.ubSize;
 
@@ -457,7 +465,7 @@ void MlaPreprocessTiling::EinSumQuantTiling()
     // input shape
     uint32_t esqBatch = opParam.N;          // tokenNum
     uint32_t esqHeadNum = opParam.headNum;  // headNum
-    uint32_t esqColNum = AXES_ALIGN_SIZE;   // 512
+    uint32_t esqColNum = opParam.kvLoraRank;
 
     // split core
     uint32_t esqFrontCore = esqBatch % aivCore;
@@ -509,12 +517,12 @@ void MlaPreprocessTiling::SetMlapoWorkSpace()
 {
     uint64_t s1wsFactor =
         static_cast<uint64_t>(opParam.cacheMode == 2 ? std::max(opParam.hiddenStateDim * sizeof(int8_t),
-                                                                opParam.headNum * AXES_ALIGN_SIZE * sizeof(uint16_t))
+                                                                opParam.headNum * opParam.kvLoraRank * sizeof(uint16_t))
                                                      : opParam.hiddenStateDim * sizeof(int8_t));
     uint64_t workSizeS1 = s1wsFactor;
-    uint64_t workSizeS2 = opParam.headNum * HIDDEN_STRATE_ROPE * sizeof(uint16_t);
-    uint64_t workSizeS3 = HIDDEN_STRATE_MM * sizeof(uint16_t);
-    uint64_t workSizeS4 = std::max(opParam.headNum * HIDDEN_STRATE_ROPE, HIDDEN_STRATE_MM) * sizeof(uint32_t);
+    uint64_t workSizeS2 = opParam.headNum * QHeadDim() * sizeof(uint16_t);
+    uint64_t workSizeS3 = Mm1OutSize() * sizeof(uint16_t);
+    uint64_t workSizeS4 = std::max(opParam.headNum * QHeadDim(), Mm1OutSize()) * sizeof(uint32_t);
 
     uint64_t maxWorkspaceSize = workSizeS1;
     maxWorkspaceSize = std::max(maxWorkspaceSize, workSizeS2);
@@ -554,6 +562,10 @@ void MlaPreprocessTiling::Init()
     tilingData->numCore = platformInfo.coreNumAic;
     tilingData->n = opParam.N;
     tilingData->hiddenStateDim = opParam.hiddenStateDim;
+    tilingData->qLoraRank = opParam.qLoraRank;
+    tilingData->kvLoraRank = opParam.kvLoraRank;
+    tilingData->qkNopeHeadDim = opParam.qkNopeHeadDim;
+    tilingData->qkRopeHeadDim = opParam.qkRopeHeadDim;
     bool deqOnTheFly = false;
     if (opParam.inDtype == at::kBFloat16 || opParam.quantMode == QuantMode::PER_TOKEN_SYMM_QUANT) {
         deqOnTheFly = true;
@@ -563,7 +575,7 @@ void MlaPreprocessTiling::Init()
                                    1,                       // numBatch
                                    opParam.N,               // m
                                    opParam.hiddenStateDim,  // k
-                                   HIDDEN_STRATE_MM,        // n
+                                   Mm1OutSize(),            // n
                                    false,                   // transA
                                    true,                    // transB
                                    true,                    // enDequant
@@ -571,25 +583,25 @@ void MlaPreprocessTiling::Init()
     mm1TilingApi.GetTilingData(tilingData->mm1);
 
     PpMatmulTilingApi mm2TilingApi(platformInfo,
-                                   1,                                     // numBatch
-                                   opParam.N,                             // m
-                                   HIDDEN_STRATE_RMS,                     // k
-                                   opParam.headNum * HIDDEN_STRATE_ROPE,  // n
-                                   false,                                 // transA
-                                   true,                                  // transB
-                                   true,                                  // enDequant
-                                   deqOnTheFly);                          // in bf16.cce?
+                                   1,                             // numBatch
+                                   opParam.N,                     // m
+                                   opParam.qLoraRank,             // k
+                                   opParam.headNum * QHeadDim(),  // n
+                                   false,                         // transA
+                                   true,                          // transB
+                                   true,                          // enDequant
+                                   deqOnTheFly);                  // in bf16.cce?
     mm2TilingApi.GetTilingData(tilingData->mm2);
 
     PpMatmulTilingApi mm3TilingApi(platformInfo,
-                                   opParam.headNum,  // numBatch
-                                   opParam.N,        // m
-                                   CONST_128,        // k
-                                   CONCAT_SIZE,      // n
-                                   false,            // transA
-                                   false,            // transB
-                                   false,            // enDequant
-                                   deqOnTheFly);     // in bf16.cce?
+                                   opParam.headNum,        // numBatch
+                                   opParam.N,              // m
+                                   opParam.qkNopeHeadDim,  // k
+                                   opParam.kvLoraRank,     // n
+                                   false,                  // transA
+                                   false,                  // transB
+                                   false,                  // enDequant
+                                   deqOnTheFly);           // in bf16.cce?
     mm3TilingApi.GetTilingData(tilingData->mm3);
 
     RmsNormQuantTiling();
@@ -602,6 +614,45 @@ void MlaPreprocessTiling::Init()
     return;
 }
 
+// Mirrors the UB layout of the rmsNormQuant2 and RmsNormAndRopeConvergence1 stages in
+// MLAOperation::ProcessVector (op_kernel/mla_preprocess_mix_bf16.hpp), the larger of the two kernels.
+uint64_t GetVectorUbSize(const OpParam &opParam)
+{
+    uint32_t mm1OutSize = opParam.qLoraRank + opParam.kvLoraRank + opParam.qkRopeHeadDim;
+    uint64_t mm1OutAlignFp32 = RoundUp(mm1OutSize, FP32_REPEAT_MASK);
+    uint64_t qAlignFp32 = RoundUp(opParam.qLoraRank, FP32_REPEAT_MASK);
+
+    // rmsNormQuant2: input row, gamma/beta, scale/offset, then the fp32 scratch and the int8 output
+    uint64_t rmsScratchOffset = mm1OutSize * NUM2 + opParam.qLoraRank * NUM4 + CONST_32 * NUM2 + mm1OutAlignFp32 * NUM4;
+    uint64_t rmsScratchEnd = rmsScratchOffset + (qAlignFp32 * NUM4 + CONST_16 + mm1OutSize * NUM2) * sizeof(float);
+    uint64_t rmsOutEnd = rmsScratchOffset + mm1OutAlignFp32 * NUM3 * NUM4 + CONST_32 * NUM2 + mm1OutSize * NUM8 +
+                         CONST_32 + opParam.qLoraRank;
+
+    // RmsNormAndRopeConvergence1: input row, gamma, sin/cos, slot mapping, fp32 scratch, kv output row
+    uint64_t ropeOutOffset = mm1OutSize * NUM2 + opParam.kvLoraRank * NUM2 + opParam.qkRopeHeadDim * NUM4 +
+                             SLOT_MAPPING_UB_SIZE + opParam.kvLoraRank * NUM3 * NUM4 +
+                             opParam.qkRopeHeadDim * NUM2 * NUM4 + mm1OutSize * NUM8 + CONST_32;
+    uint64_t ropeOutEnd = ropeOutOffset + (opParam.kvLoraRank + opParam.qkRopeHeadDim) * sizeof(uint16_t);
+
+    return std::max({rmsScratchEnd, rmsOutEnd, ropeOutEnd});
+}
+
+void CheckMlaDims(const OpParam &opParam)
+{
+    TORCH_CHECK(opParam.qLoraRank > 0 && opParam.qLoraRank % CONST_32 == 0,
+                "q_lora_rank must be a positive multiple of 32, got ", opParam.qLoraRank);
+    TORCH_CHECK(opParam.kvLoraRank > 0 && opParam.kvLoraRank % CONST_32 == 0,
+                "kv_lora_rank must be a positive multiple of 32, got ", opParam.kvLoraRank);
+    TORCH_CHECK(opParam.qkNopeHeadDim > 0 && opParam.qkNopeHeadDim % CONST_16 == 0,
+                "qk_nope_head_dim must be a positive multiple of 16, got ", opParam.qkNopeHeadDim);
+    TORCH_CHECK(opParam.qkRopeHeadDim > 0 && opParam.qkRopeHeadDim % CONST_16 == 0,
+                "qk_rope_head_dim must be a positive multiple of 16, got ", opParam.qkRopeHeadDim);
+    uint64_t ubSize = GetVectorUbSize(opParam);
+    TORCH_CHECK(ubSize <= UB_SIZE, "mla_preprocess dims (q_lora_rank=", opParam.qLoraRank,
+                ", kv_lora_rank=", opParam.kvLoraRank, ", qk_rope_head_dim=", opParam.qkRopeHeadDim,
+                ") need ", ubSize, " bytes of UB, more than ", UB_SIZE);
+}
+
 std::unordered_map<c10::string_view, uint16_t> cache_mode_map = {
     {"krope_ctkv", 1}, {"int8_nzcache", 2}, {"nzcache", 3}};
 
@@ -642,59 +693,68 @@ std::tuple<at::Tensor &, at::Tensor &, at::Tensor &, at::Tensor &> mla_preproces
             ? q_nope_scale.value()
             : at::empty({1}, at::TensorOptions().dtype(at::kHalf).device(hiddenState.options().device()));
 
-    platform_ascendc::PlatformAscendC *platformAscendC = platform_ascendc::PlatformAscendCManager::GetInstance();
-
-    struct PlatformInfo platformInfo;
-    platformInfo.coreNum = platformAscendC->GetCoreNum();
-    platformInfo.coreNumAic = platformAscendC->GetCoreNumAic();
-    platformInfo.coreNumAiv = platformAscendC->GetCoreNumAiv();
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::UB, platformInfo.ubSize);
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::L1, platformInfo.l1Size);
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::L2, platformInfo.l2Size);
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::L0_A, platformInfo.l0aSize);
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::L0_B, platformInfo.l0bSize);
-    platformAscendC->GetCoreMemSize(platform_ascendc::CoreMemType::L0_C, platformInfo.l0cSize);
+    const auto &devicePlatform = PlatformInfoRegistry::Get(hiddenState.get_device());
 
     int32_t N = hiddenState.sizes()[0];
     int32_t headNum = wuk.sizes()[0];
     uint32_t hiddenStateDim = hiddenState.sizes().back();
+    TORCH_CHECK(N > 0, "token num must be positive, got ", N);
+    TORCH_CHECK(wuk.dim() == 3, "wuk must be [head_num, qk_nope_head_dim, kv_lora_rank], got ", wuk.sizes());
+    TORCH_CHECK(wuk.sizes()[2] == gamma2.numel(), "kv_lora_rank mismatch between wuk ", wuk.sizes(), " and gamma2 ",
+                gamma2.sizes());
 
     OpParam opParam;
     opParam.hiddenStateDim = hiddenStateDim;
     opParam.N = N;
     opParam.headNum = headNum;
+    opParam.qLoraRank = static_cast<uint32_t>(gamma1.numel());
+    opParam.kvLoraRank = static_cast<uint32_t>(gamma2.numel());
+    opParam.qkNopeHeadDim = static_cast<uint32_t>(wuk.sizes()[1]);
+    opParam.qkRopeHeadDim = static_cast<uint32_t>(cos.sizes().back());
     opParam.cacheMode = static_cast<int32_t>(cacheMode);
     opParam.quantMode = static_cast<QuantMode>(quantMode);
     opParam.inDtype = hiddenState.options().dtype();
+    CheckMlaDims(opParam);
 
-    MlaTilingData tilingData;
-    MlaPreprocessTiling mlaTiling(platformInfo, opParam, &tilingData);
-
-    mlaTiling.Init();
-    uint32_t blockDim = platformInfo.coreNumAic;
+    // tiling
+    at::Tensor tiling;
+    auto key = TilingKey("mla_preprocess")
+                   .Add(hiddenState.scalar_type())
+                   .Add(N)
+                   .Add(headNum)
+                   .Add(hiddenStateDim)
+                   .Add(opParam.qLoraRank)
+                   .Add(opParam.kvLoraRank)
+                   .Add(opParam.qkNopeHeadDim)
+                   .Add(opParam.qkRopeHeadDim)
+                   .Add(cacheMode)
+                   .Add(quantMode);
+    auto tilingData = TilingCache::Instance().GetOrCreate<MlaTilingData>(
+        key,
+        [&](MlaTilingData &mlaTilingData) {
+            struct PlatformInfo platformInfo;
+            platformInfo.coreNum = devicePlatform.coreNum;
+            platformInfo.coreNumAic = devicePlatform.coreNumAic;
+            platformInfo.coreNumAiv = devicePlatform.coreNumAiv;
+            platformInfo.ubSize = devicePlatform.ubSize;
+            platformInfo.l1Size = devicePlatform.l1Size;
+            platformInfo.l2Size = devicePlatform.l2Size;
+            platformInfo.l0aSize = devicePlatform.l0aSize;
+            platformInfo.l0bSize = devicePlatform.l0bSize;
+            platformInfo.l0cSize = devicePlatform.l0cSize;
+
+            MlaPreprocessTiling mlaTiling(platformInfo, opParam, &mlaTilingData);
+            mlaTiling.Init();
+        },
+        tiling);
+    uint32_t blockDim = tilingData.numCore;
 
     // workspace
-    uint64_t system_workspace_size = static_cast<uint64_t>(platformAscendC->GetLibApiWorkSpaceSize());
+    uint64_t system_workspace_size = static_cast<uint64_t>(devicePlatform.libApiWorkspaceSize);
     uint64_t workspace_size = system_workspace_size + tilingData.userWorkspaceSize;
     auto options = at::TensorOptions().dtype(at::kByte).device(hiddenState.options().device());
     auto workspace_tensor = at::empty({static_cast<int64_t>(workspace_size)}, options);
 
-    // tiling
-    int32_t bIndex = N - 1;
-    uint32_t tilingSize = sizeof(MlaTilingData);
-    int32_t tilingOffset = tilingSize * MAX_SUPPORT_TOKEN_NUMS * (opParam.cacheMode - 1) + (tilingSize * bIndex);
-    static auto global_tiling_data =
-        at::empty({tilingSize * MAX_SUPPORT_TOKEN_NUMS * MAX_CACHE_MODE_NUMS},
-                  at::TensorOptions().dtype(at::kByte).device(hiddenState.options().device()));
-    if (bIndex >= 0 && bIndex < MAX_SUPPORT_TOKEN_NUMS) {
-        aclrtMemcpy(global_tiling_data.data_ptr<uint8_t>() + tilingOffset, tilingSize, &tilingData, tilingSize,
-                    ACL_MEMCPY_HOST_TO_DEVICE);
-    } else {
-        // Handle the case where bIndex is out of range
-        TORCH_CHECK(false, "bIndex is out of range: ", bIndex);
-    }
-    at::Tensor tiling = at::from_blob(global_tiling_data.data_ptr<uint8_t>() + tilingOffset, tilingSize, at::kByte);
-
     EXEC_KERNEL_CMD(mla_preprocess, blockDim, hiddenState, gamma0, beta0, quant_scale0, quant_offset0, wdqkv, bias0,
                     gamma1, beta1, quant_scale1, quant_offset1, gamma2, sin, cos, sin, cos, kv_cache, slotmapping, wuq,
                     bias1, wuk, descale0, descale1, CtkvScale, QnopeScale, q_out0, kv_cache_out0, q_out1, kv_cache_out1,
@@ -93,6 +93,12 @@ struct MlaTilingData {
 
     // hidden state dimension
     uint32_t hiddenStateDim{7168};
+
+    // MLA dimensions, defaults are the DeepSeek-V3 config
+    uint32_t qLoraRank{1536};
+    uint32_t kvLoraRank{512};
+    uint32_t qkNopeHeadDim{128};
+    uint32_t qkRopeHeadDim{64};
 };
 
 #endif  // MLAPREPROCESS_TILING_H
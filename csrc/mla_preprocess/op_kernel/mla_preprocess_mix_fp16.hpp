@@ -56,6 +56,7 @@ public:
         lastCoreLoopTime = ropeConcatParams.lastCoreLoopTime;
         lastCoreLoopNLast = ropeConcatParams.lastCoreLoopNLast;
         concatSize = ropeConcatParams.concatSize;
+        qkNopeHeadDim = ropeConcatParams.qkNopeHeadDim;
         blockIdx_ = (blockIdx_ / 2) * 2 + static_cast<uint64_t>(GetSubBlockidx());
         loopTime = (blockIdx_ == realCore - 1) ? lastCoreLoopTime : preCoreLoopTime;
         lastLoopN = (blockIdx_ == realCore - 1) ? lastCoreLoopNLast : preCoreLoopNLast;
@@ -65,6 +66,7 @@ public:
         headBlockLenFP32 = static_cast<uint16_t>(this->headDim / ELE_NUM_FP32);
         rotaryLen = static_cast<uint16_t>(this->rotateStride_ / ELE_NUM_FP32);
         concatBlockLen = static_cast<uint16_t>(this->concatSize / ELE_NUM_FP16);
+        nopeBlockLen = static_cast<uint16_t>(this->qkNopeHeadDim / ELE_NUM_FP16);
         outLineOffset = this->headDim + this->concatSize;
         uint32_t dataNum = this->headDim * this->maxNPerLoopForUb;
         dataSizeFp16 = dataNum * sizeof(QkDtype);
@@ -92,7 +94,7 @@ public:
             AscendC::LocalTensor<float> inputQCastFP32 = buf.GetBuffer<BufferType::ASCEND_UB, float>(dataSizeFp16);
             AscendC::LocalTensor<float> reverseQ =
                 buf.GetBuffer<BufferType::ASCEND_UB, float>(dataSizeFp32 + dataSizeFp16);
-            uint64_t qOffset = startHead * 192 + 128;
+            uint64_t qOffset = startHead * (qkNopeHeadDim + this->headDim) + qkNopeHeadDim;
             CopyQGenReverseQ(inputQ, inputQCastFP32, reverseQ, qOffset, loopN);
 
             // move in cos/sin
@@ -184,7 +186,7 @@ public:
         WAIT_FLAG(S, MTE2, EVENT_ID1);
         WAIT_FLAG(MTE3, MTE2, EVENT_ID1);
         // move in Q
-        AscendC::DataCopy(tempBufQ, this->qGm_[qOffset], {loopN, headBlockLen, 128 / 16, 0});
+        AscendC::DataCopy(tempBufQ, this->qGm_[qOffset], {loopN, headBlockLen, nopeBlockLen, 0});
         SET_FLAG(MTE2, V, EVENT_ID1);
         WAIT_FLAG(MTE2, V, EVENT_ID1);
         // cast fp32
@@ -238,6 +240,7 @@ private:
     uint32_t lastCoreLoopTime;
     uint32_t lastCoreLoopNLast;
     uint32_t concatSize;
+    uint32_t qkNopeHeadDim;
     uint32_t blockIdx_;
     uint32_t loopTime{0};   // The number of current data rounds
     uint32_t lastLoopN{0};  // The number of lines currently processed by tails kernel
@@ -248,6 +251,7 @@ private:
     uint16_t headBlockLenFP32{0};
     uint16_t rotaryLen{0};
     uint16_t concatBlockLen{0};
+    uint16_t nopeBlockLen{0};
     uint64_t outLineOffset{0};
 };
 
@@ -762,6 +766,11 @@ public:
                     AscendC::Mul(tempQuantFp16_[colOffset], inputTensor_[colOffset], scaleBrcbFp16_, CONST_128,
                                  headPerLoop, {1, 1, 0, calcRepeatStride, calcRepeatStride, 1});
                 }
+                if (colTail > 0) {
+                    colOffset = colLoop * CONST_128;
+                    AscendC::Mul(tempQuantFp16_[colOffset], inputTensor_[colOffset], scaleBrcbFp16_, colTail,
+                                 headPerLoop, {1, 1, 0, calcRepeatStride, calcRepeatStride, 1});
+                }
                 AscendC::PipeBarrier<PIPE_V>();
 
                 // quant fp16 --> int8
@@ -818,6 +827,11 @@ public:
                     AscendC::Mul(tempQuantFp16_[colOffset], inputTensor_[colOffset], scaleBrcbFp16_, CONST_128,
                                  headTail, {1, 1, 0, calcRepeatStride, calcRepeatStride, 1});
                 }
+                if (colTail > 0) {
+                    colOffset = colLoop * CONST_128;
+                    AscendC::Mul(tempQuantFp16_[colOffset], inputTensor_[colOffset], scaleBrcbFp16_, colTail,
+                                 headTail, {1, 1, 0, calcRepeatStride, calcRepeatStride, 1});
+                }
                 AscendC::PipeBarrier<PIPE_V>();
 
                 // quant fp16 --> int8
@@ -884,7 +898,7 @@ struct MatCoord {
     uint64_t n{0};
 };
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
 class PpMatmulEinSum
 {
     using InDtype = half;
@@ -946,14 +960,18 @@ private:
     uint32_t core_idx{0};
     uint32_t en_shuffle_k = 0;
     uint32_t ping_flag{0};
+    uint64_t splitGapA{0};
+    uint64_t splitGapC{0};
 };
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::Init(
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::Init(
     GM_ADDR gmA, GM_ADDR gmB, GM_ADDR gmC, const MlaTilingData &mlaParams)
 {
 #ifdef __DAV_C220_CUBE__
     batch_size = mlaParams.mm3.numBatch;
+    splitGapA = mlaParams.qkRopeHeadDim;
+    splitGapC = withGapC ? mlaParams.qkRopeHeadDim : 0;
     m = mlaParams.mm3.m;
     k = mlaParams.mm3.k;
     n = mlaParams.mm3.n;
@@ -982,9 +1000,9 @@ __aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect,
     return;
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
 __aicore__ __force_inline__ void
-PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::GetBaseBlockIdx(uint64_t index, MatCoord &tidx)
+PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::GetBaseBlockIdx(uint64_t index, MatCoord &tidx)
 {
     uint64_t in_batch_idx = index % (tdim.m * tdim.n);
     if constexpr (swizzleDirect == 0) {  // Zn
@@ -1019,8 +1037,8 @@ PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::GetBaseBlo
     return;
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::PreloadB()
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::PreloadB()
 {
 #ifdef __DAV_C220_CUBE__
     uint64_t batch_idx = core_idx / tdim.n / tdim.m;
@@ -1038,8 +1056,8 @@ __aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect,
 #endif
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ uint64_t PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::GetOffsetB(
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ uint64_t PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::GetOffsetB(
     const uint64_t batchIdx, const uint64_t kIdx, const uint64_t nIdx)
 {
     if constexpr (formatB == DataFormat::ND) {
@@ -1059,8 +1077,8 @@ __aicore__ __force_inline__ uint64_t PpMatmulEinSum<formatB, transB, swizzleDire
     }
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::CopyTileA(
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::CopyTileA(
     AscendC::LocalTensor<InDtype> &dstTensor, const AscendC::GlobalTensor<InDtype> &srcTensor, const uint64_t m_actual,
     const uint64_t m_round, const uint64_t k_actual, const uint64_t k_round)
 {
@@ -1085,8 +1103,8 @@ __aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect,
     }
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::CopyTileB(
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::CopyTileB(
     AscendC::LocalTensor<InDtype> &dstTensor, const AscendC::GlobalTensor<InDtype> &srcTensor, const uint64_t k_actual,
     const uint64_t k_round, const uint64_t n_actual, const uint64_t n_round)
 {
@@ -1133,8 +1151,8 @@ __aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect,
     }
 }
 
-template <DataFormat formatB, bool transB, uint32_t swizzleDirect, uint64_t splitGapA, uint64_t splitGapC>
-__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, splitGapA, splitGapC>::Process()
+template <DataFormat formatB, bool transB, uint32_t swizzleDirect, bool withGapC>
+__aicore__ __force_inline__ void PpMatmulEinSum<formatB, transB, swizzleDirect, withGapC>::Process()
 {
 #ifdef __DAV_C220_CUBE__
     if (block_idx >= num_core) {
@@ -2036,6 +2054,11 @@ public:
         this->epsilon_ = 1e-6;
         this->mlaParams = mlaParams_;
         this->hiddenStateDim = mlaParams_.hiddenStateDim;
+        this->qLoraRank = mlaParams_.qLoraRank;
+        this->kvLoraRank = mlaParams_.kvLoraRank;
+        this->qkRopeHeadDim = mlaParams_.qkRopeHeadDim;
+        this->kvSplitSize = kvLoraRank + qkRopeHeadDim;
+        this->mm1OutSize = qLoraRank + kvSplitSize;
     }
 
     __aicore__ inline void Init(GM_ADDR hiddenStateGm, GM_ADDR gamma1Gm, GM_ADDR beta1Gm, GM_ADDR quantScale1Gm,
@@ -2107,14 +2130,14 @@ public:
         }
         this->splitN = mlaParams.perTaskNum;
         Quant1.Init(gamma1GmTensor, beta1GmTensor, quantScale1GmTensor, quantOffset1GmTensor, hiddenStateGmTensor,
-                    s1GmTensor, 0, num_col_1, 0.0001395089285,
+                    s1GmTensor, 0, num_col_1, 1.0f / num_col_1,
                     vectorBlockIdx * static_cast<uint64_t>(row_work) * num_col_1,
                     vectorBlockIdx * static_cast<uint64_t>(row_work) * num_col_1, row_work_, mlaParams);
 
         rmsNormQuant2.Init(gamma2GmTensor, beta2GmTensor, quantScale2GmTensor, quantOffset2GmTensor, s3GmTensor,
-                           s1GmTensor, SPLIT_SIZE_ONE, num_col_2, 0.000651041666,
+                           s1GmTensor, kvSplitSize, num_col_2, 1.0f / qLoraRank,
                            vectorBlockIdx * static_cast<uint64_t>(row_work) * num_col_2,
-                           vectorBlockIdx * static_cast<uint64_t>(row_work) * SPLIT_SIZE_TWO, row_work_, mlaParams);
+                           vectorBlockIdx * static_cast<uint64_t>(row_work) * qLoraRank, row_work_, mlaParams);
         ropeFp16.RopeInit(s2GmTensor, cos2GmTensor, sin2GmTensor, qGmTensor, qGmTensor2, mlaParams);
         einSumQuant.Init(s1Gm, gmQnopeScale, qGm, mlaParams);
         ubTensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(0);
@@ -2142,10 +2165,10 @@ private:
         AscendC::LocalTensor<half> &tmpfp16, AscendC::LocalTensor<int8_t> &int8OutTensor, float quantScale3)
     {
         int64_t slotMapGmOffset = vectorBlockIdx * row_work;
-        AscendC::DataCopy(gammaTensor, gamma3GmTensor, SPLIT_RMSNRORM_SIZE_ONE);
+        AscendC::DataCopy(gammaTensor, gamma3GmTensor, kvLoraRank);
         SET_FLAG(MTE2, V, EVENT_ID1);
         WAIT_FLAG(MTE2, V, EVENT_ID1);
-        Cast(gammaFp32, gammaTensor, AscendC::RoundMode::CAST_NONE, SPLIT_RMSNRORM_SIZE_ONE);
+        Cast(gammaFp32, gammaTensor, AscendC::RoundMode::CAST_NONE, kvLoraRank);
         AscendC::DataCopyPad(slotMappingTensor, slotMappingGmTensor[slotMapGmOffset],
                              AscendC::DataCopyExtParams(1, sN * sizeof(int32_t), 0, 0, 0),
                              AscendC::DataCopyPadExtParams<int32_t>(false, 0, 8 - sN % 8, 0));
@@ -2154,134 +2177,127 @@ private:
         SET_FLAG(MTE2, S, EVENT_ID2);
         WAIT_FLAG(MTE2, S, EVENT_ID2);
         for (uint64_t loop = 0; loop < sN; ++loop) {
-            uint64_t offset = vectorBlockIdx * static_cast<uint64_t>(row_work) * num_col_2 + loop * MM1_OUT_SIZE;
+            uint64_t offset = vectorBlockIdx * static_cast<uint64_t>(row_work) * num_col_2 + loop * mm1OutSize;
             int64_t slotValue = static_cast<int64_t>(slotMappingTensor.GetValue(loop));
             if (slotValue == -1) {
                 continue;
             }
-            AscendC::DataCopy(srcTensor, s3GmTensor[offset], SPLIT_SIZE_ONE);
-            AscendC::DataCopy(sinTensor, sin1GmTensor[(row_work * vectorBlockIdx + loop) * SPLIT_RMSNRORM_SIZE_TWO],
-                              SPLIT_RMSNRORM_SIZE_TWO);
-            AscendC::DataCopy(cosTensor, cos1GmTensor[(row_work * vectorBlockIdx + loop) * SPLIT_RMSNRORM_SIZE_TWO],
-                              SPLIT_RMSNRORM_SIZE_TWO);
+            AscendC::DataCopy(srcTensor, s3GmTensor[offset], kvSplitSize);
+            AscendC::DataCopy(sinTensor, sin1GmTensor[(row_work * vectorBlockIdx + loop) * qkRopeHeadDim],
+                              qkRopeHeadDim);
+            AscendC::DataCopy(cosTensor, cos1GmTensor[(row_work * vectorBlockIdx + loop) * qkRopeHeadDim],
+                              qkRopeHeadDim);
             SET_FLAG(MTE2, V, EVENT_ID0);
             // ND
-            uint64_t cacheStart = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(SPLIT_SIZE_ONE);
-            uint64_t cacheStart1 = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(SPLIT_RMSNRORM_SIZE_ONE);
-            uint64_t cacheStart2 = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(SPLIT_RMSNRORM_SIZE_TWO);
+            uint64_t cacheStart = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(kvSplitSize);
+            uint64_t cacheStart1 = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(kvLoraRank);
+            uint64_t cacheStart2 = static_cast<uint64_t>(slotValue) * static_cast<uint64_t>(qkRopeHeadDim);
             // NZ
             uint32_t outer_idx = slotValue / 128;
             uint32_t inner_idx = slotValue % 128;
             SET_FLAG(S, MTE3, EVENT_ID0);
             /* RmsNorm start */
             WAIT_FLAG(MTE2, V, EVENT_ID0);
-            Cast(rmsNormTensor, srcTensor, AscendC::RoundMode::CAST_NONE, SPLIT_RMSNRORM_SIZE_ONE);
+            Cast(rmsNormTensor, srcTensor, AscendC::RoundMode::CAST_NONE, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
-            Mul(calTensor, rmsNormTensor, rmsNormTensor, SPLIT_RMSNRORM_SIZE_ONE);
+            Mul(calTensor, rmsNormTensor, rmsNormTensor, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
-            ReduceSumCustom(calTensor[SPLIT_RMSNRORM_SIZE_ONE], calTensor, calTensor[SPLIT_RMSNRORM_SIZE_ONE * 2],
-                            SPLIT_RMSNRORM_SIZE_ONE);
+            ReduceSumCustom(calTensor[kvLoraRank], calTensor, calTensor[kvLoraRank * 2], kvLoraRank);
             SET_FLAG(V, S, EVENT_ID1);
             WAIT_FLAG(V, S, EVENT_ID1);
-            float rms = sqrt(calTensor.GetValue(SPLIT_RMSNRORM_SIZE_ONE) / SPLIT_RMSNRORM_SIZE_ONE + epsilon_);
+            float rms = sqrt(calTensor.GetValue(kvLoraRank) / kvLoraRank + epsilon_);
             SET_FLAG(S, V, EVENT_ID1);
             WAIT_FLAG(S, V, EVENT_ID1);
             AscendC::PipeBarrier<PIPE_V>();
-            Duplicate(calTensor, rms, SPLIT_RMSNRORM_SIZE_ONE);
+            Duplicate(calTensor, rms, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
-            Div(calTensor, rmsNormTensor, calTensor, SPLIT_RMSNRORM_SIZE_ONE);
+            Div(calTensor, rmsNormTensor, calTensor, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
-            Mul(rmsNormTensor, gammaFp32, calTensor, SPLIT_RMSNRORM_SIZE_ONE);
+            Mul(rmsNormTensor, gammaFp32, calTensor, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
-            Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_NONE, SPLIT_RMSNRORM_SIZE_ONE);
+            Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_NONE, kvLoraRank);
             AscendC::PipeBarrier<PIPE_V>();
             if constexpr (cacheMode == CACHE_MODE_INT8_NZCACHE) {
                 // quant
-                Muls(rmsNormTensor, rmsNormTensor, quantScale3, SPLIT_RMSNRORM_SIZE_ONE);
+                Muls(rmsNormTensor, rmsNormTensor, quantScale3, kvLoraRank);
                 AscendC::PipeBarrier<PIPE_V>();
-                CastFrom32To16(tmpfp16, rmsNormTensor, SPLIT_RMSNRORM_SIZE_ONE);
+                CastFrom32To16(tmpfp16, rmsNormTensor, kvLoraRank);
                 AscendC::PipeBarrier<PIPE_V>();
-                CastFromF16ToI8(int8OutTensor, tmpfp16, -128, SPLIT_RMSNRORM_SIZE_ONE);
+                CastFromF16ToI8(int8OutTensor, tmpfp16, -128, kvLoraRank);
                 AscendC::PipeBarrier<PIPE_V>();
             } else {
                 AscendC::PipeBarrier<PIPE_V>();
                 if (std::is_same<T1, __bf16>::value) {
-                    Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_RINT, SPLIT_RMSNRORM_SIZE_ONE);
+                    Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_RINT, kvLoraRank);
                 } else {
-                    Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_NONE, SPLIT_RMSNRORM_SIZE_ONE);
+                    Cast(outTmpTensor, rmsNormTensor, AscendC::RoundMode::CAST_NONE, kvLoraRank);
                 }
             }
             /* RmsNorm end */
             // /* Rope K start */
-            uint64_t revertOffset = SPLIT_RMSNRORM_SIZE_TWO / 2;
-            Cast(ropeKTensor, srcTensor[SPLIT_RMSNRORM_SIZE_ONE], AscendC::RoundMode::CAST_NONE,
-                 SPLIT_RMSNRORM_SIZE_TWO);
-            Cast(ropeKRevertTensor[revertOffset], srcTensor[SPLIT_RMSNRORM_SIZE_ONE], AscendC::RoundMode::CAST_NONE,
-                 revertOffset);
-            Cast(ropeKRevertTensor, srcTensor[SPLIT_RMSNRORM_SIZE_ONE + revertOffset], AscendC::RoundMode::CAST_NONE,
-                 revertOffset);
+            uint64_t revertOffset = qkRopeHeadDim / 2;
+            Cast(ropeKTensor, srcTensor[kvLoraRank], AscendC::RoundMode::CAST_NONE, qkRopeHeadDim);
+            Cast(ropeKRevertTensor[revertOffset], srcTensor[kvLoraRank], AscendC::RoundMode::CAST_NONE, revertOffset);
+            Cast(ropeKRevertTensor, srcTensor[kvLoraRank + revertOffset], AscendC::RoundMode::CAST_NONE, revertOffset);
             Duplicate(calTensor, static_cast<float>(-1), revertOffset);
             Duplicate(calTensor[revertOffset], static_cast<float>(1), revertOffset);
             AscendC::PipeBarrier<PIPE_V>();
-            Cast(calTensor[SPLIT_RMSNRORM_SIZE_TWO], cosTensor, AscendC::RoundMode::CAST_NONE, SPLIT_RMSNRORM_SIZE_TWO);
-            Cast(calTensor[SPLIT_RMSNRORM_SIZE_TWO * 2], sinTensor, AscendC::RoundMode::CAST_NONE,
-                 SPLIT_RMSNRORM_SIZE_TWO);
+            Cast(calTensor[qkRopeHeadDim], cosTensor, AscendC::RoundMode::CAST_NONE, qkRopeHeadDim);
+            Cast(calTensor[qkRopeHeadDim * 2], sinTensor, AscendC::RoundMode::CAST_NONE, qkRopeHeadDim);
             AscendC::PipeBarrier<PIPE_V>();
-            Mul(ropeKTensor, calTensor[SPLIT_RMSNRORM_SIZE_TWO], ropeKTensor, SPLIT_RMSNRORM_SIZE_TWO);
-            Mul(ropeKRevertTensor, calTensor[SPLIT_RMSNRORM_SIZE_TWO * 2], ropeKRevertTensor, SPLIT_RMSNRORM_SIZE_TWO);
+            Mul(ropeKTensor, calTensor[qkRopeHeadDim], ropeKTensor, qkRopeHeadDim);
+            Mul(ropeKRevertTensor, calTensor[qkRopeHeadDim * 2], ropeKRevertTensor, qkRopeHeadDim);
             AscendC::PipeBarrier<PIPE_V>();
-            Mul(ropeKRevertTensor, calTensor, ropeKRevertTensor, SPLIT_RMSNRORM_SIZE_TWO);
+            Mul(ropeKRevertTensor, calTensor, ropeKRevertTensor, qkRopeHeadDim);
             AscendC::PipeBarrier<PIPE_V>();
-            Add(ropeKRevertTensor, ropeKTensor, ropeKRevertTensor, SPLIT_RMSNRORM_SIZE_TWO);
+            Add(ropeKRevertTensor, ropeKTensor, ropeKRevertTensor, qkRopeHeadDim);
             AscendC::PipeBarrier<PIPE_V>();
-            Cast(outTmpTensor[SPLIT_RMSNRORM_SIZE_ONE], ropeKRevertTensor, AscendC::RoundMode::CAST_NONE,
-                 SPLIT_RMSNRORM_SIZE_TWO);
+            Cast(outTmpTensor[kvLoraRank], ropeKRevertTensor, AscendC::RoundMode::CAST_NONE, qkRopeHeadDim);
             /* Rope K end */
             // reshapeAndcache
             SET_FLAG(V, MTE3, EVENT_ID0);
             WAIT_FLAG(V, MTE3, EVENT_ID0);
             WAIT_FLAG(S, MTE3, EVENT_ID0);
             if constexpr (cacheMode == CACHE_MODE_KVCACHE) {
-                DataCopy(keycacheGmTensor1[cacheStart], outTmpTensor, SPLIT_SIZE_ONE);
+                DataCopy(keycacheGmTensor1[cacheStart], outTmpTensor, kvSplitSize);
             } else if constexpr (cacheMode == CACHE_MODE_INT8_NZCACHE) {
                 // NZ
-                int64_t cacheSatartI8Nz1 = outer_idx * 128 * 512 + inner_idx * I8_C0_SIZE;
-                uint64_t cacheSatartNz2 = outer_idx * 128 * 64 + inner_idx * C0_SIZE;
+                int64_t cacheSatartI8Nz1 = outer_idx * 128 * kvLoraRank + inner_idx * I8_C0_SIZE;
+                uint64_t cacheSatartNz2 = outer_idx * 128 * qkRopeHeadDim + inner_idx * C0_SIZE;
                 AscendC::DataCopyExtParams outExt;
                 // nope:int8 nz
-                outExt.blockCount = SPLIT_RMSNRORM_SIZE_ONE / I8_C0_SIZE;
+                outExt.blockCount = kvLoraRank / I8_C0_SIZE;
                 outExt.blockLen = I8_C0_SIZE * sizeof(int8_t);
                 outExt.srcStride = 0;
                 outExt.dstStride = (128 * I8_C0_SIZE - I8_C0_SIZE) * sizeof(int8_t);
                 DataCopyPad(keycacheGmTensor1[cacheSatartI8Nz1], int8OutTensor, outExt);
                 // rope:T1 nz
-                outExt.blockCount = SPLIT_RMSNRORM_SIZE_TWO / C0_SIZE;
+                outExt.blockCount = qkRopeHeadDim / C0_SIZE;
                 outExt.blockLen = C0_SIZE * sizeof(T1);
                 outExt.srcStride = 0;
                 outExt.dstStride = (128 * C0_SIZE - C0_SIZE) * sizeof(T1);
-                DataCopyPad(keycacheGmTensor2[cacheSatartNz2], outTmpTensor[SPLIT_RMSNRORM_SIZE_ONE], outExt);
+                DataCopyPad(keycacheGmTensor2[cacheSatartNz2], outTmpTensor[kvLoraRank], outExt);
             } else if constexpr (cacheMode == CACHE_MODE_NZCACHE) {
-                uint64_t cacheSatartNz1 = outer_idx * 128 * 512 + inner_idx * C0_SIZE;
-                uint64_t cacheSatartNz2 = outer_idx * 128 * 64 + inner_idx * C0_SIZE;
+                uint64_t cacheSatartNz1 = outer_idx * 128 * kvLoraRank + inner_idx * C0_SIZE;
+                uint64_t cacheSatartNz2 = outer_idx * 128 * qkRopeHeadDim + inner_idx * C0_SIZE;
                 // nope:T1 nz
                 AscendC::DataCopyExtParams outExt;
-                outExt.blockCount = SPLIT_RMSNRORM_SIZE_ONE / C0_SIZE;
+                outExt.blockCount = kvLoraRank / C0_SIZE;
                 outExt.blockLen = C0_SIZE * sizeof(T1);
                 outExt.srcStride = 0;
                 outExt.dstStride = (128 * C0_SIZE - C0_SIZE) * sizeof(T1);
                 DataCopyPad(keycacheGmTensor1[cacheSatartNz1], outTmpTensor, outExt);
                 // rope:T1 nz
-                outExt.blockCount = SPLIT_RMSNRORM_SIZE_TWO / C0_SIZE;
+                outExt.blockCount = qkRopeHeadDim / C0_SIZE;
                 outExt.blockLen = C0_SIZE * sizeof(T1);
                 outExt.srcStride = 0;
                 outExt.dstStride = (128 * C0_SIZE - C0_SIZE) * sizeof(T1);
-                DataCopyPad(keycacheGmTensor2[cacheSatartNz2], outTmpTensor[SPLIT_RMSNRORM_SIZE_ONE], outExt);
+                DataCopyPad(keycacheGmTensor2[cacheSatartNz2], outTmpTensor[kvLoraRank], outExt);
             } else {
                 // keycache1
-                DataCopy(keycacheGmTensor1[cacheStart1], outTmpTensor, SPLIT_RMSNRORM_SIZE_ONE);
+                DataCopy(keycacheGmTensor1[cacheStart1], outTmpTensor, kvLoraRank);
                 // keycache2
-                DataCopy(keycacheGmTensor2[cacheStart2], outTmpTensor[SPLIT_RMSNRORM_SIZE_ONE],
-                         SPLIT_RMSNRORM_SIZE_TWO);
+                DataCopy(keycacheGmTensor2[cacheStart2], outTmpTensor[kvLoraRank], qkRopeHeadDim);
             }
             SET_FLAG(MTE3, MTE2, EVENT_ID1);
             WAIT_FLAG(MTE3, MTE2, EVENT_ID1);
@@ -2299,6 +2315,12 @@ private:
     uint32_t perTaskNum;
     uint32_t resTaskNum;
     uint32_t hiddenStateDim;
+    // an mm1 output row is [kv_lora_rank | qk_rope_head_dim | q_lora_rank]
+    uint32_t qLoraRank;
+    uint32_t kvLoraRank;
+    uint32_t qkRopeHeadDim;
+    uint32_t kvSplitSize;
+    uint32_t mm1OutSize;
     MlaTilingData mlaParams;
 
     // rmsnormQuant
@@ -2354,8 +2376,7 @@ private:
 #ifdef __DAV_C220_CUBE__
     PpMatmulW8a8<false, true, true, 0, DataFormat::ND, weightFormat1> mm_w8a8_1;
     PpMatmulW8a8<false, true, true, 1, DataFormat::ND, weightFormat2> mm_w8a8_2;
-    static constexpr uint64_t splitGapC = cacheMode == CACHE_MODE_KVCACHE ? CONST_64 : CONST_0;
-    PpMatmulEinSum<weightFormat3, false, 0, CONST_64, splitGapC> mm_ein_sum;
+    PpMatmulEinSum<weightFormat3, false, 0, cacheMode == CACHE_MODE_KVCACHE> mm_ein_sum;
 #endif
 
 #ifdef __DAV_C220_VEC__
@@ -2424,19 +2445,19 @@ __aicore__ inline void MLAOperation<cacheMode, weightFormat1, weightFormat2, wei
         uint32_t num_col_align_f16 = (num_col_2 + REPEAT_TIME_128 - 1) / REPEAT_TIME_128 * REPEAT_TIME_128;
         uint32_t num_col_align_f32 = (num_col_2 + REPEAT_TIME_64 - 1) / REPEAT_TIME_64 * REPEAT_TIME_64;
         AscendC::LocalTensor<half> input_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(0);
-        AscendC::LocalTensor<half> gamma_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(MM1_OUT_SIZE * 2);
+        AscendC::LocalTensor<half> gamma_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2);
         AscendC::LocalTensor<half> beta_tensor =
-            buf.GetBuffer<BufferType::ASCEND_UB, half>(MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2);
+            buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2 + qLoraRank * 2);
         AscendC::LocalTensor<half> scale_tensor =
-            buf.GetBuffer<BufferType::ASCEND_UB, half>(MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2 + SPLIT_SIZE_TWO * 2);
+            buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2 + qLoraRank * 2 + qLoraRank * 2);
         AscendC::LocalTensor<int8_t> offset_tensor = buf.GetBuffer<BufferType::ASCEND_UB, int8_t>(
-            MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2 + SPLIT_SIZE_TWO * 2 + 32);
+            mm1OutSize * 2 + qLoraRank * 2 + qLoraRank * 2 + 32);
         AscendC::LocalTensor<float> res1_tensor = buf.GetBuffer<BufferType::ASCEND_UB, float>(
-            MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2 + SPLIT_SIZE_TWO * 2 + 64);
+            mm1OutSize * 2 + qLoraRank * 2 + qLoraRank * 2 + 64);
         AscendC::LocalTensor<float> res3_tensor = buf.GetBuffer<BufferType::ASCEND_UB, float>(
-            MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2 + SPLIT_SIZE_TWO * 2 + 64 + num_col_align_f32 * 4);
+            mm1OutSize * 2 + qLoraRank * 2 + qLoraRank * 2 + 64 + num_col_align_f32 * 4);
         AscendC::LocalTensor<int8_t> output_tensor = buf.GetBuffer<BufferType::ASCEND_UB, int8_t>(
-            MM1_OUT_SIZE * 2 + SPLIT_SIZE_TWO * 2 + SPLIT_SIZE_TWO * 2 + 64 + num_col_align_f32 * 4 +
+            mm1OutSize * 2 + qLoraRank * 2 + qLoraRank * 2 + 64 + num_col_align_f32 * 4 +
             BUF_FACTOR * num_col_align_f32 * 4 + 32);
         rmsNormQuant2.Launch(output_tensor, input_tensor, gamma_tensor, beta_tensor, scale_tensor, offset_tensor,
                              res1_tensor, res3_tensor);
@@ -2447,19 +2468,18 @@ __aicore__ inline void MLAOperation<cacheMode, weightFormat1, weightFormat2, wei
 
     if (row_work_ != 0) {
         AscendC::LocalTensor<half> input_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(0);
-        AscendC::LocalTensor<half> gamma_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(MM1_OUT_SIZE * 2);
+        AscendC::LocalTensor<half> gamma_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2);
         AscendC::LocalTensor<half> sin_tensor =
-            buf.GetBuffer<BufferType::ASCEND_UB, half>(MM1_OUT_SIZE * 2 + SPLIT_RMSNRORM_SIZE_ONE * 2);
-        AscendC::LocalTensor<half> cos_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(
-            MM1_OUT_SIZE * 2 + SPLIT_RMSNRORM_SIZE_ONE * 2 + SPLIT_RMSNRORM_SIZE_TWO * 2);
-        AscendC::LocalTensor<int32_t> slotMapping_tensor = buf.GetBuffer<BufferType::ASCEND_UB, int32_t>(
-            MM1_OUT_SIZE * 2 + SPLIT_RMSNRORM_SIZE_ONE * 2 + SPLIT_RMSNRORM_SIZE_TWO * 4);
-        int32_t rms3_ub_offset =
-            MM1_OUT_SIZE * 2 + SPLIT_RMSNRORM_SIZE_ONE * 2 + SPLIT_RMSNRORM_SIZE_TWO * 4 + 4096 * 32;
+            buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2 + kvLoraRank * 2);
+        AscendC::LocalTensor<half> cos_tensor =
+            buf.GetBuffer<BufferType::ASCEND_UB, half>(mm1OutSize * 2 + kvLoraRank * 2 + qkRopeHeadDim * 2);
+        AscendC::LocalTensor<int32_t> slotMapping_tensor =
+            buf.GetBuffer<BufferType::ASCEND_UB, int32_t>(mm1OutSize * 2 + kvLoraRank * 2 + qkRopeHeadDim * 4);
+        int32_t rms3_ub_offset = mm1OutSize * 2 + kvLoraRank * 2 + qkRopeHeadDim * 4 + 4096 * 32;
         AscendC::LocalTensor<float> tmp32_tensor = buf.GetBuffer<BufferType::ASCEND_UB, float>(rms3_ub_offset);
 
-        int32_t out_ub_offset = MM1_OUT_SIZE * 2 + SPLIT_RMSNRORM_SIZE_ONE * 2 + SPLIT_RMSNRORM_SIZE_TWO * 4 +
-                                4096 * 32 + SPLIT_RMSNRORM_SIZE_ONE * 3 * 4 + SPLIT_RMSNRORM_SIZE_TWO * 2 * 4;
+        int32_t out_ub_offset = mm1OutSize * 2 + kvLoraRank * 2 + qkRopeHeadDim * 4 + 4096 * 32 + kvLoraRank * 3 * 4 +
+                                qkRopeHeadDim * 2 * 4;
         AscendC::LocalTensor<half> temp_tensor = buf.GetBuffer<BufferType::ASCEND_UB, half>(out_ub_offset);
 
         AscendC::LocalTensor<half> tmpfp16;
@@ -2471,8 +2491,7 @@ __aicore__ inline void MLAOperation<cacheMode, weightFormat1, weightFormat2, wei
             AscendC::LocalTensor<float> floatQuantScaleTensor =
                 buf.GetBuffer<BufferType::ASCEND_UB, float>(rms3_ub_offset + 32);
             // int8out
-            tmpfp16 = buf.GetBuffer<BufferType::ASCEND_UB, half>(rms3_ub_offset +
-                                                                 SPLIT_RMSNRORM_SIZE_ONE * sizeof(float) * 2);
+            tmpfp16 = buf.GetBuffer<BufferType::ASCEND_UB, half>(rms3_ub_offset + kvLoraRank * sizeof(float) * 2);
             int8OutTensor = buf.GetBuffer<BufferType::ASCEND_UB, int8_t>(out_ub_offset);
             AscendC::DataCopy(quantScaleTensor, quantScale3GmTensor, AscendC::DataCopyParams(1, 1, 0, 0));
             SET_FLAG(MTE2, V, EVENT_ID1);
@@ -2484,17 +2503,15 @@ __aicore__ inline void MLAOperation<cacheMode, weightFormat1, weightFormat2, wei
         }
 
         RmsNormAndRopeConvergence1<half>(
-            input_tensor,        // n * 576
+            input_tensor,        // n * kvSplitSize
             gamma_tensor,        // gamma
             sin_tensor,          // sin
             cos_tensor,          // cons
             slotMapping_tensor,  // slotMapping
-            row_work_, tmp32_tensor, tmp32_tensor[SPLIT_RMSNRORM_SIZE_ONE],
-            tmp32_tensor[SPLIT_RMSNRORM_SIZE_ONE + SPLIT_RMSNRORM_SIZE_ONE],
-            tmp32_tensor[SPLIT_RMSNRORM_SIZE_ONE + SPLIT_RMSNRORM_SIZE_ONE + SPLIT_RMSNRORM_SIZE_TWO],
-            tmp32_tensor[SPLIT_RMSNRORM_SIZE_ONE + SPLIT_RMSNRORM_SIZE_ONE + SPLIT_RMSNRORM_SIZE_TWO +
-                         SPLIT_RMSNRORM_SIZE_TWO],
-            temp_tensor, tmpfp16, int8OutTensor, scale3);
+            row_work_, tmp32_tensor, tmp32_tensor[kvLoraRank], tmp32_tensor[kvLoraRank + kvLoraRank],
+            tmp32_tensor[kvLoraRank + kvLoraRank + qkRopeHeadDim],
+            tmp32_tensor[kvLoraRank + kvLoraRank + qkRopeHeadDim + qkRopeHeadDim], temp_tensor, tmpfp16, int8OutTensor,
+            scale3);
     }
     WaitFlagDev(BMM3SPLIT);
     ropeFp16.Process();
@@ -14,6 +14,7 @@
 #include "version.h"
 
 #include "torch_helper.h"
+#include "tiling_cache.h"
 #include "sgl_kenel_npu_ops.h"
 #include "causal_conv1d_update/op_host/causal_conv1d_update.h"
 
@@ -23,6 +24,14 @@ TORCH_LIBRARY_FRAGMENT(npu, m)
     m.def("sgl_kernel_npu_print_version() -> ()", []() { printf("%s\n", LIB_VERSION_FULL); });
     m.def("sgl_kernel_npu_version() -> str", []() { return std::string("") + LIB_VERSION; });
 
+    // [hits, misses, entries] of the host tiling cache shared by all ops
+    m.def("tiling_cache_stats() -> int[]", []() {
+        auto &cache = sglang::npu_kernel::TilingCache::Instance();
+        return std::vector<int64_t>{static_cast<int64_t>(cache.Hits()), static_cast<int64_t>(cache.Misses()),
+                                    static_cast<int64_t>(cache.Size())};
+    });
+    m.def("tiling_cache_clear() -> ()", []() { sglang::npu_kernel::TilingCache::Instance().Clear(); });
+
     m.def("helloworld(Tensor x, Tensor y) -> Tensor");
 
     m.def(
@@ -46,6 +55,12 @@ TORCH_LIBRARY_FRAGMENT(npu, m)
         "Tensor tree_mask, Tensor positions, Tensor retrive_index, Tensor retrive_next_token, "
         "Tensor retrive_next_sibling, int topk, int depth, int draft_token_num, int tree_mask_mode)->()");
 
+    m.def(
+        "verify_tree_greedy(Tensor(a!) predicts, Tensor(b!) accept_index, Tensor(c!) accept_token_num, "
+        "Tensor candidates, Tensor retrive_index, Tensor retrive_next_token, Tensor retrive_next_sibling, "
+        "Tensor target_predict, *, Tensor? out_cache_loc=None, Tensor(d!)? accept_tokens=None, "
+        "Tensor(e!)? keep_cache_loc=None)->()");
+
     m.def(
         "mla_preprocess(Tensor hiddenState, Tensor gamma0, Tensor beta0, Tensor wdqkv, "
         "Tensor descale0, Tensor gamma1, Tensor beta1, Tensor wuq, "
@@ -67,6 +82,10 @@ TORCH_LIBRARY_FRAGMENT(npu, m)
         "Tensor device_v, Tensor host_v, "
         "Tensor device_indices, Tensor host_indices, int page_size, int direct, int flags) -> ()");
 
+    m.def(
+        "transfer_kv_dim_exchange_batch(Tensor[] device_bufs, Tensor[] host_bufs, "
+        "Tensor device_indices, Tensor host_indices, int page_size, int direct, int flags) -> ()");
+
     m.def(
         "bgmv_expand(Tensor! x, Tensor! weight, Tensor! indices, Tensor! y,"
         "            int slice_offset, int slice_size) -> Tensor");
@@ -88,6 +107,18 @@ TORCH_LIBRARY_FRAGMENT(npu, m)
         "sgemmv_shrink(Tensor! x, Tensor! weight, Tensor! lora_indices, Tensor! seq_len, Tensor! lora_ranks,"
         "              Tensor! lora_scales, Tensor! y) -> ()");
 
+    m.def(
+        "sgmv_grouped_expand(Tensor! x, Tensor! weight, Tensor! lora_indices, Tensor! seq_len, Tensor! lora_ranks,"
+        "                    Tensor! slice_offsets, Tensor! y) -> Tensor");
+
+    m.def(
+        "sgmv_grouped_shrink(Tensor! x, Tensor! weight, Tensor! lora_indices, Tensor! seq_len, Tensor! lora_ranks,"
+        "                    Tensor! lora_scales, Tensor! y) -> ()");
+
+    m.def(
+        "sgmv_shrink_expand(Tensor! x, Tensor! weight_a, Tensor! weight_b, Tensor! lora_indices, Tensor! seq_len,"
+        "                   Tensor! lora_ranks, Tensor! lora_scales, Tensor! slice_offsets, Tensor! y) -> Tensor");
+
     m.def(
         "recurrent_gated_delta_rule(Tensor mix_qkv, Tensor(a!) recurrent_state, Tensor beta, "
         "float scale, Tensor actual_seq_lengths, Tensor ssm_state_indices, "
@@ -129,11 +160,14 @@ TORCH_LIBRARY_IMPL(npu, PrivateUse1, m)
 
     m.impl("build_tree_kernel_efficient", TORCH_FN(sglang::npu_kernel::build_tree_efficient));
 
+    m.impl("verify_tree_greedy", TORCH_FN(sglang::npu_kernel::verify_tree_greedy));
+
     m.impl("mla_preprocess", TORCH_FN(sglang::npu_kernel::mla_preprocess));
 
     m.impl("batch_matmul_transpose", TORCH_FN(sglang::npu_kernel::batch_matmul_transpose));
 
     m.impl("transfer_kv_dim_exchange", TORCH_FN(sglang::npu_kernel::transfer_kv_dim_exchange));
+    m.impl("transfer_kv_dim_exchange_batch", TORCH_FN(sglang::npu_kernel::transfer_kv_dim_exchange_batch));
 
     m.impl("bgmv_expand", TORCH_FN(sglang::npu_kernel::bgmv_expand));
 
@@ -147,6 +181,12 @@ TORCH_LIBRARY_IMPL(npu, PrivateUse1, m)
 
     m.impl("sgemmv_shrink", TORCH_FN(sglang::npu_kernel::sgemmv_shrink));
 
+    m.impl("sgmv_grouped_expand", TORCH_FN(sglang::npu_kernel::sgmv_grouped_expand));
+
+    m.impl("sgmv_grouped_shrink", TORCH_FN(sglang::npu_kernel::sgmv_grouped_shrink));
+
+    m.impl("sgmv_shrink_expand", TORCH_FN(sglang::npu_kernel::sgmv_shrink_expand));
+
     m.impl("recurrent_gated_delta_rule", TORCH_FN(sglang::npu_kernel::recurrent_gated_delta_rule));
 
 #ifdef BUILD_CATLASS_MODULE
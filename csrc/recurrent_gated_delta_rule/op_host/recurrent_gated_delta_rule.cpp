@@ -21,10 +21,9 @@
 #include "torch_npu/csrc/core/npu/DeviceUtils.h"
 #include "torch_npu/csrc/framework/OpCommand.h"
 
-#include "tiling/platform/platform_ascendc.h"
-
 #include "defines.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 #include "aclrtlaunch_recurrent_gated_delta_rule.h"
 
 namespace sglang {
@@ -68,17 +67,15 @@ HOST_API at::Tensor recurrent_gated_delta_rule(at::Tensor &mix_qkv, at::Tensor &
     TORCH_CHECK(ssm_state_indices.size(0) == b, "ssm_state_indices batch size must match MixQKV");
     TORCH_CHECK(ssm_state_indices.size(1) == s, "ssm_state_indices sequence length must match MixQKV");
 
-    uint64_t ubSize{0UL};
-    auto ascendcPlatform = platform_ascendc::PlatformAscendCManager::GetInstance();
-    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
-
-    uint32_t coreNum = ascendcPlatform->GetCoreNum();
-
     int devidx = mix_qkv.device().index();
     c10_npu::set_device(devidx);
 
+    const auto &platformInfo = PlatformInfoRegistry::Get(devidx);
+    uint64_t ubSize = platformInfo.ubSize;
+    uint32_t coreNum = platformInfo.coreNum;
+
     // =================================Calculate the size of UB===================================
-    const int64_t MAX_MTP = 8;
+    const int64_t MTP_CHUNK = 8;  // tokens per sequence held in UB, the kernel streams longer sequences in chunks
     const int64_t ALIGN_SIZE = 16;
 
     auto ceilAlign = [](int64_t value, int64_t align) { return (value + align - 1) & ~(align - 1); };
@@ -89,15 +86,15 @@ HOST_API at::Tensor recurrent_gated_delta_rule(at::Tensor &mix_qkv, at::Tensor &
     int64_t aDv = ceilAlign(dv, ALIGN_SIZE);
     int64_t aDk = ceilAlign(dk, ALIGN_SIZE);
 
-    int64_t usedUbBytes = MAX_MTP * (4 * aDk + 2 * aDv);  // 4 for qLocal & kLocal, 2 for vLocal
-    usedUbBytes += 128;                                   // reserve 128 Bytes
-    usedUbBytes += MAX_MTP * (4 * aNv + 2 * aNv);         // 4 for gamaLocal, 2 for betaLocal
+    int64_t usedUbBytes = MTP_CHUNK * (4 * aDk + 2 * aDv);  // 4 for qLocal & kLocal, 2 for vLocal
+    usedUbBytes += 128;                                     // reserve 128 Bytes
+    usedUbBytes += MTP_CHUNK * (4 * aNv + 2 * aNv);         // 4 for gamaLocal, 2 for betaLocal
 
     int64_t ubRestBytes = ubSize - usedUbBytes;
 
-    usedUbBytes += MAX_MTP * (8 * aDk + 4 * aDv + 4 * aNv);  // 8 for qk in ub, 4 for v in ub, 4 for beta in ub
-    int64_t coeff = (2 + 2) * aDk + 4;                       // 2 for stateLocal, stateOutLocal, 4 for attnOutLocal
-    coeff += (4 + 4) * aDk + 4 + 4;                          // 4 for qInUb, kInUb, vInUb, deltaInUb, attnInUb
+    usedUbBytes += MTP_CHUNK * (8 * aDk + 4 * aDv + 4 * aNv);  // 8 for qk in ub, 4 for v in ub, 4 for beta in ub
+    int64_t coeff = (2 + 2) * aDk + 4;                         // 2 for stateLocal, stateOutLocal, 4 for attnOutLocal
+    coeff += (4 + 4) * aDk + 4 + 4;                            // 4 for qInUb, kInUb, vInUb, deltaInUb, attnInUb
 
     int64_t vStep = (ubSize - usedUbBytes) / coeff / 8 * 8;  // 8 * sizeof(float) = 32
     if (vStep < 8) {                                         // vStep must be no less than 8
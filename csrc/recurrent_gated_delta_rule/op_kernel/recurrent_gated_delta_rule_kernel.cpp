@@ -20,7 +20,7 @@ using namespace matmul;
 using namespace AscendC;
 
 constexpr uint64_t BUFFER_NUM = 1;
-constexpr uint64_t MAX_MTP = 8;
+constexpr uint64_t MTP_CHUNK = 8;  // tokens of a sequence held in UB at once, longer sequences are streamed
 constexpr uint64_t BF16_NUM_PER_BLOCK = 16;
 constexpr uint64_t FP32_NUM_PER_BLOCK = 8;
 constexpr uint32_t REPEAT_LENTH = 64;  // 256Byte for float
@@ -113,16 +113,16 @@ public:
     {
         uint32_t cubeSize = alignK_ * vStep_ * sizeof(float);
         uint32_t singleVSize = vStep_ * sizeof(float);
-        uint32_t vSize = MAX_MTP * alignV_ * sizeof(float);
-        uint32_t kSize = MAX_MTP * alignK_ * sizeof(float);
-        uint32_t betaUbNum = Ceil(MAX_MTP * NV_, BF16_NUM_PER_BLOCK) * BF16_NUM_PER_BLOCK;  // 8: 8 * 4 = 32B;
-        uint32_t sumLocalNum = Ceil(MAX_MTP, FP32_NUM_PER_BLOCK) * FP32_NUM_PER_BLOCK;
+        uint32_t vSize = MTP_CHUNK * alignV_ * sizeof(float);
+        uint32_t kSize = MTP_CHUNK * alignK_ * sizeof(float);
+        uint32_t betaUbNum = Ceil(MTP_CHUNK * NV_, BF16_NUM_PER_BLOCK) * BF16_NUM_PER_BLOCK;  // 8: 8 * 4 = 32B;
+        uint32_t sumLocalNum = Ceil(MTP_CHUNK, FP32_NUM_PER_BLOCK) * FP32_NUM_PER_BLOCK;
 
-        uint32_t inQSize = BUFFER_NUM * MAX_MTP * alignK_ * sizeof(inType);
-        uint32_t inVSize = BUFFER_NUM * MAX_MTP * alignV_ * sizeof(inType);
+        uint32_t inQSize = BUFFER_NUM * MTP_CHUNK * alignK_ * sizeof(inType);
+        uint32_t inVSize = BUFFER_NUM * MTP_CHUNK * alignV_ * sizeof(inType);
         uint32_t inStateSize = BUFFER_NUM * alignK_ * vStep_ * sizeof(inType);
-        uint32_t inGamaSize = BUFFER_NUM * MAX_MTP * NV_ * sizeof(float);
-        uint32_t inBetaSize = BUFFER_NUM * MAX_MTP * NV_ * sizeof(inType);
+        uint32_t inGamaSize = BUFFER_NUM * MTP_CHUNK * NV_ * sizeof(float);
+        uint32_t inBetaSize = BUFFER_NUM * MTP_CHUNK * NV_ * sizeof(inType);
         uint32_t outStateSize = BUFFER_NUM * alignK_ * vStep_ * sizeof(outType);
         uint32_t outAttnSize = BUFFER_NUM * vStep_ * sizeof(outType);
         uint32_t totalBufferSize = inQSize * 2 +   // Q and K queues (each double buffered)
@@ -136,22 +136,22 @@ public:
         pipe_->InitBuffer(stageBuff, totalBufferSize);
         uint32_t totalBufferOffset = 0;
         qLocal =
-            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MAX_MTP * alignK_), totalBufferOffset);
+            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MTP_CHUNK * alignK_), totalBufferOffset);
         totalBufferOffset += inQSize;
         kLocal =
-            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MAX_MTP * alignK_), totalBufferOffset);
+            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MTP_CHUNK * alignK_), totalBufferOffset);
         totalBufferOffset += inQSize;
         vLocal =
-            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MAX_MTP * alignV_), totalBufferOffset);
+            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MTP_CHUNK * alignV_), totalBufferOffset);
         totalBufferOffset += inVSize;
         stateLocal =
             stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * alignK_ * vStep_), totalBufferOffset);
         totalBufferOffset += inStateSize;
         gamaLocal =
-            stageBuff.GetWithOffset<float>(static_cast<uint32_t>(BUFFER_NUM * MAX_MTP * NV_), totalBufferOffset);
+            stageBuff.GetWithOffset<float>(static_cast<uint32_t>(BUFFER_NUM * MTP_CHUNK * NV_), totalBufferOffset);
         totalBufferOffset += inGamaSize;
         betaLocal =
-            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MAX_MTP * NV_), totalBufferOffset);
+            stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * MTP_CHUNK * NV_), totalBufferOffset);
         totalBufferOffset += inBetaSize;
         stateOutLocal =
             stageBuff.GetWithOffset<inType>(static_cast<uint32_t>(BUFFER_NUM * alignK_ * vStep_), totalBufferOffset);
@@ -163,16 +163,16 @@ public:
         buffOffset += singleVSize;
         attnInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(vStep_), buffOffset);
         buffOffset += singleVSize;
-        vInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MAX_MTP * alignV_), buffOffset);
+        vInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MTP_CHUNK * alignV_), buffOffset);
         buffOffset += vSize;
-        qInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MAX_MTP * alignK_), buffOffset);
+        qInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MTP_CHUNK * alignK_), buffOffset);
         buffOffset += kSize;
-        kInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MAX_MTP * alignK_), buffOffset);
+        kInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MTP_CHUNK * alignK_), buffOffset);
         buffOffset += kSize;
 
-        qTempInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MAX_MTP * alignK_), buffOffset);
+        qTempInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MTP_CHUNK * alignK_), buffOffset);
         buffOffset += kSize;
-        kTempInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MAX_MTP * alignK_), buffOffset);
+        kTempInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(MTP_CHUNK * alignK_), buffOffset);
         buffOffset += kSize;
 
         stateInUb = tmpBuff.GetWithOffset<float>(static_cast<uint32_t>(alignK_ * vStep_), buffOffset);
@@ -232,7 +232,10 @@ public:
                 if (hasIntermediateState_ && stateOffset % S_ == 0) {
                     needRecurrentInit_ = true;
                 }
-                CopyInGamaBeta(seq0, seq1);
+                // Sequences longer than one chunk load gama/beta chunk by chunk in ProcessHead
+                if (seq1 - seq0 <= MTP_CHUNK) {
+                    CopyInGamaBeta(seq0, seq1);
+                }
                 lastProcessedBatch = batchIdx;
             }
             in_empty_Beta.wait();
@@ -336,7 +339,7 @@ private:
         SetFlag<HardEvent::V_S>(eventIDS);
         WaitFlag<HardEvent::V_S>(eventIDS);
 
-        float normFactors[MAX_MTP];
+        float normFactors[MTP_CHUNK];
         for (uint32_t i = 0; i < seqLen; ++i) {
             normFactors[i] = kSumLocal.GetValue(i);
 
@@ -367,7 +370,7 @@ private:
         SetFlag<HardEvent::V_S>(eventIDS);
         WaitFlag<HardEvent::V_S>(eventIDS);
 
-        float normFactors[MAX_MTP];
+        float normFactors[MTP_CHUNK];
         for (uint32_t i = 0; i < seqLen; ++i) {
             normFactors[i] = qSumLocal.GetValue(i);
 
@@ -492,14 +495,19 @@ private:
 
         out_empty_Attn.wait();
 
-        Cast(stateOutLocal, stateInUb, AscendC::RoundMode::CAST_RINT, alignK_ * curSingleV);
+        // Padded draft slots (negative index) can never be accepted, their state is not written back
+        int32_t stateSlot = ssmStateIndicesGm_.GetValue(seq_i);
+        if (stateSlot >= 0) {
+            Cast(stateOutLocal, stateInUb, AscendC::RoundMode::CAST_RINT, alignK_ * curSingleV);
+        }
 
         out_ready_Attn.set();
         out_ready_Attn.wait();
 
-        uint64_t curStateOutOffset = ((ssmStateIndicesGm_.GetValue(seq_i) * NV_ + head_i) * realV_ + v_i) * realK_;
-
-        CopyOutState(curStateOutOffset, curSingleV);
+        if (stateSlot >= 0) {
+            uint64_t curStateOutOffset = ((static_cast<uint64_t>(stateSlot) * NV_ + head_i) * realV_ + v_i) * realK_;
+            CopyOutState(curStateOutOffset, curSingleV);
+        }
 
         for (uint32_t i = 0; i < alignK_ / VEC_FLOAT; i++) {
             // {1, 8} * {1, alignK_} => {1, alignK_}
@@ -576,9 +584,25 @@ private:
         WaitFlag<HardEvent::V_S>(eventIDS);
     }
 
+    __aicore__ inline void WaitVectorIdle()
+    {
+        AscendC::TEventID eventID = GetTPipePtr()->FetchEventID(HardEvent::V_MTE2);
+        SetFlag<HardEvent::V_MTE2>(eventID);
+        WaitFlag<HardEvent::V_MTE2>(eventID);
+    }
+
+    /**
+     * The state slice of a v step stays in UB for the whole sequence. Sequences longer than MTP_CHUNK walk their
+     * tokens chunk by chunk, reloading q/k/v and gama/beta of every chunk, so one launch covers any draft length.
+     * With the v loop outside, each chunk is loaded once per v step (ceil(dv / vStep), 2 for dk = dv = 128). Putting
+     * the chunk loop outside instead would round-trip the state slice (vStep x dk) through GM per chunk, which is
+     * larger than the q/k/v of a chunk and has no GM home when the chunk ends on a padded slot.
+     */
     __aicore__ inline void ProcessHead(int32_t seq0, int32_t seq1, uint64_t head_i, uint64_t stateOffset,
                                        uint64_t recurrentStateOffset)
     {
+        const int32_t chunkLen = static_cast<int32_t>(MTP_CHUNK);
+        bool streamed = seq1 - seq0 > chunkLen;
         qkvcopyFlag_ = false;
         for (uint64_t v_i = 0; v_i < realV_; v_i += vStep_) {
             uint32_t curSingleV = v_i + vStep_ > realV_ ? realV_ - v_i : vStep_;
@@ -586,12 +610,22 @@ private:
             uint64_t curRecurrentOffset = ((recurrentStateOffset * NV_ + head_i) * realV_ + v_i) * realK_;
 
             CopyInState(curStateOffset, curRecurrentOffset, curSingleV);
-            for (uint64_t seq_i = seq0; seq_i < seq1; seq_i++) {
-                uint64_t curQKOffset = (seq_i - seq0) * alignK_;
-                uint64_t curVOffset = (seq_i - seq0) * alignV_ + v_i;
-                uint64_t attnOffset = (seq_i * NV_ + head_i) * realV_ + v_i;
+            for (int32_t chunk0 = seq0; chunk0 < seq1; chunk0 += chunkLen) {
+                int32_t chunk1 = chunk0 + chunkLen < seq1 ? chunk0 + chunkLen : seq1;
+                if (streamed) {
+                    // The previous chunk's q/k/v and gama/beta buffers are overwritten
+                    WaitVectorIdle();
+                    CopyInGamaBeta(chunk0, chunk1);
+                    qkvcopyFlag_ = false;
+                }
+                for (uint64_t seq_i = chunk0; seq_i < chunk1; seq_i++) {
+                    uint64_t curQKOffset = (seq_i - chunk0) * alignK_;
+                    uint64_t curVOffset = (seq_i - chunk0) * alignV_ + v_i;
+                    uint64_t attnOffset = (seq_i * NV_ + head_i) * realV_ + v_i;
 
-                Compute(curSingleV, curQKOffset, curVOffset, seq_i, attnOffset, seq0, seq1, head_i, stateOffset, v_i);
+                    Compute(curSingleV, curQKOffset, curVOffset, seq_i, attnOffset, chunk0, chunk1, head_i,
+                            stateOffset, v_i);
+                }
             }
         }
     }
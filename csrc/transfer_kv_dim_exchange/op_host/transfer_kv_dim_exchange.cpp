@@ -8,6 +8,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <vector>
+
 #include "acl/acl.h"
 #include "defines.h"
 #include "torch_helper.h"
@@ -15,6 +18,8 @@
 namespace sglang {
 namespace npu_kernel {
 
+// 1D: host buffers share the layer-first device layout [layer, page, page_size, head, dim]
+// 2D: host buffers are page-first [page, layer, page_size, head, dim], layers are exchanged by a 2D copy
 constexpr int64_t KV_TRANS_FLAG_1D = 1 << 0;
 constexpr int64_t KV_TRANS_FLAG_2D = 1 << 1;
 
@@ -23,84 +28,190 @@ enum TransferDirection : int64_t {
     D2H = 2,
 };
 
+namespace {
+
+// A run of pages that are consecutive on both the device and the host side
+struct PageRun {
+    int64_t device_page;
+    int64_t host_page;
+    int64_t num_pages;
+};
+
+std::vector<PageRun> CoalescePageRuns(const at::Tensor &device_indices, const at::Tensor &host_indices,
+                                      int64_t page_size, int64_t device_pages_num, int64_t host_pages_num)
+{
+    auto device_indices_cpu = device_indices.to(at::kCPU, at::kLong).contiguous();
+    auto host_indices_cpu = host_indices.to(at::kCPU, at::kLong).contiguous();
+    const int64_t *device_idx = device_indices_cpu.data_ptr<int64_t>();
+    const int64_t *host_idx = host_indices_cpu.data_ptr<int64_t>();
+
+    std::vector<PageRun> runs;
+    const int64_t num_pages = device_indices_cpu.numel() / page_size;
+    for (int64_t i = 0; i < num_pages; ++i) {
+        const int64_t device_page = device_idx[i * page_size] / page_size;
+        const int64_t host_page = host_idx[i * page_size] / page_size;
+        TORCH_CHECK(device_page >= 0 && device_page < device_pages_num,
+                    "device_page_index must be less than the 2nd dim of device_k");
+        TORCH_CHECK(host_page >= 0 && host_page < host_pages_num,
+                    "host_page_index must be less than the page dim of host_k");
+        if (!runs.empty()) {
+            auto &last = runs.back();
+            if (last.device_page + last.num_pages == device_page && last.host_page + last.num_pages == host_page) {
+                ++last.num_pages;
+                continue;
+            }
+        }
+        runs.push_back({device_page, host_page, 1});
+    }
+    return runs;
+}
+
+void CheckKvPair(const at::Tensor &device_buf, const at::Tensor &host_buf, int64_t page_size, int64_t flags)
+{
+    TORCH_CHECK(device_buf.dim() == host_buf.dim(), "the number of dimensions of device buffer must be equal to host");
+    TORCH_CHECK(device_buf.dim() == 5, "the number of dimensions of device buffer must be 5");
+    TORCH_CHECK(device_buf.element_size() == host_buf.element_size(),
+                "device and host buffer must have the same element size");
+    const int64_t host_layer_dim = (flags & KV_TRANS_FLAG_2D) ? 1 : 0;
+    TORCH_CHECK(device_buf.sizes()[0] == host_buf.sizes()[host_layer_dim],
+                "the layer number of device buffer must be equal to host");
+    TORCH_CHECK(device_buf.sizes()[2] == page_size, "the 3rd dimension of device buffer must be equal to page size");
+    TORCH_CHECK(host_buf.sizes()[2] == page_size, "the 3rd dimension of host buffer must be equal to page size");
+    TORCH_CHECK(device_buf.sizes().slice(2) == host_buf.sizes().slice(2),
+                "the page shape of device buffer must be equal to host");
+    // a page of one layer must be dense, outer dims are addressed through strides
+    TORCH_CHECK(device_buf[0][0].is_contiguous() && host_buf[0][0].is_contiguous(),
+                "a page of one layer must be contiguous in both device and host buffers");
+    TORCH_CHECK(device_buf.stride(1) == device_buf[0][0].numel(), "pages of device buffer must be densely packed");
+    if (flags & KV_TRANS_FLAG_1D) {
+        TORCH_CHECK(host_buf.stride(1) == host_buf[0][0].numel(), "pages of host buffer must be densely packed");
+    }
+}
+
+void CopyRun(uint8_t *dst, size_t dst_pitch, const uint8_t *src, size_t src_pitch, size_t width, size_t height,
+             aclrtMemcpyKind kind, aclrtStream stream)
+{
+    auto ret = aclrtMemcpy2dAsync(dst, dst_pitch, src, src_pitch, width, height, kind, stream);
+    TORCH_CHECK(ret == ACL_SUCCESS, "aclrtMemcpy2dAsync failed, ret = ", ret);
+}
+
+void TransferBuffer(at::Tensor &device_buf, at::Tensor &host_buf, const std::vector<PageRun> &runs, bool d2h,
+                    int64_t flags, aclrtStream stream)
+{
+    const auto item_size = device_buf.element_size();
+    const int64_t num_layers = device_buf.sizes()[0];
+    const size_t page_bytes = device_buf[0][0].numel() * item_size;
+    const size_t device_layer_pitch = device_buf.stride(0) * item_size;
+    const size_t device_page_pitch = device_buf.stride(1) * item_size;
+    auto *device_base = static_cast<uint8_t *>(device_buf.data_ptr());
+    auto *host_base = static_cast<uint8_t *>(host_buf.data_ptr());
+    const auto kind = d2h ? ACL_MEMCPY_DEVICE_TO_HOST : ACL_MEMCPY_HOST_TO_DEVICE;
+
+    auto copy = [&](uint8_t *device_ptr, size_t device_pitch, uint8_t *host_ptr, size_t host_pitch, size_t width,
+                    size_t height) {
+        if (d2h) {
+            CopyRun(host_ptr, host_pitch, device_ptr, device_pitch, width, height, kind, stream);
+        } else {
+            CopyRun(device_ptr, device_pitch, host_ptr, host_pitch, width, height, kind, stream);
+        }
+    };
+
+    if (flags & KV_TRANS_FLAG_2D) {
+        const size_t host_page_pitch = host_buf.stride(0) * item_size;
+        const size_t host_layer_pitch = host_buf.stride(1) * item_size;
+        for (const auto &run : runs) {
+            uint8_t *device_ptr = device_base + run.device_page * device_page_pitch;
+            uint8_t *host_ptr = host_base + run.host_page * host_page_pitch;
+            if (run.num_pages > num_layers) {
+                // long run: one copy per layer, rows walk the pages of the run
+                for (int64_t layer = 0; layer < num_layers; ++layer) {
+                    copy(device_ptr + layer * device_layer_pitch, device_page_pitch,
+                         host_ptr + layer * host_layer_pitch, host_page_pitch, page_bytes, run.num_pages);
+                }
+            } else {
+                // short run: one copy per page, rows walk the layers
+                for (int64_t page = 0; page < run.num_pages; ++page) {
+                    copy(device_ptr + page * device_page_pitch, device_layer_pitch,
+                         host_ptr + page * host_page_pitch, host_layer_pitch, page_bytes, num_layers);
+                }
+            }
+        }
+    } else {
+        // same layout on both sides: a run is contiguous in every layer
+        const size_t host_layer_pitch = host_buf.stride(0) * item_size;
+        const size_t host_page_pitch = host_buf.stride(1) * item_size;
+        for (const auto &run : runs) {
+            copy(device_base + run.device_page * device_page_pitch, device_layer_pitch,
+                 host_base + run.host_page * host_page_pitch, host_layer_pitch, run.num_pages * page_bytes,
+                 num_layers);
+        }
+    }
+}
+
+}  // namespace
+
+// Copies the pages addressed by device_indices/host_indices for every (device, host) buffer pair.
+// The indices are read once for all buffers, and pages consecutive on both sides are merged into runs,
+// so the number of copies follows the number of discontinuities rather than the number of pages.
 // @direction: only support 1 or 2, 1 is H2D, 2 is D2H
-// @flags: only support 2
-HOST_API void transfer_kv_dim_exchange(at::Tensor &device_k, at::Tensor &host_k, at::Tensor &device_v,
-                                       at::Tensor &host_v, const at::Tensor &device_indices,
-                                       const at::Tensor &host_indices, int64_t page_size, int64_t direction,
-                                       int64_t flags)
+// @flags: 1 for the layer-first host layout, 2 for the page-first host layout
+HOST_API void transfer_kv_dim_exchange_batch(at::TensorList device_bufs, at::TensorList host_bufs,
+                                             const at::Tensor &device_indices, const at::Tensor &host_indices,
+                                             int64_t page_size, int64_t direction, int64_t flags)
 {
-    TORCH_CHECK(device_k.numel() != 0, "device_k must not be empty");
-    TORCH_CHECK(host_k.numel() != 0, "host_k must not be empty");
-    TORCH_CHECK(device_k.dim() == host_k.dim(), "the number of dimensions of device_k must be equal to host_k");
-    TORCH_CHECK(device_k.dim() == 5, "the number of dimensions of device_k must be 5");
-    TORCH_CHECK(device_k.sizes()[0] == host_k.sizes()[1], "the layer number of device_k must be equal to host_k");
-    TORCH_CHECK(device_k.sizes()[2] == page_size, "the 3rd dimension of device_k must be equal to page size");
-    TORCH_CHECK(host_k.sizes()[2] == page_size, "the 3rd dimension of host_k must be equal to page size");
     TORCH_CHECK(page_size > 0, "Page size must be positive");
+    TORCH_CHECK(!device_bufs.empty(), "device buffers must not be empty");
+    TORCH_CHECK(device_bufs.size() == host_bufs.size(), "device and host buffers must have the same number");
     TORCH_CHECK(device_indices.numel() == host_indices.numel(), "device and host indices must have the same length");
     TORCH_CHECK(device_indices.numel() % page_size == 0, "device indices size must be divisible by page size");
     TORCH_CHECK(direction == static_cast<int64_t>(TransferDirection::H2D) ||
                     direction == static_cast<int64_t>(TransferDirection::D2H),
-                "direction must be equal to 1(h2d) or 2(d2h)")
-    TORCH_CHECK((flags & KV_TRANS_FLAG_2D) == KV_TRANS_FLAG_2D, "now only support 2d(flags=2) copy");
+                "direction must be equal to 1(h2d) or 2(d2h)");
+    TORCH_CHECK(flags == KV_TRANS_FLAG_1D || flags == KV_TRANS_FLAG_2D, "flags must be equal to 1(1d) or 2(2d)");
 
-    if (device_v.numel() != 0 && host_v.numel() != 0) {
-        TORCH_CHECK(device_v.dim() == host_v.dim(), "the number of dimensions of device_v must be equal to host_v");
-        TORCH_CHECK(device_v.dim() == 5, "the number of dimensions of device_v must be 5");
-        TORCH_CHECK(device_v.sizes()[0] == host_v.sizes()[1], "the layer number of device_v must be equal to host_v");
-        TORCH_CHECK(device_v.sizes()[2] == page_size, "the 3rd dimension of device_v must be equal to page size");
-        TORCH_CHECK(host_v.sizes()[2] == page_size, "the 3rd dimension of host_v must be equal to page size");
+    for (const auto i : c10::irange(device_bufs.size())) {
+        TORCH_CHECK(device_bufs[i].numel() != 0, "device buffer must not be empty");
+        TORCH_CHECK(host_bufs[i].numel() != 0, "host buffer must not be empty");
+        CheckKvPair(device_bufs[i], host_bufs[i], page_size, flags);
+        TORCH_CHECK(device_bufs[i].sizes()[1] == device_bufs[0].sizes()[1],
+                    "all device buffers must have the same page number");
+    }
+    if (device_indices.numel() == 0) {
+        return;
     }
 
-    auto device_indices_cpu = device_indices.cpu();
-    auto host_indices_cpu = host_indices.cpu();
-    const int64_t device_pages_num = device_k.sizes()[1];
-    const int64_t host_pages_num = host_k.sizes()[0];
-    const int64_t total_num_layers = device_k.sizes()[0];
-    const auto heads_num = device_k.sizes()[3];
-    const auto item_size = device_k.element_size();
-    const auto k_head_dim = device_k.sizes()[4];
-    const auto k_device_pitch = device_pages_num * page_size * heads_num * k_head_dim * item_size;
-    const auto k_host_pitch = page_size * heads_num * k_head_dim * item_size;
-    const auto k_width = page_size * heads_num * k_head_dim * item_size;
-    const auto v_head_dim = device_v.sizes()[4];
-    const auto v_device_pitch = device_pages_num * page_size * heads_num * v_head_dim * item_size;
-    const auto v_host_pitch = page_size * heads_num * v_head_dim * item_size;
-    const auto v_width = page_size * heads_num * v_head_dim * item_size;
-    const auto height = total_num_layers;
-    c10_npu::NPUStream current_stream = c10_npu::getCurrentNPUStream();
-    aclrtStream acl_stream = current_stream.stream();
-
-    const int64_t num_pages = device_indices.size(0) / page_size;
-    for (const auto i : c10::irange(num_pages)) {
-        auto device_page_index = device_indices_cpu[i * page_size].item<int64_t>() / page_size;
-        auto host_page_index = host_indices_cpu[i * page_size].item<int64_t>() / page_size;
-        TORCH_CHECK(device_page_index < device_k.sizes()[1],
-                    "device_page_index must be less than the 2nd dim of device_k");
-        TORCH_CHECK(host_page_index < host_k.sizes()[0], "host_page_index must be less than the 1st dim of host_k");
+    const int64_t host_page_dim = (flags & KV_TRANS_FLAG_2D) ? 0 : 1;
+    int64_t host_pages_num = host_bufs[0].sizes()[host_page_dim];
+    for (const auto &host_buf : host_bufs) {
+        host_pages_num = std::min(host_pages_num, host_buf.sizes()[host_page_dim]);
+    }
+    const auto runs =
+        CoalescePageRuns(device_indices, host_indices, page_size, device_bufs[0].sizes()[1], host_pages_num);
 
-        void *device_k_ptr = reinterpret_cast<void *>(device_k[0][device_page_index].data_ptr());
-        void *host_k_ptr = reinterpret_cast<void *>(host_k[host_page_index][0].data_ptr());
-        if (direction == static_cast<int64_t>(TransferDirection::D2H)) {
-            aclrtMemcpy2dAsync(host_k_ptr, k_host_pitch, device_k_ptr, k_device_pitch, k_width, height,
-                               aclrtMemcpyKind::ACL_MEMCPY_DEVICE_TO_HOST, acl_stream);
-        } else {
-            aclrtMemcpy2dAsync(device_k_ptr, k_device_pitch, host_k_ptr, k_host_pitch, k_width, height,
-                               aclrtMemcpyKind::ACL_MEMCPY_HOST_TO_DEVICE, acl_stream);
-        }
+    aclrtStream acl_stream = c10_npu::getCurrentNPUStream().stream();
+    const bool d2h = direction == static_cast<int64_t>(TransferDirection::D2H);
+    for (const auto i : c10::irange(device_bufs.size())) {
+        at::Tensor device_buf = device_bufs[i];
+        at::Tensor host_buf = host_bufs[i];
+        TransferBuffer(device_buf, host_buf, runs, d2h, flags, acl_stream);
+    }
+}
 
-        if (device_v.numel() != 0 && host_v.numel() != 0) {
-            void *device_v_ptr = reinterpret_cast<void *>(device_v[0][device_page_index].data_ptr());
-            void *host_v_ptr = reinterpret_cast<void *>(host_v[host_page_index][0].data_ptr());
-            if (direction == static_cast<int64_t>(TransferDirection::D2H)) {
-                aclrtMemcpy2dAsync(host_v_ptr, v_host_pitch, device_v_ptr, v_device_pitch, v_width, height,
-                                   aclrtMemcpyKind::ACL_MEMCPY_DEVICE_TO_HOST, acl_stream);
-            } else {
-                aclrtMemcpy2dAsync(device_v_ptr, v_device_pitch, host_v_ptr, v_host_pitch, v_width, height,
-                                   aclrtMemcpyKind::ACL_MEMCPY_HOST_TO_DEVICE, acl_stream);
-            }
-        }
+// @direction: only support 1 or 2, 1 is H2D, 2 is D2H
+// @flags: 1 for the layer-first host layout, 2 for the page-first host layout
+HOST_API void transfer_kv_dim_exchange(at::Tensor &device_k, at::Tensor &host_k, at::Tensor &device_v,
+                                       at::Tensor &host_v, const at::Tensor &device_indices,
+                                       const at::Tensor &host_indices, int64_t page_size, int64_t direction,
+                                       int64_t flags)
+{
+    TORCH_CHECK(device_k.numel() != 0, "device_k must not be empty");
+    TORCH_CHECK(host_k.numel() != 0, "host_k must not be empty");
+    if (device_v.numel() != 0 && host_v.numel() != 0) {
+        transfer_kv_dim_exchange_batch({device_k, device_v}, {host_k, host_v}, device_indices, host_indices, page_size,
+                                       direction, flags);
+    } else {
+        transfer_kv_dim_exchange_batch({device_k}, {host_k}, device_indices, host_indices, page_size, direction,
+                                       flags);
     }
 }
 
@@ -10,6 +10,7 @@
 
 #include "defines.h"
 #include "torch_helper.h"
+#include "tiling_cache.h"
 
 #include "tiling_tri_inv.h"
 #include "aclrtlaunch_tri_inv_col_sweep_fp16.h"
@@ -21,18 +22,10 @@ namespace npu_kernel {
 
 at::Tensor calc_tiling(const TriInvColumnSweepTiling &tiling)
 {
-    constexpr uint32_t PADDING_BYTE = 32U;
-
-    // align to 32 bytes
-    int32_t tiling_size = (sizeof(TriInvColumnSweepTiling) + PADDING_BYTE - 1) / PADDING_BYTE * PADDING_BYTE;
-    auto tiling_buffer = at::empty({tiling_size}, at::TensorOptions().dtype(at::kByte).device(at::kCPU));
-
-    TriInvColumnSweepTiling *tiling_data = reinterpret_cast<TriInvColumnSweepTiling *>(tiling_buffer.data_ptr());
-    tiling_data->num_blocks = tiling.num_blocks;
-    tiling_data->num_elems = tiling.num_elems;
-    tiling_data->matrix_size = tiling.matrix_size;
-
-    auto tiling_tensor = TorchNpuHelper::CopyTensorHostToDevice(tiling_buffer);
+    at::Tensor tiling_tensor;
+    auto key = TilingKey("tri_inv_col_sweep").Add(tiling.num_blocks).Add(tiling.num_elems).Add(tiling.matrix_size);
+    TilingCache::Instance().GetOrCreate<TriInvColumnSweepTiling>(
+        key, [&](TriInvColumnSweepTiling &tiling_data) { tiling_data = tiling; }, tiling_tensor);
     return tiling_tensor;
 }
 
@@ -15,6 +15,7 @@
 #include <cmath>
 #include "common.h"
 #include "tiling/platform/platform_ascendc.h"
+#include "platform_info.h"
 #include "../batch_matmul_transpose/op_host/tiling/tiling_data.h"
 
 namespace host_utils {
@@ -40,10 +41,10 @@ enum class PlatformType { ASCEND_310P, ASCEND_910A, ASCEND_910B, ASCEND_910C, PL
 
 struct PlatformInfo {
 public:
-    static const PlatformInfo &Instance()
+    // Looks the registry up by the current device on every call, host ops may run on different devices
+    static PlatformInfo Current()
     {
-        static PlatformInfo platformInfo;
-        return platformInfo;
+        return PlatformInfo(sglang::npu_kernel::PlatformInfoRegistry::Get());
     }
 
     PlatformType socType;
@@ -58,26 +59,20 @@ public:
     uint64_t l0cSize;
 
 private:
-    PlatformInfo()
+    explicit PlatformInfo(const sglang::npu_kernel::DevicePlatformInfo &info)
     {
-        auto ascendcPlatform = platform_ascendc::PlatformAscendCManager::GetInstance();
         // TODO Hard coding set to 910_93xx, parse using aclrtGetSocName is better
         socType = PlatformType::ASCEND_910C;
-        coreNum = ascendcPlatform->GetCoreNum();
-        coreNumAic = ascendcPlatform->GetCoreNumAic();
-        coreNumAiv = ascendcPlatform->GetCoreNumAiv();
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L1, l1Size);
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L2, l2Size);
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_A, l0aSize);
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_B, l0bSize);
-        ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_C, l0cSize);
+        coreNum = info.coreNum;
+        coreNumAic = info.coreNumAic;
+        coreNumAiv = info.coreNumAiv;
+        ubSize = info.ubSize;
+        l1Size = info.l1Size;
+        l2Size = info.l2Size;
+        l0aSize = info.l0aSize;
+        l0bSize = info.l0bSize;
+        l0cSize = info.l0cSize;
     }
-
-    PlatformInfo(const PlatformInfo &) = delete;
-    PlatformInfo &operator=(const PlatformInfo &) = delete;
-    PlatformInfo(PlatformInfo &&) = delete;
-    PlatformInfo &operator=(PlatformInfo &&) = delete;
 };
 
 inline __attribute__((always_inline)) uint32_t GetN0TilingLimit(bool compressFlag, uint32_t tilingN,
@@ -154,7 +149,7 @@ void TilingFunc(OpShareType &opShape, TilingType &tilingParam, const HardwareTyp
     uint32_t priAxes = RoundUp<uint32_t>(PRI_FLAG ? opShape.m : opShape.n, ROUND_CONST_16);
     uint32_t axes = RoundUp<uint32_t>(PRI_FLAG ? opShape.n : opShape.m, roundBase);
     float axes0Max = static_cast<float>(AXES_ALIGN_SIZE) / mmInfo.inDtype;
-    auto platformType = PlatformInfo::Instance().socType;
+    auto platformType = PlatformInfo::Current().socType;
     if (mmInfo.isInt8 && (platformType == PlatformType::ASCEND_310P || platformType == PlatformType::ASCEND_910A)) {
         axes0Max /= CONST_2;
     }
@@ -6,6 +6,7 @@
 #include <map>
 #include "tiling/platform/platform_ascendc.h"
 #include "torch_helper.h"
+#include "platform_info.h"
 
 #include <stdexcept>
 
@@ -381,8 +382,7 @@ public:
 
     void SetWorkspaceSizes(size_t userSize)
     {
-        auto platformAscendC = platform_ascendc::PlatformAscendCManager::GetInstance();
-        systemWorkSpaceSize_ = static_cast<size_t>(platformAscendC->GetLibApiWorkSpaceSize());
+        systemWorkSpaceSize_ = static_cast<size_t>(npu_kernel::PlatformInfoRegistry::Get().libApiWorkspaceSize);
         userWorkSpaceSize_ = userSize;
     }
 
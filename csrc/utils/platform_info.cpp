@@ -0,0 +1,69 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <mutex>
+#include "acl/acl.h"
+#include "tiling/platform/platform_ascendc.h"
+#include "torch_helper.h"
+
+#include "platform_info.h"
+
+namespace sglang {
+namespace npu_kernel {
+
+namespace {
+DevicePlatformInfo QueryPlatformInfo(int32_t deviceId)
+{
+    auto ascendcPlatform = platform_ascendc::PlatformAscendCManager::GetInstance();
+    DevicePlatformInfo info{};
+    info.deviceId = deviceId;
+    info.coreNum = ascendcPlatform->GetCoreNum();
+    info.coreNumAic = ascendcPlatform->GetCoreNumAic();
+    info.coreNumAiv = ascendcPlatform->GetCoreNumAiv();
+    info.libApiWorkspaceSize = ascendcPlatform->GetLibApiWorkSpaceSize();
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::UB, info.ubSize);
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L1, info.l1Size);
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L2, info.l2Size);
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_A, info.l0aSize);
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_B, info.l0bSize);
+    ascendcPlatform->GetCoreMemSize(platform_ascendc::CoreMemType::L0_C, info.l0cSize);
+
+    // The SoC description knows nothing about the device, its usable core counts come from ACL
+    int64_t value = 0;
+    if (aclGetDeviceCapability(deviceId, ACL_DEVICE_INFO_AI_CORE_NUM, &value) == ACL_SUCCESS && value > 0) {
+        info.coreNumAic = static_cast<uint32_t>(value);
+    }
+    if (aclGetDeviceCapability(deviceId, ACL_DEVICE_INFO_VECTOR_CORE_NUM, &value) == ACL_SUCCESS && value > 0) {
+        info.coreNumAiv = static_cast<uint32_t>(value);
+    }
+    return info;
+}
+}  // namespace
+
+const DevicePlatformInfo &PlatformInfoRegistry::Get()
+{
+    int deviceIndex = 0;
+    c10_npu::GetDevice(&deviceIndex);
+    return Get(deviceIndex);
+}
+
+const DevicePlatformInfo &PlatformInfoRegistry::Get(int32_t deviceId)
+{
+    static std::array<std::once_flag, MAX_DEVICES> initFlags;
+    static std::array<DevicePlatformInfo, MAX_DEVICES> infos;
+    TORCH_CHECK(deviceId >= 0 && deviceId < MAX_DEVICES, "device id should be in [0, ", MAX_DEVICES, "), got ",
+                deviceId);
+    std::call_once(initFlags[deviceId], [deviceId]() { infos[deviceId] = QueryPlatformInfo(deviceId); });
+    return infos[deviceId];
+}
+
+}  // namespace npu_kernel
+}  // namespace sglang
@@ -0,0 +1,62 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGL_KERNEL_NPU_PLATFORM_INFO_H
+#define SGL_KERNEL_NPU_PLATFORM_INFO_H
+
+#include <cstdint>
+
+namespace sglang {
+namespace npu_kernel {
+
+/**
+ * @brief Core counts, on-chip memory sizes and library workspace of one NPU.
+ */
+struct DevicePlatformInfo {
+    int32_t deviceId;
+    uint32_t coreNum;
+    uint32_t coreNumAic;
+    uint32_t coreNumAiv;
+    uint32_t libApiWorkspaceSize;
+    uint64_t ubSize;
+    uint64_t l1Size;
+    uint64_t l2Size;
+    uint64_t l0aSize;
+    uint64_t l0bSize;
+    uint64_t l0cSize;
+};
+
+/**
+ * @brief Process-wide registry of DevicePlatformInfo, one entry per device.
+ *
+ * An entry is queried on the first lookup of its device and never changes afterwards, so the returned reference can
+ * be kept and read from any thread, including OpCommand handlers. Core counts come from the ACL capabilities of that
+ * very device, memory sizes and the library workspace from the SoC description shared by all devices of the process.
+ */
+class PlatformInfoRegistry
+{
+public:
+    static constexpr int32_t MAX_DEVICES = 64;
+
+    /**
+     * @brief Info of the current NPU device of the calling thread.
+     */
+    static const DevicePlatformInfo &Get();
+
+    /**
+     * @brief Info of device `deviceId`, e.g. `tensor.get_device()`.
+     */
+    static const DevicePlatformInfo &Get(int32_t deviceId);
+};
+
+}  // namespace npu_kernel
+}  // namespace sglang
+
+#endif  // SGL_KERNEL_NPU_PLATFORM_INFO_H
@@ -0,0 +1,151 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include "acl/acl.h"
+#include "torch_npu/csrc/core/npu/DeviceUtils.h"
+#include "torch_npu/csrc/core/npu/NPUGraphsUtils.h"
+
+#include "tiling_cache.h"
+
+namespace sglang {
+namespace npu_kernel {
+
+std::size_t TilingKey::Hash() const
+{
+    std::size_t seed = std::hash<std::string>{}(op_);
+    for (int64_t value : values_) {
+        seed ^= std::hash<int64_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+TilingCache &TilingCache::Instance()
+{
+    static TilingCache cache;
+    return cache;
+}
+
+bool TilingCache::Lookup(const TilingKey &key, at::Tensor &tiling_tensor, void *host, std::size_t host_size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    TORCH_CHECK(it->second.host.size() == host_size, "tiling cache: size mismatch for an existing key");
+    std::memcpy(host, it->second.host.data(), host_size);
+    tiling_tensor = it->second.device;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+at::Tensor TilingCache::Insert(const TilingKey &key, const void *host, std::size_t host_size)
+{
+    int64_t tiling_size = (static_cast<int64_t>(host_size) + PADDING_BYTE - 1) / PADDING_BYTE * PADDING_BYTE;
+    const uint8_t *bytes = static_cast<const uint8_t *>(host);
+    std::vector<uint8_t> padded(tiling_size, 0);
+    std::memcpy(padded.data(), bytes, host_size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have inserted the same key meanwhile, keep the first slot
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        return it->second.device;
+    }
+
+    // An uncached tiling is a transient H2D copy whose pinned source is freed on return, a captured graph would
+    // replay it from freed host memory
+    bool capturing = c10_npu::currentStreamCaptureStatusMayInitCtx() != c10_npu::CaptureStatus::None;
+    TORCH_CHECK(!capturing, "tiling cache: miss for op ", key.Op(),
+                " while the stream is being captured, warm the op up with the same shapes before capture");
+    if (entries_.size() >= MAX_ENTRIES) {
+        auto tiling_buffer = at::empty({tiling_size}, at::TensorOptions().dtype(at::kByte).device(at::kCPU));
+        std::memcpy(tiling_buffer.data_ptr(), padded.data(), tiling_size);
+        return TorchNpuHelper::CopyTensorHostToDevice(tiling_buffer);
+    }
+
+    // Slab memory is never shared with the caching allocator and a slot is written only here, so a blocking copy
+    // cannot race with kernels on any stream.
+    auto slot = AllocateSlot(tiling_size);
+    auto ret = aclrtMemcpy(slot.data_ptr(), tiling_size, padded.data(), tiling_size, ACL_MEMCPY_HOST_TO_DEVICE);
+    TORCH_CHECK(ret == ACL_SUCCESS, "tiling cache: aclrtMemcpy failed, error code ", ret);
+    entries_.emplace(key, Entry{slot, std::vector<uint8_t>(bytes, bytes + host_size)});
+    return slot;
+}
+
+at::Tensor TilingCache::AllocateSlot(int64_t num_bytes)
+{
+    int deviceIndex = 0;
+    c10_npu::GetDevice(&deviceIndex);
+    auto &slab = slabs_[deviceIndex];
+    if (slab.base == nullptr || slab.used + num_bytes > slab.size) {
+        void *base = nullptr;
+        int64_t size = std::max(SLAB_BYTES, num_bytes);
+        auto ret = aclrtMalloc(&base, size, ACL_MEM_MALLOC_HUGE_FIRST);
+        TORCH_CHECK(ret == ACL_SUCCESS, "tiling cache: aclrtMalloc of ", size, " bytes failed, error code ", ret);
+        slab.deviceIndex = deviceIndex;
+        slab.base = static_cast<uint8_t *>(base);
+        slab.size = size;
+        slab.used = 0;
+        allSlabs_.push_back(slab);
+    }
+
+    void *slot = slab.base + slab.used;
+    slab.used += num_bytes;
+    return at::from_blob(slot, {num_bytes}, at::TensorOptions().dtype(at::kByte).device(DEVICE_TYPE, deviceIndex));
+}
+
+std::size_t TilingCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void TilingCache::ReleaseSlabs()
+{
+    if (allSlabs_.empty()) {
+        return;
+    }
+    int currentDevice = 0;
+    c10_npu::GetDevice(&currentDevice);
+    for (const auto &slab : allSlabs_) {
+        c10_npu::set_device(slab.deviceIndex);
+        // Kernels already launched with a cached tiling may still read the slab
+        auto ret = aclrtSynchronizeDevice();
+        TORCH_CHECK(ret == ACL_SUCCESS, "tiling cache: aclrtSynchronizeDevice failed, error code ", ret);
+        ret = aclrtFree(slab.base);
+        TORCH_CHECK(ret == ACL_SUCCESS, "tiling cache: aclrtFree failed, error code ", ret);
+    }
+    c10_npu::set_device(currentDevice);
+    allSlabs_.clear();
+    slabs_.clear();
+}
+
+TilingCache::~TilingCache()
+{
+    // The runtime may already be finalized at exit, a failed free is not worth reporting then
+    for (const auto &slab : allSlabs_) {
+        (void)aclrtFree(slab.base);
+    }
+}
+
+void TilingCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    ReleaseSlabs();
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace npu_kernel
+}  // namespace sglang
@@ -0,0 +1,177 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGL_KERNEL_NPU_TILING_CACHE_H
+#define SGL_KERNEL_NPU_TILING_CACHE_H
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <ATen/ATen.h>
+
+#include "torch_helper.h"
+
+namespace sglang {
+namespace npu_kernel {
+
+/**
+ * @brief Identity of a tiling: op name, device and every dtype/shape/attribute the tiling depends on.
+ */
+class TilingKey
+{
+public:
+    explicit TilingKey(const char *op) : op_(op)
+    {
+        int deviceIndex = 0;
+        c10_npu::GetDevice(&deviceIndex);
+        values_.push_back(deviceIndex);
+    }
+
+    TilingKey &Add(int64_t value)
+    {
+        values_.push_back(value);
+        return *this;
+    }
+
+    TilingKey &Add(at::ScalarType dtype)
+    {
+        return Add(static_cast<int64_t>(dtype));
+    }
+
+    TilingKey &Add(at::IntArrayRef sizes)
+    {
+        Add(static_cast<int64_t>(sizes.size()));
+        values_.insert(values_.end(), sizes.begin(), sizes.end());
+        return *this;
+    }
+
+    const std::string &Op() const
+    {
+        return op_;
+    }
+
+    bool operator==(const TilingKey &other) const
+    {
+        return op_ == other.op_ && values_ == other.values_;
+    }
+
+    std::size_t Hash() const;
+
+private:
+    std::string op_;
+    std::vector<int64_t> values_;
+};
+
+struct TilingKeyHasher {
+    std::size_t operator()(const TilingKey &key) const
+    {
+        return key.Hash();
+    }
+};
+
+/**
+ * @brief Process-wide cache of device-resident tiling blobs.
+ *
+ * A tiling is built on the host and uploaded once per key; later calls with the same key reuse the device tensor and
+ * skip both the host computation and the H2D copy. The table has no size limit per op, slots are populated lazily
+ * on the first call of a key and carved out of SLAB_BYTES buckets of device memory that bypass the caching allocator.
+ * A slot is written exactly once and never moved until `Clear`, so its address stays valid for NPU graphs that
+ * captured it.
+ *
+ * Once MAX_ENTRIES keys are cached, a miss is built and uploaded with an async copy on the current stream without
+ * being inserted. A miss while the current stream is being captured is an error, ops must be warmed up with the same
+ * shapes before capture. `Clear` synchronizes the devices and frees the slabs, and must not be called while a captured
+ * graph still references a cached tiling.
+ */
+class TilingCache
+{
+public:
+    static constexpr std::size_t MAX_ENTRIES = 16384;
+    static constexpr int64_t PADDING_BYTE = 32;
+    static constexpr int64_t SLAB_BYTES = 1024 * 1024;
+
+    static TilingCache &Instance();
+
+    /**
+     * @brief Return the host copy of the tiling for `key`, calling `build(TilingT &)` only on a miss.
+     *
+     * @param key             [in] identity of the tiling
+     * @param build           [in] fills a value-initialized TilingT
+     * @param tiling_tensor   [out] device tensor holding the tiling, padded to PADDING_BYTE
+     */
+    template <typename TilingT, typename BuildFn>
+    TilingT GetOrCreate(const TilingKey &key, BuildFn &&build, at::Tensor &tiling_tensor)
+    {
+        static_assert(std::is_trivially_copyable<TilingT>::value, "tiling data must be trivially copyable");
+        TilingT tiling{};
+        if (Lookup(key, tiling_tensor, &tiling, sizeof(TilingT))) {
+            return tiling;
+        }
+
+        build(tiling);
+        tiling_tensor = Insert(key, &tiling, sizeof(TilingT));
+        return tiling;
+    }
+
+    uint64_t Hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t Size() const;
+
+    void Clear();
+
+private:
+    struct Entry {
+        at::Tensor device;
+        std::vector<uint8_t> host;
+    };
+
+    struct Slab {
+        int deviceIndex = 0;
+        uint8_t *base = nullptr;
+        int64_t size = 0;
+        int64_t used = 0;
+    };
+
+    TilingCache() = default;
+    ~TilingCache();
+    TilingCache(const TilingCache &) = delete;
+    TilingCache &operator=(const TilingCache &) = delete;
+
+    bool Lookup(const TilingKey &key, at::Tensor &tiling_tensor, void *host, std::size_t host_size);
+    at::Tensor Insert(const TilingKey &key, const void *host, std::size_t host_size);
+    at::Tensor AllocateSlot(int64_t num_bytes);
+    void ReleaseSlabs();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<TilingKey, Entry, TilingKeyHasher> entries_;
+    // current bucket per device index, full buckets stay allocated for the slots already handed out
+    std::unordered_map<int, Slab> slabs_;
+    // every bucket ever allocated, freed by Clear and at exit
+    std::vector<Slab> allSlabs_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace npu_kernel
+}  // namespace sglang
+
+#endif  // SGL_KERNEL_NPU_TILING_CACHE_H
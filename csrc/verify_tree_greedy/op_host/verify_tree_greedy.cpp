@@ -0,0 +1,110 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "defines.h"
+#include "verify_tree_greedy_tiling.h"
+#include "aclrtlaunch_verify_tree_greedy.h"
+#include "torch_helper.h"
+#include "tiling_cache.h"
+#include "platform_info.h"
+
+namespace sglang {
+namespace npu_kernel {
+
+at::Tensor get_verify_tree_greedy_tiling(int32_t &block_dim, int32_t batch_size, int32_t num_draft_tokens,
+                                         int32_t num_spec_step, bool compact)
+{
+    int32_t max_aiv_core = static_cast<int32_t>(PlatformInfoRegistry::Get().coreNumAiv);
+    block_dim = std::min(max_aiv_core, batch_size);
+
+    at::Tensor tiling_tensor;
+    auto key = TilingKey("verify_tree_greedy")
+                   .Add(batch_size)
+                   .Add(num_draft_tokens)
+                   .Add(num_spec_step)
+                   .Add(static_cast<int64_t>(compact))
+                   .Add(block_dim);
+    TilingCache::Instance().GetOrCreate<VerifyTreeGreedyTilingData>(
+        key,
+        [&](VerifyTreeGreedyTilingData &tiling) {
+            tiling.batch_size = batch_size;
+            tiling.num_draft_tokens = num_draft_tokens;
+            tiling.num_spec_step = num_spec_step;
+            tiling.compact = compact ? 1 : 0;
+
+            auto num_big_core = batch_size % block_dim;
+            tiling.big_core_num = num_big_core == 0 ? block_dim : num_big_core;
+            tiling.big_core_tile_num = (batch_size + block_dim - 1) / block_dim;
+            tiling.small_core_tile_num = batch_size / block_dim;
+        },
+        tiling_tensor);
+    return tiling_tensor;
+}
+
+HOST_API void verify_tree_greedy(const at::Tensor &predicts, const at::Tensor &accept_index,
+                                 const at::Tensor &accept_token_num, const at::Tensor &candidates,
+                                 const at::Tensor &retrive_index, const at::Tensor &retrive_next_token,
+                                 const at::Tensor &retrive_next_sibling, const at::Tensor &target_predict,
+                                 const c10::optional<at::Tensor> &out_cache_loc,
+                                 const c10::optional<at::Tensor> &accept_tokens,
+                                 const c10::optional<at::Tensor> &keep_cache_loc)
+{
+    if (candidates.options().dtype() != at::kLong || retrive_index.options().dtype() != at::kLong ||
+        retrive_next_token.options().dtype() != at::kLong || retrive_next_sibling.options().dtype() != at::kLong ||
+        target_predict.options().dtype() != at::kLong || predicts.options().dtype() != at::kInt ||
+        accept_index.options().dtype() != at::kInt || accept_token_num.options().dtype() != at::kInt) {
+        throw std::invalid_argument(
+            "Invalid input datetype. "
+            "Support combo: int32, int32, int32, int64, int64, int64, int64, int64");
+    }
+    if (candidates.dim() != 2 || accept_index.dim() != 2) {
+        throw std::invalid_argument("candidates and accept_index must be 2D tensors.");
+    }
+
+    bool compact = out_cache_loc.has_value();
+    if (compact != accept_tokens.has_value() || compact != keep_cache_loc.has_value()) {
+        throw std::invalid_argument("out_cache_loc, accept_tokens and keep_cache_loc must be given together.");
+    }
+    if (compact && (out_cache_loc->options().dtype() != at::kLong || accept_tokens->options().dtype() != at::kInt ||
+                    keep_cache_loc->options().dtype() != at::kLong)) {
+        throw std::invalid_argument(
+            "Invalid compact output datetype. "
+            "Support combo: out_cache_loc int64, accept_tokens int32, keep_cache_loc int64");
+    }
+
+    int32_t batch_size = static_cast<int32_t>(candidates.size(0));
+    int32_t num_draft_tokens = static_cast<int32_t>(candidates.size(1));
+    int32_t num_spec_step = static_cast<int32_t>(accept_index.size(1));
+    if (batch_size == 0) {
+        return;
+    }
+    if (compact && (out_cache_loc->numel() < static_cast<int64_t>(batch_size) * num_draft_tokens ||
+                    accept_tokens->numel() < static_cast<int64_t>(batch_size) * num_spec_step ||
+                    keep_cache_loc->numel() < static_cast<int64_t>(batch_size) * num_spec_step)) {
+        throw std::invalid_argument(
+            "out_cache_loc needs bs * num_draft_tokens elements, accept_tokens and keep_cache_loc bs * num_spec_step.");
+    }
+
+    int32_t block_dim;
+    at::Tensor tiling_tensor =
+        get_verify_tree_greedy_tiling(block_dim, batch_size, num_draft_tokens, num_spec_step, compact);
+
+    // the kernel leaves the compact tensors untouched when they are not requested
+    auto placeholder = at::empty({1}, candidates.options());
+    const at::Tensor &out_cache_loc_in = compact ? *out_cache_loc : placeholder;
+    const at::Tensor &accept_tokens_out = compact ? *accept_tokens : placeholder;
+    const at::Tensor &keep_cache_loc_out = compact ? *keep_cache_loc : placeholder;
+    /* launch the kernel function via torch */
+    EXEC_KERNEL_CMD(verify_tree_greedy, block_dim, candidates, retrive_index, retrive_next_token, retrive_next_sibling,
+                    target_predict, out_cache_loc_in, predicts, accept_index, accept_token_num, accept_tokens_out,
+                    keep_cache_loc_out, tiling_tensor);
+}
+
+}  // namespace npu_kernel
+}  // namespace sglang
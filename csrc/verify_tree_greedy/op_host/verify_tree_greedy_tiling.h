@@ -0,0 +1,32 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIFY_TREE_GREEDY_TILING_H
+#define VERIFY_TREE_GREEDY_TILING_H
+
+#include <cstdint>
+namespace sglang {
+namespace npu_kernel {
+
+struct VerifyTreeGreedyTilingData {
+    int32_t batch_size;
+    int32_t num_draft_tokens;
+    int32_t num_spec_step;  // columns of accept_index
+    int32_t compact;        // also write accept_tokens and keep_cache_loc
+
+    int32_t big_core_num;
+    int32_t big_core_tile_num;
+    int32_t small_core_tile_num;
+};
+
+}  // namespace npu_kernel
+}  // namespace sglang
+
+#endif  // VERIFY_TREE_GREEDY_TILING_H
@@ -0,0 +1,295 @@
+// Licensed under the BSD 3-Clause License  (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* include file of ascendc */
+#include "kernel_operator.h"
+#include "../op_host/verify_tree_greedy_tiling.h"
+
+constexpr uint32_t ALIGN_32B = 32;
+
+template <AscendC::HardEvent event>
+__aicore__ inline void SyncFlag()
+{
+    int32_t event_id = static_cast<int32_t>(GetTPipePtr()->FetchEventID(event));
+    AscendC::SetFlag<event>(event_id);
+    AscendC::WaitFlag<event>(event_id);
+}
+
+__aicore__ inline uint32_t AlignUp32B(uint32_t bytes)
+{
+    return (bytes + ALIGN_32B - 1) / ALIGN_32B * ALIGN_32B;
+}
+
+class KernelVerifyTreeGreedy
+{
+public:
+    __aicore__ inline KernelVerifyTreeGreedy() {}
+
+    __aicore__ inline void Init(GM_ADDR candidates,            // [bs, num_draft_tokens]
+                                GM_ADDR retrive_index,         // [bs, num_draft_tokens]
+                                GM_ADDR retrive_next_token,    // [bs, num_draft_tokens]
+                                GM_ADDR retrive_next_sibling,  // [bs, num_draft_tokens]
+                                GM_ADDR target_predict,        // [bs, num_draft_tokens]
+                                GM_ADDR out_cache_loc,         // [bs * num_draft_tokens], only read when compact
+                                GM_ADDR predicts,              // [bs * num_draft_tokens]
+                                GM_ADDR accept_index,          // [bs, num_spec_step]
+                                GM_ADDR accept_token_num,      // [bs]
+                                GM_ADDR accept_tokens,         // [bs * num_spec_step], only written when compact
+                                GM_ADDR keep_cache_loc,        // [bs * num_spec_step], only written when compact
+                                GM_ADDR tiling_gm_in)
+    {
+        auto tiling = reinterpret_cast<__gm__ sglang::npu_kernel::VerifyTreeGreedyTilingData *>(tiling_gm_in);
+        this->batch_size = tiling->batch_size;
+        this->num_draft_tokens = tiling->num_draft_tokens;
+        this->num_spec_step = tiling->num_spec_step;
+        this->compact = tiling->compact != 0;
+
+        this->bs_offset = AscendC::GetBlockIdx() * tiling->big_core_tile_num;
+        if (AscendC::GetBlockIdx() < tiling->big_core_num) {
+            this->bs_per_core = tiling->big_core_tile_num;
+        } else {
+            this->bs_per_core = tiling->small_core_tile_num;
+            this->bs_offset -= (tiling->big_core_tile_num - tiling->small_core_tile_num) *
+                               (AscendC::GetBlockIdx() - tiling->big_core_num);
+        }
+
+        int64_t token_num = static_cast<int64_t>(this->batch_size) * this->num_draft_tokens;
+        int64_t accept_num = static_cast<int64_t>(this->batch_size) * this->num_spec_step;
+        this->candidates_gm.SetGlobalBuffer((__gm__ int64_t *)candidates, token_num);
+        this->retrive_index_gm.SetGlobalBuffer((__gm__ int64_t *)retrive_index, token_num);
+        this->retrive_next_token_gm.SetGlobalBuffer((__gm__ int64_t *)retrive_next_token, token_num);
+        this->retrive_next_sibling_gm.SetGlobalBuffer((__gm__ int64_t *)retrive_next_sibling, token_num);
+        this->target_predict_gm.SetGlobalBuffer((__gm__ int64_t *)target_predict, token_num);
+        this->predicts_gm.SetGlobalBuffer((__gm__ int32_t *)predicts, token_num);
+        this->accept_index_gm.SetGlobalBuffer((__gm__ int32_t *)accept_index, accept_num);
+        this->accept_token_num_gm.SetGlobalBuffer((__gm__ int32_t *)accept_token_num, this->batch_size);
+        if (this->compact) {
+            this->out_cache_loc_gm.SetGlobalBuffer((__gm__ int64_t *)out_cache_loc, token_num);
+            this->accept_tokens_gm.SetGlobalBuffer((__gm__ int32_t *)accept_tokens, accept_num);
+            this->keep_cache_loc_gm.SetGlobalBuffer((__gm__ int64_t *)keep_cache_loc, accept_num);
+        }
+
+        uint32_t row_len = AlignUp32B(this->num_draft_tokens * sizeof(int64_t));
+        this->pipe.InitBuffer(this->tree_buf, row_len * TREE_ROW_NUM);
+        this->pipe.InitBuffer(this->predicts_buf, AlignUp32B(this->num_draft_tokens * sizeof(int32_t)));
+        this->pipe.InitBuffer(this->accept_buf, AlignUp32B(this->num_spec_step * sizeof(int32_t)));
+        this->pipe.InitBuffer(this->count_buf, AlignUp32B(this->bs_per_core * sizeof(int32_t)));
+        if (this->compact) {
+            this->pipe.InitBuffer(this->prior_count_buf, AlignUp32B(this->batch_size * sizeof(int32_t)));
+            this->pipe.InitBuffer(this->cache_loc_buf, row_len);
+            this->pipe.InitBuffer(this->keep_buf, AlignUp32B(this->num_spec_step * sizeof(int64_t)));
+            this->pipe.InitBuffer(this->tokens_buf, AlignUp32B(this->num_spec_step * sizeof(int32_t)));
+        }
+
+        AscendC::LocalTensor<int64_t> tree_ub = this->tree_buf.Get<int64_t>();
+        uint32_t row_elems = row_len / sizeof(int64_t);
+        this->candidates_ub = tree_ub;
+        this->retrive_index_ub = tree_ub[row_elems];
+        this->retrive_next_token_ub = tree_ub[row_elems * 2];
+        this->retrive_next_sibling_ub = tree_ub[row_elems * 3];
+        this->target_predict_ub = tree_ub[row_elems * 4];
+        this->predicts_ub = this->predicts_buf.Get<int32_t>();
+        this->accept_ub = this->accept_buf.Get<int32_t>();
+        this->count_ub = this->count_buf.Get<int32_t>();
+    }
+
+    __aicore__ inline void Process()
+    {
+        for (int32_t bid = 0; bid < this->bs_per_core; bid++) {
+            Verify(bid);
+        }
+
+        SyncFlag<AscendC::HardEvent::S_MTE3>();
+        AscendC::DataCopyExtParams copy_params{1, static_cast<uint32_t>(this->bs_per_core * sizeof(int32_t)), 0, 0, 0};
+        AscendC::DataCopyPad(this->accept_token_num_gm[this->bs_offset], this->count_ub, copy_params);
+        if (!this->compact) {
+            return;
+        }
+
+        // the compacted offset of a request depends on the accept lengths written by every core before it
+        AscendC::PipeBarrier<PIPE_ALL>();
+        AscendC::SyncAll<true>();
+        Compact();
+    }
+
+private:
+    // Greedy walk of one draft tree: follow retrive_next_token to the first child, and retrive_next_sibling across
+    // siblings until a draft token matches the target prediction of the last accepted node.
+    __aicore__ inline void Verify(int32_t bid)
+    {
+        int32_t bs = this->bs_offset + bid;
+        int64_t row_offset = static_cast<int64_t>(bs) * this->num_draft_tokens;
+
+        SyncFlag<AscendC::HardEvent::MTE3_MTE2>();
+        AscendC::DataCopyExtParams row_params{1, static_cast<uint32_t>(this->num_draft_tokens * sizeof(int64_t)), 0,
+                                              0, 0};
+        AscendC::DataCopyPadExtParams<int64_t> pad_params{false, 0, 0, 0};
+        AscendC::DataCopyPad(this->candidates_ub, this->candidates_gm[row_offset], row_params, pad_params);
+        AscendC::DataCopyPad(this->retrive_index_ub, this->retrive_index_gm[row_offset], row_params, pad_params);
+        AscendC::DataCopyPad(this->retrive_next_token_ub, this->retrive_next_token_gm[row_offset], row_params,
+                             pad_params);
+        AscendC::DataCopyPad(this->retrive_next_sibling_ub, this->retrive_next_sibling_gm[row_offset], row_params,
+                             pad_params);
+        AscendC::DataCopyPad(this->target_predict_ub, this->target_predict_gm[row_offset], row_params, pad_params);
+        AscendC::DataCopyExtParams predicts_params{1, static_cast<uint32_t>(this->num_draft_tokens * sizeof(int32_t)),
+                                                   0, 0, 0};
+        AscendC::DataCopyPadExtParams<int32_t> pad_params_int32{false, 0, 0, 0};
+        AscendC::DataCopyPad(this->predicts_ub, this->predicts_gm[row_offset], predicts_params, pad_params_int32);
+        SyncFlag<AscendC::HardEvent::MTE3_S>();
+        SyncFlag<AscendC::HardEvent::MTE2_S>();
+
+        for (int32_t i = 0; i < this->num_spec_step; i++) {
+            this->accept_ub.SetValue(i, -1);
+        }
+        // retrive_index holds flat token indices, the local slot is the index minus the row offset
+        int64_t last_accepted_idx = this->retrive_index_ub.GetValue(0);
+        this->accept_ub.SetValue(0, static_cast<int32_t>(last_accepted_idx));
+        int32_t num_accepted = 0;
+        int64_t cur_node = 0;
+        for (int32_t step = 1; step < this->num_spec_step; step++) {
+            cur_node = this->retrive_next_token_ub.GetValue(cur_node);
+            int64_t target_token = this->target_predict_ub.GetValue(last_accepted_idx - row_offset);
+            while (cur_node != -1) {
+                if (this->candidates_ub.GetValue(cur_node) == target_token) {
+                    this->predicts_ub.SetValue(last_accepted_idx - row_offset, static_cast<int32_t>(target_token));
+                    num_accepted++;
+                    last_accepted_idx = this->retrive_index_ub.GetValue(cur_node);
+                    this->accept_ub.SetValue(num_accepted, static_cast<int32_t>(last_accepted_idx));
+                    break;
+                }
+                cur_node = this->retrive_next_sibling_ub.GetValue(cur_node);
+            }
+            if (cur_node == -1) {
+                break;
+            }
+        }
+        int64_t last_slot = last_accepted_idx - row_offset;
+        this->predicts_ub.SetValue(last_slot, static_cast<int32_t>(this->target_predict_ub.GetValue(last_slot)));
+        this->count_ub.SetValue(bid, num_accepted);
+
+        SyncFlag<AscendC::HardEvent::S_MTE3>();
+        AscendC::DataCopyPad(this->predicts_gm[row_offset], this->predicts_ub, predicts_params);
+        AscendC::DataCopyExtParams accept_params{1, static_cast<uint32_t>(this->num_spec_step * sizeof(int32_t)), 0, 0,
+                                                 0};
+        AscendC::DataCopyPad(this->accept_index_gm[static_cast<int64_t>(bs) * this->num_spec_step], this->accept_ub,
+                             accept_params);
+    }
+
+    // Gather the accepted tokens and their KV slots of every request into one dense array, request after request.
+    __aicore__ inline void Compact()
+    {
+        AscendC::LocalTensor<int32_t> prior_count_ub = this->prior_count_buf.Get<int32_t>();
+        if (this->bs_offset > 0) {
+            AscendC::DataCopyExtParams count_params{1, static_cast<uint32_t>(this->bs_offset * sizeof(int32_t)), 0, 0,
+                                                    0};
+            AscendC::DataCopyPadExtParams<int32_t> pad_params_int32{false, 0, 0, 0};
+            AscendC::DataCopyPad(prior_count_ub, this->accept_token_num_gm, count_params, pad_params_int32);
+            SyncFlag<AscendC::HardEvent::MTE2_S>();
+        }
+        int64_t dst_offset = 0;
+        for (int32_t i = 0; i < this->bs_offset; i++) {
+            dst_offset += prior_count_ub.GetValue(i) + 1;
+        }
+
+        AscendC::LocalTensor<int64_t> cache_loc_ub = this->cache_loc_buf.Get<int64_t>();
+        AscendC::LocalTensor<int64_t> keep_ub = this->keep_buf.Get<int64_t>();
+        AscendC::LocalTensor<int32_t> tokens_ub = this->tokens_buf.Get<int32_t>();
+        AscendC::DataCopyExtParams row_params{1, static_cast<uint32_t>(this->num_draft_tokens * sizeof(int64_t)), 0,
+                                              0, 0};
+        AscendC::DataCopyExtParams predicts_params{1, static_cast<uint32_t>(this->num_draft_tokens * sizeof(int32_t)),
+                                                   0, 0, 0};
+        AscendC::DataCopyExtParams accept_params{1, static_cast<uint32_t>(this->num_spec_step * sizeof(int32_t)), 0, 0,
+                                                 0};
+        AscendC::DataCopyPadExtParams<int64_t> pad_params{false, 0, 0, 0};
+        AscendC::DataCopyPadExtParams<int32_t> pad_params_int32{false, 0, 0, 0};
+        for (int32_t bid = 0; bid < this->bs_per_core; bid++) {
+            int32_t bs = this->bs_offset + bid;
+            int64_t row_offset = static_cast<int64_t>(bs) * this->num_draft_tokens;
+
+            SyncFlag<AscendC::HardEvent::MTE3_MTE2>();
+            AscendC::DataCopyPad(cache_loc_ub, this->out_cache_loc_gm[row_offset], row_params, pad_params);
+            AscendC::DataCopyPad(this->predicts_ub, this->predicts_gm[row_offset], predicts_params, pad_params_int32);
+            AscendC::DataCopyPad(this->accept_ub, this->accept_index_gm[static_cast<int64_t>(bs) * this->num_spec_step],
+                                 accept_params, pad_params_int32);
+            SyncFlag<AscendC::HardEvent::MTE3_S>();
+            SyncFlag<AscendC::HardEvent::MTE2_S>();
+
+            int32_t accept_len = this->count_ub.GetValue(bid) + 1;
+            for (int32_t i = 0; i < accept_len; i++) {
+                int64_t slot = this->accept_ub.GetValue(i) - row_offset;
+                tokens_ub.SetValue(i, this->predicts_ub.GetValue(slot));
+                keep_ub.SetValue(i, cache_loc_ub.GetValue(slot));
+            }
+
+            SyncFlag<AscendC::HardEvent::S_MTE3>();
+            AscendC::DataCopyExtParams tokens_params{1, static_cast<uint32_t>(accept_len * sizeof(int32_t)), 0, 0, 0};
+            AscendC::DataCopyPad(this->accept_tokens_gm[dst_offset], tokens_ub, tokens_params);
+            AscendC::DataCopyExtParams keep_params{1, static_cast<uint32_t>(accept_len * sizeof(int64_t)), 0, 0, 0};
+            AscendC::DataCopyPad(this->keep_cache_loc_gm[dst_offset], keep_ub, keep_params);
+            dst_offset += accept_len;
+        }
+    }
+
+private:
+    static constexpr uint32_t TREE_ROW_NUM = 5;  // candidates, retrive_index/next_token/next_sibling, target_predict
+
+    AscendC::TPipe pipe;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tree_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> predicts_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> accept_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> count_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> prior_count_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> cache_loc_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> keep_buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tokens_buf;
+
+    AscendC::LocalTensor<int64_t> candidates_ub;
+    AscendC::LocalTensor<int64_t> retrive_index_ub;
+    AscendC::LocalTensor<int64_t> retrive_next_token_ub;
+    AscendC::LocalTensor<int64_t> retrive_next_sibling_ub;
+    AscendC::LocalTensor<int64_t> target_predict_ub;
+    AscendC::LocalTensor<int32_t> predicts_ub;
+    AscendC::LocalTensor<int32_t> accept_ub;
+    AscendC::LocalTensor<int32_t> count_ub;  // accept lengths of the requests on this core
+
+    AscendC::GlobalTensor<int64_t> candidates_gm;
+    AscendC::GlobalTensor<int64_t> retrive_index_gm;
+    AscendC::GlobalTensor<int64_t> retrive_next_token_gm;
+    AscendC::GlobalTensor<int64_t> retrive_next_sibling_gm;
+    AscendC::GlobalTensor<int64_t> target_predict_gm;
+    AscendC::GlobalTensor<int64_t> out_cache_loc_gm;
+    AscendC::GlobalTensor<int32_t> predicts_gm;
+    AscendC::GlobalTensor<int32_t> accept_index_gm;
+    AscendC::GlobalTensor<int32_t> accept_token_num_gm;
+    AscendC::GlobalTensor<int32_t> accept_tokens_gm;
+    AscendC::GlobalTensor<int64_t> keep_cache_loc_gm;
+
+    int32_t batch_size;
+    int32_t num_draft_tokens;
+    int32_t num_spec_step;
+    bool compact;
+
+    int32_t bs_per_core;
+    int32_t bs_offset = 0;
+};
+
+extern "C" __global__ __aicore__ void verify_tree_greedy(GM_ADDR candidates, GM_ADDR retrive_index,
+                                                         GM_ADDR retrive_next_token, GM_ADDR retrive_next_sibling,
+                                                         GM_ADDR target_predict, GM_ADDR out_cache_loc,
+                                                         GM_ADDR predicts, GM_ADDR accept_index,
+                                                         GM_ADDR accept_token_num, GM_ADDR accept_tokens,
+                                                         GM_ADDR keep_cache_loc, GM_ADDR tiling_in)
+{
+    KERNEL_TASK_TYPE_DEFAULT(KERNEL_TYPE_AIV_ONLY);
+    KernelVerifyTreeGreedy op;
+    op.Init(candidates, retrive_index, retrive_next_token, retrive_next_sibling, target_predict, out_cache_loc,
+            predicts, accept_index, accept_token_num, accept_tokens, keep_cache_loc, tiling_in);
+    op.Process();
+}
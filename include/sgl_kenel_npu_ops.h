@@ -46,6 +46,18 @@ void build_tree_efficient(
     const at::Tensor &retrive_next_sibling, int64_t topk, int64_t depth,
     int64_t draft_token_num, int64_t tree_mask_mode);
 
+void verify_tree_greedy(const at::Tensor &predicts,
+                        const at::Tensor &accept_index,
+                        const at::Tensor &accept_token_num,
+                        const at::Tensor &candidates,
+                        const at::Tensor &retrive_index,
+                        const at::Tensor &retrive_next_token,
+                        const at::Tensor &retrive_next_sibling,
+                        const at::Tensor &target_predict,
+                        const c10::optional<at::Tensor> &out_cache_loc,
+                        const c10::optional<at::Tensor> &accept_tokens,
+                        const c10::optional<at::Tensor> &keep_cache_loc);
+
 std::tuple<at::Tensor &, at::Tensor &, at::Tensor &, at::Tensor &>
 mla_preprocess(const at::Tensor &hiddenState, const at::Tensor &gamma0,
                const at::Tensor &beta0, const at::Tensor &wdqkv,
@@ -76,6 +88,13 @@ void transfer_kv_dim_exchange(at::Tensor &device_k, at::Tensor &host_k,
                               const at::Tensor &host_indices, int64_t page_size,
                               int64_t direction, int64_t flags);
 
+void transfer_kv_dim_exchange_batch(at::TensorList device_bufs,
+                                    at::TensorList host_bufs,
+                                    const at::Tensor &device_indices,
+                                    const at::Tensor &host_indices,
+                                    int64_t page_size, int64_t direction,
+                                    int64_t flags);
+
 at::Tensor bgmv_expand(at::Tensor &x, at::Tensor &weight, at::Tensor &indices,
                        at::Tensor &y, int64_t slice_offset, int64_t slice_size);
 
@@ -98,6 +117,22 @@ void sgemmv_shrink(at::Tensor &x, at::Tensor &weight, at::Tensor &lora_indices,
                    at::Tensor &seq_len, at::Tensor &lora_ranks,
                    at::Tensor &lora_scales, at::Tensor &y);
 
+at::Tensor sgmv_grouped_expand(at::Tensor &x, at::Tensor &weight,
+                               at::Tensor &lora_indices, at::Tensor &seq_len,
+                               at::Tensor &lora_ranks, at::Tensor &slice_offsets,
+                               at::Tensor &y);
+
+void sgmv_grouped_shrink(at::Tensor &x, at::Tensor &weight,
+                         at::Tensor &lora_indices, at::Tensor &seq_len,
+                         at::Tensor &lora_ranks, at::Tensor &lora_scales,
+                         at::Tensor &y);
+
+at::Tensor sgmv_shrink_expand(at::Tensor &x, at::Tensor &weight_a,
+                              at::Tensor &weight_b, at::Tensor &lora_indices,
+                              at::Tensor &seq_len, at::Tensor &lora_ranks,
+                              at::Tensor &lora_scales,
+                              at::Tensor &slice_offsets, at::Tensor &y);
+
 at::Tensor recurrent_gated_delta_rule(
     at::Tensor &mix_qkv, at::Tensor &recurrent_state, at::Tensor &beta,
     double scale, at::Tensor &actual_seq_lengths, at::Tensor &ssm_state_indices,
@@ -149,11 +149,34 @@ class Buffer:
         hidden: int,
         num_ranks: int,
         num_experts: int,
+        num_topk: int = 16,
     ) -> int:
+        """
+        Get the HCCL window bytes the low-latency dispatch and combine need on this SoC, with per-128-channel scales
+            as the worst case of the quantization modes. Set `HCCL_BUFFSIZE` (or `DEEPEP_HCCL_BUFFSIZE`, both in MB)
+            to at least this size; the kernels check it again before launching.
+
+        Arguments:
+            num_max_dispatch_tokens_per_rank: the maximum number of tokens to dispatch from one rank.
+            hidden: the hidden dimension of each token.
+            num_ranks: the number of EP ranks.
+            num_experts: the number of all experts.
+            num_topk: the number of experts each token is sent to, including shared experts.
+
+        Returns:
+            size: the window size in bytes.
+        """
         return deep_ep_cpp.get_low_latency_rdma_size_hint(
-            num_max_dispatch_tokens_per_rank, hidden, num_ranks, num_experts
+            num_max_dispatch_tokens_per_rank, hidden, num_ranks, num_experts, num_topk
         )
 
+    @staticmethod
+    def get_hccl_window_size() -> int:
+        """
+        Get the HCCL window bytes the operators see, from `DEEPEP_HCCL_BUFFSIZE` or `HCCL_BUFFSIZE` (200MB by default).
+        """
+        return deep_ep_cpp.get_hccl_window_bytes()
+
     # noinspection PyTypeChecker
     def get_dispatch_layout(
         self,
@@ -234,6 +257,65 @@ class Buffer:
             num_max_dispatch_tokens_per_rank, hidden, num_experts
         )
 
+    def set_expert_location_map(
+        self, physical_map: torch.Tensor, replica_count: torch.Tensor
+    ) -> None:
+        """
+        Install or hot-swap the logical to physical expert mapping used by expert-parallel load balancing (EPLB).
+        Once a mapping is installed, `topk_idx` passed to the layout, dispatch and combine functions holds logical
+            expert ids, and every selection is routed to one of the physical replicas of its logical expert. The
+            replica is picked round-robin by the position of the selection, so dispatch and combine of the same
+            `topk_idx` always agree. `num_experts` keeps meaning the number of physical experts. Ids outside
+            `[0, num_logical_experts)` are treated like -1 and not dispatched.
+        Swap the mapping only between steps, never between a dispatch and its combine. All ranks must install the
+            same mapping.
+
+        Arguments:
+            physical_map: `[num_logical_experts, max_replicas]` with `torch.int` or `torch.int64`, the physical expert
+                ids serving each logical expert, only the first `replica_count[i]` entries of row `i` are used.
+            replica_count: `[num_logical_experts]` with `torch.int` or `torch.int64`, the number of replicas of each
+                logical expert, in `[1, max_replicas]`.
+        """
+        self.runtime.set_expert_location_map(physical_map, replica_count)
+
+    def clear_expert_location_map(self) -> None:
+        """
+        Remove the mapping installed by `set_expert_location_map`, `topk_idx` holds physical expert ids again and the
+            load counters are dropped. Like a swap, only call it between steps.
+        """
+        self.runtime.clear_expert_location_map()
+
+    def get_expert_load_stats(self, reset: bool = False) -> torch.Tensor:
+        """
+        Read the per-logical-expert load counters accumulated on device by every layout or dispatch call of this rank
+            since the mapping was installed (or since the last reset). All-reduce them over the EP group to get the
+            global load for rebalancing.
+
+        Arguments:
+            reset: whether to clear the counters after reading them.
+
+        Returns:
+            load: `[num_logical_experts]` with `torch.int64`, the number of token selections of each logical expert.
+        """
+        return self.runtime.get_expert_load_stats(reset)
+
+    def fit_normal_rounds(self, hidden: int, num_topk: int) -> Tuple[int, int]:
+        """
+        Split the normal-mode dispatch into rounds that fit the HCCL window, instead of failing when one round of
+            `DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS` tokens does not fit. The total number of tokens per dispatch stays
+            the same. Rounds set through the environment are only validated. Call it on every rank with the same
+            arguments before the first `get_dispatch_layout`.
+
+        Arguments:
+            hidden: the hidden dimension of each token.
+            num_topk: the number of experts each token is sent to.
+
+        Returns:
+            round: the number of rounds of a dispatch.
+            per_round_tokens: the maximum number of tokens of one rank in a round.
+        """
+        return self.runtime.fit_normal_rounds(hidden, num_topk)
+
     # noinspection PyTypeChecker
     @log_parameters(["topk_idx"])
     def dispatch(
@@ -257,7 +339,7 @@ class Buffer:
         Union[Tuple[torch.Tensor, torch.Tensor], torch.Tensor],
         Optional[torch.Tensor],
         Optional[torch.Tensor],
-        List[int],
+        Union[List[int], torch.Tensor],
         Tuple,
         EventOverlap,
     ]:
@@ -283,7 +365,11 @@ class Buffer:
             topk_weights: `[num_tokens, num_topk]` with `torch.float`, the expert weights of each token to dispatch.
             expert_alignment: align the number of tokens received by each local expert to this variable.
             num_worst_tokens: the worst number of tokens to receive, if specified, there will be no CPU sync, and it
-                will be CUDA-graph compatible. Please also notice that this flag is for intranode only.
+                will be CUDA-graph compatible. The received tensors are sized to this bound and every rank's batch
+                size is bounded by `DEEPEP_NORMAL_SYNC_FREE_MAX_BS` (defaults to the long-seq round capacity).
+                If more tokens arrive, the kernel drops the ones past this bound, the per-expert counts still report
+                them and the handle must not be used for combine. Please also notice that this flag is for intranode
+                only.
             config: the performance tuning config.
             previous_event: the event to wait before actually executing the kernel.
             async_finish: the current stream will not wait for the communication kernels to be finished if set.
@@ -298,8 +384,9 @@ class Buffer:
             recv_topk_idx: received expert indices.
             recv_topk_weights: received expert weights.
             num_recv_tokens_per_expert_list: Python list shaped `[num_local_experts]`, the received token count by
-                each local expert, aligned to the input `expert_alignment`. If `num_worst_tokens` is specified, the list
-                will be empty.
+                each local expert, aligned to the input `expert_alignment`. If `num_worst_tokens` is specified, this is
+                a device tensor shaped `[num_local_experts]` with `torch.int64` instead, and only the first
+                `sum(num_recv_tokens_per_expert_list)` rows of `recv_x` are valid.
             handle: the returned communication handle.
             event: the event after executing the kernel (valid only if `async_finish` is set).
         """
@@ -346,6 +433,7 @@ class Buffer:
                 recv_topk_idx,
                 recv_topk_weights,
                 num_recv_tokens_per_expert_list,
+                num_recv_tokens_per_expert,
                 rank_prefix_matrix,
                 channel_prefix_matrix,
                 recv_channel_prefix_matrix,
@@ -382,6 +470,8 @@ class Buffer:
                 topk_idx,
                 topk_weights,
             )
+            if num_worst_tokens > 0:
+                num_recv_tokens_per_expert_list = num_recv_tokens_per_expert
             return (
                 (recv_x, recv_x_scales) if use_quant else recv_x,
                 recv_topk_idx,
@@ -545,7 +635,15 @@ class Buffer:
 
         # Launch the kernel
         recv_x, recv_topk_weights, event = self.runtime.intranode_combine(
-            x, topk_idx, topk_weights_ori, src_idx, send_head, combine_send_cost_stats
+            x,
+            topk_idx,
+            topk_weights_ori,
+            src_idx,
+            send_head,
+            combine_send_cost_stats,
+            getattr(previous_event, "event", None),
+            async_finish,
+            allocate_on_comm_stream,
         )
         return recv_x, recv_topk_weights, EventOverlap(event)
 
@@ -600,6 +698,8 @@ class Buffer:
                 offset_outer,
                 count_outer,
                 expand_scales,
+                recv_round_perm,
+                recv_round_offsets,
                 event,
             ) = self.runtime.internode_dispatch(
                 x,
@@ -626,6 +726,8 @@ class Buffer:
                 offset_outer,  # token_server_idx
                 count_outer,
                 expand_scales,
+                recv_round_perm,  # `None` unless the dispatch ran in several rounds
+                recv_round_offsets,
             )
             return (
                 (recv_x, recv_x_scales) if use_quant else recv_x,
@@ -661,6 +763,8 @@ class Buffer:
             offset_outer,
             count_outer,
             expand_scales,
+            recv_round_perm,
+            recv_round_offsets,
         ) = handle
 
         # Launch the kernel
@@ -674,6 +778,11 @@ class Buffer:
             offset_outer,
             count_outer,
             expand_scales,
+            recv_round_perm,
+            recv_round_offsets,
+            getattr(previous_event, "event", None),
+            async_finish,
+            allocate_on_comm_stream,
         )
         return recv_x, recv_topk_weights, EventOverlap(event)
 
@@ -691,6 +800,7 @@ class Buffer:
         use_ue8m0: bool = False,
         async_finish: bool = False,
         return_recv_hook: bool = False,
+        use_block_scales: bool = False,
     ) -> Tuple[
         Tuple[torch.Tensor, torch.Tensor], torch.Tensor, Tuple, EventOverlap, Callable
     ]:
@@ -708,18 +818,22 @@ class Buffer:
                 `[num_local_experts]` and be typed as `torch.int`. This is useful for online service EP load balance
                 monitoring.
             use_fp8: whether to enable FP8 casting, with this, the received data will be a tuple of FP8 tensor and scaling factors.
-            round_scale: whether round the scaling factors into power of 2.
+            round_scale: whether round the scaling factors up into power of 2 (only with `use_block_scales=True`).
             use_ue8m0: whether use UE8M0 as scaling factor format (available only with `round_scale=True`).
             async_finish: the current stream will not wait for the communication kernels to be finished if set.
             return_recv_hook: return a receiving hook if set. If set, the kernel will just do the RDMA request issues,
                 but **without actually receiving the data**. You must call the received hook to make sure the data's arrival.
                 If you do not set this flag, the kernel will ensure the data's arrival.
+            use_block_scales: with `use_fp8=True`, quantize every 128-channel block of a token with its own scale
+                instead of one scale per token. Not supported on Ascend 910B.
 
         Returns:
             recv_x: a tensor or tuple with received tokens for each expert.
                 With `use_fp8=True`: the first element is a `torch.Tensor` shaped as
                 `[num_local_experts, num_max_dispatch_tokens_per_rank * num_ranks, hidden]` with `torch.float8_e4m3fn`.
-                The second tensor is the corresponding scales for the first element with shape
+                The second tensor is the corresponding per-token scales for the first element with shape
+                `[num_local_experts * num_max_dispatch_tokens_per_rank * num_ranks]` with `torch.float`.
+                With `use_block_scales=True` it is shaped as
                 `[num_local_experts, num_max_dispatch_tokens_per_rank * num_ranks, hidden // 128]` with `torch.float`,
                 if `use_ue8m0=False`. With `use_ue8m0=True`, the second one is packed and shaped as
                 `[num_local_experts, num_max_dispatch_tokens_per_rank * num_ranks, hidden // 512]` with type `torch.int`.
@@ -752,6 +866,7 @@ class Buffer:
             use_fp8,
             round_scale,
             use_ue8m0,
+            use_block_scales,
             async_finish,
             return_recv_hook,
         )
@@ -781,6 +896,27 @@ class Buffer:
             hook,
         )
 
+    def get_next_low_latency_combine_buffer(
+        self, handle: tuple, num_topk: int
+    ) -> torch.Tensor:
+        """
+        Get the persistent buffer the expert GEMM should write its output into before calling
+        `low_latency_combine(..., zero_copy=True)`. Two buffers are used alternately, so the combine of one layer may
+        still be in flight while the next layer fills the other one.
+
+        Arguments:
+            handle: the communication handle given by the `low_latency_dispatch` function.
+            num_topk: the number of experts selected by each dispatched token.
+
+        Returns:
+            buffer: `[num_max_tokens, hidden]` with `torch.bfloat16`, laid out like the received tokens of
+                `low_latency_dispatch`.
+        """
+        _, _, num_max_dispatch_tokens_per_rank, hidden, num_experts, _ = handle
+        return self.runtime.get_next_low_latency_combine_buffer(
+            num_max_dispatch_tokens_per_rank, hidden, num_experts, num_topk
+        )
+
     @log_parameters(["topk_idx"])
     def low_latency_combine(
         self,
@@ -805,13 +941,14 @@ class Buffer:
             topk_weights: `[num_combined_tokens, num_topk]` with `torch.float`, the expert weights selected by the dispatched
                 tokens. The received tokens will be reduced with the weights in this tensor.
             handle: the communication handle given by the `dispatch` function.
-            zero_copy: whether the tensor is already copied into the RDMA buffer, should be cooperative
-                with `get_next_low_latency_combine_buffer`.
+            zero_copy: whether `x` is the buffer returned by `get_next_low_latency_combine_buffer`, i.e. the expert
+                GEMM wrote its output there directly.
             async_finish: the current stream will not wait for the communication kernels to be finished if set.
             return_recv_hook: return a receiving hook if set. If set, the kernel will just do the RDMA request issues,
                 but **without actually receiving the data**. You must call the received hook to make sure the data's arrival.
                 If you do not set this flag, the kernel will ensure the data's arrival.
-            out: the in-place output tensor, if set, the kernel will write the result to this tensor and return it directly.
+            out: the in-place output tensor with at least `num_combined_tokens` rows, if set, the kernel will write the
+                result to its leading rows and return them directly instead of allocating a new tensor.
 
         Returns:
             combined_x: the reduced token tensor, with shape `[num_combined_tokens, hidden]` and type `torch.bfloat16`.
@@ -861,9 +998,9 @@ class Buffer:
         topk_idx: torch.Tensor,
         topk_weights: torch.Tensor,
         gmm1_permuted_weight: torch.Tensor,
-        gmm1_permuted_weight_scale: torch.Tensor,
+        gmm1_permuted_weight_scale: Optional[torch.Tensor],
         gmm2_weight: torch.Tensor,
-        gmm2_weight_scale: torch.Tensor,
+        gmm2_weight_scale: Optional[torch.Tensor],
         num_max_dispatch_tokens_per_rank: int,
         num_experts: int,
         quant_mode: int = 1,
@@ -898,6 +1035,8 @@ class Buffer:
             - The second dimension of `x` defines the hidden dimension `hidden`.
             - Exact shapes of weight/scale tensors depend on GMM permutation and sharding.
             - If optional scale tensors are empty, the kernel skips those transforms.
+            - With DISPATCH_FFN_COMBINE, bf16/fp16 weights matching `x` run the unquantized kernel; they must be
+              FRACTAL_NZ and the weight scale tensors may be None.
 
         Returns:
             output: `torch.Tensor`, shape `[bs, hidden]` and usually `torch.bfloat16`,
@@ -10,6 +10,7 @@ class TransferDirection(Enum):
 
 
 class TransferFlag(Enum):
+    FAST1D = 1
     FAST2D = 2
 
 
@@ -40,28 +41,25 @@ def transfer_kv_dim_exchange(
         host_index_k: index_k_buffer in host
         page_size: page size
         direction: only support H2D and D2H.
-        flags: only FAST2D is supported, which indicates 2D data transfer via calling aclrtMemcpy2dAsync.
+        flags: FAST2D copies a layer-first device buffer to a page-first host buffer
+            ([page, layer, ...]) via aclrtMemcpy2dAsync. FAST1D copies between buffers with the
+            same layer-first layout ([layer, page, ...]).
     """
-    torch.ops.npu.transfer_kv_dim_exchange(
-        device_k,
-        host_k,
-        device_v,
-        host_v,
+    device_bufs = [device_k]
+    host_bufs = [host_k]
+    if device_v.numel() != 0 and host_v.numel() != 0:
+        device_bufs.append(device_v)
+        host_bufs.append(host_v)
+    if device_index_k is not None and host_index_k is not None:
+        device_bufs.append(device_index_k)
+        host_bufs.append(host_index_k)
+    # a single call reads the indices once and coalesces page runs for all buffers
+    torch.ops.npu.transfer_kv_dim_exchange_batch(
+        device_bufs,
+        host_bufs,
         device_indices,
         host_indices,
         page_size,
         direction.value,
         flags.value,
     )
-    if device_index_k is not None and host_index_k is not None:
-        torch.ops.npu.transfer_kv_dim_exchange(
-            device_index_k,
-            host_index_k,
-            torch.empty(0),
-            torch.empty(0),
-            device_indices,
-            host_indices,
-            page_size,
-            direction.value,
-            flags.value,
-        )
@@ -222,7 +222,7 @@ def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
     rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
     torch.manual_seed(rank)
 
-    if args.test_type == "normal":
+    if args.test_type in ("normal", "normal_multi_round"):
         buffer = deep_ep.Buffer(
             group, int(2e9), 0, low_latency_mode=False, num_qps_per_rank=1
         )
@@ -274,11 +274,20 @@ if __name__ == "__main__":
         "--test-type",
         type=str,
         default="normal",
-        choices=["normal", "low_latency"],
-        help="Test type: normal (combine) or low_latency (low_latency_combine)",
+        choices=["normal", "normal_multi_round", "low_latency"],
+        help="Test type: normal (combine), normal_multi_round (combine split into rounds) "
+        "or low_latency (low_latency_combine)",
     )
     args = parser.parse_args()
 
+    if args.test_type == "normal_multi_round":
+        # Two dispatch rounds of 8192 top-16 tokens overflow one half of the combine
+        # status window, so the tiling has to split the combine into rounds itself.
+        args.num_tokens = 2 * 8192
+        args.num_topk = 16
+        os.environ["DEEPEP_NORMAL_LONG_SEQ_ROUND"] = "2"
+        os.environ["DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS"] = "8192"
+
     num_processes = args.num_processes
     torch.multiprocessing.spawn(
         test_loop, args=(num_processes, args), nprocs=num_processes
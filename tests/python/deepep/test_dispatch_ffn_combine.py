@@ -2,6 +2,7 @@ import argparse
 import os
 import random
 import sys
+import tempfile
 import time
 from functools import partial
 
@@ -115,6 +116,207 @@ def test(
         print(f"{rank=} PASSED")
 
 
+def test_bf16(
+    num_tokens: int,
+    hidden: int,
+    moe_intermediate_size: int,
+    num_topk: int,
+    rank: int,
+    num_ranks: int,
+    group: dist.ProcessGroup,
+    buffer: Buffer,
+    local_rank: int,
+    seed: int = 0,
+):
+    # One expert per rank keeps the all-gathered reference weights small
+    num_experts = num_ranks
+    assert num_topk <= num_experts
+    torch.manual_seed(seed + rank)
+
+    num_tokens_tensor = torch.tensor([num_tokens], dtype=torch.int32, device="npu")
+    dist.all_reduce(num_tokens_tensor, op=dist.ReduceOp.MAX)
+    max_num_tokens = num_tokens_tensor.item()
+
+    x = (torch.randn((num_tokens, hidden), dtype=torch.bfloat16) * 0.1).npu()
+    expert_idx = (
+        torch.stack([torch.randperm(num_experts)[:num_topk] for _ in range(num_tokens)])
+        .int()
+        .npu()
+    )
+    probs = torch.rand((num_tokens, num_topk), dtype=torch.float32).npu()
+    weight1 = (
+        torch.randn((1, hidden, moe_intermediate_size), dtype=torch.bfloat16) * 0.02
+    ).npu()
+    weight2 = (
+        torch.randn((1, moe_intermediate_size // 2, hidden), dtype=torch.bfloat16)
+        * 0.02
+    ).npu()
+    all_weight1 = torch.empty(
+        (num_experts, hidden, moe_intermediate_size),
+        dtype=torch.bfloat16,
+        device="npu",
+    )
+    all_weight2 = torch.empty(
+        (num_experts, moe_intermediate_size // 2, hidden),
+        dtype=torch.bfloat16,
+        device="npu",
+    )
+    dist.all_gather_into_tensor(all_weight1, weight1, group=group)
+    dist.all_gather_into_tensor(all_weight2, weight2, group=group)
+
+    out, expert_token_nums = buffer.fused_deep_moe(
+        x=x,
+        topk_idx=expert_idx,
+        topk_weights=probs,
+        gmm1_permuted_weight=torch_npu.npu_format_cast(weight1.clone(), 29),
+        gmm1_permuted_weight_scale=None,
+        gmm2_weight=torch_npu.npu_format_cast(weight2.clone(), 29),
+        gmm2_weight_scale=None,
+        num_max_dispatch_tokens_per_rank=max_num_tokens * num_topk * 2,
+        num_experts=num_experts,
+        fuse_mode=2,
+    )
+    torch.npu.synchronize()
+
+    # Reference: sum over the selected experts of prob * (silu(gate) * up) @ w2
+    ref_out = torch.zeros((num_tokens, hidden), dtype=torch.float32, device="npu")
+    for expert in range(num_experts):
+        token_ids, slot_ids = (expert_idx == expert).nonzero(as_tuple=True)
+        if token_ids.numel() == 0:
+            continue
+        h = x[token_ids].float() @ all_weight1[expert].float()
+        gate, up = h.chunk(2, dim=-1)
+        act = (torch.nn.functional.silu(gate) * up).bfloat16().float()
+        y = act @ all_weight2[expert].float()
+        ref_out.index_add_(0, token_ids, y * probs[token_ids, slot_ids].unsqueeze(-1))
+
+    expert_counts = torch.bincount(expert_idx.flatten().long(), minlength=num_experts)
+    dist.all_reduce(expert_counts, group=group)
+    assert (
+        expert_token_nums.long().cpu() == expert_counts[rank : rank + 1].cpu()
+    ).all(), f"{rank=}: {expert_token_nums=} != {expert_counts[rank]=}"
+    diff = calc_diff(out.float(), ref_out)
+    assert (
+        diff < 1e-3
+    ), f"{rank=}: bf16 output differs from the torch reference, {diff=}"
+    if local_rank == 0:
+        print(f"[bf16] {diff=:.6f} PASSED", flush=True)
+
+
+def test_count_sort(
+    num_tokens: int,
+    hidden: int,
+    moe_intermediate_size: int,
+    num_experts: int,
+    num_topk: int,
+    rank: int,
+    num_ranks: int,
+    buffer: Buffer,
+    out_path: str,
+    seed: int = 0,
+):
+    # Routing with <= 512 experts takes the counting sort; the outputs are saved and compared against the merge sort
+    # run of another process
+    torch.manual_seed(seed + rank)
+    assert num_experts % num_ranks == 0
+    e = num_experts // num_ranks
+
+    num_tokens_tensor = torch.tensor([num_tokens], dtype=torch.int32, device="npu")
+    dist.all_reduce(num_tokens_tensor, op=dist.ReduceOp.MAX)
+    max_num_tokens = num_tokens_tensor.item()
+
+    x = (torch.randn((num_tokens, hidden), dtype=torch.bfloat16) * 0.1).npu()
+    expert_idx = torch.randint(
+        0, num_experts, (num_tokens, num_topk), dtype=torch.int32
+    ).npu()
+    probs = torch.rand((num_tokens, num_topk), dtype=torch.float32).npu()
+    weight1 = (
+        torch.randn((e, hidden, moe_intermediate_size), dtype=torch.bfloat16) * 0.02
+    ).npu()
+    weight1 = torch_npu.npu_format_cast(weight1, 29)
+    weight2 = (
+        torch.randn((e, moe_intermediate_size // 2, hidden), dtype=torch.bfloat16)
+        * 0.02
+    ).npu()
+    weight2 = torch_npu.npu_format_cast(weight2, 29)
+
+    out, expert_token_nums = buffer.fused_deep_moe(
+        x=x,
+        topk_idx=expert_idx,
+        topk_weights=probs,
+        gmm1_permuted_weight=weight1,
+        gmm1_permuted_weight_scale=None,
+        gmm2_weight=weight2,
+        gmm2_weight_scale=None,
+        num_max_dispatch_tokens_per_rank=max_num_tokens * num_topk * 2,
+        num_experts=num_experts,
+        fuse_mode=2,
+    )
+    torch.save((out.cpu(), expert_token_nums.cpu()), out_path)
+
+
+def count_sort_loop(
+    local_rank: int,
+    num_local_ranks: int,
+    args: argparse.Namespace,
+    disable_count_sort: bool,
+    out_dir: str,
+):
+    # DEEPEP_DISABLE_COUNT_SORT is read when an op is first tiled and is not part of the op cache key, so each
+    # routing mode gets processes of its own
+    os.environ["DEEPEP_DISABLE_COUNT_SORT"] = "1" if disable_count_sort else "0"
+    rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
+    buffer = Buffer(group, int(2e9), 0, low_latency_mode=False, num_qps_per_rank=1)
+
+    # One expert count below the counting-sort limit and one at it
+    for num_experts in count_sort_experts(num_ranks):
+        test_count_sort(
+            args.num_tokens,
+            args.hidden,
+            args.moe_intermediate_size,
+            num_experts,
+            args.num_topk,
+            rank,
+            num_ranks,
+            buffer,
+            count_sort_path(out_dir, disable_count_sort, num_experts, rank),
+            seed=1,
+        )
+
+    dist.barrier()
+    dist.destroy_process_group()
+
+
+def count_sort_experts(num_ranks: int):
+    return [e for e in (256, 512) if e % num_ranks == 0]
+
+
+def count_sort_path(
+    out_dir: str, disable_count_sort: bool, num_experts: int, rank: int
+):
+    mode = "merge_sort" if disable_count_sort else "count_sort"
+    return os.path.join(out_dir, f"{mode}_{num_experts}_rank{rank}.pt")
+
+
+def check_count_sort(out_dir: str, num_ranks: int):
+    for num_experts in count_sort_experts(num_ranks):
+        for rank in range(num_ranks):
+            out_count, expert_token_nums_count = torch.load(
+                count_sort_path(out_dir, False, num_experts, rank)
+            )
+            out_sort, expert_token_nums_sort = torch.load(
+                count_sort_path(out_dir, True, num_experts, rank)
+            )
+            assert torch.equal(
+                expert_token_nums_count, expert_token_nums_sort
+            ), f"{rank=}, {num_experts=}: {expert_token_nums_count=} != {expert_token_nums_sort=}"
+            diff = calc_diff(out_count, out_sort)
+            assert (
+                diff < 1e-5
+            ), f"{rank=}, {num_experts=}: count sort output differs, {diff=}"
+        print(f"[count sort] {num_experts=} PASSED", flush=True)
+
+
 def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
     rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
 
@@ -149,6 +351,19 @@ def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
         if local_rank == 0:
             print(f"loop {i=} finish.", flush=True)
 
+    test_bf16(
+        num_tokens,
+        hidden,
+        moe_intermediate_size,
+        num_topk,
+        rank,
+        num_ranks,
+        group,
+        buffer,
+        local_rank,
+        seed=1,
+    )
+
     dist.barrier()
     dist.destroy_process_group()
 
@@ -188,3 +403,12 @@ if __name__ == "__main__":
     torch.multiprocessing.spawn(
         test_loop, args=(num_processes, args), nprocs=num_processes
     )
+
+    with tempfile.TemporaryDirectory() as out_dir:
+        for disable_count_sort in (False, True):
+            torch.multiprocessing.spawn(
+                count_sort_loop,
+                args=(num_processes, args, disable_count_sort, out_dir),
+                nprocs=num_processes,
+            )
+        check_count_sort(out_dir, num_processes)
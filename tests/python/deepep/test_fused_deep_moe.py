@@ -577,6 +577,76 @@ def test(
     )
 
 
+def test_multi_round(
+    round_tokens: int,
+    hidden: int,
+    moe_intermediate_size: int,
+    num_experts: int,
+    num_topk: int,
+    rank: int,
+    num_ranks: int,
+    buffer: Buffer,
+    seed: int = 0,
+):
+    # A batch larger than one round is split into rounds inside the kernel; it must match separate launches
+    torch.manual_seed(seed + rank)
+    num_local_experts = num_experts // num_ranks
+    num_chunks = 3
+    num_tokens = round_tokens * num_chunks
+
+    x = torch.rand((num_tokens, hidden), dtype=torch.bfloat16, device="npu") * 10 - 5
+    scores = (
+        torch.randn((num_tokens, num_experts), dtype=torch.float32, device="npu").abs()
+        + 1
+    )
+    topk_idx = torch.topk(scores, num_topk, dim=-1, largest=True, sorted=True)[1]
+    topk_weights = torch.randn(
+        (num_tokens, num_topk), dtype=torch.float32, device="npu"
+    ).abs()
+    w13_weight, w13_weight_scale, w2_weight, w2_weight_scale = init_base_weights(
+        num_local_experts=num_local_experts,
+        hidden_in=hidden,
+        moe_intermediate_size=moe_intermediate_size,
+    )
+    w13_f, w13s_f, w2_f, w2s_f = init_fused_weights_int8(
+        w13_weight, w13_weight_scale, w2_weight, w2_weight_scale
+    )
+
+    def run(start: int, end: int):
+        return buffer.fused_deep_moe(
+            x[start:end],
+            topk_idx[start:end],
+            topk_weights[start:end],
+            w13_f,
+            w13s_f,
+            w2_f,
+            w2s_f,
+            end - start,
+            num_experts,
+            0,
+        )
+
+    multi_round_output, multi_round_recv_count = run(0, num_tokens)
+    chunk_outputs = []
+    chunk_recv_count = torch.zeros_like(multi_round_recv_count)
+    for i in range(num_chunks):
+        output, recv_count = run(i * round_tokens, (i + 1) * round_tokens)
+        chunk_outputs.append(output)
+        chunk_recv_count += recv_count
+    chunk_output = torch.cat(chunk_outputs, dim=0)
+    torch.npu.synchronize()
+
+    avg_diff = torch.mean(torch.abs(multi_round_output - chunk_output)).item()
+    print(
+        f"[Rank {rank}] multi-round {num_tokens=}, {round_tokens=}, avg_diff={avg_diff:.6e}",
+        flush=True,
+    )
+    assert avg_diff < 4e-4, f"[Rank {rank}] Multi-round mismatch! diff={avg_diff}"
+    assert torch.equal(
+        multi_round_recv_count, chunk_recv_count
+    ), f"[Rank {rank}] Multi-round recv count mismatch: {multi_round_recv_count=} vs {chunk_recv_count=}"
+
+
 # ======================== Distributed Entry ========================
 def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
     rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
@@ -622,6 +692,21 @@ def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
         seed=1,
     )
 
+    if shared_expert_rank_num == 0:
+        # A round holds at most 256 tokens and 2048 token * top-k pairs per rank
+        round_tokens = min(256, 2048 // num_topk)
+        test_multi_round(
+            round_tokens,
+            hidden,
+            moe_intermediate_size,
+            num_experts,
+            num_topk,
+            rank,
+            num_ranks,
+            buffer,
+            seed=2,
+        )
+
     dist.barrier()
     dist.destroy_process_group()
 
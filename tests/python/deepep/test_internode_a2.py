@@ -62,8 +62,17 @@ def test_main(
     else:
         num_tokens = base_num_tokens
 
+    # Longer batches are dispatched in rounds of at most MAX_BATCH_SIZE tokens per rank
+    round_val = int(os.getenv("DEEPEP_NORMAL_LONG_SEQ_ROUND", 1))
+    per_round_tokens = int(
+        os.getenv("DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS", MAX_BATCH_SIZE)
+    )
+    if round_val == 1:
+        per_round_tokens = MAX_BATCH_SIZE
+    assert per_round_tokens <= MAX_BATCH_SIZE
+
     assert num_experts % num_ranks == 0 and num_nodes >= 2
-    assert num_tokens <= MAX_BATCH_SIZE
+    assert num_tokens <= round_val * per_round_tokens
     if local_rank == 0:
         print(
             f"[config] num_tokens={num_tokens}, hidden={hidden}, num_topk={num_topk}, active_ranks={args.active_ranks}",
@@ -167,14 +176,24 @@ def test_main(
     inplace_unique(rdma_idx, num_nodes)
     num_rdma_token_sent = rdma_idx.ne(-1).sum().item()
 
-    # Expert meta
-    num_tokens_per_expert = torch.zeros((num_experts,), dtype=torch.int, device="npu")
-    for i in range(num_experts):
-        num_tokens_per_expert[i] = (topk_idx == i).sum()
-    gbl_num_tokens_per_expert = num_tokens_per_expert.clone()
+    # Expert meta, one row per round
+    num_tokens_per_expert = torch.zeros(
+        (round_val, num_experts), dtype=torch.int, device="npu"
+    )
+    for round_id in range(round_val):
+        chunk_topk = topk_idx[
+            round_id * per_round_tokens : (round_id + 1) * per_round_tokens
+        ]
+        for i in range(num_experts):
+            num_tokens_per_expert[round_id, i] = (chunk_topk == i).sum()
+    round_num_tokens_per_expert = num_tokens_per_expert
+    gbl_num_tokens_per_expert = num_tokens_per_expert.sum(dim=0, dtype=torch.int)
+    num_tokens_per_expert = num_tokens_per_expert.flatten()
     dist.all_reduce(gbl_num_tokens_per_expert, group=group)
 
-    def check_layout_a2_data(notify_send_data):
+    def check_layout_a2_data(notify_send_data, topk_idx, num_tokens_per_expert):
+        # Checks the notify send data of one round against its slice of topk_idx
+        num_tokens = topk_idx.size(0)
         # cpu calc data
         count_num_expert = [0] * num_experts
         num_tokens_per_server_uniq = torch.zeros(
@@ -268,30 +287,27 @@ def test_main(
         ]
 
         # check data
-        try:
-            assert torch.allclose(
-                num_tokens_per_expert, notify_send_data[:num_experts]
-            ), f"Assertion num_tokens_per_rank failed on rank {rank}: Expected {ref_num_tokens_per_expert}, Actual {notify_send_data[:num_experts]}"
-            assert torch.allclose(
-                num_tokens_per_server_uniq, ref_num_tokens_per_server_uniq
-            ), f"Assertion num_tokens_per_server_uniq failed on rank {rank}: Expected {num_tokens_per_server_uniq}, Actual {ref_num_tokens_per_server_uniq}"
-            assert torch.allclose(
-                num_each_token_to_server, ref_num_each_token_to_server
-            ), f"Assertion num_each_token_to_server failed on rank {rank}: Expected {num_each_token_to_server}, Actual {ref_num_each_token_to_server}"
-            assert torch.allclose(
-                each_token_to_num_server, ref_each_token_to_num_server
-            ), f"Assertion each_token_to_num_server failed on rank {rank}: Expected {each_token_to_num_server}, Actual {ref_each_token_to_num_server}"
-            assert torch.allclose(
-                each_token_offset_to_server, ref_each_token_offset_to_server
-            ), f"Assertion each_token_offset_to_server failed on rank {rank}: Expected {each_token_offset_to_server}, Actual {ref_each_token_offset_to_server}"
-            assert torch.allclose(
-                send_token_idx, ref_send_token_idx
-            ), f"Assertion send_token_idx failed on rank {rank}: Expected {send_token_idx}, Actual {ref_send_token_idx}"
-            assert torch.allclose(
-                expert_rank_token_idx, ref_expert_rank_token_idx
-            ), f"Assertion expert_rank_token_idx failed on rank {rank}: Expected {expert_rank_token_idx}, Actual {ref_expert_rank_token_idx}"
-        except AssertionError as e:
-            raise
+        assert torch.allclose(
+            num_tokens_per_expert, notify_send_data[:num_experts]
+        ), f"Assertion num_tokens_per_expert failed on rank {rank}: Expected {num_tokens_per_expert}, Actual {notify_send_data[:num_experts]}"
+        assert torch.allclose(
+            num_tokens_per_server_uniq, ref_num_tokens_per_server_uniq
+        ), f"Assertion num_tokens_per_server_uniq failed on rank {rank}: Expected {num_tokens_per_server_uniq}, Actual {ref_num_tokens_per_server_uniq}"
+        assert torch.allclose(
+            num_each_token_to_server, ref_num_each_token_to_server
+        ), f"Assertion num_each_token_to_server failed on rank {rank}: Expected {num_each_token_to_server}, Actual {ref_num_each_token_to_server}"
+        assert torch.allclose(
+            each_token_to_num_server, ref_each_token_to_num_server
+        ), f"Assertion each_token_to_num_server failed on rank {rank}: Expected {each_token_to_num_server}, Actual {ref_each_token_to_num_server}"
+        assert torch.allclose(
+            each_token_offset_to_server, ref_each_token_offset_to_server
+        ), f"Assertion each_token_offset_to_server failed on rank {rank}: Expected {each_token_offset_to_server}, Actual {ref_each_token_offset_to_server}"
+        assert torch.allclose(
+            send_token_idx, ref_send_token_idx
+        ), f"Assertion send_token_idx failed on rank {rank}: Expected {send_token_idx}, Actual {ref_send_token_idx}"
+        assert torch.allclose(
+            expert_rank_token_idx, ref_expert_rank_token_idx
+        ), f"Assertion expert_rank_token_idx failed on rank {rank}: Expected {expert_rank_token_idx}, Actual {ref_expert_rank_token_idx}"
 
     # Rank layout meta
     num_tokens_per_rank = torch.empty((num_ranks,), dtype=torch.int, device="npu")
@@ -321,38 +337,34 @@ def test_main(
     dist.barrier()
     time.sleep(1)
 
-    try:
-        try:
-            return_values = buffer.get_dispatch_layout(topk_idx, num_experts)
-        except Exception as e:
-            print(f"Error occurred while calling get_dispatch_layout: {e}")
-            raise
-
-        (
-            ref_num_tokens_per_rank,
-            _,
-            ref_num_tokens_per_expert,
-            ref_is_token_in_rank,
-            _,
-        ) = return_values
-        try:
-            assert torch.allclose(
-                ref_num_tokens_per_rank, num_tokens_per_rank
-            ), f"Assertion num_tokens_per_rank failed on rank {rank}: Expected {num_tokens_per_rank}, Actual {ref_num_tokens_per_rank}"
-            assert torch.allclose(
-                ref_num_tokens_per_expert, num_tokens_per_expert
-            ), f"Assertion num_tokens_per_expert failed on rank {rank}: Expected {num_tokens_per_expert}, Actual {ref_num_tokens_per_expert}"
-            assert torch.allclose(
-                ref_is_token_in_rank, is_token_in_rank
-            ), f"Assertion is_token_in_rank failed on rank {rank}: Expected {is_token_in_rank}, Actual {ref_is_token_in_rank}"
-            if enable_a2_test:
-                notify_send_data = buffer.get_notify_send_data()
-                check_layout_a2_data(notify_send_data)
-        except AssertionError as e:
-            print(e)
-            raise
-    except Exception as e:
-        print(f"An error occurred: {e}")
+    (
+        ref_num_tokens_per_rank,
+        _,
+        ref_num_tokens_per_expert,
+        ref_is_token_in_rank,
+        _,
+    ) = buffer.get_dispatch_layout(topk_idx, num_experts)
+    assert torch.allclose(
+        ref_num_tokens_per_rank, num_tokens_per_rank
+    ), f"Assertion num_tokens_per_rank failed on rank {rank}: Expected {num_tokens_per_rank}, Actual {ref_num_tokens_per_rank}"
+    # The layout returns one row of expert counts per round, flattened
+    assert torch.allclose(
+        ref_num_tokens_per_expert.view(round_val, num_experts),
+        round_num_tokens_per_expert,
+    ), f"Assertion num_tokens_per_expert failed on rank {rank}: Expected {round_num_tokens_per_expert}, Actual {ref_num_tokens_per_expert}"
+    assert torch.allclose(
+        ref_is_token_in_rank, is_token_in_rank
+    ), f"Assertion is_token_in_rank failed on rank {rank}: Expected {is_token_in_rank}, Actual {ref_is_token_in_rank}"
+    if enable_a2_test:
+        notify_send_data = buffer.get_notify_send_data().view(round_val, -1)
+        for round_id in range(round_val):
+            check_layout_a2_data(
+                notify_send_data[round_id],
+                topk_idx[
+                    round_id * per_round_tokens : (round_id + 1) * per_round_tokens
+                ],
+                round_num_tokens_per_expert[round_id],
+            )
 
     # Config
     buffer_size = 256
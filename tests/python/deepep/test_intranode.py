@@ -413,6 +413,94 @@ def test_main(
     if local_rank == 0:
         print("", flush=True)
 
+    # Sync-free dispatch: outputs sized from `num_worst_tokens`, counts kept on device
+    if local_rank == 0:
+        print("[testing] Running sync-free dispatch ...", flush=True, end="")
+    # Any bound above the real receive count works, pad the reference count to exercise the unused tail
+    num_worst_tokens = int(local_expert_token.sum().item()) + 16
+    dispatch_args = {
+        "x": x,
+        "num_tokens_per_rank": ref_num_tokens_per_rank,
+        "is_token_in_rank": ref_is_token_in_rank,
+        "num_tokens_per_expert": ref_num_tokens_per_expert,
+        "config": config,
+        "topk_idx": topk_idx,
+        "topk_weights": topk_weights,
+        "num_worst_tokens": num_worst_tokens,
+    }
+    recv_x, _, _, recv_num_tokens_per_expert, handle, _ = buffer.dispatch(
+        **dispatch_args
+    )
+    recv_x = per_token_cast_back(*recv_x) if isinstance(recv_x, tuple) else recv_x
+    assert recv_x.size(0) == num_worst_tokens
+    assert recv_num_tokens_per_expert.tolist() == local_expert_token_list
+    combined_x, _, _ = buffer.combine(
+        x=recv_x, handle=handle, config=config, topk_weights=handle[7]
+    )
+    diff = calc_diff(
+        combined_x.float(),
+        x * handle[7].masked_fill(topk_idx == -1, 0).sum(dim=1).view(-1, 1),
+    )
+    assert diff < 5e-5
+
+    # An undersized bound keeps the rows below it and drops the overflow instead of writing past the outputs
+    num_recv_tokens = num_worst_tokens - 16
+    dispatch_args["num_worst_tokens"] = max(num_recv_tokens // 2, 1)
+    short_recv_x, _, _, short_num_tokens_per_expert, _, _ = buffer.dispatch(
+        **dispatch_args
+    )
+    short_recv_x = (
+        per_token_cast_back(*short_recv_x)
+        if isinstance(short_recv_x, tuple)
+        else short_recv_x
+    )
+    assert short_recv_x.size(0) == dispatch_args["num_worst_tokens"]
+    assert short_num_tokens_per_expert.tolist() == local_expert_token_list
+    if num_recv_tokens > 0:
+        assert torch.equal(short_recv_x, recv_x[: short_recv_x.size(0)])
+    if local_rank == 0:
+        print(" passed", flush=True)
+
+    # Async dispatch/combine on the communication stream, chained through events
+    if local_rank == 0:
+        print("[testing] Running async dispatch/combine ...", flush=True, end="")
+    previous_event = deep_ep.Buffer.capture()
+    dispatch_args = {
+        "x": x,
+        "num_tokens_per_rank": ref_num_tokens_per_rank,
+        "is_token_in_rank": ref_is_token_in_rank,
+        "num_tokens_per_expert": ref_num_tokens_per_expert,
+        "config": config,
+        "topk_idx": topk_idx,
+        "topk_weights": topk_weights,
+        "previous_event": previous_event,
+        "async_finish": True,
+        "allocate_on_comm_stream": True,
+    }
+    recv_x, _, _, _, handle, event = buffer.dispatch(**dispatch_args)
+    if isinstance(recv_x, tuple):
+        # recv_x is written on the communication stream, cast it back only once the dispatch is done
+        event.current_stream_wait()
+        recv_x = per_token_cast_back(*recv_x)
+        event = deep_ep.Buffer.capture()
+    combined_x, _, event = buffer.combine(
+        x=recv_x,
+        handle=handle,
+        config=config,
+        topk_weights=handle[7],
+        previous_event=event,
+        async_finish=True,
+        allocate_on_comm_stream=True,
+    )
+    event.current_stream_wait()
+    diff = calc_diff(
+        combined_x.float(),
+        x * handle[7].masked_fill(topk_idx == -1, 0).sum(dim=1).view(-1, 1),
+    )
+    assert diff < 5e-5
+    if local_rank == 0:
+        print(" passed", flush=True)
+
     # Tune dispatch performance
     fp8_factor = (1 + 4 / 128) / 2
     config = deep_ep.Config(24, 8, buffer_size)
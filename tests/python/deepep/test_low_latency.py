@@ -75,7 +75,16 @@ def test(
     cumulative_local_expert_recv_stats = torch.zeros(
         (num_local_experts,), dtype=torch.int, device="npu"
     )
-    for dispatch_use_fp8 in (True, False):
+    # Per-128-channel block scales (and their power-of-two/UE8M0 variants) are only produced by the A3 dispatch kernel
+    dispatch_cases = [(True, False, False, False)]
+    if "910B" not in torch.npu.get_device_name():
+        dispatch_cases += [
+            (True, False, False, True),
+            (True, True, False, True),
+            (True, True, True, True),
+        ]
+    dispatch_cases.append((False, False, False, False))
+    for dispatch_use_fp8, round_scale, use_ue8m0, use_block_scales in dispatch_cases:
         packed_recv_x, packed_recv_count, handle, event, hook = (
             buffer.low_latency_dispatch(
                 x,
@@ -83,11 +92,12 @@ def test(
                 aligned_num_tokens,
                 num_experts,
                 use_fp8=dispatch_use_fp8,
-                round_scale=False,
-                use_ue8m0=False,
+                round_scale=round_scale,
+                use_ue8m0=use_ue8m0,
                 cumulative_local_expert_recv_stats=cumulative_local_expert_recv_stats,
                 async_finish=not return_recv_hook,
                 return_recv_hook=return_recv_hook,
+                use_block_scales=use_block_scales,
             )
         )
         simulated_gemm_x = (
@@ -148,6 +158,13 @@ def test(
             recv_x = recv_x[:num_valid_tokens]
             recv_x_amin = recv_x[:, :-128].amin(dim=-1)
             assert torch.equal(recv_x_amin, recv_x[:, :-128].amax(dim=-1))
+            if round_scale and not use_ue8m0:
+                recv_scales = packed_recv_x[1][
+                    int(i * temp) : int(i * temp + num_valid_tokens)
+                ]
+                assert torch.equal(
+                    recv_scales, torch.exp2(torch.log2(recv_scales).round())
+                )
             if dispatch_use_fp8:
                 hash_value ^= hash_tensor(
                     packed_recv_x[0][int(i * temp) : int(i * temp + num_valid_tokens)]
@@ -194,6 +211,23 @@ def test(
                 assert diff < 1e-4, f"Error: {diff=}"
             else:
                 assert diff < 1e-5, f"Error: {diff=}"
+
+            # Zero-copy combine: the expert output lives in the registered buffer, the result lands in `out`
+            combine_buffer = buffer.get_next_low_latency_combine_buffer(
+                handle, num_topk
+            )
+            combine_buffer.copy_(simulated_gemm_x)
+            zero_copy_out = torch.empty_like(out)
+            zero_copy_x, event, hook = buffer.low_latency_combine(
+                combine_buffer,
+                topk_idx,
+                topk_weights,
+                handle,
+                zero_copy=True,
+                out=zero_copy_out,
+            )
+            assert zero_copy_x.data_ptr() == zero_copy_out.data_ptr()
+            assert torch.equal(zero_copy_x, combined_x)
             hash_value ^= hash_tensor(combined_x)
 
             print(f"rank {rank} PASSED")
@@ -276,6 +310,70 @@ def test(
     return hash_value
 
 
+def test_eplb(
+    num_tokens: int,
+    hidden: int,
+    num_experts: int,
+    num_topk: int,
+    rank: int,
+    num_ranks: int,
+    group: dist.ProcessGroup,
+    buffer: Buffer,
+):
+    torch.manual_seed(rank)
+
+    # Every logical expert is served by two physical replicas
+    num_logical_experts = num_experts // 2
+    assert num_topk <= num_logical_experts
+    logical_ids = torch.arange(num_logical_experts, dtype=torch.int64, device="npu")
+    physical_map = torch.stack([logical_ids, logical_ids + num_logical_experts], dim=1)
+    replica_count = torch.full_like(logical_ids, 2)
+    buffer.set_expert_location_map(physical_map, replica_count)
+    buffer.get_expert_load_stats(reset=True)
+
+    x = torch.randn((num_tokens, hidden), dtype=torch.bfloat16, device="npu")
+    scores = (
+        torch.randn(
+            (num_tokens, num_logical_experts), dtype=torch.float32, device="npu"
+        ).abs()
+        + 1
+    )
+    topk_idx = torch.topk(scores, num_topk, dim=-1, largest=True, sorted=True)[1]
+    topk_weights = torch.randn(
+        (num_tokens, num_topk), dtype=torch.float32, device="npu"
+    ).abs()
+
+    packed_recv_x, packed_recv_count, handle, event, hook = buffer.low_latency_dispatch(
+        x, topk_idx, num_tokens, num_experts, use_fp8=False
+    )
+    combined_x, event, hook = buffer.low_latency_combine(
+        packed_recv_x, topk_idx, topk_weights, handle
+    )
+    diff = calc_diff(x * topk_weights.sum(dim=1).view(-1, 1), combined_x)
+    assert diff < 1e-5, f"Error: {diff=}"
+
+    # Every selection lands on exactly one replica
+    total_recv = packed_recv_count.sum().view(1)
+    dist.all_reduce(total_recv, group=group)
+    assert total_recv.item() == num_tokens * num_topk * num_ranks
+
+    expected_load = torch.bincount(
+        topk_idx.flatten().cpu(), minlength=num_logical_experts
+    )
+    assert torch.equal(buffer.get_expert_load_stats().cpu(), expected_load)
+
+    # Without the map, topk_idx holds physical ids again, including those past the logical range
+    buffer.clear_expert_location_map()
+    physical_topk_idx = topk_idx + num_logical_experts
+    _, packed_recv_count, _, _, _ = buffer.low_latency_dispatch(
+        x, physical_topk_idx, num_tokens, num_experts, use_fp8=False
+    )
+    total_recv = packed_recv_count.sum().view(1)
+    dist.all_reduce(total_recv, group=group)
+    assert total_recv.item() == num_tokens * num_topk * num_ranks
+    print(f"rank {rank} EPLB PASSED")
+
+
 def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
     rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
     shared_expert_rank_num = int(os.getenv("MOE_SHARED_EXPERT_RANK_NUM", 0))
@@ -371,6 +469,18 @@ def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
                 )
                 == ref_hash
             ), f"Error: seed={seed}"
+
+    if shared_expert_rank_num == 0:
+        test_eplb(
+            aligned_num_tokens,
+            hidden,
+            use_experts,
+            num_topk,
+            rank,
+            use_ranks,
+            group,
+            buffer,
+        )
     dist.barrier()
     dist.destroy_process_group()
 
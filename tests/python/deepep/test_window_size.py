@@ -0,0 +1,284 @@
+import argparse
+import os
+from contextlib import contextmanager
+
+import torch
+import torch.distributed as dist
+import torch_npu
+from deep_ep import Buffer, Config
+from utils import init_dist
+
+MB_SIZE = 1024 * 1024
+WIN_ADDR_ALIGN = 512
+UB_ALIGN = 32
+MAX_OUT_DTYPE_SIZE = 2
+DOUBLE_DATA_BUFFER = 2
+SCALE_EXPAND_IDX_BUFFER = 44
+TRIPLE_BYTES = 3 * 4
+QUANT_BLOCK_SIZE = 128
+MAX_BATCH_SIZE = 4096
+MIN_TOKENS_PER_ROUND = 32
+MAX_TOKENS_PER_ROUND = 8192
+MAX_ROUNDS = 256
+
+
+def align_up(value: int, align: int) -> int:
+    return (value + align - 1) // align * align
+
+
+# The reference sizes below are transcribed from the `NEEDED_HCCL_BUFFSIZE` checks of the operator tilings, so that a
+# change on either side shows up here instead of as a tiling failure on the first launch.
+def normal_reserved_bytes(is_a2: bool) -> int:
+    # COMBINE_STATE_WIN_OFFSET + NOTIFY_DISPATCH_WIN_OFFSET of ops{,2}/op_host/tiling_args.h
+    return (8 + 404) * MB_SIZE if is_a2 else (4 + 102) * MB_SIZE
+
+
+def tiling_dispatch_normal(max_bs: int, h: int, k: int, round: int, is_a2: bool) -> int:
+    # cam_moe_dispatch_normal_tiling.cc
+    token_actual_len = (
+        align_up(h * MAX_OUT_DTYPE_SIZE, UB_ALIGN) + SCALE_EXPAND_IDX_BUFFER
+    )
+    token_need_size_dispatch = align_up(token_actual_len, WIN_ADDR_ALIGN)
+    token_need_size_combine = align_up(h * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN)
+    if round > 1:
+        token_need_size_combine *= 2
+    actual_size = (
+        max_bs * k * (token_need_size_combine + token_need_size_dispatch)
+        + normal_reserved_bytes(is_a2)
+    ) * DOUBLE_DATA_BUFFER
+    if is_a2:
+        actual_size += 2 * MB_SIZE * 4
+    return actual_size
+
+
+def tiling_combine_normal(
+    real_bs: int, h: int, k: int, max_round: int, is_a2: bool
+) -> int:
+    # cam_moe_combine_normal_tiling.cc
+    token_need_size_combine = align_up(h * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN)
+    if max_round > 1:
+        token_need_size_combine *= 2
+    return (
+        real_bs * k * token_need_size_combine + normal_reserved_bytes(is_a2)
+    ) * DOUBLE_DATA_BUFFER
+
+
+def tiling_dispatch_normal_a2(
+    max_bs: int, h: int, ep_world_size: int, local_moe_expert_num: int
+) -> int:
+    # dispatch_normal_a2_tiling.cpp
+    return (
+        ep_world_size
+        * max_bs
+        * h
+        * MAX_OUT_DTYPE_SIZE
+        * DOUBLE_DATA_BUFFER
+        * local_moe_expert_num
+    )
+
+
+def tiling_dispatch_low_latency_a3(
+    max_bs: int, h: int, ep_world_size: int, local_moe_expert_num: int, k: int
+) -> int:
+    # moe_distribute_dispatch_v2_tiling.cpp, with per-128-channel scales
+    scale_num = h // QUANT_BLOCK_SIZE
+    token_need_size_combine = align_up(h * MAX_OUT_DTYPE_SIZE, WIN_ADDR_ALIGN)
+    token_actual_len = (
+        align_up(h * MAX_OUT_DTYPE_SIZE, UB_ALIGN)
+        + align_up(scale_num * 4, UB_ALIGN)
+        + TRIPLE_BYTES
+    )
+    token_need_size_dispatch = align_up(token_actual_len, WIN_ADDR_ALIGN)
+    return (
+        max_bs * token_need_size_dispatch * ep_world_size * local_moe_expert_num
+        + max_bs * token_need_size_combine * k
+    ) * DOUBLE_DATA_BUFFER
+
+
+@contextmanager
+def env(**values):
+    saved = {name: os.environ.get(name) for name in values}
+    for name, value in values.items():
+        if value is None:
+            os.environ.pop(name, None)
+        else:
+            os.environ[name] = str(value)
+    try:
+        yield
+    finally:
+        for name, value in saved.items():
+            if value is None:
+                os.environ.pop(name, None)
+            else:
+                os.environ[name] = value
+
+
+def test_hccl_window_bytes():
+    with env(HCCL_BUFFSIZE=None, DEEPEP_HCCL_BUFFSIZE=None):
+        assert Buffer.get_hccl_window_size() == 200 * MB_SIZE
+    with env(HCCL_BUFFSIZE=1024, DEEPEP_HCCL_BUFFSIZE=None):
+        assert Buffer.get_hccl_window_size() == 1024 * MB_SIZE
+    with env(HCCL_BUFFSIZE=1024, DEEPEP_HCCL_BUFFSIZE=2048):
+        assert Buffer.get_hccl_window_size() == 2048 * MB_SIZE
+
+
+def test_size_hints(hiddens, topks, num_ranks: int, is_a2: bool):
+    config = Config()
+    for hidden in hiddens:
+        for num_topk in topks:
+            for round, per_round_tokens in ((1, 8192), (1, 512), (2, 4096), (4, 256)):
+                with env(
+                    DEEPEP_NORMAL_LONG_SEQ_ROUND=round,
+                    DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS=per_round_tokens,
+                ):
+                    hint = config.get_nvl_buffer_size_hint(
+                        hidden * 2, num_ranks, num_topk
+                    )
+                expected = max(
+                    tiling_dispatch_normal(
+                        per_round_tokens, hidden, num_topk, round, is_a2
+                    ),
+                    tiling_combine_normal(
+                        per_round_tokens, hidden, num_topk, round, is_a2
+                    ),
+                )
+                assert (
+                    hint == expected
+                ), f"nvl hint {hint} != {expected} for {hidden=}, {num_topk=}, {round=}, {per_round_tokens=}"
+
+            num_experts = num_ranks * 16
+            hint = config.get_rdma_buffer_size_hint(hidden * 2, num_ranks, num_experts)
+            expected = tiling_dispatch_normal_a2(
+                MAX_BATCH_SIZE, hidden, num_ranks, num_experts // num_ranks
+            )
+            assert hint == expected, f"rdma hint {hint} != {expected} for {hidden=}"
+
+            # The A2 low-latency windows follow other layouts, only the A3 one is checked here
+            if not is_a2:
+                for num_max_dispatch_tokens_per_rank in (1, 128, 512):
+                    hint = Buffer.get_low_latency_rdma_size_hint(
+                        num_max_dispatch_tokens_per_rank,
+                        hidden,
+                        num_ranks,
+                        num_experts,
+                        num_topk,
+                    )
+                    expected = tiling_dispatch_low_latency_a3(
+                        num_max_dispatch_tokens_per_rank,
+                        hidden,
+                        num_ranks,
+                        num_experts // num_ranks,
+                        num_topk,
+                    )
+                    assert hint == expected, (
+                        f"low-latency hint {hint} != {expected} for {hidden=}, {num_topk=}, "
+                        f"{num_max_dispatch_tokens_per_rank=}"
+                    )
+
+
+def test_fit_normal_rounds(buffer: Buffer, hiddens, topks, is_a2: bool):
+    # The buffer was created without rounds in the environment, so it splits the default 8192 tokens
+    total_tokens = MAX_TOKENS_PER_ROUND
+    for hidden in hiddens:
+        for num_topk in topks:
+            base = tiling_dispatch_normal(0, hidden, num_topk, 1, is_a2)
+            for extra_mb in (64, 256, 1024, 4096):
+                window_mb = (base + MB_SIZE - 1) // MB_SIZE + extra_mb
+                with env(DEEPEP_HCCL_BUFFSIZE=window_mb):
+                    round, per_round_tokens = buffer.fit_normal_rounds(hidden, num_topk)
+                window_bytes = window_mb * MB_SIZE
+                case = f"{hidden=}, {num_topk=}, {window_mb=}"
+                assert round * per_round_tokens >= total_tokens, case
+                assert (round - 1) * per_round_tokens < total_tokens, case
+                assert (
+                    per_round_tokens % MIN_TOKENS_PER_ROUND == 0 and round <= MAX_ROUNDS
+                ), case
+                assert (
+                    tiling_dispatch_normal(
+                        per_round_tokens, hidden, num_topk, round, is_a2
+                    )
+                    <= window_bytes
+                ), case
+                # The combine of the same split runs with the same window
+                assert (
+                    tiling_combine_normal(
+                        per_round_tokens, hidden, num_topk, round, is_a2
+                    )
+                    <= window_bytes
+                ), case
+                # No larger round would have fitted
+                for tokens in range(
+                    per_round_tokens + MIN_TOKENS_PER_ROUND,
+                    total_tokens + 1,
+                    MIN_TOKENS_PER_ROUND,
+                ):
+                    rounds = (total_tokens + tokens - 1) // tokens
+                    assert (
+                        tiling_dispatch_normal(tokens, hidden, num_topk, rounds, is_a2)
+                        > window_bytes
+                    ), f"{case}: {tokens} tokens per round also fit"
+
+            # Not even the smallest round fits next to the reserved areas
+            with env(DEEPEP_HCCL_BUFFSIZE=base // MB_SIZE):
+                try:
+                    buffer.fit_normal_rounds(hidden, num_topk)
+                except RuntimeError:
+                    pass
+                else:
+                    assert (
+                        False
+                    ), f"fit_normal_rounds accepted a too small window for {hidden=}, {num_topk=}"
+
+
+def test_loop(local_rank: int, num_local_ranks: int, args: argparse.Namespace):
+    rank, num_ranks, group = init_dist(local_rank, num_local_ranks)
+    is_a2 = "910B" in torch.npu.get_device_name()
+    hiddens = [int(h) for h in args.hiddens.split(",")]
+    topks = [int(k) for k in args.topks.split(",")]
+
+    test_hccl_window_bytes()
+    test_size_hints(hiddens, topks, num_ranks, is_a2)
+
+    buffer = Buffer(group, int(2e9), 0, low_latency_mode=False, num_qps_per_rank=1)
+    test_fit_normal_rounds(buffer, hiddens, topks, is_a2)
+    if local_rank == 0:
+        print(
+            f"[window size] {'A2' if is_a2 else 'A3'} windows match the tiling formulas",
+            flush=True,
+        )
+
+    dist.barrier()
+    dist.destroy_process_group()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Test the window sizes against the operator tilings"
+    )
+    parser.add_argument(
+        "--num-processes",
+        type=int,
+        default=2,
+        help="Number of processes to spawn (default: 2)",
+    )
+    parser.add_argument(
+        "--hiddens",
+        type=str,
+        default="2048,4096,7168",
+        help="Comma-separated hidden sizes (default: 2048,4096,7168)",
+    )
+    parser.add_argument(
+        "--topks",
+        type=str,
+        default="1,8,16",
+        help="Comma-separated top-k values (default: 1,8,16)",
+    )
+    args = parser.parse_args()
+
+    # Rounds in the environment would turn `fit_normal_rounds` into a validation only
+    os.environ.pop("DEEPEP_NORMAL_LONG_SEQ_ROUND", None)
+    os.environ.pop("DEEPEP_NORMAL_LONG_SEQ_PER_ROUND_TOKENS", None)
+    num_processes = args.num_processes
+    torch.multiprocessing.spawn(
+        test_loop, args=(num_processes, args), nprocs=num_processes
+    )
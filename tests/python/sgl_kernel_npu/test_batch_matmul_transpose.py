@@ -67,6 +67,7 @@ class TestMatrixMultiplication(unittest.TestCase):
             (10, 20, 30, 40),  # Medium size
             (36, 128, 512, 128),  # target case
             (8, 160, 512, 128),
+            (2048, 4, 128, 64),  # beyond the former 1024-row tiling table
         ]
 
         dtypes = [torch.float16, torch.bfloat16]
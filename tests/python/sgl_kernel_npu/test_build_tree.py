@@ -5,6 +5,7 @@ import math
 from enum import IntEnum
 from typing import List, Optional
 
+import pytest
 import torch
 from sgl_kernel_npu.speculative import build_tree_efficient_native
 
@@ -45,6 +46,15 @@ class TreeMaskMode(IntEnum):
     QLEN_ONLY_BITPACKING = 2
 
 
+def mask_row_bytes(num_verify_tokens: int):
+    # one uint8/uint16/uint32 per row, or ceil(n / 32) uint32 words for wider trees
+    if num_verify_tokens <= 8:
+        return 1
+    if num_verify_tokens <= 16:
+        return 2
+    return (num_verify_tokens + 31) // 32 * 4
+
+
 def build_tree_kernel_efficient(
     verified_id: torch.Tensor,
     score_list: List[torch.Tensor],
@@ -84,6 +94,12 @@ def build_tree_kernel_efficient(
             dtype=torch.bool,
             device=device,
         )
+    elif tree_mask_mode == TreeMaskMode.QLEN_ONLY_BITPACKING and num_verify_tokens > 32:
+        tree_mask = torch.zeros(
+            (num_verify_tokens * bs, mask_row_bytes(num_verify_tokens) // 4),
+            dtype=torch.int32,
+            device=device,
+        )
     elif tree_mask_mode == TreeMaskMode.QLEN_ONLY_BITPACKING:
         packed_dtypes = [torch.uint8, torch.uint16, torch.uint32]
         packed_dtype_idx = int(math.ceil(math.log2((num_verify_tokens + 7) // 8)))
@@ -172,7 +188,7 @@ def build_tree_kernel_efficient(
     )
 
 
-def test_build_tree_kernel_efficient():
+def make_test_inputs(num_draft_token=8):
     verified_id = torch.tensor([29974, 13], device="npu", dtype=torch.int32)
     score_list = [
         torch.tensor(
@@ -383,16 +399,7 @@ def test_build_tree_kernel_efficient():
     seq_lens = torch.tensor([5, 10], dtype=torch.int64, device="npu")
     topk = 4
     depth = 4
-    num_draft_token = 8
-
-    (
-        tree_mask,
-        position,
-        retrive_index,
-        retrive_next_token,
-        retrive_next_sibling,
-        draft_tokens,
-    ) = build_tree_kernel_efficient(
+    return dict(
         verified_id=verified_id,
         score_list=score_list,
         token_list=token_list,
@@ -404,6 +411,18 @@ def test_build_tree_kernel_efficient():
         num_verify_tokens=num_draft_token,
     )
 
+
+def test_build_tree_kernel_efficient():
+
+    (
+        tree_mask,
+        position,
+        retrive_index,
+        retrive_next_token,
+        retrive_next_sibling,
+        draft_tokens,
+    ) = build_tree_kernel_efficient(**make_test_inputs())
+
     print("=========== build tree kernel efficient ==========")
     print(f"{tree_mask=}")
     print(f"{position=}")
@@ -444,5 +463,35 @@ def test_build_tree_kernel_efficient():
     ]
 
 
+def pack_tree_mask(tree_mask: torch.Tensor, num_verify_tokens: int, row_bytes: int):
+    rows = tree_mask.view(-1, num_verify_tokens).to(torch.int32)
+    rows = torch.nn.functional.pad(rows, (0, row_bytes * 8 - num_verify_tokens))
+    weights = 1 << torch.arange(8, dtype=torch.int32, device=rows.device)
+    return (rows.view(rows.shape[0], row_bytes, 8) * weights).sum(-1).to(torch.uint8)
+
+
+# 8 fits one uint8 per row, 12 a uint16, 24 a uint32 and 40 two uint32 words
+@pytest.mark.parametrize("num_draft_token", [8, 12, 24, 40])
+def test_build_tree_kernel_efficient_bitpacking(num_draft_token):
+    inputs = make_test_inputs(num_draft_token)
+    num_verify_tokens = inputs["num_verify_tokens"]
+    qlen_only = build_tree_kernel_efficient(
+        **inputs, tree_mask_mode=TreeMaskMode.QLEN_ONLY
+    )
+    packed = build_tree_kernel_efficient(
+        **inputs, tree_mask_mode=TreeMaskMode.QLEN_ONLY_BITPACKING
+    )
+
+    # bit j of a draft token row is set when the token attends to draft token j
+    row_bytes = mask_row_bytes(num_verify_tokens)
+    expected = pack_tree_mask(qlen_only[0], num_verify_tokens, row_bytes)
+    actual = packed[0].view(torch.uint8).view(-1, row_bytes)
+    assert torch.equal(actual.cpu(), expected.cpu())
+    for lhs, rhs in zip(qlen_only[1:], packed[1:]):
+        assert torch.equal(lhs, rhs)
+
+
 if __name__ == "__main__":
     test_build_tree_kernel_efficient()
+    for num_draft_token in [8, 12, 24, 40]:
+        test_build_tree_kernel_efficient_bitpacking(num_draft_token)
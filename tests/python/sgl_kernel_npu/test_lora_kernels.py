@@ -1,3 +1,4 @@
+import itertools
 import random
 import unittest
 
@@ -143,6 +144,270 @@ class TestLoraKernels(unittest.TestCase):
             torch.allclose(actual_output_cpu, expect_output, atol=1e-3, rtol=1e-3)
         )
 
+    def test_sgmv_grouped_shrink(self):
+        # Segments longer than one token block and ending in a partial one
+        seq_lens = [5, 11, 16, 3]
+        batch_size = sum(seq_lens)
+        input_dim = 2560
+        num_loras = 3
+
+        # Random ranks, and rank 8 next to a larger max rank
+        rank_sets = [random.choices([8, 16, 32, 64], k=num_loras), [8, 32, 64]]
+        for dtype, lora_ranks in itertools.product(
+            [torch.float16, torch.bfloat16], rank_sets
+        ):
+            with self.subTest(dtype=dtype, lora_ranks=lora_ranks):
+                max_lora_rank = max(lora_ranks)
+                lora_scaling = random.choices([0.25, 0.5, 1.0, 2.0, 4.0], k=num_loras)
+
+                inputs = torch.randn(batch_size, input_dim, dtype=dtype)
+                lora_a_weights = torch.randn(
+                    num_loras, max_lora_rank, input_dim, dtype=dtype
+                )
+                # Every LoRA of the set serves at least one sequence
+                lora_indices_tensor = (torch.randperm(len(seq_lens)) % num_loras).to(
+                    torch.int32
+                )
+                seq_len_tensor = torch.tensor(seq_lens, dtype=torch.int32)
+                lora_ranks_tensor = torch.tensor(lora_ranks, dtype=torch.int32)
+                lora_scaling_tensor = torch.tensor(lora_scaling, dtype=torch.float16)
+
+                expect_output = reference_sgmv_shrink(
+                    inputs.float(),
+                    lora_a_weights.float(),
+                    lora_indices_tensor,
+                    seq_len_tensor,
+                    lora_ranks_tensor,
+                    lora_scaling_tensor.float(),
+                )
+
+                actual_output = torch.zeros(
+                    (batch_size, max_lora_rank), dtype=torch.float, device="npu"
+                )
+                torch.ops.npu.sgmv_grouped_shrink(
+                    inputs.npu(),
+                    lora_a_weights.npu(),
+                    lora_indices_tensor.npu(),
+                    seq_len_tensor.npu(),
+                    lora_ranks_tensor.npu(),
+                    lora_scaling_tensor.npu(),
+                    actual_output,
+                )
+
+                self.assertTrue(
+                    torch.allclose(
+                        actual_output.cpu(), expect_output, atol=1e-2, rtol=1e-2
+                    )
+                )
+
+    def test_sgmv_grouped_expand(self):
+        seq_lens = [5, 11, 16, 3]
+        batch_size = sum(seq_lens)
+        output_dim = 1280
+        num_loras = 4
+
+        # Random ranks, and rank 8 next to a larger max rank
+        rank_sets = [random.choices([8, 16, 32, 64], k=num_loras), [8, 16, 8, 64]]
+        for dtype, lora_ranks in itertools.product(
+            [torch.float16, torch.bfloat16], rank_sets
+        ):
+            with self.subTest(dtype=dtype, lora_ranks=lora_ranks):
+                max_lora_rank = max(lora_ranks)
+
+                inputs = torch.randn(batch_size, max_lora_rank, dtype=dtype)
+                lora_b_weights = torch.randn(
+                    num_loras, output_dim, max_lora_rank, dtype=dtype
+                )
+                lora_ranks_tensor = torch.tensor(lora_ranks, dtype=torch.int32)
+                seq_len_tensor = torch.tensor(seq_lens, dtype=torch.int32)
+                # One sequence per LoRA so that every rank of the set is exercised
+                lora_indices_tensor = torch.randperm(num_loras).to(torch.int32)
+                slice_offsets = torch.tensor([0, output_dim], dtype=torch.int32)
+
+                expect_output = reference_sgmv_expand(
+                    inputs.float(),
+                    lora_b_weights.float(),
+                    lora_indices_tensor,
+                    seq_len_tensor,
+                    lora_ranks_tensor,
+                    slice_offsets,
+                )
+
+                actual_output = torch.zeros(
+                    (batch_size, output_dim), dtype=dtype, device="npu"
+                )
+                torch.ops.npu.sgmv_grouped_expand(
+                    inputs.to(dtype=torch.float, device="npu"),
+                    lora_b_weights.npu(),
+                    lora_indices_tensor.npu(),
+                    seq_len_tensor.npu(),
+                    lora_ranks_tensor.npu(),
+                    slice_offsets.npu(),
+                    actual_output,
+                )
+
+                self.assertTrue(
+                    torch.allclose(
+                        actual_output.cpu().float(),
+                        expect_output,
+                        atol=5e-2,
+                        rtol=1e-2,
+                    )
+                )
+
+    def test_sgemmv_long_rank(self):
+        # Mixed ranks above 64 and ones that do not divide a repeat or a 32B block, no padding to the max rank
+        seq_lens = [3, 1, 4, 2, 2, 3]
+        batch_size = sum(seq_lens)
+        hidden_dim = 1024
+        dtype = torch.float16
+        lora_ranks = [8, 16, 24, 96, 200, 256]
+        num_loras = len(lora_ranks)
+        max_lora_rank = max(lora_ranks)
+
+        inputs = torch.randn(batch_size, hidden_dim, dtype=dtype)
+        lora_a_weights = torch.randn(num_loras, max_lora_rank, hidden_dim, dtype=dtype)
+        lora_b_weights = torch.randn(num_loras, hidden_dim, max_lora_rank, dtype=dtype)
+        lora_indices_tensor = torch.randperm(num_loras, dtype=torch.int32)
+        seq_len_tensor = torch.tensor(seq_lens, dtype=torch.int32)
+        lora_ranks_tensor = torch.tensor(lora_ranks, dtype=torch.int32)
+        lora_scaling_tensor = torch.full((num_loras,), 0.5, dtype=torch.float16)
+        slice_offsets = torch.tensor([0, hidden_dim], dtype=torch.int32)
+
+        expect_shrink = reference_sgmv_shrink(
+            inputs,
+            lora_a_weights,
+            lora_indices_tensor,
+            seq_len_tensor,
+            lora_ranks_tensor,
+            lora_scaling_tensor,
+        )
+        expand_inputs = torch.randn(batch_size, max_lora_rank, dtype=dtype)
+        expect_expand = reference_sgmv_expand(
+            expand_inputs,
+            lora_b_weights,
+            lora_indices_tensor,
+            seq_len_tensor,
+            lora_ranks_tensor,
+            slice_offsets,
+        )
+
+        for shrink_op, expand_op in (
+            (torch.ops.npu.sgemmv_shrink, torch.ops.npu.sgemmv_expand),
+            (torch.ops.npu.sgmv_grouped_shrink, torch.ops.npu.sgmv_grouped_expand),
+        ):
+            shrink_output = torch.zeros(
+                (batch_size, max_lora_rank), dtype=torch.float, device="npu"
+            )
+            shrink_op(
+                inputs.npu(),
+                lora_a_weights.npu(),
+                lora_indices_tensor.npu(),
+                seq_len_tensor.npu(),
+                lora_ranks_tensor.npu(),
+                lora_scaling_tensor.npu(),
+                shrink_output,
+            )
+            expand_output = torch.zeros(
+                (batch_size, hidden_dim), dtype=dtype, device="npu"
+            )
+            expand_op(
+                expand_inputs.to(dtype=torch.float, device="npu"),
+                lora_b_weights.npu(),
+                lora_indices_tensor.npu(),
+                seq_len_tensor.npu(),
+                lora_ranks_tensor.npu(),
+                slice_offsets.npu(),
+                expand_output,
+            )
+
+            self.assertTrue(
+                torch.allclose(
+                    shrink_output.to(dtype=dtype, device="cpu"),
+                    expect_shrink,
+                    atol=1e-2,
+                    rtol=1e-2,
+                )
+            )
+            self.assertTrue(
+                torch.allclose(expand_output.cpu(), expect_expand, atol=1e-2, rtol=1e-2)
+            )
+
+    def test_sgmv_shrink_expand(self):
+        # Fused QKV: three slices of different widths, the intermediate never leaves UB
+        seq_lens = [5, 11, 2]
+        batch_size = sum(seq_lens)
+        input_dim = 2048
+        slice_sizes = [1024, 256, 256]
+        num_slices = len(slice_sizes)
+        num_loras = 3
+        dtype = torch.float16
+
+        # Packed, padded power of two and odd long ranks, rank 8 strided by the larger max rank
+        rank_sets = [random.sample([16, 32, 64, 128], k=num_loras), [8, 24, 200]]
+        for lora_ranks in rank_sets:
+            with self.subTest(lora_ranks=lora_ranks):
+                max_lora_rank = max(lora_ranks)
+                lora_scaling = random.choices([0.25, 0.5, 1.0, 2.0], k=num_loras)
+
+                inputs = torch.randn(batch_size, input_dim, dtype=dtype) / 8
+                lora_a_weights = (
+                    torch.randn(
+                        num_loras, num_slices * max_lora_rank, input_dim, dtype=dtype
+                    )
+                    / 8
+                )
+                lora_b_weights = torch.randn(
+                    num_loras, sum(slice_sizes), max_lora_rank, dtype=dtype
+                )
+                base_output = torch.randn(batch_size, sum(slice_sizes), dtype=dtype)
+                # One sequence per LoRA so that every rank of the set is exercised
+                lora_indices_tensor = torch.randperm(num_loras).to(torch.int32)
+                seq_len_tensor = torch.tensor(seq_lens, dtype=torch.int32)
+                lora_ranks_tensor = torch.tensor(lora_ranks, dtype=torch.int32)
+                lora_scaling_tensor = torch.tensor(lora_scaling, dtype=torch.float16)
+                slice_offsets = torch.tensor(
+                    [0] + list(itertools.accumulate(slice_sizes)), dtype=torch.int32
+                )
+
+                intermediate = reference_sgmv_shrink(
+                    inputs.float(),
+                    lora_a_weights.float(),
+                    lora_indices_tensor,
+                    seq_len_tensor,
+                    lora_ranks_tensor,
+                    lora_scaling_tensor.float(),
+                    num_slices=num_slices,
+                )
+                expect_output = reference_sgmv_expand(
+                    intermediate,
+                    lora_b_weights.float(),
+                    lora_indices_tensor,
+                    seq_len_tensor,
+                    lora_ranks_tensor,
+                    slice_offsets,
+                    base_output=base_output.float(),
+                )
+
+                actual_output = base_output.npu()
+                torch.ops.npu.sgmv_shrink_expand(
+                    inputs.npu(),
+                    lora_a_weights.npu(),
+                    lora_b_weights.npu(),
+                    lora_indices_tensor.npu(),
+                    seq_len_tensor.npu(),
+                    lora_ranks_tensor.npu(),
+                    lora_scaling_tensor.npu(),
+                    slice_offsets.npu(),
+                    actual_output,
+                )
+
+                self.assertTrue(
+                    torch.allclose(
+                        actual_output.cpu().float(), expect_output, atol=5e-2, rtol=1e-2
+                    )
+                )
+
 
 if __name__ == "__main__":
     unittest.main(verbosity=2)
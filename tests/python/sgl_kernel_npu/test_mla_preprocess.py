@@ -133,6 +133,11 @@ def extract_from_nzcache(x, outer_idx, inner_idx, C0_SIZE=16):
 
 
 class TestMLAPO(TestCase):
+    # MLA dims, DeepSeek-V3 by default
+    q_lora_rank = Q_RMS
+    kv_lora_rank = K_NOPE
+    qk_nope_head_dim = Q_NOPE_DIM
+    qk_rope_head_dim = K_PE
 
     def gen_random_tensors(
         self,
@@ -146,6 +151,8 @@ class TestMLAPO(TestCase):
     ):
         torch.manual_seed(seed)
         np.random.seed(seed)
+        mm1_out = self.q_lora_rank + self.kv_lora_rank + self.qk_rope_head_dim
+        q_dim = self.qk_nope_head_dim + self.qk_rope_head_dim
         # hidden
         hidden = (
             torch.from_numpy(np.random.uniform(-2.0, 2.0, size=(N, hiddenDim)))
@@ -170,34 +177,36 @@ class TestMLAPO(TestCase):
 
         # MM1
         wdqkv = (
-            torch.from_numpy(np.random.uniform(-2.0, 2.0, size=(MM1_OUT, hiddenDim)))
+            torch.from_numpy(np.random.uniform(-2.0, 2.0, size=(mm1_out, hiddenDim)))
             .to(torch.int8)
             .to(device)
         )
         bias1 = (
-            torch.from_numpy(np.random.randint(-10, 10, (MM1_OUT)).astype(np.int32))
+            torch.from_numpy(np.random.randint(-10, 10, (mm1_out)).astype(np.int32))
             .to(torch.int32)
             .to(device)
         )
         descale1 = torch.from_numpy(
-            (np.random.rand(MM1_OUT) / 1000).astype(np.float32)
+            (np.random.rand(mm1_out) / 1000).astype(np.float32)
         ).to(device)
         if dtype == torch.float16:
             descale1 = trans_descale_param(np.array(descale1.cpu())).to(device)
 
         # RMS2 & RMS3
         gamma2 = (
-            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(Q_RMS)))
+            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(self.q_lora_rank)))
             .to(dtype)
             .to(device)
         )
         beta2 = (
-            torch.from_numpy(np.random.randint(-2, 2, (Q_RMS)).astype(np.float16))
+            torch.from_numpy(
+                np.random.randint(-2, 2, (self.q_lora_rank)).astype(np.float16)
+            )
             .to(dtype)
             .to(device)
         )
         gamma3 = (
-            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(K_NOPE)))
+            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(self.kv_lora_rank)))
             .to(dtype)
             .to(device)
         )
@@ -217,21 +226,21 @@ class TestMLAPO(TestCase):
         # MM2
         wuq = (
             torch.from_numpy(
-                np.random.uniform(-2.0, 2.0, size=(headNum * Q_DIM, Q_RMS))
+                np.random.uniform(-2.0, 2.0, size=(headNum * q_dim, self.q_lora_rank))
             )
             .to(torch.int8)
             .to(device)
         )
         bias2 = (
             torch.from_numpy(
-                np.random.randint(-10, 10, (headNum * Q_DIM)).astype(np.int32)
+                np.random.randint(-10, 10, (headNum * q_dim)).astype(np.int32)
             )
             .to(torch.int32)
             .to(device)
         )
 
         descale2 = torch.from_numpy(
-            (np.random.rand(headNum * Q_DIM) / 1000).astype(np.float32)
+            (np.random.rand(headNum * q_dim) / 1000).astype(np.float32)
         ).to(device)
         if dtype == torch.float16:
             descale2 = trans_descale_param(np.array(descale2.cpu())).to(device)
@@ -239,7 +248,9 @@ class TestMLAPO(TestCase):
         # BMM3
         wuk = (
             torch.from_numpy(
-                np.random.uniform(-2.0, 2.0, size=(headNum, Q_NOPE_DIM, Q_NOPE))
+                np.random.uniform(
+                    -2.0, 2.0, size=(headNum, self.qk_nope_head_dim, self.kv_lora_rank)
+                )
             )
             .to(dtype)
             .to(device)
@@ -247,12 +258,16 @@ class TestMLAPO(TestCase):
 
         # Rope sin/cos
         sin = (
-            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(N, K_PE)))
+            torch.from_numpy(
+                np.random.uniform(-1.0, 1.0, size=(N, self.qk_rope_head_dim))
+            )
             .to(dtype)
             .to(device)
         )
         cos = (
-            torch.from_numpy(np.random.uniform(-1.0, 1.0, size=(N, K_PE)))
+            torch.from_numpy(
+                np.random.uniform(-1.0, 1.0, size=(N, self.qk_rope_head_dim))
+            )
             .to(dtype)
             .to(device)
         )
@@ -268,10 +283,20 @@ class TestMLAPO(TestCase):
             .to(torch.int32)
             .to(device)
         )
-        keyCache_nope = torch.zeros(blockNum, blockSize, 1, K_NOPE).to(dtype).to(device)
-        keyCache_rope = torch.zeros(blockNum, blockSize, 1, K_PE).to(dtype).to(device)
-        q_nope_out = torch.zeros((N, headNum, 512), dtype=dtype).to(device)
-        q_rope_out = torch.zeros((N, headNum, 64), dtype=dtype).to(device)
+        keyCache_nope = (
+            torch.zeros(blockNum, blockSize, 1, self.kv_lora_rank).to(dtype).to(device)
+        )
+        keyCache_rope = (
+            torch.zeros(blockNum, blockSize, 1, self.qk_rope_head_dim)
+            .to(dtype)
+            .to(device)
+        )
+        q_nope_out = torch.zeros((N, headNum, self.kv_lora_rank), dtype=dtype).to(
+            device
+        )
+        q_rope_out = torch.zeros((N, headNum, self.qk_rope_head_dim), dtype=dtype).to(
+            device
+        )
 
         if cache_mode == "int8_nzcache":
             keyCache_nope = keyCache_nope.to(torch.int8)
@@ -337,9 +362,11 @@ class TestMLAPO(TestCase):
             output_dtype=dtype,
         )
 
-        latent, q = fused.split([K_NOPE + K_PE, Q_RMS], dim=-1)
-        k_nope = latent[..., :K_NOPE]
-        k_pe = latent[..., K_NOPE:].unsqueeze(1)  # [N,1,64]
+        latent, q = fused.split(
+            [self.kv_lora_rank + self.qk_rope_head_dim, self.q_lora_rank], dim=-1
+        )
+        k_nope = latent[..., : self.kv_lora_rank]
+        k_pe = latent[..., self.kv_lora_rank :].unsqueeze(1)  # [N,1,64]
 
         # RMSNorm2+3
         q = (
@@ -362,10 +389,10 @@ class TestMLAPO(TestCase):
             bias=self.dataDict["bias2"],
             output_dtype=dtype,
         )
-        q_out = q_out.view(-1, headNum, Q_DIM)
+        q_out = q_out.view(-1, headNum, self.qk_nope_head_dim + self.qk_rope_head_dim)
 
         q_nope, q_pe = q_out.split(
-            [Q_NOPE_DIM, Q_PE_DIM], dim=-1
+            [self.qk_nope_head_dim, self.qk_rope_head_dim], dim=-1
         )  # [N,16,128], [N,16,64]
 
         # === BMM3 ===
@@ -421,9 +448,11 @@ class TestMLAPO(TestCase):
             output_dtype=dtype,
         ).to(dev)
 
-        latent, q = fused.split([K_NOPE + K_PE, Q_RMS], dim=-1)
-        k_nope = latent[..., :K_NOPE]
-        k_pe = latent[..., K_NOPE:].unsqueeze(1)  # [N,1,64]
+        latent, q = fused.split(
+            [self.kv_lora_rank + self.qk_rope_head_dim, self.q_lora_rank], dim=-1
+        )
+        k_nope = latent[..., : self.kv_lora_rank]
+        k_pe = latent[..., self.kv_lora_rank :].unsqueeze(1)  # [N,1,64]
 
         # RMSNorm2+3
         q = rms_norm(q, self.dataDict["gamma2"]) + self.dataDict["beta2"]
@@ -440,10 +469,10 @@ class TestMLAPO(TestCase):
             self.dataDict["bias2"].cpu(),
             output_dtype=dtype,
         ).to(dev)
-        q_out = q_out.view(-1, headNum, Q_DIM)
+        q_out = q_out.view(-1, headNum, self.qk_nope_head_dim + self.qk_rope_head_dim)
 
         q_nope, q_pe = q_out.split(
-            [Q_NOPE_DIM, Q_PE_DIM], dim=-1
+            [self.qk_nope_head_dim, self.qk_rope_head_dim], dim=-1
         )  # [N,16,128], [N,16,64]
 
         # === BMM3 ===
@@ -492,6 +521,7 @@ class TestMLAPO(TestCase):
         (31, 64, 7168),
         (31, 128, 7168),
         (31, 128, 6144),
+        (1536, 32, 7168),  # beyond the former 1024-token tiling table
     ]
 
     class GoldenType(IntEnum):
@@ -574,8 +604,8 @@ class TestMLAPO(TestCase):
                 kv_cache_out1=self.dataDict["keyCache_rope"].npu(),
             )
 
-            extracted_k_nope = torch.zeros(N, 1, K_NOPE, dtype=dtype)
-            extracted_k_rope = torch.zeros(N, 1, K_PE, dtype=dtype)
+            extracted_k_nope = torch.zeros(N, 1, self.kv_lora_rank, dtype=dtype)
+            extracted_k_rope = torch.zeros(N, 1, self.qk_rope_head_dim, dtype=dtype)
             if cache_mode == "int8_nzcache":
                 extracted_k_nope = extracted_k_nope.to(torch.int8)
             slotMapping = self.dataDict["slotMapping"].cpu().numpy()
@@ -804,6 +834,45 @@ class TestMLAPO(TestCase):
             seed=SEED,
         )
 
+    def test_mla_preprocess_ops_non_deepseek_dims(self):
+        # A smaller MLA config than DeepSeek-V3 goes through the same fused path
+        self.q_lora_rank = 768
+        self.kv_lora_rank = 256
+        self.qk_nope_head_dim = 64
+        self.qk_rope_head_dim = 32
+        self.param_combinations = [(1, 16, 4096), (31, 32, 4096)]
+        for cacheMode in self.cache_mode_names:
+            self.run_tests_and_compare(
+                cacheMode=cacheMode,
+                golden=self.GoldenType.PYTORCH_NATIVE,
+                dtype=torch.bfloat16,
+                seed=SEED,
+            )
+        self.run_tests_and_compare(
+            cacheMode=1,
+            golden=self.GoldenType.PYTORCH_NATIVE,
+            dtype=torch.float16,
+            seed=SEED,
+        )
+
+    def test_mla_preprocess_ops_kv_lora_rank_col_tail(self):
+        # kv_lora_rank = 160 leaves a 32-column tail after the 128/64-wide q_nope quant repeats
+        self.kv_lora_rank = 160
+        self.param_combinations = [(1, 16, 7168), (31, 32, 7168)]
+        for cacheMode in self.cache_mode_names:
+            self.run_tests_and_compare(
+                cacheMode=cacheMode,
+                golden=self.GoldenType.PYTORCH_NATIVE,
+                dtype=torch.bfloat16,
+                seed=SEED,
+            )
+        self.run_tests_and_compare(
+            cacheMode=1,
+            golden=self.GoldenType.PYTORCH_NATIVE,
+            dtype=torch.float16,
+            seed=SEED,
+        )
+
 
 if __name__ == "__main__":
     run_tests()
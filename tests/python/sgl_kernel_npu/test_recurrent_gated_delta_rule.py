@@ -156,6 +156,7 @@ class TestCase:
         has_g=True,
         has_gk=False,
         has_num_accepted_tokens=True,
+        num_padded_slots=0,
     ):
         self.b = b
         self.mtp = mtp
@@ -169,6 +170,8 @@ class TestCase:
         self.has_g = has_g
         self.has_gk = has_gk
         self.has_num_accepted_tokens = has_num_accepted_tokens
+        # Trailing draft slots of every sequence marked -1 in ssm_state_indices
+        self.num_padded_slots = num_padded_slots
 
         self.max_slots = 65
         self.mix_qkv = None
@@ -186,12 +189,14 @@ class TestCase:
         self.state_npu = None
         self.out_golden = None
         self.state_golden = None
+        self.padded_state_rows = None
 
     def __repr__(self):
         return (
             f"B={self.b}, MTP={self.mtp}, Nk={self.nk}, Nv={self.nv}, Dk={self.dk}, Dv={self.dv}, "
             f"is_continue={self.is_continue}, has_beta={self.has_beta}, has_scale={self.has_scale}, "
-            f"has_g={self.has_g}, has_gk={self.has_gk}, has_num_accepted_tokens={self.has_num_accepted_tokens}"
+            f"has_g={self.has_g}, has_gk={self.has_gk}, has_num_accepted_tokens={self.has_num_accepted_tokens}, "
+            f"num_padded_slots={self.num_padded_slots}"
         )
 
     def generate_input(self):
@@ -239,13 +244,20 @@ class TestCase:
             offsets = torch.arange(S, device="npu", dtype=torch.int32)  # shape: (S,)
 
             self.ssm_state_indices = (base_indices + offsets).contiguous()
+            num_real_slots = mtp - self.num_padded_slots
+            if self.num_padded_slots > 0:
+                self.padded_state_rows = (
+                    self.ssm_state_indices[:, num_real_slots:].flatten().clone()
+                )
+                self.ssm_state_indices[:, num_real_slots:] = -1
             if mtp > 1:
                 self.cache_indices = cache_indices
 
             self.scale = dk**-0.5
-            self.num_accepted_tokens = (torch.randint(1, mtp + 1, (bs,)).npu()).to(
-                torch.int32
-            )
+            # Padded slots can never be accepted
+            self.num_accepted_tokens = (
+                torch.randint(1, num_real_slots + 1, (bs,)).npu()
+            ).to(torch.int32)
         else:
             raise NotImplementedError(
                 "Initialization for is_continue=False is not defined. "
@@ -343,7 +355,8 @@ class TestCase:
                     S_ = y[:, None] * k_i[None, :]  # [Dv, Dk]
                     S = S + S_  # [Dv, Dk]
 
-                    initial_state[ssm_state_indices[slot_id]][head_id] = S
+                    if ssm_state_indices[slot_id] >= 0:
+                        initial_state[ssm_state_indices[slot_id]][head_id] = S
                     o[slot_id][head_id] = (S * q_i.unsqueeze(-2)).sum(dim=-1)  # [Dv]
 
             seq_start += actual_seq_lengths[i]
@@ -396,6 +409,20 @@ class TestCase:
             self.state_golden, self.state_npu, rtol=eps, atol=eps, equal_nan=False
         )
 
+        if self.padded_state_rows is not None:
+            # The kernel must not write the state of padded slots at all
+            untouched = torch.equal(
+                self.state_npu.view(-1, self.nv, self.dv, self.dk)[
+                    self.padded_state_rows
+                ],
+                self.intermediate_state.view(-1, self.nv, self.dv, self.dk)[
+                    self.padded_state_rows
+                ].to(torch.float32),
+            )
+            if not untouched:
+                print(f"\t{eps=}: padded state rows were written")
+                return False
+
         if is_close_o and is_close_state:
             print(f"\t{eps=}: passed.")
             return True
@@ -438,6 +465,38 @@ def compatible_cases():
             "option": (True, True, True, True, False),
         }
     )
+    # Padded draft slots (-1 in ssm_state_indices), inside one chunk and across chunks
+    res.append(
+        {
+            "shape": (16, 8, 128, 128, 4, 8),
+            "is_cont": True,
+            "option": (True, True, True, True, False),
+            "num_padded_slots": 3,
+        }
+    )
+    res.append(
+        {
+            "shape": (8, 16, 128, 128, 4, 8),
+            "is_cont": True,
+            "option": (True, True, True, True, False),
+            "num_padded_slots": 10,
+        }
+    )
+    # Draft windows longer than one in-kernel chunk of 8 tokens
+    res.append(
+        {
+            "shape": (8, 16, 128, 128, 4, 8),
+            "is_cont": True,
+            "option": (True, True, True, True, False),
+        }
+    )
+    res.append(
+        {
+            "shape": (8, 32, 128, 128, 4, 8),
+            "is_cont": True,
+            "option": (True, True, True, True, False),
+        }
+    )
 
     return res, "compatible"
 
@@ -467,6 +526,7 @@ def run_cases(cases):
             has_beta=beta,
             has_gk=gk,
             has_num_accepted_tokens=n_acc_tokens,
+            num_padded_slots=case.get("num_padded_slots", 0),
         )
 
         print(f"{tc}")
@@ -0,0 +1,61 @@
+import sgl_kernel_npu
+import torch
+import torch_npu
+
+
+def tiling_cache_stats():
+    hits, misses, entries = torch.ops.npu.tiling_cache_stats()
+    return hits, misses, entries
+
+
+def test_tiling_cache_reuses_tiling_for_same_shape():
+    torch.ops.npu.tiling_cache_clear()
+    input_x = torch.eye(32, dtype=torch.float32).repeat(4, 1, 1).npu()
+
+    first = torch.ops.npu.triangular_inverse(input_x)
+    hits, misses, entries = tiling_cache_stats()
+    assert (hits, misses, entries) == (0, 1, 1)
+
+    second = torch.ops.npu.triangular_inverse(input_x)
+    hits, misses, entries = tiling_cache_stats()
+    assert (hits, misses, entries) == (1, 1, 1)
+    assert torch.equal(first, second)
+
+    # A new shape is a new key
+    torch.ops.npu.triangular_inverse(input_x[:2])
+    hits, misses, entries = tiling_cache_stats()
+    assert (hits, misses, entries) == (1, 2, 2)
+
+
+def test_tiling_cache_clear():
+    input_x = torch.eye(16, dtype=torch.float16).repeat(2, 1, 1).npu()
+    torch.ops.npu.triangular_inverse(input_x)
+    torch.ops.npu.tiling_cache_clear()
+    assert tiling_cache_stats() == (0, 0, 0)
+
+
+def test_tiling_cache_miss_during_capture_is_rejected():
+    torch.ops.npu.tiling_cache_clear()
+    input_x = torch.eye(32, dtype=torch.float32).repeat(4, 1, 1).npu()
+
+    graph = torch.npu.NPUGraph()
+    torch.npu.synchronize()
+    capture_stream = torch.npu.Stream()
+    raised = False
+    try:
+        with torch.npu.graph(graph, stream=capture_stream):
+            torch.ops.npu.triangular_inverse(input_x)
+    except RuntimeError as e:
+        raised = "warm the op up" in str(e)
+    torch.npu.synchronize()
+    assert raised
+
+    # Warmed up, the capture hits the cache and replays the cached tiling
+    expected = torch.ops.npu.triangular_inverse(input_x)
+    graph = torch.npu.NPUGraph()
+    torch.npu.synchronize()
+    with torch.npu.graph(graph, stream=capture_stream):
+        output = torch.ops.npu.triangular_inverse(input_x)
+    graph.replay()
+    torch.npu.synchronize()
+    assert torch.equal(output, expected)
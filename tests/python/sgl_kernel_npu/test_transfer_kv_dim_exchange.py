@@ -223,6 +223,57 @@ class TestTransferKV(unittest.TestCase):
             msg="device v sum() * 2 should be equal to host value after transfer k h2d",
         )
 
+    def _page_indices(self, pages):
+        offsets = torch.arange(PAGE_SIZE, dtype=torch.int64)
+        return (
+            torch.tensor(pages, dtype=torch.int64)[:, None] * PAGE_SIZE + offsets
+        ).flatten()
+
+    def _scattered_transfer(self, flags: TransferFlag):
+        torch.npu.set_device(0)
+        num_layers = 4
+        # a long run, a reversed stretch and isolated pages, so both copy shapes are used
+        device_pages = list(range(2, 14)) + [20, 19, 18] + [25, 0]
+        host_pages = list(range(5, 17)) + [1, 2, 3] + [29, 17]
+
+        device_k = torch.randn(
+            (num_layers, NUM_PAGES, PAGE_SIZE, HEAD_NUM_PER_TP, HEAD_DIM),
+            dtype=torch.bfloat16,
+            device="npu",
+        )
+        if flags == TransferFlag.FAST2D:
+            host_shape = (NUM_PAGES, num_layers, PAGE_SIZE, HEAD_NUM_PER_TP, HEAD_DIM)
+        else:
+            host_shape = (num_layers, NUM_PAGES, PAGE_SIZE, HEAD_NUM_PER_TP, HEAD_DIM)
+        host_k = torch.zeros(host_shape, dtype=torch.bfloat16, pin_memory=True)
+
+        transfer_kv_dim_exchange(
+            device_indices=self._page_indices(device_pages),
+            host_indices=self._page_indices(host_pages),
+            device_k=device_k,
+            host_k=host_k,
+            device_v=torch.empty(0),
+            host_v=torch.empty(0),
+            page_size=PAGE_SIZE,
+            direction=TransferDirection.D2H,
+            flags=flags,
+        )
+        torch.npu.synchronize()
+
+        expected = device_k.cpu()
+        for device_page, host_page in zip(device_pages, host_pages):
+            if flags == TransferFlag.FAST2D:
+                actual = host_k[host_page]
+            else:
+                actual = host_k[:, host_page]
+            self.assertTrue(torch.equal(actual, expected[:, device_page]))
+
+    def test_scattered_pages_copy_2d(self):
+        self._scattered_transfer(TransferFlag.FAST2D)
+
+    def test_scattered_pages_copy_1d(self):
+        self._scattered_transfer(TransferFlag.FAST1D)
+
 
 if __name__ == "__main__":
     unittest.main()
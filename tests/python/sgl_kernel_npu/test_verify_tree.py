@@ -129,5 +129,92 @@ def test_verify_tree_greedy_simple():
     assert torch.allclose(accept_token_num_gt, accept_token_num)
 
 
+def make_ascendc_inputs():
+    candidates = torch.tensor(
+        [[0, 1, 2, 3, 4, 5], [7, 8, 9, 10, 11, 12]], dtype=torch.int64, device="npu"
+    )
+    retrive_index = torch.arange(12, dtype=torch.int64, device="npu").view(2, 6)
+    retrive_next_token = torch.tensor(
+        [[1, 2, -1, 4, 5, -1], [4, 2, 3, -1, 5, -1]], dtype=torch.int64, device="npu"
+    )
+    retrive_next_sibling = torch.tensor(
+        [[-1, 3, -1, -1, -1, -1], [-1, -1, -1, -1, 1, -1]],
+        dtype=torch.int64,
+        device="npu",
+    )
+    target_predict = torch.tensor(
+        [[3, 18, 18, 4, 5, 18], [11, 18, 18, 18, 12, 18]],
+        dtype=torch.int64,
+        device="npu",
+    )
+    return (
+        candidates,
+        retrive_index,
+        retrive_next_token,
+        retrive_next_sibling,
+        target_predict,
+    )
+
+
+def test_verify_tree_greedy_ascendc():
+    import sgl_kernel_npu
+
+    bs, num_spec_step = 2, 4
+    predicts = torch.full((12,), -1, dtype=torch.int32, device="npu")
+    accept_index = torch.full((bs, num_spec_step), -1, dtype=torch.int32, device="npu")
+    accept_token_num = torch.zeros((bs,), dtype=torch.int32, device="npu")
+
+    # without out_cache_loc/accept_tokens/keep_cache_loc only the Triton outputs are written
+    torch.ops.npu.verify_tree_greedy(
+        predicts, accept_index, accept_token_num, *make_ascendc_inputs()
+    )
+
+    predicts_gt, accept_index_gt, accept_token_num_gt = verify_tree_greedy_native(
+        torch.full_like(predicts, -1),
+        torch.full_like(accept_index, -1),
+        torch.zeros_like(accept_token_num),
+        *make_ascendc_inputs(),
+        topk=4,
+    )
+    assert predicts.tolist() == predicts_gt.tolist()
+    assert accept_index.tolist() == accept_index_gt.tolist()
+    assert accept_token_num.tolist() == accept_token_num_gt.tolist()
+    assert accept_token_num.tolist() == [3, 2]
+
+
+def test_verify_tree_greedy_ascendc_compact():
+    import sgl_kernel_npu
+
+    out_cache_loc = torch.arange(100, 112, dtype=torch.int64, device="npu")
+    bs, num_spec_step = 2, 4
+
+    predicts = torch.full((12,), -1, dtype=torch.int32, device="npu")
+    accept_index = torch.full((bs, num_spec_step), -1, dtype=torch.int32, device="npu")
+    accept_token_num = torch.zeros((bs,), dtype=torch.int32, device="npu")
+    accept_tokens = torch.full(
+        (bs * num_spec_step,), -1, dtype=torch.int32, device="npu"
+    )
+    keep_cache_loc = torch.full(
+        (bs * num_spec_step,), -1, dtype=torch.int64, device="npu"
+    )
+
+    torch.ops.npu.verify_tree_greedy(
+        predicts,
+        accept_index,
+        accept_token_num,
+        *make_ascendc_inputs(),
+        out_cache_loc=out_cache_loc,
+        accept_tokens=accept_tokens,
+        keep_cache_loc=keep_cache_loc,
+    )
+
+    assert predicts.tolist() == [3, -1, -1, 4, 5, 18, 11, -1, -1, -1, 12, 18]
+    assert accept_index.tolist() == [[0, 3, 4, 5], [6, 10, 11, -1]]
+    assert accept_token_num.tolist() == [3, 2]
+    # dense over requests: (3 + 1) tokens of request 0, then (2 + 1) of request 1
+    assert accept_tokens.tolist()[:7] == [3, 4, 5, 18, 11, 12, 18]
+    assert keep_cache_loc.tolist()[:7] == [100, 103, 104, 105, 106, 110, 111]
+
+
 if __name__ == "__main__":
     pytest.main([__file__])